@@ -4,7 +4,12 @@
 #include "cache.h"
 #include "performance.h"
 #include "platform.h"
-#include <unordered_set>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace superbblas {
 
@@ -280,19 +285,111 @@ namespace superbblas {
                     })};
         }
 
-        inline std::unordered_set<char *> &getAllocatedBuffers(const Cpu &) {
-            static std::unordered_set<char *> allocs(16);
-            return allocs;
+        /// Return the size class of an allocation and the size of the allocations in that class
+        /// \param size: requested allocation size in bytes
+        /// \param class_size: (out) size in bytes of the allocations in the returned class
+        ///
+        /// NOTE: each power of two is split into four classes, so at most 25% of the allocation is
+        /// wasted by rounding up the requested size.
+
+        inline std::size_t get_buffer_size_class(std::size_t size, std::size_t &class_size) {
+            // Minimum allocation is 256 bytes, that is 2^8
+            constexpr unsigned int min_log2 = 8;
+            if (size <= (std::size_t(1) << min_log2)) {
+                class_size = std::size_t(1) << min_log2;
+                return 0;
+            }
+
+            // Find b such that 2^b < size <= 2^(b+1)
+            unsigned int b = min_log2;
+            while ((std::size_t(1) << (b + 1)) < size) ++b;
+            std::size_t base = std::size_t(1) << b, step = base / 4;
+            std::size_t q = (size - base + step - 1) / step;
+            class_size = base + q * step;
+            return (b - min_log2) * 4 + q;
+        }
+
+        /// Free lists of the buffers allocated with `allocateBufferResouce`, lists[key], where
+        /// `key` is returned by `get_buffer_pool_key`
+        ///
+        /// NOTE: the buffers are pushed back when the last user releases them, which may happen on
+        /// any thread, so the lists are guarded by a mutex. The buffers are removed from the lists
+        /// when evicted from cache.
+
+        struct BufferFreeLists {
+            std::mutex mutex;
+            std::unordered_map<std::size_t, std::vector<char *>> lists;
+
+            /// Append a buffer to a free list
+            /// \param key: free list
+            /// \param ptr: buffer
+
+            void push(std::size_t key, char *ptr) {
+                std::lock_guard<std::mutex> g(mutex);
+                lists[key].push_back(ptr);
+            }
+
+            /// Remove and return the last buffer in a free list, or null if the list is empty
+            /// \param key: free list
+
+            char *pop(std::size_t key) {
+                std::lock_guard<std::mutex> g(mutex);
+                auto it = lists.find(key);
+                if (it == lists.end() || it->second.size() == 0) return nullptr;
+                char *ptr = it->second.back();
+                it->second.pop_back();
+                if (it->second.size() == 0) lists.erase(it);
+                return ptr;
+            }
+
+            /// Remove a buffer from a free list if it is there
+            /// \param key: free list
+            /// \param ptr: buffer
+
+            void erase(std::size_t key, char *ptr) {
+                std::lock_guard<std::mutex> g(mutex);
+                auto it = lists.find(key);
+                if (it == lists.end()) return;
+                auto ptr_it = std::find(it->second.begin(), it->second.end(), ptr);
+                if (ptr_it == it->second.end()) return;
+                *ptr_it = it->second.back();
+                it->second.pop_back();
+                if (it->second.size() == 0) lists.erase(it);
+            }
+
+            /// Remove all buffers from the free lists
+            void clear() {
+                std::lock_guard<std::mutex> g(mutex);
+                lists.clear();
+            }
+        };
+
+        /// Return the key of the free list for a size class, a backup device and external use
+        /// \param size_class: size class returned by `get_buffer_size_class`
+        /// \param device: backup device of the allocation
+        /// \param external_use: whether the allocation will be used by other libraries such as MPI
+
+        inline std::size_t get_buffer_pool_key(std::size_t size_class, int device,
+                                               bool external_use) {
+            return (size_class << 16) | (std::size_t(device + 1) << 1) | (external_use ? 1u : 0u);
+        }
+
+        // NOTE: the free lists are never destroyed, as the cached buffers may be released while
+        // destroying the caches at exit
+
+        inline BufferFreeLists &getAllocatedBuffers(const Cpu &) {
+            static BufferFreeLists *allocs = new BufferFreeLists;
+            return *allocs;
         }
 
 #ifdef SUPERBBLAS_USE_GPU
-        inline std::vector<std::unordered_set<char *>> &getAllocatedBuffersGpu() {
-            static std::vector<std::unordered_set<char *>> allocs(getGpuDevicesCount() + 1,
-                                                                  std::unordered_set<char *>(16));
-            return allocs;
+        inline std::vector<BufferFreeLists> &getAllocatedBuffersGpu() {
+            static std::vector<BufferFreeLists> *allocs =
+                new std::vector<BufferFreeLists>(getGpuDevicesCount() + 1);
+            return *allocs;
         }
 
-        inline std::unordered_set<char *> &getAllocatedBuffers(const Gpu &xpu) {
+        inline BufferFreeLists &getAllocatedBuffers(const Gpu &xpu) {
             return getAllocatedBuffersGpu().at(deviceId(xpu) + 1);
         }
 #endif
@@ -332,42 +429,49 @@ namespace superbblas {
 
             // Get alignment and the worst case size to adjust for alignment
             if (alignment == 0) alignment = default_alignment<T>::alignment;
-            std::size_t size = (n + (alignment + sizeof(T) - 1) / sizeof(T)) * sizeof(T);
+            std::size_t alignment_elems = (alignment + sizeof(T) - 1) / sizeof(T);
+            std::size_t size = (n + alignment_elems) * sizeof(T);
+
+            // Round up the size to the size class
+            std::size_t selected_buffer_size = 0;
+            const std::size_t size_class = get_buffer_size_class(size, selected_buffer_size);
 
-            // Look for the smallest free allocation that can hold the requested size.
-            // Also, update `getAllocatedBuffers` by removing the buffers not longer in cache.
+            // Pop free buffers from the free list of the size class until finding one not in use.
             // We take extra care for the fake gpu allocations (the ones with device == CPU_DEVICE_ID):
-            // we avoid sharing allocations for different backup devices. It should work without this hack,
-            // but it avoids correlation between different devices.
+            // we avoid sharing allocations for different backup devices. It should work without this
+            // hack, but it avoids correlation between different devices.
             auto cache =
                 getCache<char *, AllocationEntry, std::hash<char *>, allocate_buffer_t>(xpu);
-            auto &all_buffers = getAllocatedBuffers(xpu);
-            std::vector<char *> buffers_to_remove;
-            std::size_t selected_buffer_size = std::numeric_limits<std::size_t>::max();
+            const int backup_device = backupDeviceId(xpu);
+            const std::size_t pool_key = get_buffer_pool_key(size_class, backup_device, external_use);
+            BufferFreeLists *free_lists = &getAllocatedBuffers(xpu);
             std::shared_ptr<char> selected_buffer;
-            for (char *buffer_ptr : all_buffers) {
+            while (!selected_buffer) {
+                char *buffer_ptr = free_lists->pop(pool_key);
+                if (!buffer_ptr) break;
                 auto it = cache.find(buffer_ptr);
-                if (it == cache.end()) {
-                    buffers_to_remove.push_back(buffer_ptr);
-                } else if (it->second.value.device == backupDeviceId(xpu) &&
-                           it->second.value.external_use == external_use &&
-                           it->second.value.res.use_count() == 1 && it->second.value.size >= size &&
-                           it->second.value.size < selected_buffer_size) {
-                    selected_buffer_size = it->second.value.size;
+                if (it != cache.end() && it->second.value.device == backup_device &&
+                    it->second.value.external_use == external_use &&
+                    it->second.value.res.use_count() == 1 &&
+                    it->second.value.size == selected_buffer_size)
                     selected_buffer = it->second.value.res;
-                }
             }
-            for (char *buffer_ptr : buffers_to_remove) all_buffers.erase(buffer_ptr);
 
-            // If no suitable buffer was found, create a new one and cache it
+            // If no suitable buffer was found, create a new one and cache it; the buffer is removed
+            // from the free list when evicted from cache
             if (!selected_buffer) {
-                selected_buffer = allocateResouce<T>(n, xpu, alignment, external_use).second;
-                selected_buffer_size = size;
-                all_buffers.insert(selected_buffer.get());
-                cache.insert(
-                    selected_buffer.get(),
-                    AllocationEntry{size, selected_buffer, backupDeviceId(xpu), external_use},
-                    size);
+                std::shared_ptr<char> res =
+                    allocateResouce<T>((selected_buffer_size + sizeof(T) - 1) / sizeof(T) -
+                                           alignment_elems,
+                                       xpu, alignment, external_use)
+                        .second;
+                selected_buffer = std::shared_ptr<char>(
+                    res.get(),
+                    [res, free_lists, pool_key](char *ptr) { free_lists->erase(pool_key, ptr); });
+                cache.insert(selected_buffer.get(),
+                             AllocationEntry{selected_buffer_size, selected_buffer, backup_device,
+                                             external_use},
+                             selected_buffer_size);
             }
 
             // Connect the allocation stream with the current stream and make sure to connect back as soon as
@@ -377,11 +481,18 @@ namespace superbblas {
             setDevice(xpu);
             causalConnectTo(allocStream, stream);
             auto return_buffer = std::shared_ptr<char>(
-                selected_buffer.get(), [stream, allocStream, selected_buffer, device](char *) {
+                selected_buffer.get(),
+                [stream, allocStream, selected_buffer, device, free_lists,
+                 pool_key](char *ptr) mutable {
                     if (stream != allocStream) {
                         setDevice(device);
                         causalConnectTo(stream, allocStream);
                     }
+
+                    // Drop this reference before returning the buffer to the free list; otherwise
+                    // a concurrent pop may find the buffer still in use and discard it
+                    selected_buffer.reset();
+                    free_lists->push(pool_key, ptr);
                 });
 
             // Align and return the buffer
@@ -389,6 +500,105 @@ namespace superbblas {
                                       selected_buffer_size);
             return {ptr_aligned, return_buffer};
         }
+
+        /// Bump allocator for the scratch memory used by a single thread
+        ///
+        /// The chunks returned by `allocate` are freed all at once by `release`. The memory is kept
+        /// between calls, so the kernels don't allocate memory in their parallel regions after the
+        /// first call. Use `ScratchArenaScope` to reset the arena at the end of the region.
+
+        class ScratchArena {
+            /// Alignment of the returned chunks; a cache line
+            static constexpr std::size_t alignment = 64;
+
+            /// Memory blocks; only the last one is used to serve new chunks
+            std::vector<std::unique_ptr<char[]>> blocks;
+
+            /// Size of the last block
+            std::size_t capacity;
+
+            /// Used size of the last block
+            std::size_t used;
+
+            /// Total used size in all blocks
+            std::size_t total_used;
+
+        public:
+            /// State of the arena to be restored by `release`
+            struct Mark {
+                std::size_t nblocks;    ///< number of blocks
+                std::size_t used;       ///< used size of the last block
+                std::size_t total_used; ///< total used size in all blocks
+            };
+
+            ScratchArena() : capacity(0), used(0), total_used(0) {}
+
+            /// Return the current state of the arena; to be passed to `release`
+            Mark mark() const { return Mark{blocks.size(), used, total_used}; }
+
+            /// Return memory for `n` elements of type `T` (without calling the constructors)
+            /// \param n: number of elements
+
+            template <typename T> T *allocate(std::size_t n) {
+                std::size_t size = (sizeof(T) * n + alignment - 1) / alignment * alignment;
+                if (used + size > capacity) {
+                    // Allocate a new block big enough for all the used memory so far, so that
+                    // after the release, all chunks are served from a single block
+                    capacity = std::max(2 * capacity, total_used + size);
+                    blocks.emplace_back(new char[capacity + alignment]);
+                    used = 0;
+                }
+                char *block = blocks.back().get();
+                char *r = block + (alignment - (uintptr_t)block % alignment) % alignment + used;
+                used += size;
+                total_used += size;
+                return (T *)r;
+            }
+
+            /// Free all chunks allocated after the given mark
+            /// \param m: value returned by `mark`
+
+            void release(const Mark &m) {
+                if (m.total_used >= total_used) return;
+                total_used = m.total_used;
+
+                if (total_used == 0) {
+                    // Drop the old blocks when all the chunks are freed
+                    if (blocks.size() > 1) blocks.erase(blocks.begin(), blocks.end() - 1);
+                    used = 0;
+                } else if (blocks.size() == m.nblocks) {
+                    // The freed chunks are all in the last block
+                    used = m.used;
+                } else {
+                    // The blocks created after the mark only have freed chunks; keep the last
+                    // one, which is the largest, to serve the new chunks. The chunks still in
+                    // use stay in the blocks up to the mark
+                    blocks.erase(blocks.begin() + m.nblocks, blocks.end() - 1);
+                    used = 0;
+                }
+            }
+        };
+
+        /// Return the scratch arena of the current thread
+
+        inline ScratchArena &getScratchArena() {
+            static thread_local ScratchArena arena;
+            return arena;
+        }
+
+        /// Allocate scratch memory from the current thread arena and free it on destruction
+
+        struct ScratchArenaScope {
+            ScratchArena &arena;  ///< current thread arena
+            ScratchArena::Mark m; ///< arena mark at construction
+
+            ScratchArenaScope() : arena(getScratchArena()), m(arena.mark()) {}
+            ~ScratchArenaScope() { arena.release(m); }
+
+            /// Return memory for `n` elements of type `T` (without calling the constructors)
+            /// \param n: number of elements
+            template <typename T> T *allocate(std::size_t n) { return arena.allocate<T>(n); }
+        };
     }
 
     /// Allocate memory
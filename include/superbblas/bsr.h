@@ -1,9 +1,16 @@
 #ifndef __SUPERBBLAS_BSR__
 #define __SUPERBBLAS_BSR__
 
+#include "dense.h"
 #include "dist.h"
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <mutex>
 #include <numeric>
 #include <stdexcept>
+#include <unordered_map>
+#include <unistd.h>
 
 namespace superbblas {
 
@@ -77,12 +84,20 @@ namespace superbblas {
             bool blockImFast; ///< whether the image indices are the fastest on the dense blocks
             CoorOrder co;     ///< Coordinate order of ii and jj
             unsigned int componentId; ///< Component Id
+            bool lowPrecision = false; ///< whether to keep the nonzero values in lower precision
+            bool hermitian = false;    ///< whether only the diagonal and upper blocks are given
+            Coor<Nd> fromdi{};         ///< first domain element relative to the first image
+                                       ///< element, for hermitian operators
+            Coor<Nd> dimh{};           ///< dimensions of the whole operator, for hermitian
+                                       ///< operators
 
             template <typename Q = T, typename = typename std::enable_if<std::is_same<
                                           Q, typename std::remove_const<Q>::type>::value>::type>
             operator BSRComponent<Nd, Ni, const Q, XPU>() const {
-                return {i,     j,     it,      dimd,        dimi, blockd,     blocki,
-                        krond, kroni, kron_it, blockImFast, co,   componentId};
+                return {i,           j,         it,          dimd,         dimi,
+                        blockd,      blocki,    krond,       kroni,        kron_it,
+                        blockImFast, co,        componentId, lowPrecision, hermitian,
+                        fromdi,      dimh};
             }
         };
 
@@ -245,6 +260,1442 @@ namespace superbblas {
             }
         }
 
+        ///
+        /// BSR-dense matrix multiplication on CPU
+        ///
+
+        /// Type used to store the nonzeros of a BSR operator in lower precision
+
+        template <typename T> struct lower_precision {
+            using type = T;
+        };
+        template <> struct lower_precision<double> {
+            using type = float;
+        };
+        template <> struct lower_precision<std::complex<double>> {
+            using type = std::complex<float>;
+        };
+
+        /// Compressed column indices of a BSR operator on CPU: the first row of x for a nonzero
+        /// block is given by an offset from a table plus the first row of x with the same
+        /// index as the block row, which for stencil-like operators takes few distinct values
+
+        struct BSRCompressedIndices {
+            std::vector<IndexType> delta; ///< offsets
+            vector<std::uint8_t, Cpu> j8; ///< index on `delta` for each block, if it fits
+            vector<std::uint16_t, Cpu> j16; ///< index on `delta` for each block, if it fits
+        };
+
+        /// Return the first row of x for a nonzero block, or -1 if the block should be skipped
+        /// \param jj: first row of x for each nonzero block, or -1 to skip the block
+        /// \param j: nonzero block index
+
+        inline IndexType bsr_col(const IndexType *SB_RESTRICT jj, IndexType j,
+                                 const IndexType *, IndexType) {
+            return jj[j];
+        }
+
+        /// Return the first row of x for a nonzero block, or -1 if the block should be skipped
+        /// \param jj: index on `jdelta` for each nonzero block, or the maximum value of JT to
+        ///        skip the block
+        /// \param j: nonzero block index
+        /// \param jdelta: offsets
+        /// \param jbase: first row of x with the same index as the block row
+
+        template <typename JT>
+        inline IndexType bsr_col(const JT *SB_RESTRICT jj, IndexType j,
+                                 const IndexType *SB_RESTRICT jdelta, IndexType jbase) {
+            return jj[j] == std::numeric_limits<JT>::max() ? -1 : jbase + jdelta[jj[j]];
+        }
+
+        /// Return c + a * b; on complex types, avoid the checks for infinities of the standard
+        /// multiplication that prevent vectorization
+
+        template <typename T> inline T bsr_madd(const T &c, const T &a, const T &b) {
+            return c + a * b;
+        }
+
+        inline _Complex float bsr_madd(const _Complex float &c, const _Complex float &a,
+                                       const _Complex float &b) {
+            _Complex float r;
+            __real__ r = __real__ c + __real__ a * __real__ b - __imag__ a * __imag__ b;
+            __imag__ r = __imag__ c + __real__ a * __imag__ b + __imag__ a * __real__ b;
+            return r;
+        }
+
+        inline _Complex double bsr_madd(const _Complex double &c, const _Complex double &a,
+                                        const _Complex double &b) {
+            _Complex double r;
+            __real__ r = __real__ c + __real__ a * __real__ b - __imag__ a * __imag__ b;
+            __imag__ r = __imag__ c + __real__ a * __imag__ b + __imag__ a * __real__ b;
+            return r;
+        }
+
+        /// Return the complex conjugate of a value
+
+        template <typename T> inline T bsr_conj(const T &a) { return a; }
+
+        inline _Complex float bsr_conj(const _Complex float &a) {
+            _Complex float r;
+            __real__ r = __real__ a;
+            __imag__ r = -__imag__ a;
+            return r;
+        }
+
+        inline _Complex double bsr_conj(const _Complex double &a) {
+            _Complex double r;
+            __real__ r = __real__ a;
+            __imag__ r = -__imag__ a;
+            return r;
+        }
+
+        /// Contract the nonzero blocks of a block row of a BSR operator with NK columns of a
+        /// dense matrix, keeping the output block on local accumulators
+        /// \tparam BI: if greater than zero, the number of rows of the blocks known at compile time
+        /// \tparam BD: if greater than zero, the number of columns of the blocks known at compile
+        ///         time
+        /// \tparam NK: number of columns to contract
+        /// \tparam TA: type of the nonzero blocks, converted into T before the multiplication
+        /// \param bi: number of rows of the blocks, at most 64
+        /// \param bd: number of columns of the blocks
+        /// \param alpha: factor on the contraction
+        /// \param nonzeros: nonzero blocks
+        /// \param tb: whether the blocks are stored in row-major
+        /// \param jj: first row of x for each nonzero block, see `bsr_col`
+        /// \param jdelta: offsets for the compressed column indices, see `bsr_col`
+        /// \param jbase: first row of x for the compressed column indices of the block row
+        /// \param j0: first nonzero block of the block row
+        /// \param j1: last nonzero block of the block row plus one
+        /// \param x: input dense matrix
+        /// \param xr: distance between consecutive rows of x
+        /// \param xc: distance between consecutive columns of x
+        /// \param y: first row of the block row on the output dense matrix
+        /// \param yr: distance between consecutive rows of y
+        /// \param yc: distance between consecutive columns of y
+        /// \param k: first column to contract
+
+        template <int BI, int BD, int NK, typename T, typename TA = T, typename JT = IndexType>
+        void bsr_block_row_cpu(IndexType bi, IndexType bd, const T &alpha,
+                               const TA *SB_RESTRICT nonzeros, bool tb, const JT *SB_RESTRICT jj,
+                               const IndexType *SB_RESTRICT jdelta, IndexType jbase, IndexType j0,
+                               IndexType j1, const T *SB_RESTRICT x, IndexType xr, IndexType xc,
+                               T *SB_RESTRICT y, IndexType yr, IndexType yc, IndexType k) {
+            const IndexType bi_ = (BI > 0 ? BI : bi), bd_ = (BD > 0 ? BD : bd);
+            T acc[BI > 0 ? BI : 64][NK];
+            for (IndexType r = 0; r < bi_; ++r)
+                for (int n = 0; n < NK; ++n) acc[r][n] = 0;
+            for (IndexType j = j0; j < j1; ++j) {
+                const IndexType col = bsr_col(jj, j, jdelta, jbase);
+                if (col == -1) continue;
+                const TA *SB_RESTRICT a = nonzeros + j * bi_ * bd_;
+                const T *SB_RESTRICT xj = x + col * xr + k * xc;
+                if (tb) {
+                    for (IndexType r = 0; r < bi_; ++r) {
+                        for (IndexType c = 0; c < bd_; ++c) {
+                            const T arc = a[r * bd_ + c];
+                            for (int n = 0; n < NK; ++n)
+                                acc[r][n] = bsr_madd(acc[r][n], arc, xj[c * xr + n * xc]);
+                        }
+                    }
+                } else {
+                    for (IndexType c = 0; c < bd_; ++c) {
+                        for (IndexType r = 0; r < bi_; ++r) {
+                            const T arc = a[r + c * bi_];
+                            for (int n = 0; n < NK; ++n)
+                                acc[r][n] = bsr_madd(acc[r][n], arc, xj[c * xr + n * xc]);
+                        }
+                    }
+                }
+            }
+            for (IndexType r = 0; r < bi_; ++r)
+                for (int n = 0; n < NK; ++n)
+                    y[r * yr + (k + n) * yc] = bsr_madd(T{0}, alpha, acc[r][n]);
+        }
+
+        /// Function contracting a block row, see `bsr_block_row_cpu`
+        template <typename T, typename TA = T, typename JT = IndexType>
+        using BSRBlockRowKernel = void (*)(IndexType, IndexType, const T &, const TA *, bool,
+                                           const JT *, const IndexType *, IndexType, IndexType,
+                                           IndexType, const T *, IndexType, IndexType, T *,
+                                           IndexType, IndexType, IndexType);
+
+        /// Return the microkernel for the given block dimensions, with the common dimensions,
+        /// mostly coming from spin and color, given at compile time; return null if the blocks
+        /// are too large
+        /// \param bi: number of rows of the blocks
+        /// \param bd: number of columns of the blocks
+
+        template <int NK, typename T, typename TA = T, typename JT = IndexType>
+        BSRBlockRowKernel<T, TA, JT> get_bsr_block_row_kernel(IndexType bi, IndexType bd) {
+            if (bi > 64) return nullptr;
+            if (bi != bd) return bsr_block_row_cpu<0, 0, NK, T, TA, JT>;
+            switch (bi) {
+            case 2: return bsr_block_row_cpu<2, 2, NK, T, TA, JT>;
+            case 3: return bsr_block_row_cpu<3, 3, NK, T, TA, JT>;
+            case 4: return bsr_block_row_cpu<4, 4, NK, T, TA, JT>;
+            case 6: return bsr_block_row_cpu<6, 6, NK, T, TA, JT>;
+            case 8: return bsr_block_row_cpu<8, 8, NK, T, TA, JT>;
+            case 12: return bsr_block_row_cpu<12, 12, NK, T, TA, JT>;
+            default: return bsr_block_row_cpu<0, 0, NK, T, TA, JT>;
+            }
+        }
+
+        /// Return the number of threads available for the CPU kernels
+
+        inline int get_max_cpu_threads() {
+#ifdef _OPENMP
+            return omp_get_max_threads();
+#else
+            return 1;
+#endif
+        }
+
+        /// Return a partition of the block rows into consecutive ranges with about the same
+        /// number of nonzero blocks, one range for each thread; the range of the t-th thread is
+        /// [r[t], r[t+1])
+        /// \param ii: first nonzero block of each block row, with block_rows+1 elements
+        /// \param block_rows: number of block rows
+        /// \param num_threads: number of ranges
+
+        inline std::vector<IndexType> get_balanced_row_partition(const IndexType *ii,
+                                                                 IndexType block_rows,
+                                                                 int num_threads) {
+            // The cost of a block row is its number of nonzero blocks plus one for writing the
+            // output, so that empty rows are also distributed
+            num_threads = std::max(1, num_threads);
+            std::vector<IndexType> r(num_threads + 1);
+            const double total_cost = (double)ii[block_rows] - ii[0] + block_rows;
+            r[0] = 0;
+            for (int t = 1; t < num_threads; ++t) {
+                const double cost = total_cost * t / num_threads;
+                IndexType i0 = r[t - 1], i1 = block_rows;
+                while (i0 < i1) {
+                    IndexType m = i0 + (i1 - i0) / 2;
+                    if ((double)ii[m] - ii[0] + m < cost)
+                        i0 = m + 1;
+                    else
+                        i1 = m;
+                }
+                r[t] = i0;
+            }
+            r[num_threads] = block_rows;
+            return r;
+        }
+
+        /// Call a function on ranges of block rows in parallel, following a partition
+        /// \param row_part: partition of the block rows, see `get_balanced_row_partition`; if
+        ///        empty, split the block rows evenly
+        /// \param block_rows: number of block rows
+        /// \param f: function called with the first block row and the last one plus one
+
+        template <typename F>
+        void parallel_for_block_rows(const std::vector<IndexType> &row_part, IndexType block_rows,
+                                     const F &f) {
+#ifdef _OPENMP
+#    pragma omp parallel
+#endif
+            {
+#ifdef _OPENMP
+                IndexType num_threads = omp_get_num_threads();
+                IndexType t = omp_get_thread_num();
+#else
+                IndexType num_threads = 1, t = 0;
+#endif
+                if (row_part.size() == 0) {
+                    f(block_rows / num_threads * t + std::min(block_rows % num_threads, t),
+                      block_rows / num_threads * (t + 1) +
+                          std::min(block_rows % num_threads, t + 1));
+                } else {
+                    // Assign consecutive parts to each thread if the number of threads changed
+                    // after computing the partition
+                    IndexType num_parts = row_part.size() - 1;
+                    f(row_part[num_parts * t / num_threads],
+                      row_part[num_parts * (t + 1) / num_threads]);
+                }
+            }
+        }
+
+        /// Return the size in bytes of the last level cache of the CPU, or 1 MiB if it can't be
+        /// detected
+
+        inline std::size_t get_cpu_last_level_cache_size() {
+            static const std::size_t size = []() {
+                long s = 0;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+                s = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+#ifdef _SC_LEVEL2_CACHE_SIZE
+                if (s <= 0) s = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+                return s > 0 ? (std::size_t)s : (std::size_t)1024 * 1024;
+            }();
+            return size;
+        }
+
+        /// Return the typical number of blocks of rows of x between the first and the last
+        /// nonzero blocks of a block row, that is, the median over the block rows; a block of
+        /// x loaded by a block row is reused by the block rows within about that distance
+        /// \param block_rows: number of block rows
+        /// \param bd: number of columns of the blocks
+        /// \param ii: first nonzero block of each block row, with block_rows+1 elements
+        /// \param jj: first row of x for each nonzero block, or -1 to skip the block
+
+        inline IndexType get_bsr_column_span(IndexType block_rows, IndexType bd,
+                                             const IndexType *ii, const IndexType *jj) {
+            std::vector<IndexType> spans;
+            spans.reserve(block_rows);
+            for (IndexType i = 0; i < block_rows; ++i) {
+                IndexType first = std::numeric_limits<IndexType>::max(), last = -1;
+                for (IndexType j = ii[i]; j < ii[i + 1]; ++j) {
+                    if (jj[j] == -1) continue;
+                    first = std::min(first, jj[j]);
+                    last = std::max(last, jj[j]);
+                }
+                if (last >= 0) spans.push_back((last - first) / bd + 1);
+            }
+            if (spans.size() == 0) return 0;
+            std::nth_element(spans.begin(), spans.begin() + spans.size() / 2, spans.end());
+            return spans[spans.size() / 2];
+        }
+
+        /// Return the number of columns of x and y to process at once on the builtin CPU BSR
+        /// matvec, so that the blocks of x reused by nearby block rows stay on the last level
+        /// cache; return ncols if it doesn't pay off to split the columns
+        /// \param ncols: number of columns of x and y
+        /// \param bi: number of rows of the blocks
+        /// \param bd: number of columns of the blocks
+        /// \param span: typical distance between reuses of x, see `get_bsr_column_span`
+        /// \param elem_size: size in bytes of the elements of x
+
+        inline IndexType get_bsr_rhs_tile(IndexType ncols, IndexType bi, IndexType bd,
+                                          IndexType span, std::size_t elem_size) {
+            const int user_tile = getBSRRhsTile();
+            if (user_tile > 0) return std::min((IndexType)user_tile, ncols);
+            if (user_tile < 0 || ncols <= 4 || span <= 0) return ncols;
+
+            // Take half of the cache for the blocks of x used by all threads; every tile reads
+            // again all the nonzero blocks, which pays off only if the tiles have at least as
+            // many columns as the blocks have rows
+            IndexType tile = get_cpu_last_level_cache_size() / 2 / get_max_cpu_threads() /
+                             ((std::size_t)span * bd * elem_size);
+            if (tile >= ncols || tile < bi || tile < 4) return ncols;
+
+            // Split the columns evenly into tiles with a multiple of four columns, as the
+            // microkernels process four columns at once
+            const IndexType num_tiles = (ncols + tile - 1) / tile;
+            return std::min(ncols, ((ncols + num_tiles - 1) / num_tiles + 3) / 4 * 4);
+        }
+
+        /// Return the index on the table of offsets for each nonzero block, see
+        /// `get_bsr_compressed_indices`
+        /// \param delta_idx: index on the table for each offset
+
+        template <typename JT>
+        vector<JT, Cpu>
+        get_bsr_delta_indices(IndexType block_rows, IndexType bd, const IndexType *ii,
+                              const IndexType *jj,
+                              const std::unordered_map<IndexType, IndexType> &delta_idx,
+                              const std::vector<IndexType> &row_part) {
+            // Write the indices with the threads that are going to use them
+            vector<JT, Cpu> r(ii[block_rows], Cpu{});
+            JT *rp = r.data();
+            parallel_for_block_rows(row_part, block_rows, [&](IndexType i0, IndexType i1) {
+                for (IndexType i = i0; i < i1; ++i)
+                    for (IndexType j = ii[i]; j < ii[i + 1]; ++j)
+                        rp[j] = jj[j] == -1 ? std::numeric_limits<JT>::max()
+                                            : (JT)delta_idx.at(jj[j] - i * bd);
+            });
+            return r;
+        }
+
+        /// Return the compressed column indices of a BSR operator, with 8-bit or 16-bit indices
+        /// on a table of offsets; return empty indices if there are too many distinct offsets
+        /// \param block_rows: number of block rows
+        /// \param bd: number of columns of the blocks
+        /// \param ii: first nonzero block of each block row, with block_rows+1 elements
+        /// \param jj: first row of x for each nonzero block, or -1 to skip the block
+        /// \param row_part: partition of the block rows among threads, see
+        ///        `get_balanced_row_partition`
+
+        inline BSRCompressedIndices
+        get_bsr_compressed_indices(IndexType block_rows, IndexType bd, const IndexType *ii,
+                                   const IndexType *jj, const std::vector<IndexType> &row_part) {
+
+            tracker<Cpu> _t("get bsr compressed indices", Cpu{});
+
+            // Collect the distinct offsets between the first row of x for each block and the
+            // first row of x with the same index as the block row
+            BSRCompressedIndices r;
+            std::unordered_map<IndexType, IndexType> delta_idx(16);
+            const std::size_t max_deltas = std::numeric_limits<std::uint16_t>::max();
+            for (IndexType i = 0; i < block_rows; ++i) {
+                for (IndexType j = ii[i]; j < ii[i + 1]; ++j) {
+                    if (jj[j] == -1) continue;
+                    auto it = delta_idx.find(jj[j] - i * bd);
+                    if (it != delta_idx.end()) continue;
+                    if (delta_idx.size() >= max_deltas) return {};
+                    delta_idx[jj[j] - i * bd] = r.delta.size();
+                    r.delta.push_back(jj[j] - i * bd);
+                }
+            }
+
+            // Use the smallest type able to index the offsets, and reserve its maximum value
+            // for the blocks to skip
+            if (r.delta.size() < std::numeric_limits<std::uint8_t>::max())
+                r.j8 = get_bsr_delta_indices<std::uint8_t>(block_rows, bd, ii, jj, delta_idx,
+                                                            row_part);
+            else
+                r.j16 = get_bsr_delta_indices<std::uint16_t>(block_rows, bd, ii, jj, delta_idx,
+                                                              row_part);
+            return r;
+        }
+
+        /// BSR-dense matrix multiplication on CPU with the microkernels for several operators
+        /// with the same nonzero pattern, y[op] = alpha * A[op] * x; each block row of all
+        /// operators is processed before the next one, so that the rows of x read by an operator
+        /// are found on cache by the next one; return false if there are no microkernels for the
+        /// block dimensions
+        /// \tparam TA: type of the nonzero blocks, which may have lower precision than T
+        /// \tparam JT: type of the column indices, see `bsr_col`
+        /// \param nops: number of operators
+        /// \param block_rows: number of block rows
+        /// \param bi: number of rows of the blocks
+        /// \param bd: number of columns of the blocks
+        /// \param alpha: factor on the contraction
+        /// \param nonzeros: nonzero blocks for each operator
+        /// \param tb: whether the blocks are stored in row-major
+        /// \param ii: first nonzero block of each block row, with block_rows+1 elements
+        /// \param jj: first row of x for each nonzero block, see `bsr_col`
+        /// \param jdelta: offsets for the compressed column indices, see `bsr_col`
+        /// \param x: input dense matrix
+        /// \param ldx: leading dimension of x
+        /// \param lx: layout of x
+        /// \param y: output dense matrix for each operator
+        /// \param ldy: leading dimension of y
+        /// \param ly: layout of y
+        /// \param ncols: number of columns of x and y
+        /// \param row_part: partition of the block rows among threads, see
+        ///        `get_balanced_row_partition`
+
+        template <typename T, typename TA, typename JT>
+        bool bsr_multi_matvec_microkernels_cpu(
+            unsigned int nops, IndexType block_rows, IndexType bi, IndexType bd, const T &alpha,
+            const TA *const *nonzeros, bool tb, const IndexType *ii, const JT *jj,
+            const IndexType *jdelta, const T *x, IndexType ldx, MatrixLayout lx, T *const *y,
+            IndexType ldy, MatrixLayout ly, IndexType ncols,
+            const std::vector<IndexType> &row_part) {
+
+            // Process four columns at once and the remaining columns one at a time
+            using Tc = typename ccomplex<T>::type;
+            using TAc = typename ccomplex<TA>::type;
+            BSRBlockRowKernel<Tc, TAc, JT> kernel4 =
+                get_bsr_block_row_kernel<4, Tc, TAc, JT>(bi, bd);
+            BSRBlockRowKernel<Tc, TAc, JT> kernel1 =
+                get_bsr_block_row_kernel<1, Tc, TAc, JT>(bi, bd);
+            if (!kernel4 || !kernel1) return false;
+
+            const Tc alphac = *(const Tc *)&alpha;
+            const Tc *xc = (const Tc *)x;
+            const IndexType xrs = lx == RowMajor ? ldx : 1, xcs = lx == RowMajor ? 1 : ldx;
+            const IndexType yrs = ly == RowMajor ? ldy : 1, ycs = ly == RowMajor ? 1 : ldy;
+            parallel_for_block_rows(row_part, block_rows, [&](IndexType i0, IndexType i1) {
+                for (IndexType i = i0; i < i1; ++i) {
+                    for (unsigned int op = 0; op < nops; ++op) {
+                        const TAc *nonzerosc = (const TAc *)nonzeros[op];
+                        Tc *yc = (Tc *)y[op] + i * bi * yrs;
+                        IndexType k = 0;
+                        for (; k + 4 <= ncols; k += 4)
+                            kernel4(bi, bd, alphac, nonzerosc, tb, jj, jdelta, i * bd, ii[i],
+                                    ii[i + 1], xc, xrs, xcs, yc, yrs, ycs, k);
+                        for (; k < ncols; ++k)
+                            kernel1(bi, bd, alphac, nonzerosc, tb, jj, jdelta, i * bd, ii[i],
+                                    ii[i + 1], xc, xrs, xcs, yc, yrs, ycs, k);
+                    }
+                }
+            });
+            return true;
+        }
+
+        /// BSR-dense matrix multiplication on CPU with the microkernels for several operators
+        /// with the same nonzero pattern, using the compressed column indices if given; return
+        /// false if there are no microkernels for the block dimensions
+        /// \param cjj: compressed column indices, see `get_bsr_compressed_indices`
+
+        template <typename T, typename TA>
+        bool bsr_multi_matvec_microkernels_cpu(
+            unsigned int nops, IndexType block_rows, IndexType bi, IndexType bd, const T &alpha,
+            const TA *const *nonzeros, bool tb, const IndexType *ii, const IndexType *jj,
+            const BSRCompressedIndices *cjj, const T *x, IndexType ldx, MatrixLayout lx,
+            T *const *y, IndexType ldy, MatrixLayout ly, IndexType ncols,
+            const std::vector<IndexType> &row_part) {
+            if (cjj && cjj->j8.size() > 0)
+                return bsr_multi_matvec_microkernels_cpu(
+                    nops, block_rows, bi, bd, alpha, nonzeros, tb, ii, cjj->j8.data(),
+                    cjj->delta.data(), x, ldx, lx, y, ldy, ly, ncols, row_part);
+            if (cjj && cjj->j16.size() > 0)
+                return bsr_multi_matvec_microkernels_cpu(
+                    nops, block_rows, bi, bd, alpha, nonzeros, tb, ii, cjj->j16.data(),
+                    cjj->delta.data(), x, ldx, lx, y, ldy, ly, ncols, row_part);
+            return bsr_multi_matvec_microkernels_cpu(nops, block_rows, bi, bd, alpha, nonzeros,
+                                                     tb, ii, jj, (const IndexType *)nullptr, x,
+                                                     ldx, lx, y, ldy, ly, ncols, row_part);
+        }
+
+        /// BSR-dense matrix multiplication on CPU with the microkernels, y = alpha * A * x;
+        /// return false if there are no microkernels for the block dimensions, see
+        /// `bsr_multi_matvec_microkernels_cpu`
+
+        template <typename T, typename TA>
+        bool bsr_matvec_microkernels_cpu(IndexType block_rows, IndexType bi, IndexType bd,
+                                         const T &alpha, const TA *nonzeros, bool tb,
+                                         const IndexType *ii, const IndexType *jj,
+                                         const BSRCompressedIndices *cjj, const T *x,
+                                         IndexType ldx, MatrixLayout lx, T *y, IndexType ldy,
+                                         MatrixLayout ly, IndexType ncols,
+                                         const std::vector<IndexType> &row_part) {
+            return bsr_multi_matvec_microkernels_cpu(1, block_rows, bi, bd, alpha, &nonzeros, tb,
+                                                     ii, jj, cjj, x, ldx, lx, &y, ldy, ly, ncols,
+                                                     row_part);
+        }
+
+        /// Set to zero a dense matrix on CPU
+        /// \param nrows: number of rows
+        /// \param ncols: number of columns
+        /// \param y: dense matrix
+        /// \param ldy: leading dimension of y, which may be larger than the number of rows or
+        ///        columns when y is a slice of a larger matrix, see `get_bsr_rhs_tile`
+        /// \param ly: layout of y
+
+        template <typename T>
+        void zero_dense_cpu(IndexType nrows, IndexType ncols, T *y, IndexType ldy,
+                            MatrixLayout ly) {
+            const IndexType n = ly == ColumnMajor ? nrows : ncols;
+            if (ldy == n)
+                xscal(nrows * ncols, T{0}, y, 1, Cpu{});
+            else
+                for (IndexType k = 0, nk = ly == ColumnMajor ? ncols : nrows; k < nk; ++k)
+                    xscal(n, T{0}, y + k * ldy, 1, Cpu{});
+        }
+
+        /// Return a nonzero block with values of type T
+        /// \param a: nonzero block
+        /// \param n: number of elements of the block
+        /// \param buf: buffer with room for n elements where to convert the block if needed
+
+        template <typename T> const T *bsr_block_as(const T *a, std::size_t, T *) { return a; }
+
+        template <typename T, typename TA>
+        const T *bsr_block_as(const TA *a, std::size_t n, T *buf) {
+            std::transform(a, a + n, buf, [](const TA &t) { return (T)t; });
+            return buf;
+        }
+
+        /// BSR-dense matrix multiplication on CPU, y = alpha * A * x
+        /// \param use_microkernels: whether to use the microkernels instead of a BLAS call for
+        ///        each nonzero block, see `use_bsr_microkernels`
+        /// \param block_rows: number of block rows
+        /// \param bi: number of rows of the blocks
+        /// \param bd: number of columns of the blocks
+        /// \param alpha: factor on the contraction
+        /// \param nonzeros: nonzero blocks, possibly in lower precision than x and y; BLAS
+        ///        contracts a copy of each block converted to T
+        /// \param tb: whether the blocks are stored in row-major
+        /// \param ii: first nonzero block of each block row, with block_rows+1 elements
+        /// \param jj: first row of x for each nonzero block, or -1 to skip the block
+        /// \param x: input dense matrix
+        /// \param ldx: leading dimension of x
+        /// \param lx: layout of x
+        /// \param y: output dense matrix
+        /// \param ldy: leading dimension of y
+        /// \param ly: layout of y
+        /// \param ncols: number of columns of x and y
+        /// \param row_part: partition of the block rows among threads, see
+        ///        `get_balanced_row_partition`
+        /// \param cjj: optional compressed column indices used by the microkernels, see
+        ///        `get_bsr_compressed_indices`
+
+        template <typename T, typename TA>
+        void bsr_matvec_cpu(bool use_microkernels, IndexType block_rows, IndexType bi,
+                            IndexType bd, const T &alpha, const TA *nonzeros, bool tb,
+                            const IndexType *ii, const IndexType *jj, const T *x, IndexType ldx,
+                            MatrixLayout lx, T *y, IndexType ldy, MatrixLayout ly,
+                            IndexType ncols, const std::vector<IndexType> &row_part,
+                            const BSRCompressedIndices *cjj = nullptr) {
+
+            const bool tx = lx == RowMajor;
+            const bool ty = ly == RowMajor;
+            const IndexType xs = lx == ColumnMajor ? 1 : ldx;
+
+            // Contract each block row with the microkernels
+            if (use_microkernels &&
+                bsr_matvec_microkernels_cpu(block_rows, bi, bd, alpha, nonzeros, tb, ii, jj, cjj,
+                                            x, ldx, lx, y, ldy, ly, ncols, row_part))
+                return;
+
+            // Contract each nonzero block with a BLAS call
+            zero_dense_cpu(block_rows * bi, ncols, y, ldy, ly);
+            parallel_for_block_rows(row_part, block_rows, [&](IndexType i0, IndexType i1) {
+                ScratchArenaScope scratch;
+                T *buf = std::is_same<T, TA>::value ? nullptr : scratch.allocate<T>(bi * bd);
+                for (IndexType i = i0; i < i1; ++i) {
+                    for (IndexType j = ii[i], j1 = ii[i + 1]; j < j1; ++j) {
+                        if (jj[j] == -1) continue;
+                        const T *a = bsr_block_as(nonzeros + j * bi * bd, bi * bd, buf);
+                        if (ncols == 1)
+                            xgemv(tb ? 'T' : 'N', tb ? bd : bi, tb ? bi : bd, alpha, a,
+                                  tb ? bd : bi, x + jj[j] * xs, tx ? ldx : 1, T{1},
+                                  y + i * bi * (ty ? ldy : 1), ty ? ldy : 1, Cpu{});
+                        else if (ly == ColumnMajor)
+                            xgemm(tb ? 'T' : 'N', tx ? 'T' : 'N', bi, ncols, bd, alpha, a,
+                                  tb ? bd : bi, x + jj[j] * xs, ldx, T{1}, y + i * bi, ldy,
+                                  Cpu{});
+                        else
+                            xgemm(!tx ? 'T' : 'N', !tb ? 'T' : 'N', ncols, bi, bd, alpha,
+                                  x + jj[j] * xs, ldx, a, tb ? bd : bi, T{1}, y + i * bi * ldy,
+                                  ldy, Cpu{});
+                    }
+                }
+            });
+        }
+
+        /// Return whether to contract the nonzero blocks on the builtin CPU BSR matvec with the
+        /// microkernels instead of a BLAS call for each nonzero block. The microkernels keep
+        /// `naccs` accumulators for each row of the block and each of up to four columns, and
+        /// they are used if the accumulators fit on sixteen 256-bit registers; otherwise they
+        /// spill on every update, and BLAS does better. The choice doesn't depend on timings, so
+        /// the results are reproducible, see `getUseBSRMicrokernels`
+        /// \param bi: number of rows of the blocks
+        /// \param ncols: number of columns of x and y
+        /// \param naccs: number of accumulators for each row and column
+
+        template <typename T>
+        bool use_bsr_microkernels(IndexType bi, IndexType ncols, IndexType naccs = 1) {
+            const int mode = getUseBSRMicrokernels();
+            if (mode == 0 || bi > 64) return false;
+            if (mode > 1 || ncols <= 1) return true;
+            return bi * std::min(ncols, (IndexType)4) * naccs * sizeof(T) <= 512;
+        }
+
+        ///
+        /// Sliced ELL (SELL-C-sigma) BSR format on CPU
+        ///
+
+        /// BSR operator with the block rows grouped into chunks of `c` block rows; all block
+        /// rows in a chunk have the same number of nonzero blocks, padding with zero blocks, and
+        /// the nonzeros of a chunk are interleaved so that consecutive rows are contiguous
+        /// in memory
+
+        template <typename T> struct SellBSR {
+            IndexType c = 0;             ///< number of block rows on each chunk, or zero if unused
+            vector<IndexType, Cpu> ii;   ///< first nonzero slot of each chunk
+            vector<IndexType, Cpu> jj;   ///< first row of x for each slot
+            vector<IndexType, Cpu> rows; ///< block row for each chunk row, or -1 for padding
+            vector<T, Cpu> it;           ///< nonzeros, (bi,c,bd) column-major for each chunk slot
+            std::vector<IndexType> part; ///< chunks for each thread
+        };
+
+        /// Return the number of block rows on each chunk of the SELL format, so that a chunk
+        /// has at least eight rows
+        /// \param bi: number of rows of the blocks
+
+        inline IndexType get_sell_chunk_size(IndexType bi) {
+            return std::max(IndexType(1), (8 + bi - 1) / bi);
+        }
+
+        /// Return whether to keep a copy of the builtin CPU BSR operator in the SELL format. In
+        /// auto mode, it's used when a column of a block is shorter than a 256-bit register, so
+        /// the CSR microkernels can't fill the vector lanes; then the SELL format is faster on
+        /// single-vector matvecs, and slower otherwise, see `getUseBSRSell`
+        /// \param bi: number of rows of the blocks
+
+        template <typename T> bool use_bsr_sell(IndexType bi) {
+            const int mode = getUseBSRSell();
+            if (mode == 0) return false;
+            if (mode > 0) return true;
+            return bi * sizeof(T) < 32 && get_sell_chunk_size(bi) > 1;
+        }
+
+        /// Return the SELL format of a BSR operator or an empty format (with `c` zero) if the
+        /// padding is too large
+        /// \param block_rows: number of block rows
+        /// \param bi: number of rows of the blocks
+        /// \param bd: number of columns of the blocks
+        /// \param nonzeros: nonzero blocks
+        /// \param tb: whether the blocks are stored in row-major
+        /// \param ii: first nonzero block of each block row, with block_rows+1 elements
+        /// \param jj: first row of x for each nonzero block, or -1 to skip the block
+        /// \param c: number of block rows on each chunk
+        /// \param sigma: sort the block rows by decreasing number of nonzeros in windows of
+        ///        `sigma` chunks
+        /// \param max_overhead: maximum ratio of padding blocks over the nonzero blocks
+
+        template <typename T>
+        SellBSR<T> get_sell_bsr(IndexType block_rows, IndexType bi, IndexType bd,
+                                const T *nonzeros, bool tb, const IndexType *ii,
+                                const IndexType *jj, IndexType c, IndexType sigma,
+                                double max_overhead) {
+
+            tracker<Cpu> _t("get sell bsr", Cpu{});
+
+            SellBSR<T> r{};
+            if (block_rows == 0 || c <= 0 || c * bi > 64) return r;
+
+            // Count the nonzero blocks on each block row, skipping the ones marked with -1
+            std::vector<IndexType> nnz(block_rows);
+            IndexType total_nnz = 0;
+            for (IndexType i = 0; i < block_rows; ++i) {
+                nnz[i] = 0;
+                for (IndexType j = ii[i]; j < ii[i + 1]; ++j)
+                    if (jj[j] != -1) ++nnz[i];
+                total_nnz += nnz[i];
+            }
+
+            // Sort the block rows by decreasing number of nonzeros on each window
+            const IndexType num_chunks = (block_rows + c - 1) / c;
+            std::vector<IndexType> perm(num_chunks * c, -1);
+            std::iota(perm.begin(), perm.begin() + block_rows, IndexType(0));
+            if (sigma > 1) {
+                for (IndexType i = 0; i < block_rows; i += sigma * c)
+                    std::stable_sort(perm.begin() + i,
+                                     perm.begin() + std::min(block_rows, i + sigma * c),
+                                     [&](IndexType a, IndexType b) { return nnz[a] > nnz[b]; });
+            }
+
+            // Compute the first slot of each chunk and check the padding
+            Indices<Cpu> sii(num_chunks + 1, Cpu{});
+            sii[0] = 0;
+            for (IndexType ch = 0; ch < num_chunks; ++ch) {
+                IndexType width = 0;
+                for (IndexType r = 0; r < c; ++r)
+                    if (perm[ch * c + r] >= 0) width = std::max(width, nnz[perm[ch * c + r]]);
+                sii[ch + 1] = sii[ch] + width * c;
+            }
+            if ((double)sii[num_chunks] > total_nnz * (1 + max_overhead)) return r;
+
+            // Fill in the indices and the nonzeros, with the same threads that are going to use
+            // them. Padding slots refer to the first row of x and have zero blocks
+            r.c = c;
+            r.ii = sii;
+            r.rows = Indices<Cpu>(num_chunks * c, Cpu{});
+            r.jj = Indices<Cpu>(sii[num_chunks], Cpu{});
+            r.it = vector<T, Cpu>((std::size_t)sii[num_chunks] * bi * bd, Cpu{});
+            r.part = get_balanced_row_partition(sii.data(), num_chunks, get_max_cpu_threads());
+            const std::size_t b = (std::size_t)bi * bd;
+            parallel_for_block_rows(r.part, num_chunks, [&](IndexType ch0, IndexType ch1) {
+                for (IndexType ch = ch0; ch < ch1; ++ch) {
+                    const IndexType width = (sii[ch + 1] - sii[ch]) / c;
+                    T *it = r.it.data() + sii[ch] * b;
+                    for (IndexType ri = 0; ri < c; ++ri) {
+                        const IndexType row = perm[ch * c + ri];
+                        r.rows[ch * c + ri] = row;
+                        IndexType j = (row >= 0 ? ii[row] : 0), j1 = (row >= 0 ? ii[row + 1] : 0);
+                        for (IndexType s = 0; s < width; ++s, ++j) {
+                            while (j < j1 && jj[j] == -1) ++j;
+                            const bool pad = (j >= j1);
+                            r.jj[sii[ch] + s * c + ri] = (pad ? 0 : jj[j]);
+                            const T *a = nonzeros + (pad ? 0 : j * b);
+                            for (IndexType bj = 0; bj < bd; ++bj)
+                                for (IndexType bk = 0; bk < bi; ++bk)
+                                    it[((s * bd + bj) * c + ri) * bi + bk] =
+                                        pad ? T{0} : (tb ? a[bk * bd + bj] : a[bk + bj * bi]);
+                        }
+                    }
+                }
+            });
+
+            return r;
+        }
+
+        /// Contract a chunk of a SELL BSR operator with NK columns of a dense matrix
+        /// \tparam BI: if greater than zero, the number of rows of the blocks known at compile time
+        /// \tparam NK: number of columns to contract
+        /// \param bi: number of rows of the blocks
+        /// \param bd: number of columns of the blocks
+        /// \param c: number of block rows on each chunk, `c*bi` should be at most 64
+        /// \param alpha: factor on the contraction
+        /// \param nonzeros: nonzeros of the chunk
+        /// \param jj: first row of x for each slot of the chunk
+        /// \param width: number of slots for each row of the chunk
+        /// \param rows: block row for each row of the chunk, or -1 to skip it
+        /// \param x: input dense matrix
+        /// \param xr: distance between consecutive rows of x
+        /// \param xc: distance between consecutive columns of x
+        /// \param y: output dense matrix
+        /// \param yr: distance between consecutive rows of y
+        /// \param yc: distance between consecutive columns of y
+        /// \param k: first column to contract
+
+        template <int BI, int NK, typename T>
+        void bsr_sell_chunk_cpu(IndexType bi, IndexType bd, IndexType c, const T &alpha,
+                                const T *SB_RESTRICT nonzeros, const IndexType *SB_RESTRICT jj,
+                                IndexType width, const IndexType *SB_RESTRICT rows,
+                                const T *SB_RESTRICT x, IndexType xr, IndexType xc,
+                                T *SB_RESTRICT y, IndexType yr, IndexType yc, IndexType k) {
+            // Each lane is a row of the chunk; with the block size known at compile time, the
+            // number of lanes is also known
+            const IndexType bi_ = (BI > 0 ? BI : bi);
+            const IndexType c_ = (BI > 0 ? (8 + BI - 1) / BI : c);
+            const IndexType lanes = c_ * bi_;
+            T acc[NK][64], xl[NK][64];
+            for (int n = 0; n < NK; ++n)
+                for (IndexType l = 0; l < lanes; ++l) acc[n][l] = 0;
+            const T *SB_RESTRICT a = nonzeros;
+            for (IndexType s = 0; s < width; ++s) {
+                for (IndexType bj = 0; bj < bd; ++bj, a += lanes) {
+                    // Gather the input for each lane
+                    for (IndexType ri = 0; ri < c_; ++ri) {
+                        const T *SB_RESTRICT xj = x + (jj[s * c_ + ri] + bj) * xr + k * xc;
+                        for (int n = 0; n < NK; ++n)
+                            for (IndexType bk = 0; bk < bi_; ++bk)
+                                xl[n][ri * bi_ + bk] = xj[n * xc];
+                    }
+                    for (int n = 0; n < NK; ++n)
+                        for (IndexType l = 0; l < lanes; ++l)
+                            acc[n][l] = bsr_madd(acc[n][l], a[l], xl[n][l]);
+                }
+            }
+            for (IndexType ri = 0; ri < c_; ++ri) {
+                if (rows[ri] == -1) continue;
+                for (IndexType bk = 0; bk < bi_; ++bk)
+                    for (int n = 0; n < NK; ++n)
+                        y[(rows[ri] * bi_ + bk) * yr + (k + n) * yc] =
+                            bsr_madd(T{0}, alpha, acc[n][ri * bi_ + bk]);
+            }
+        }
+
+        /// Function contracting a SELL chunk, see `bsr_sell_chunk_cpu`
+        template <typename T>
+        using BSRSellChunkKernel = void (*)(IndexType, IndexType, IndexType, const T &,
+                                            const T *, const IndexType *, IndexType,
+                                            const IndexType *, const T *, IndexType, IndexType,
+                                            T *, IndexType, IndexType, IndexType);
+
+        /// Return the SELL kernel for the given block rows
+        /// \param bi: number of rows of the blocks
+        /// \param c: number of block rows on each chunk
+
+        template <int NK, typename T>
+        BSRSellChunkKernel<T> get_bsr_sell_chunk_kernel(IndexType bi, IndexType c) {
+            if (c != get_sell_chunk_size(bi)) return bsr_sell_chunk_cpu<0, NK, T>;
+            switch (bi) {
+            case 1: return bsr_sell_chunk_cpu<1, NK, T>;
+            case 2: return bsr_sell_chunk_cpu<2, NK, T>;
+            case 3: return bsr_sell_chunk_cpu<3, NK, T>;
+            case 4: return bsr_sell_chunk_cpu<4, NK, T>;
+            case 6: return bsr_sell_chunk_cpu<6, NK, T>;
+            case 8: return bsr_sell_chunk_cpu<8, NK, T>;
+            case 12: return bsr_sell_chunk_cpu<12, NK, T>;
+            default: return bsr_sell_chunk_cpu<0, NK, T>;
+            }
+        }
+
+        /// SELL BSR-dense matrix multiplication on CPU, y = alpha * A * x
+        /// \param sell: operator in SELL format, see `get_sell_bsr`
+        /// \param bi: number of rows of the blocks
+        /// \param bd: number of columns of the blocks
+        /// \param alpha: factor on the contraction
+        /// \param x: input dense matrix
+        /// \param ldx: leading dimension of x
+        /// \param lx: layout of x
+        /// \param y: output dense matrix
+        /// \param ldy: leading dimension of y
+        /// \param ly: layout of y
+        /// \param ncols: number of columns of x and y
+
+        template <typename T>
+        void bsr_sell_matvec_cpu(const SellBSR<T> &sell, IndexType bi, IndexType bd,
+                                 const T &alpha, const T *x, IndexType ldx, MatrixLayout lx, T *y,
+                                 IndexType ldy, MatrixLayout ly, IndexType ncols) {
+
+            using Tc = typename ccomplex<T>::type;
+            BSRSellChunkKernel<Tc> kernel4 = get_bsr_sell_chunk_kernel<4, Tc>(bi, sell.c);
+            BSRSellChunkKernel<Tc> kernel1 = get_bsr_sell_chunk_kernel<1, Tc>(bi, sell.c);
+            const Tc alphac = *(const Tc *)&alpha;
+            const Tc *nonzeros = (const Tc *)sell.it.data();
+            const Tc *xc = (const Tc *)x;
+            Tc *yc = (Tc *)y;
+            const IndexType xrs = lx == RowMajor ? ldx : 1, xcs = lx == RowMajor ? 1 : ldx;
+            const IndexType yrs = ly == RowMajor ? ldy : 1, ycs = ly == RowMajor ? 1 : ldy;
+            const IndexType c = sell.c, num_chunks = sell.ii.size() - 1;
+            const IndexType *ii = sell.ii.data(), *jj = sell.jj.data(), *rows = sell.rows.data();
+            parallel_for_block_rows(sell.part, num_chunks, [&](IndexType ch0, IndexType ch1) {
+                for (IndexType ch = ch0; ch < ch1; ++ch) {
+                    const IndexType width = (ii[ch + 1] - ii[ch]) / c;
+                    const Tc *a = nonzeros + (std::size_t)ii[ch] * bi * bd;
+                    IndexType k = 0;
+                    for (; k + 4 <= ncols; k += 4)
+                        kernel4(bi, bd, c, alphac, a, jj + ii[ch], width, rows + ch * c, xc, xrs,
+                                xcs, yc, yrs, ycs, k);
+                    for (; k < ncols; ++k)
+                        kernel1(bi, bd, c, alphac, a, jj + ii[ch], width, rows + ch * c, xc, xrs,
+                                xcs, yc, yrs, ycs, k);
+                }
+            });
+        }
+
+        ///
+        /// Hermitian BSR operators on CPU storing only the diagonal and upper blocks
+        ///
+
+        /// Indices for applying the conjugate transpose of the nonzero blocks of a Hermitian BSR
+        /// operator, see `get_bsr_hermitian_indices`
+
+        struct BSRHermitianIndices {
+            std::vector<IndexType> mirror; ///< block row on y for the conjugate transpose of each
+                                           ///< nonzero block if it's on the same part of the
+                                           ///< block rows, or -1 otherwise
+            std::vector<IndexType> xrow;   ///< first row of x for each block row, or -1
+            std::vector<IndexType> far_ii; ///< first far mirror of each block row on y, with
+                                           ///< block_rows+1 elements
+            std::vector<IndexType> far_j;  ///< nonzero block of each far mirror
+            std::vector<IndexType> far_xrow; ///< first row of x of each far mirror
+            std::size_t num_mirrors = 0;     ///< number of nonzero blocks with a mirror
+        };
+
+        /// Return the indices for applying the conjugate transpose of the nonzero blocks. Only
+        /// the nonzero blocks with a domain coordinate inside the image range are mirrored, and
+        /// they should be on the diagonal or after it; the other nonzero blocks are applied as
+        /// usual. The mirrors on the same part of the block rows as the block are applied
+        /// together with the block, and the far ones are grouped by the block row on y
+        /// \param v: BSR component with `hermitian` set
+        /// \param ii: first nonzero block of each block row, with block_rows+1 elements
+        /// \param jj: first row of x for each nonzero block, or -1 to skip the block
+        /// \param row_part: partition of the block rows among threads, see
+        ///        `get_balanced_row_partition`
+
+        template <std::size_t N, typename T>
+        BSRHermitianIndices get_bsr_hermitian_indices(const BSRComponent<N, N, T, Cpu> &v,
+                                                      const IndexType *ii, const IndexType *jj,
+                                                      const std::vector<IndexType> &row_part) {
+            if (v.blocki != v.blockd)
+                throw std::runtime_error("hermitian BSR: the blocks should be square");
+            if (volume(v.kroni) > 1 || volume(v.krond) > 1 || v.kron_it.size() > 0)
+                throw std::runtime_error("hermitian BSR: unsupported Kronecker blocks");
+            if (volume(v.blocki) > 64)
+                throw std::runtime_error(
+                    "hermitian BSR: unsupported blocks with more than 64 rows");
+
+            const Coor<N> rows = v.dimi / v.blocki;
+            const Coor<N, IndexType> strides = get_strides<IndexType>(rows, v.co);
+            const Coor<N, IndexType> stridesd = get_strides<IndexType>(v.dimd, v.co);
+            const IndexType block_rows = volume(rows);
+            auto is_in = [](const Coor<N> &c, const Coor<N> &dim) {
+                for (std::size_t d = 0; d < N; ++d)
+                    if (c[d] >= dim[d]) return false;
+                return true;
+            };
+
+            BSRHermitianIndices h;
+            h.mirror.resize(ii[block_rows], -1);
+            h.xrow.resize(block_rows, -1);
+            h.far_ii.resize(block_rows + 1, 0);
+            std::vector<std::pair<IndexType, IndexType>> far; // (block row on y, nonzero block)
+            for (IndexType i = 0, part = 0; i < block_rows; ++i) {
+                while (row_part[part + 1] <= i) ++part;
+                Coor<N> ci = index2coor(i, rows, strides);
+                for (std::size_t d = 0; d < N; ++d) ci[d] *= v.blocki[d];
+                const Coor<N> cd = normalize_coor(ci - v.fromdi, v.dimh);
+                if (is_in(cd, v.dimd)) h.xrow[i] = coor2index(cd, v.dimd, stridesd);
+                for (IndexType j = ii[i]; j < ii[i + 1]; ++j) {
+                    if (jj[j] == -1) continue;
+                    const Coor<N> cj =
+                        normalize_coor(index2coor(jj[j], v.dimd, stridesd) + v.fromdi, v.dimh);
+                    if (!is_in(cj, v.dimi)) continue;
+                    const IndexType m = coor2index(cj / v.blocki, rows, strides);
+                    if (m < i)
+                        throw std::runtime_error("hermitian BSR: found a nonzero block under the "
+                                                 "diagonal; give only the upper blocks");
+                    if (m == i) continue;
+                    if (h.xrow[i] == -1)
+                        throw std::runtime_error("hermitian BSR: the domain should include the "
+                                                 "image rows with nonzero blocks above the "
+                                                 "diagonal");
+                    if (m < row_part[part + 1])
+                        h.mirror[j] = m;
+                    else
+                        far.push_back({m, j});
+                    h.num_mirrors++;
+                }
+            }
+
+            // Sort the far mirrors by the block row on y
+            std::sort(far.begin(), far.end());
+            h.far_j.resize(far.size());
+            h.far_xrow.resize(far.size());
+            for (std::size_t f = 0; f < far.size(); ++f) {
+                h.far_ii[far[f].first + 1]++;
+                h.far_j[f] = far[f].second;
+                h.far_xrow[f] = h.xrow[std::upper_bound(ii, ii + block_rows + 1, far[f].second) -
+                                       ii - 1];
+            }
+            for (IndexType i = 0; i < block_rows; ++i) h.far_ii[i + 1] += h.far_ii[i];
+            return h;
+        }
+
+        template <std::size_t Nd, std::size_t Ni, typename T>
+        BSRHermitianIndices get_bsr_hermitian_indices(const BSRComponent<Nd, Ni, T, Cpu> &,
+                                                      const IndexType *, const IndexType *,
+                                                      const std::vector<IndexType> &) {
+            throw std::runtime_error("hermitian BSR: the image and the domain should have the "
+                                     "same number of dimensions");
+        }
+
+        /// Contract the nonzero blocks of a block row of a Hermitian BSR operator with NK columns
+        /// of a dense matrix, and add the conjugate transpose of the mirrored blocks contracted
+        /// with the block row of x into the mirror block rows; see `bsr_block_row_cpu`
+        /// \tparam BI: if greater than zero, the number of rows and columns of the blocks known
+        ///         at compile time
+        /// \tparam NK: number of columns to contract
+        /// \param bi: number of rows and columns of the blocks, at most 64
+        /// \param alpha: factor on the contraction
+        /// \param nonzeros: nonzero blocks
+        /// \param tb: whether the blocks are stored in row-major
+        /// \param jj: first row of x for each nonzero block, or -1 to skip the block
+        /// \param mirror: block row for the conjugate transpose of each nonzero block, or -1
+        /// \param i: block row
+        /// \param j0: first nonzero block of the block row
+        /// \param j1: last nonzero block of the block row plus one
+        /// \param x: input dense matrix
+        /// \param xr: distance between consecutive rows of x
+        /// \param xc: distance between consecutive columns of x
+        /// \param xi: first row of x for the block row
+        /// \param y: output dense matrix
+        /// \param yr: distance between consecutive rows of y
+        /// \param yc: distance between consecutive columns of y
+        /// \param k: first column to contract
+
+        template <int BI, int NK, typename T>
+        void bsr_hermitian_block_row_cpu(IndexType bi, const T &alpha,
+                                         const T *SB_RESTRICT nonzeros, bool tb,
+                                         const IndexType *SB_RESTRICT jj,
+                                         const IndexType *SB_RESTRICT mirror, IndexType i,
+                                         IndexType j0, IndexType j1, const T *SB_RESTRICT x,
+                                         IndexType xr, IndexType xc, IndexType xi,
+                                         T *SB_RESTRICT y, IndexType yr, IndexType yc,
+                                         IndexType k) {
+            const IndexType bi_ = (BI > 0 ? BI : bi);
+            T acc[BI > 0 ? BI : 64][NK];
+            T accm[BI > 0 ? BI : 64][NK];
+            for (IndexType r = 0; r < bi_; ++r)
+                for (int n = 0; n < NK; ++n) acc[r][n] = 0;
+            const T *SB_RESTRICT xii = x + xi * xr + k * xc;
+            for (IndexType j = j0; j < j1; ++j) {
+                if (jj[j] == -1) continue;
+                const T *SB_RESTRICT a = nonzeros + j * bi_ * bi_;
+                const T *SB_RESTRICT xj = x + jj[j] * xr + k * xc;
+                const IndexType m = mirror[j];
+                if (m < 0) {
+                    for (IndexType c = 0; c < bi_; ++c) {
+                        for (IndexType r = 0; r < bi_; ++r) {
+                            const T arc = a[tb ? r * bi_ + c : r + c * bi_];
+                            for (int n = 0; n < NK; ++n)
+                                acc[r][n] = bsr_madd(acc[r][n], arc, xj[c * xr + n * xc]);
+                        }
+                    }
+                    continue;
+                }
+
+                // Contract the block with x[jj[j]] and its conjugate transpose with x[xi] in
+                // the same pass over the block
+                for (IndexType c = 0; c < bi_; ++c)
+                    for (int n = 0; n < NK; ++n) accm[c][n] = 0;
+                if (tb) {
+                    for (IndexType r = 0; r < bi_; ++r) {
+                        for (IndexType c = 0; c < bi_; ++c) {
+                            const T arc = a[r * bi_ + c];
+                            for (int n = 0; n < NK; ++n) {
+                                acc[r][n] = bsr_madd(acc[r][n], arc, xj[c * xr + n * xc]);
+                                accm[c][n] =
+                                    bsr_madd(accm[c][n], bsr_conj(arc), xii[r * xr + n * xc]);
+                            }
+                        }
+                    }
+                } else {
+                    for (IndexType c = 0; c < bi_; ++c) {
+                        for (IndexType r = 0; r < bi_; ++r) {
+                            const T arc = a[r + c * bi_];
+                            for (int n = 0; n < NK; ++n) {
+                                acc[r][n] = bsr_madd(acc[r][n], arc, xj[c * xr + n * xc]);
+                                accm[c][n] =
+                                    bsr_madd(accm[c][n], bsr_conj(arc), xii[r * xr + n * xc]);
+                            }
+                        }
+                    }
+                }
+                T *SB_RESTRICT ym = y + m * bi_ * yr;
+                for (IndexType c = 0; c < bi_; ++c)
+                    for (int n = 0; n < NK; ++n)
+                        ym[c * yr + (k + n) * yc] =
+                            bsr_madd(ym[c * yr + (k + n) * yc], alpha, accm[c][n]);
+            }
+            T *SB_RESTRICT yi = y + i * bi_ * yr;
+            for (IndexType r = 0; r < bi_; ++r)
+                for (int n = 0; n < NK; ++n)
+                    yi[r * yr + (k + n) * yc] =
+                        bsr_madd(yi[r * yr + (k + n) * yc], alpha, acc[r][n]);
+        }
+
+        /// Add the conjugate transpose of the far mirrored blocks on a block row of a Hermitian
+        /// BSR operator contracted with NK columns of a dense matrix
+        /// \tparam BI: if greater than zero, the number of rows and columns of the blocks known
+        ///         at compile time
+        /// \tparam NK: number of columns to contract
+        /// \param bi: number of rows and columns of the blocks, at most 64
+        /// \param alpha: factor on the contraction
+        /// \param nonzeros: nonzero blocks
+        /// \param tb: whether the blocks are stored in row-major
+        /// \param far_j: nonzero block of each far mirror
+        /// \param far_xrow: first row of x of each far mirror
+        /// \param m: block row
+        /// \param f0: first far mirror of the block row
+        /// \param f1: last far mirror of the block row plus one
+        /// \param x: input dense matrix
+        /// \param xr: distance between consecutive rows of x
+        /// \param xc: distance between consecutive columns of x
+        /// \param y: output dense matrix
+        /// \param yr: distance between consecutive rows of y
+        /// \param yc: distance between consecutive columns of y
+        /// \param k: first column to contract
+
+        template <int BI, int NK, typename T>
+        void bsr_hermitian_far_block_row_cpu(IndexType bi, const T &alpha,
+                                             const T *SB_RESTRICT nonzeros, bool tb,
+                                             const IndexType *SB_RESTRICT far_j,
+                                             const IndexType *SB_RESTRICT far_xrow, IndexType m,
+                                             IndexType f0, IndexType f1, const T *SB_RESTRICT x,
+                                             IndexType xr, IndexType xc, T *SB_RESTRICT y,
+                                             IndexType yr, IndexType yc, IndexType k) {
+            const IndexType bi_ = (BI > 0 ? BI : bi);
+            T accm[BI > 0 ? BI : 64][NK];
+            for (IndexType c = 0; c < bi_; ++c)
+                for (int n = 0; n < NK; ++n) accm[c][n] = 0;
+            for (IndexType f = f0; f < f1; ++f) {
+                const T *SB_RESTRICT a = nonzeros + far_j[f] * bi_ * bi_;
+                const T *SB_RESTRICT xi = x + far_xrow[f] * xr + k * xc;
+                if (tb) {
+                    for (IndexType r = 0; r < bi_; ++r)
+                        for (IndexType c = 0; c < bi_; ++c) {
+                            const T arc = bsr_conj(a[r * bi_ + c]);
+                            for (int n = 0; n < NK; ++n)
+                                accm[c][n] = bsr_madd(accm[c][n], arc, xi[r * xr + n * xc]);
+                        }
+                } else {
+                    for (IndexType c = 0; c < bi_; ++c)
+                        for (IndexType r = 0; r < bi_; ++r) {
+                            const T arc = bsr_conj(a[r + c * bi_]);
+                            for (int n = 0; n < NK; ++n)
+                                accm[c][n] = bsr_madd(accm[c][n], arc, xi[r * xr + n * xc]);
+                        }
+                }
+            }
+            T *SB_RESTRICT ym = y + m * bi_ * yr;
+            for (IndexType c = 0; c < bi_; ++c)
+                for (int n = 0; n < NK; ++n)
+                    ym[c * yr + (k + n) * yc] =
+                        bsr_madd(ym[c * yr + (k + n) * yc], alpha, accm[c][n]);
+        }
+
+        /// Function contracting a block row of a Hermitian operator, see
+        /// `bsr_hermitian_block_row_cpu`
+        template <typename T>
+        using BSRHermitianBlockRowKernel =
+            void (*)(IndexType, const T &, const T *, bool, const IndexType *, const IndexType *,
+                     IndexType, IndexType, IndexType, const T *, IndexType, IndexType, IndexType,
+                     T *, IndexType, IndexType, IndexType);
+
+        /// Function adding the far mirrors of a block row of a Hermitian operator, see
+        /// `bsr_hermitian_far_block_row_cpu`
+        template <typename T>
+        using BSRHermitianFarBlockRowKernel =
+            void (*)(IndexType, const T &, const T *, bool, const IndexType *, const IndexType *,
+                     IndexType, IndexType, IndexType, const T *, IndexType, IndexType, T *,
+                     IndexType, IndexType, IndexType);
+
+        /// Return the Hermitian microkernel for the given block dimensions, see
+        /// `get_bsr_block_row_kernel`
+        /// \param bi: number of rows and columns of the blocks
+
+        template <int NK, typename T>
+        BSRHermitianBlockRowKernel<T> get_bsr_hermitian_block_row_kernel(IndexType bi) {
+            if (bi > 64) return nullptr;
+            switch (bi) {
+            case 2: return bsr_hermitian_block_row_cpu<2, NK, T>;
+            case 3: return bsr_hermitian_block_row_cpu<3, NK, T>;
+            case 4: return bsr_hermitian_block_row_cpu<4, NK, T>;
+            case 6: return bsr_hermitian_block_row_cpu<6, NK, T>;
+            case 8: return bsr_hermitian_block_row_cpu<8, NK, T>;
+            case 12: return bsr_hermitian_block_row_cpu<12, NK, T>;
+            default: return bsr_hermitian_block_row_cpu<0, NK, T>;
+            }
+        }
+
+        /// Return the microkernel for the far mirrors for the given block dimensions, see
+        /// `get_bsr_hermitian_block_row_kernel`
+        /// \param bi: number of rows and columns of the blocks
+
+        template <int NK, typename T>
+        BSRHermitianFarBlockRowKernel<T> get_bsr_hermitian_far_block_row_kernel(IndexType bi) {
+            if (bi > 64) return nullptr;
+            switch (bi) {
+            case 2: return bsr_hermitian_far_block_row_cpu<2, NK, T>;
+            case 3: return bsr_hermitian_far_block_row_cpu<3, NK, T>;
+            case 4: return bsr_hermitian_far_block_row_cpu<4, NK, T>;
+            case 6: return bsr_hermitian_far_block_row_cpu<6, NK, T>;
+            case 8: return bsr_hermitian_far_block_row_cpu<8, NK, T>;
+            case 12: return bsr_hermitian_far_block_row_cpu<12, NK, T>;
+            default: return bsr_hermitian_far_block_row_cpu<0, NK, T>;
+            }
+        }
+
+        /// Hermitian BSR-dense matrix multiplication on CPU, y = alpha * A * x, given the
+        /// diagonal and upper blocks of A. Each thread first adds its blocks and the conjugate
+        /// transpose of the blocks mirrored on its own block rows, and after all threads finish,
+        /// it adds the conjugate transpose of the blocks of other threads mirrored on its block
+        /// rows; so no thread writes on the block rows of another thread
+        /// \param use_microkernels: whether to use the microkernels instead of BLAS calls for
+        ///        each nonzero block, see `use_bsr_microkernels`; BLAS is only used when the conjugate
+        ///        transpose can be expressed with the block layout
+        /// \param block_rows: number of block rows
+        /// \param bi: number of rows and columns of the blocks, at most 64
+        /// \param alpha: factor on the contraction
+        /// \param nonzeros: nonzero blocks
+        /// \param tb: whether the blocks are stored in row-major
+        /// \param ii: first nonzero block of each block row, with block_rows+1 elements
+        /// \param jj: first row of x for each nonzero block, or -1 to skip the block
+        /// \param h: indices for the conjugate transpose, see `get_bsr_hermitian_indices`
+        /// \param x: input dense matrix
+        /// \param ldx: leading dimension of x
+        /// \param lx: layout of x
+        /// \param y: output dense matrix
+        /// \param ldy: leading dimension of y
+        /// \param ly: layout of y
+        /// \param ncols: number of columns of x and y
+        /// \param row_part: partition of the block rows among threads used to build `h`, see
+        ///        `get_balanced_row_partition`
+
+        template <typename T>
+        void bsr_hermitian_matvec_cpu(bool use_microkernels, IndexType block_rows, IndexType bi,
+                                      const T &alpha,
+                                      const T *nonzeros, bool tb, const IndexType *ii,
+                                      const IndexType *jj, const BSRHermitianIndices &h,
+                                      const T *x, IndexType ldx, MatrixLayout lx, T *y,
+                                      IndexType ldy, MatrixLayout ly, IndexType ncols,
+                                      const std::vector<IndexType> &row_part) {
+
+            using Tc = typename ccomplex<T>::type;
+            BSRHermitianBlockRowKernel<Tc> kernel4 = get_bsr_hermitian_block_row_kernel<4, Tc>(bi);
+            BSRHermitianBlockRowKernel<Tc> kernel1 = get_bsr_hermitian_block_row_kernel<1, Tc>(bi);
+            BSRHermitianFarBlockRowKernel<Tc> far_kernel4 =
+                get_bsr_hermitian_far_block_row_kernel<4, Tc>(bi);
+            BSRHermitianFarBlockRowKernel<Tc> far_kernel1 =
+                get_bsr_hermitian_far_block_row_kernel<1, Tc>(bi);
+            if (!kernel4 || !kernel1 || !far_kernel4 || !far_kernel1)
+                throw std::runtime_error(
+                    "hermitian BSR: unsupported blocks with more than 64 rows");
+
+            zero_dense_cpu(block_rows * bi, ncols, y, ldy, ly);
+            const bool tx = lx == RowMajor;
+            const bool use_blas = !use_microkernels && (ly == ColumnMajor ? !tb : tb);
+            const Tc alphac = *(const Tc *)&alpha;
+            const Tc *nonzerosc = (const Tc *)nonzeros;
+            const Tc *xc = (const Tc *)x;
+            Tc *yc = (Tc *)y;
+            const IndexType xrs = lx == RowMajor ? ldx : 1, xcs = lx == RowMajor ? 1 : ldx;
+            const IndexType yrs = ly == RowMajor ? ldy : 1, ycs = ly == RowMajor ? 1 : ldy;
+            const IndexType *mirror = h.mirror.data(), *xrow = h.xrow.data();
+            const IndexType *far_ii = h.far_ii.data(), *far_j = h.far_j.data(),
+                            *far_xrow = h.far_xrow.data();
+
+            // Add the conjugate transpose of a block contracted with x[xi] on y[m]
+            auto add_mirror_blas = [&](IndexType j, IndexType xi, IndexType m) {
+                const T *a = nonzeros + j * bi * bi;
+                if (ly == ColumnMajor)
+                    xgemm('C', tx ? 'T' : 'N', bi, ncols, bi, alpha, a, bi, x + xi * xrs, ldx,
+                          T{1}, y + m * bi * yrs, ldy, Cpu{});
+                else
+                    xgemm(!tx ? 'T' : 'N', 'C', ncols, bi, bi, alpha, x + xi * xrs, ldx, a, bi,
+                          T{1}, y + m * bi * yrs, ldy, Cpu{});
+            };
+
+            parallel_for_block_rows(row_part, block_rows, [&](IndexType i0, IndexType i1) {
+                // Add the blocks and the near mirrors, which are on the block rows [i0, i1)
+                for (IndexType i = i0; i < i1; ++i) {
+                    if (use_blas) {
+                        for (IndexType j = ii[i], j1 = ii[i + 1]; j < j1; ++j) {
+                            if (jj[j] == -1) continue;
+                            const T *a = nonzeros + j * bi * bi;
+                            if (ly == ColumnMajor)
+                                xgemm(tb ? 'T' : 'N', tx ? 'T' : 'N', bi, ncols, bi, alpha, a, bi,
+                                      x + jj[j] * xrs, ldx, T{1}, y + i * bi * yrs, ldy, Cpu{});
+                            else
+                                xgemm(!tx ? 'T' : 'N', !tb ? 'T' : 'N', ncols, bi, bi, alpha,
+                                      x + jj[j] * xrs, ldx, a, bi, T{1}, y + i * bi * yrs, ldy,
+                                      Cpu{});
+                            if (mirror[j] != -1) add_mirror_blas(j, xrow[i], mirror[j]);
+                        }
+                        continue;
+                    }
+                    IndexType k = 0;
+                    for (; k + 4 <= ncols; k += 4)
+                        kernel4(bi, alphac, nonzerosc, tb, jj, mirror, i, ii[i], ii[i + 1], xc,
+                                xrs, xcs, xrow[i], yc, yrs, ycs, k);
+                    for (; k < ncols; ++k)
+                        kernel1(bi, alphac, nonzerosc, tb, jj, mirror, i, ii[i], ii[i + 1], xc,
+                                xrs, xcs, xrow[i], yc, yrs, ycs, k);
+                }
+
+                // Add the far mirrors on the block rows [i0, i1) after all threads finish
+                // writing on their block rows
+                if (far_ii[block_rows] == 0) return;
+#ifdef _OPENMP
+#    pragma omp barrier
+#endif
+                for (IndexType m = i0; m < i1; ++m) {
+                    if (far_ii[m] == far_ii[m + 1]) continue;
+                    if (use_blas) {
+                        for (IndexType f = far_ii[m]; f < far_ii[m + 1]; ++f)
+                            add_mirror_blas(far_j[f], far_xrow[f], m);
+                        continue;
+                    }
+                    IndexType k = 0;
+                    for (; k + 4 <= ncols; k += 4)
+                        far_kernel4(bi, alphac, nonzerosc, tb, far_j, far_xrow, m, far_ii[m],
+                                    far_ii[m + 1], xc, xrs, xcs, yc, yrs, ycs, k);
+                    for (; k < ncols; ++k)
+                        far_kernel1(bi, alphac, nonzerosc, tb, far_j, far_xrow, m, far_ii[m],
+                                    far_ii[m + 1], xc, xrs, xcs, yc, yrs, ycs, k);
+                }
+            });
+        }
+
+        ///
+        /// Kronecker BSR operators on CPU
+        ///
+
+        /// Contract the nonzero blocks of a block row of a Kronecker BSR operator with NK columns
+        /// of a dense matrix, applying each Kronecker block and each nonzero block on local
+        /// accumulators without storing the product of the Kronecker blocks and x. The Kronecker
+        /// index is the fastest on x and y, then the column, and then the block index
+        /// \tparam K: number of rows and columns of the Kronecker blocks
+        /// \tparam B: number of rows and columns of the nonzero blocks
+        /// \tparam NK: number of columns to contract
+        /// \param alpha: factor on the contraction
+        /// \param nonzeros: nonzero blocks
+        /// \param tb: whether the blocks are stored in row-major
+        /// \param kron: Kronecker blocks, one for each nonzero block on a block row
+        /// \param jj: first row of x for each nonzero block, or -1 to skip the block
+        /// \param j0: first nonzero block of the block row
+        /// \param j1: last nonzero block of the block row plus one
+        /// \param x: input dense matrix
+        /// \param ncols: number of columns of x and y
+        /// \param y: first row of the block row on the output dense matrix
+        /// \param k: first column to contract
+
+        template <int K, int B, int NK, typename T>
+        void bsr_kron_block_row_cpu(const T &alpha, const T *nonzeros, bool tb,
+                                    const CSRs<IndexType, T> &kron, const IndexType *SB_RESTRICT jj,
+                                    IndexType j0, IndexType j1, const T *x, IndexType ncols, T *y,
+                                    IndexType k) {
+            using Tc = typename ccomplex<T>::type;
+            constexpr int L = K * NK; // Kronecker index and column on the accumulators
+            const Tc alphac = *(const Tc *)&alpha;
+            const Tc *SB_RESTRICT a0 = (const Tc *)nonzeros;
+            const Tc *SB_RESTRICT xc = (const Tc *)x;
+            Tc *SB_RESTRICT yc = (Tc *)y + k * K;
+            const Tc *SB_RESTRICT kv = (const Tc *)kron.vals.data();
+            const IndexType *SB_RESTRICT kii = kron.ii.data(), *SB_RESTRICT kjj = kron.jj.data();
+            const bool sparse = kron.is_sparse(), kron_row_major = kron.layout == RowMajor;
+            const IndexType xb = K * ncols; // distance between consecutive block indices on x
+
+            Tc acc[B][L];
+            for (int r = 0; r < B; ++r)
+                for (int l = 0; l < L; ++l) acc[r][l] = 0;
+            for (IndexType j = j0, d = 0; j < j1; ++j, ++d) {
+                if (jj[j] == -1) continue;
+                const Tc *SB_RESTRICT xj = xc + jj[j] * ncols + k * K;
+
+                // Contract the Kronecker block: (ki,kd) x (kd,n,bd) -> (ki,n,bd)
+                Tc t[B][L];
+                if (sparse && kron.type[d] == CSRs<IndexType, T>::Identity) {
+                    for (int c = 0; c < B; ++c)
+                        for (int l = 0; l < L; ++l) t[c][l] = xj[l + c * xb];
+                } else if (sparse) {
+                    const bool all_ones = kron.type[d] == CSRs<IndexType, T>::SparseAllOnes;
+                    for (int c = 0; c < B; ++c)
+                        for (int l = 0; l < L; ++l) t[c][l] = 0;
+                    for (int s = 0; s < K; ++s) {
+                        for (IndexType idx = kii[K * d + s]; idx < kii[K * d + s + 1]; ++idx) {
+                            const IndexType q = kjj[idx];
+                            const Tc v = kv[idx];
+                            for (int c = 0; c < B; ++c)
+                                for (int n = 0; n < NK; ++n)
+                                    t[c][s + n * K] =
+                                        all_ones ? t[c][s + n * K] + xj[q + n * K + c * xb]
+                                                 : bsr_madd(t[c][s + n * K], v,
+                                                            xj[q + n * K + c * xb]);
+                        }
+                    }
+                } else {
+                    const Tc *SB_RESTRICT kd = kv + K * K * d;
+                    for (int c = 0; c < B; ++c)
+                        for (int l = 0; l < L; ++l) t[c][l] = 0;
+                    for (int q = 0; q < K; ++q) {
+                        for (int s = 0; s < K; ++s) {
+                            const Tc ksq = kron_row_major ? kd[s * K + q] : kd[s + q * K];
+                            for (int c = 0; c < B; ++c)
+                                for (int n = 0; n < NK; ++n)
+                                    t[c][s + n * K] =
+                                        bsr_madd(t[c][s + n * K], ksq, xj[q + n * K + c * xb]);
+                        }
+                    }
+                }
+
+                // Contract the block: (bi,bd) x (ki,n,bd) -> (ki,n,bi)
+                const Tc *SB_RESTRICT a = a0 + j * B * B;
+                for (int r = 0; r < B; ++r) {
+                    for (int c = 0; c < B; ++c) {
+                        const Tc arc = tb ? a[r * B + c] : a[r + c * B];
+                        for (int l = 0; l < L; ++l) acc[r][l] = bsr_madd(acc[r][l], arc, t[c][l]);
+                    }
+                }
+            }
+            for (int r = 0; r < B; ++r)
+                for (int l = 0; l < L; ++l) yc[l + r * xb] = bsr_madd(Tc{0}, alphac, acc[r][l]);
+        }
+
+        /// Function contracting a block row of a Kronecker BSR operator, see
+        /// `bsr_kron_block_row_cpu`
+        template <typename T>
+        using BSRKronBlockRowKernel = void (*)(const T &, const T *, bool,
+                                               const CSRs<IndexType, T> &, const IndexType *,
+                                               IndexType, IndexType, const T *, IndexType, T *,
+                                               IndexType);
+
+        /// Return the fused kernel for the given dimensions of the Kronecker and the nonzero
+        /// blocks, which are given at compile time for the common spin and color dimensions;
+        /// return null if there's no kernel for the dimensions
+        /// \param ki: number of rows of the Kronecker blocks
+        /// \param kd: number of columns of the Kronecker blocks
+        /// \param bi: number of rows of the nonzero blocks
+        /// \param bd: number of columns of the nonzero blocks
+
+        template <int NK, typename T>
+        BSRKronBlockRowKernel<T> get_bsr_kron_block_row_kernel(IndexType ki, IndexType kd,
+                                                               IndexType bi, IndexType bd) {
+            if (ki != kd || bi != bd) return nullptr;
+            switch (ki * 16 + bi) {
+            case 2 * 16 + 1: return bsr_kron_block_row_cpu<2, 1, NK, T>;
+            case 2 * 16 + 2: return bsr_kron_block_row_cpu<2, 2, NK, T>;
+            case 2 * 16 + 3: return bsr_kron_block_row_cpu<2, 3, NK, T>;
+            case 2 * 16 + 4: return bsr_kron_block_row_cpu<2, 4, NK, T>;
+            case 4 * 16 + 1: return bsr_kron_block_row_cpu<4, 1, NK, T>;
+            case 4 * 16 + 2: return bsr_kron_block_row_cpu<4, 2, NK, T>;
+            case 4 * 16 + 3: return bsr_kron_block_row_cpu<4, 3, NK, T>;
+            case 4 * 16 + 4: return bsr_kron_block_row_cpu<4, 4, NK, T>;
+            default: return nullptr;
+            }
+        }
+
         ///
         /// Implementation of operations for each platform
         ///
@@ -261,6 +1712,18 @@ namespace superbblas {
 
         template <std::size_t Nd, std::size_t Ni, typename T, typename XPU> struct BSR;
 
+        /// Contract several operators with the same nonzero pattern in a single pass,
+        /// y[op] = alpha * A[op] * x; return false if the implementation doesn't support it.
+        /// See `BSR::operator()` for the description of the parameters
+
+        template <std::size_t Nd, std::size_t Ni, typename T, typename XPU>
+        bool bsr_multi_matvec(T, const std::vector<const BSR<Nd, Ni, T, XPU> *> &, bool,
+                              const vector<T, XPU> &, IndexType, MatrixLayout,
+                              const std::vector<vector<T, XPU>> &, IndexType, MatrixLayout,
+                              IndexType) {
+            return false;
+        }
+
 #if defined(SUPERBBLAS_USE_MKL)
         inline void checkMKLSparse(sparse_status_t status) {
             static std::map<sparse_status_t, std::string> statuses = {
@@ -294,6 +1757,8 @@ namespace superbblas {
                 if (volume(v.dimi) == 0 || volume(v.dimd) == 0) return;
                 if (volume(v.blocki) != volume(v.blockd))
                     throw std::runtime_error("MKL Sparse does not support non-square blocks");
+                if (v.hermitian)
+                    throw std::runtime_error("MKL Sparse does not support hermitian storage");
                 if (v.blockImFast)
                     throw std::runtime_error("MKL Sparse does not support column major as the "
                                              "nonzero BSR blocks layout");
@@ -455,12 +1920,88 @@ namespace superbblas {
         };
 #else
 
+        /// Nonzero pattern of builtin CPU BSR operators, shared by the live operators with the
+        /// same indices, see `get_bsr_pattern`
+
+        struct BSRPattern {
+            vector<IndexType, Cpu> ii, jj; ///< BSR row and column nonzero indices
+        };
+
+        /// Live nonzero patterns by a hash of their indices
+
+        struct BSRPatterns {
+            std::mutex mutex; ///< guard for `patterns`
+            std::unordered_multimap<std::size_t, std::weak_ptr<BSRPattern>> patterns;
+        };
+
+        inline BSRPatterns &getBSRPatterns() {
+            static BSRPatterns patterns;
+            return patterns;
+        }
+
+        /// Return the nonzero pattern with the given indices. If a live operator has the same
+        /// indices, return its pattern; otherwise copy the indices with the same threads that
+        /// are going to use them, so that the pages are on their memory nodes. Operators with
+        /// the same pattern share the storage of the indices, which `bsr_multi_matvec` checks
+        /// by comparing pointers
+        /// \param block_rows: number of block rows
+        /// \param ii: first nonzero block of each block row, with block_rows+1 elements
+        /// \param nnz: number of nonzero blocks
+        /// \param jj: first row of x for each nonzero block, or -1 to skip the block
+        /// \param row_part: partition of the block rows among threads, see
+        ///        `get_balanced_row_partition`
+
+        inline std::shared_ptr<BSRPattern>
+        get_bsr_pattern(IndexType block_rows, const IndexType *ii, IndexType nnz,
+                        const IndexType *jj, const std::vector<IndexType> &row_part) {
+            std::size_t h = std::hash<IndexType>{}(block_rows);
+            for (IndexType i = 0; i <= block_rows; ++i) h = h * 31 + std::hash<IndexType>{}(ii[i]);
+            for (IndexType j = 0; j < nnz; ++j) h = h * 31 + std::hash<IndexType>{}(jj[j]);
+
+            BSRPatterns &patterns = getBSRPatterns();
+            std::lock_guard<std::mutex> g(patterns.mutex);
+            auto range = patterns.patterns.equal_range(h);
+            for (auto it = range.first; it != range.second;) {
+                std::shared_ptr<BSRPattern> pattern = it->second.lock();
+                if (!pattern) {
+                    it = patterns.patterns.erase(it);
+                    continue;
+                }
+                if (pattern->ii.size() == (std::size_t)block_rows + 1 &&
+                    pattern->jj.size() == (std::size_t)nnz &&
+                    std::equal(ii, ii + block_rows + 1, pattern->ii.data()) &&
+                    std::equal(jj, jj + nnz, pattern->jj.data()))
+                    return pattern;
+                ++it;
+            }
+
+            auto pattern = std::make_shared<BSRPattern>();
+            pattern->ii = vector<IndexType, Cpu>(block_rows + 1, Cpu{});
+            pattern->jj = vector<IndexType, Cpu>(nnz, Cpu{});
+            IndexType *iip = pattern->ii.data(), *jjp = pattern->jj.data();
+            parallel_for_block_rows(row_part, block_rows, [&](IndexType i0, IndexType i1) {
+                std::copy_n(ii + i0, i1 - i0, iip + i0);
+                std::copy_n(jj + ii[i0], ii[i1] - ii[i0], jjp + ii[i0]);
+            });
+            iip[block_rows] = ii[block_rows];
+            patterns.patterns.emplace(h, pattern);
+            return pattern;
+        }
+
         template <std::size_t Nd, std::size_t Ni, typename T> struct BSR<Nd, Ni, T, Cpu> {
             BSRComponent<Nd, Ni, T, Cpu> v; ///< BSR general information
             vector<IndexType, Cpu> ii, jj;  ///< BSR row and column nonzero indices
+            std::shared_ptr<BSRPattern> pattern; ///< storage of `ii` and `jj`
             static std::string implementation() { return "builtin_cpu"; }
             unsigned int num_nnz_per_row; ///< Number of nnz per row (for Kronecker BSR)
             CSRs<IndexType, T> kron;      ///< kron sparse representation
+            std::vector<IndexType> row_part; ///< block rows for each thread
+            SellBSR<T> sell;                 ///< SELL format of the operator, if used
+            using lowT = typename lower_precision<T>::type;
+            vector<lowT, Cpu> it_lowp; ///< nonzeros in lower precision, if used
+            BSRCompressedIndices cjj;  ///< compressed column indices, if used
+            IndexType span = 0; ///< typical distance between reuses of x, see `get_bsr_column_span`
+            BSRHermitianIndices herm; ///< indices for the conjugate transpose, if hermitian
 
             SpMMAllowedLayout allowLayout;
             static const MatrixLayout preferredLayout = RowMajor;
@@ -469,9 +2010,67 @@ namespace superbblas {
                 allowLayout = (v.kron_it.size() > 0) ? SameLayoutForXAndY : AnyLayoutForXAndY;
                 if (volume(v.dimi) == 0 || volume(v.dimd) == 0) return;
                 auto bsr = get_bsr_indices(v); // column indices aren't blocked
-                ii = bsr.i;
-                jj = bsr.j;
                 num_nnz_per_row = bsr.num_nnz_per_row;
+
+                // Balance the number of nonzero blocks processed by each thread
+                IndexType bi = volume(v.blocki), bd = volume(v.blockd);
+                IndexType block_rows = volume(v.dimi) / bi / volume(v.kroni);
+                row_part = get_balanced_row_partition(bsr.i.data(), block_rows,
+                                                      get_max_cpu_threads());
+
+                // Get the indices, shared with other operators with the same pattern
+                const IndexType *bsri = bsr.i.data();
+                pattern = get_bsr_pattern(block_rows, bsri, bsr.j.size(), bsr.j.data(), row_part);
+                ii = pattern->ii;
+                jj = pattern->jj;
+
+                // Optionally copy the nonzero values with the same threads that are going to use
+                // them, so that the pages are on their memory nodes
+                const bool copy_values = getUseBSRFirstTouch() && v.it.size() > 0;
+                const T *it0 = v.it.data();
+                const std::size_t b = (std::size_t)bi * bd;
+                if (copy_values) {
+                    this->v.it = vector<T, Cpu>(v.it.size(), Cpu{});
+                    T *it1 = this->v.it.data();
+                    parallel_for_block_rows(row_part, block_rows, [&](IndexType i0, IndexType i1) {
+                        std::copy_n(it0 + bsri[i0] * b, (bsri[i1] - bsri[i0]) * b,
+                                    it1 + bsri[i0] * b);
+                    });
+                }
+
+                // Get the block rows for the conjugate transpose of the blocks on Hermitian
+                // operators, which only use `bsr_hermitian_matvec_cpu`
+                if (v.hermitian)
+                    herm = get_bsr_hermitian_indices(v, ii.data(), jj.data(), row_part);
+
+                // Keep a copy of the nonzeros in lower precision if asked; the vectors are still
+                // contracted in the precision of T
+                if (v.lowPrecision && v.kron_it.size() == 0 && !v.hermitian &&
+                    !std::is_same<lowT, T>::value) {
+                    it_lowp = vector<lowT, Cpu>(v.it.size(), Cpu{});
+                    lowT *itl = it_lowp.data();
+                    parallel_for_block_rows(row_part, block_rows, [&](IndexType i0, IndexType i1) {
+                        std::transform(it0 + bsri[i0] * b, it0 + bsri[i1] * b, itl + bsri[i0] * b,
+                                       [](const T &t) { return (lowT)t; });
+                    });
+                }
+
+                if (v.kron_it.size() == 0)
+                    span = get_bsr_column_span(block_rows, bd, ii.data(), jj.data());
+
+                // Compress the column indices for the microkernels
+                if (v.kron_it.size() == 0 && !v.hermitian && bi <= 64 && getUseBSRMicrokernels() &&
+                    getUseBSRCompressedIndices())
+                    cjj = get_bsr_compressed_indices(block_rows, bd, ii.data(), jj.data(),
+                                                     row_part);
+
+                // Use the SELL format on small blocks if the padding is small enough
+                if (v.kron_it.size() == 0 && it_lowp.size() == 0 && !v.hermitian &&
+                    use_bsr_sell<T>(bi))
+                    sell = get_sell_bsr(block_rows, bi, bd, this->v.it.data(), !v.blockImFast,
+                                        ii.data(), jj.data(), get_sell_chunk_size(bi),
+                                        getBSRSellSigma(),
+                                        getUseBSRSell() < 0 ? 0.1 : 1e300);
                 if (v.kron_it.size() > 0)
                     kron =
                         CSRs<IndexType, T>(v.kron_it, volume(v.kroni), volume(v.krond),
@@ -494,8 +2093,10 @@ namespace superbblas {
                                 : ki * volume(v.dimd) * num_nnz_per_row + ki * bi * bd * jj.size());
 
                 // For the regular variant, each operator nonzero block will involve the contraction
-                // of the block will all the rhs (bi*bd*rhs flops)
-                return bi * bd * jj.size() * rhs * multiplication_cost<T>::value;
+                // of the block will all the rhs (bi*bd*rhs flops), and also of its conjugate
+                // transpose if mirrored on Hermitian operators
+                return bi * bd * (jj.size() + herm.num_mirrors) * rhs *
+                       multiplication_cost<T>::value;
             }
 
             /// Return the number of memory operations for a given number of right-hand-sides
@@ -528,8 +2129,48 @@ namespace superbblas {
                                       volume(v.dimi) * rhs));
 
                 // For the regular variant, each operator nonzero block will involve reading the
-                // nonzero block and the input right-hand-size, plus writing the output vectors
-                return (volume(v.dimi) * rhs + (bi * bd + bd * rhs) * jj.size()) * sizeof(T);
+                // nonzero block and the input right-hand-size, plus writing the output vectors;
+                // the mirrored blocks of Hermitian operators also update an output block
+                return (volume(v.dimi) * rhs + bd * rhs * jj.size() +
+                        2 * bi * rhs * herm.num_mirrors) *
+                           sizeof(T) +
+                       bi * bd * jj.size() * (it_lowp.size() > 0 ? sizeof(lowT) : sizeof(T));
+            }
+
+            /// Contract the operator without Kronecker blocks, y = alpha * A * x
+            /// \param alpha: factor on the contraction
+            /// \param x: input dense matrix
+            /// \param ldx: leading dimension of x
+            /// \param lx: layout of x
+            /// \param y: output dense matrix
+            /// \param ldy: leading dimension of y
+            /// \param ly: layout of y
+            /// \param ncols: number of columns of x and y
+
+            void matvec(const T &alpha, const T *x, IndexType ldx, MatrixLayout lx, T *y,
+                        IndexType ldy, MatrixLayout ly, IndexType ncols) const {
+                IndexType bi = volume(v.blocki);
+                IndexType bd = volume(v.blockd);
+                IndexType block_rows = ii.size() - 1;
+                const bool tb = !v.blockImFast;
+                if (v.hermitian) {
+                    // The Hermitian microkernels keep accumulators also for the mirrored blocks
+                    bsr_hermitian_matvec_cpu(use_bsr_microkernels<T>(bi, ncols, 2), block_rows,
+                                             bi, alpha, v.it.data(), tb, ii.data(), jj.data(),
+                                             herm, x, ldx, lx, y, ldy, ly, ncols, row_part);
+                } else if (it_lowp.size() > 0) {
+                    // Both the microkernels and BLAS use the nonzeros in lower precision, so the
+                    // result doesn't depend on the kernel
+                    bsr_matvec_cpu(use_bsr_microkernels<T>(bi, ncols), block_rows, bi, bd, alpha,
+                                   it_lowp.data(), tb, ii.data(), jj.data(), x, ldx, lx, y, ldy,
+                                   ly, ncols, row_part, &cjj);
+                } else if (sell.c > 0 && (getUseBSRSell() > 0 || ncols == 1)) {
+                    bsr_sell_matvec_cpu(sell, bi, bd, alpha, x, ldx, lx, y, ldy, ly, ncols);
+                } else {
+                    bsr_matvec_cpu(use_bsr_microkernels<T>(bi, ncols), block_rows, bi, bd, alpha,
+                                   v.it.data(), tb, ii.data(), jj.data(), x, ldx, lx, y, ldy, ly,
+                                   ncols, row_part, &cjj);
+                }
             }
 
             void operator()(T alpha, bool conjA, const vector<T, Cpu> &vx, IndexType ldx,
@@ -545,52 +2186,53 @@ namespace superbblas {
                 IndexType block_rows = volume(v.dimi) / bi / ki;
                 const T *x = vx.data();
                 T *y = vy.data();
-                const T beta{0};
-                xscal(volume(v.dimi) * ncols, beta, y, 1, Cpu{});
                 T *nonzeros = v.it.data();
-                const bool tx = lx == RowMajor;
-                const bool ty = ly == RowMajor;
                 const bool tb = !v.blockImFast;
-                const IndexType xs = lx == ColumnMajor ? 1 : ldx;
                 if (v.kron_it.size() == 0) {
-                    if (ncols > 1) {
-#    ifdef _OPENMP
-#        pragma omp parallel for schedule(static)
-#    endif
-                        for (IndexType i = 0; i < block_rows; ++i) {
-                            for (IndexType j = ii[i], j1 = ii[i + 1]; j < j1; ++j) {
-                                if (jj[j] == -1) continue;
-                                if (ly == ColumnMajor)
-                                    xgemm(tb ? 'T' : 'N', tx ? 'T' : 'N', bi, ncols, bd, alpha,
-                                          nonzeros + j * bi * bd, tb ? bd : bi, x + jj[j] * xs, ldx,
-                                          T{1}, y + i * bi, ldy, Cpu{});
-                                else
-                                    xgemm(!tx ? 'T' : 'N', !tb ? 'T' : 'N', ncols, bi, bd, alpha,
-                                          x + jj[j] * xs, ldx, nonzeros + j * bi * bd, tb ? bd : bi,
-                                          T{1}, y + i * bi * ldy, ldy, Cpu{});
-                            }
-                        }
+                    // Process the columns in tiles so that the blocks of x stay on cache
+                    const IndexType tile = get_bsr_rhs_tile(ncols, bi, bd, span, sizeof(T));
+                    if (tile < ncols) {
+                        tracker<Cpu> _t("BSR matvec rhs tile " + std::to_string(tile), Cpu{0});
+                        const IndexType xcs = lx == RowMajor ? 1 : ldx;
+                        const IndexType ycs = ly == RowMajor ? 1 : ldy;
+                        for (IndexType k = 0; k < ncols; k += tile)
+                            matvec(alpha, x + k * xcs, ldx, lx, y + k * ycs, ldy, ly,
+                                   std::min(tile, ncols - k));
                     } else {
-#    ifdef _OPENMP
-#        pragma omp parallel for schedule(static)
-#    endif
-                        for (IndexType i = 0; i < block_rows; ++i) {
-                            for (IndexType j = ii[i], j1 = ii[i + 1]; j < j1; ++j) {
-                                if (jj[j] == -1) continue;
-                                xgemv(tb ? 'T' : 'N', tb ? bd : bi, tb ? bi : bd, alpha,
-                                      nonzeros + j * bi * bd, tb ? bd : bi, x + jj[j] * xs,
-                                      tx ? ldx : 1, T{1}, y + i * bi, ty ? ldy : 1, Cpu{});
-                            }
-                        }
+                        matvec(alpha, x, ldx, lx, y, ldy, ly, ncols);
                     }
                 } else {
-                    // With Kronecker product
+                    // With Kronecker product; use the fused kernel if available
+                    BSRKronBlockRowKernel<T> kernel4 = nullptr, kernel1 = nullptr;
+                    if (lx == RowMajor && getUseBSRMicrokernels()) {
+                        kernel4 = get_bsr_kron_block_row_kernel<4, T>(ki, kd, bi, bd);
+                        kernel1 = get_bsr_kron_block_row_kernel<1, T>(ki, kd, bi, bd);
+                    }
+                    if (kernel4 && kernel1) {
+                        parallel_for_block_rows(
+                            row_part, block_rows, [&](IndexType i0, IndexType i1) {
+                                for (IndexType i = i0; i < i1; ++i) {
+                                    T *yi = y + i * ki * ncols * bi;
+                                    IndexType k = 0;
+                                    for (; k + 4 <= ncols; k += 4)
+                                        kernel4(alpha, nonzeros, tb, kron, jj.data(), ii[i],
+                                                ii[i + 1], x, ncols, yi, k);
+                                    for (; k < ncols; ++k)
+                                        kernel1(alpha, nonzeros, tb, kron, jj.data(), ii[i],
+                                                ii[i + 1], x, ncols, yi, k);
+                                }
+                            });
+                        return;
+                    }
+                    const T beta{0};
+                    xscal(volume(v.dimi) * ncols, beta, y, 1, Cpu{});
                     if (lx == RowMajor) {
 #    ifdef _OPENMP
 #        pragma omp parallel
 #    endif
                         {
-                            std::vector<T> aux(ki * ncols * bd);
+                            ScratchArenaScope scratch;
+                            T *aux = scratch.allocate<T>(ki * ncols * bd);
 #    ifdef _OPENMP
 #        pragma omp for schedule(static)
 #    endif
@@ -607,11 +2249,10 @@ namespace superbblas {
                                     } else {
                                         // Contract with the blocking:  (ki,kd) x (kd,n,bd,rows) -> (ki,n,bd) ; note (fast,slow)
                                         xgemm_csr_mat(T{1}, kron, j0, x + jj[j] * ncols, kd,
-                                                      ncols * bd, ColumnMajor, kd, T{0}, aux.data(),
-                                                      ki);
+                                                      ncols * bd, ColumnMajor, kd, T{0}, aux, ki);
                                         // Contract with the Kronecker blocking: (ki,n,bd) x (bi,bd)[rows,mu] -> (ki,n,bi) ; note (fast,slow)
                                         xgemm('N', !tb ? 'T' : 'N', ki * ncols, bi, bd, alpha,
-                                              aux.data(), ki * ncols, nonzeros + j * bi * bd,
+                                              aux, ki * ncols, nonzeros + j * bi * bd,
                                               !tb ? bi : bd, T{1}, y + i * ki * ncols * bi,
                                               ki * ncols, Cpu{});
                                     }
@@ -620,7 +2261,8 @@ namespace superbblas {
                         }
                     } else {
                         // Contract with the blocking: (bd,rows,n,kd) x (ki,kd)[mu] -> (bd,rows,n,ki,mu) ; note (fast,slow)
-                        vector<T, Cpu> aux(bd * block_cols * ncols * ki * num_nnz_per_row, Cpu{});
+                        vector<T, Cpu> aux(bd * block_cols * ncols * ki * num_nnz_per_row, Cpu{},
+                                           doCacheAlloc);
                         zero_n(aux.data(), aux.size(), aux.ctx());
 #    ifdef _OPENMP
 #        pragma omp parallel for schedule(static)
@@ -651,6 +2293,68 @@ namespace superbblas {
 
             ~BSR() {}
         };
+
+        /// Contract several operators with the same nonzero pattern in a single pass with the
+        /// microkernels, y[op] = alpha * A[op] * x; return false if some operator has Kronecker
+        /// blocks or a different pattern, or if the microkernels don't suit the blocks
+
+        template <std::size_t Nd, std::size_t Ni, typename T>
+        bool bsr_multi_matvec(T alpha, const std::vector<const BSR<Nd, Ni, T, Cpu> *> &ops,
+                              bool conjA, const vector<T, Cpu> &vx, IndexType ldx,
+                              MatrixLayout lx, const std::vector<vector<T, Cpu>> &vy,
+                              IndexType ldy, MatrixLayout ly, IndexType ncols) {
+            if (conjA || ops.size() == 0 || !getUseBSRMicrokernels()) return false;
+            const BSR<Nd, Ni, T, Cpu> &op0 = *ops[0];
+            if (op0.ii.size() == 0) return false;
+
+            IndexType bi = volume(op0.v.blocki), bd = volume(op0.v.blockd);
+            if (bi > 64) return false;
+
+            // Check that all operators have the same pattern and the nonzeros with the same
+            // layout and precision; operators with the same pattern share it, see
+            // `get_bsr_pattern`
+            for (const BSR<Nd, Ni, T, Cpu> *op : ops) {
+                if (op->v.kron_it.size() > 0 || op->v.hermitian ||
+                    op->v.blockImFast != op0.v.blockImFast ||
+                    (op->it_lowp.size() > 0) != (op0.it_lowp.size() > 0) ||
+                    op->pattern != op0.pattern)
+                    return false;
+            }
+
+            IndexType block_rows = op0.ii.size() - 1;
+            using lowT = typename BSR<Nd, Ni, T, Cpu>::lowT;
+            std::vector<const lowT *> nonzeros_lowp(ops.size());
+            std::vector<const T *> nonzeros(ops.size());
+            for (std::size_t op = 0; op < ops.size(); ++op) {
+                nonzeros_lowp[op] = ops[op]->it_lowp.data();
+                nonzeros[op] = ops[op]->v.it.data();
+            }
+
+            const IndexType xcs = lx == RowMajor ? 1 : ldx, ycs = ly == RowMajor ? 1 : ldy;
+            std::vector<T *> y(ops.size());
+            auto matvec = [&](IndexType k, IndexType n) {
+                // Use the microkernels only if `BSR::matvec` would use them
+                if (!use_bsr_microkernels<T>(bi, n)) return false;
+                for (std::size_t op = 0; op < ops.size(); ++op) y[op] = vy[op].data() + k * ycs;
+                if (op0.it_lowp.size() > 0)
+                    return bsr_multi_matvec_microkernels_cpu(
+                        ops.size(), block_rows, bi, bd, alpha, nonzeros_lowp.data(),
+                        !op0.v.blockImFast, op0.ii.data(), op0.jj.data(), &op0.cjj,
+                        vx.data() + k * xcs, ldx, lx, y.data(), ldy, ly, n, op0.row_part);
+                return bsr_multi_matvec_microkernels_cpu(
+                    ops.size(), block_rows, bi, bd, alpha, nonzeros.data(), !op0.v.blockImFast,
+                    op0.ii.data(), op0.jj.data(), &op0.cjj, vx.data() + k * xcs, ldx, lx,
+                    y.data(), ldy, ly, n, op0.row_part);
+            };
+
+            // Process the columns in tiles so that the blocks of x stay on cache
+            const IndexType tile = get_bsr_rhs_tile(ncols, bi, bd, op0.span, sizeof(T));
+            if (tile >= ncols) return matvec(0, ncols);
+            tracker<Cpu> _t("BSR matvec rhs tile " + std::to_string(tile), Cpu{0});
+            for (IndexType k = 0; k < ncols; k += tile)
+                if (!matvec(k, std::min(tile, ncols - k))) return false;
+            return true;
+        }
 #endif
 
 #ifdef SUPERBBLAS_USE_GPU
@@ -680,6 +2384,8 @@ namespace superbblas {
             BSR(BSRComponent<Nd, Ni, T, Gpu> v) : v(v) {
                 if (deviceId(v.it.ctx()) == CPU_DEVICE_ID)
                     throw std::runtime_error("BSR: unsupported a cpu device");
+                if (v.hermitian)
+                    throw std::runtime_error("BSR: unsupported hermitian storage on gpu");
                 setDevice(deviceId(v.it.ctx()));
                 allowLayout = ColumnMajorForY; // Default setting for empty tensor
                 preferredLayout = ColumnMajor; // Default setting for empty tensor
@@ -1189,6 +2895,39 @@ namespace superbblas {
         };
 #endif // SUPERBBLAS_USE_GPU
 
+        /// Operators for computing several powers of a BSR operator without communications in
+        /// between, see `get_bsr_powers`
+        template <std::size_t Nd, std::size_t Ni, typename T, typename XPU0, typename XPU1>
+        struct BSRPowers {
+            /// Whether the operator supports computing powers this way
+            bool supported = true;
+            /// Copy of the number of nonzero blocks on each block row for every local component
+            std::vector<Indices<Cpu>> i;
+            /// Copy of the domain coordinates of the nonzero blocks for every local component
+            std::vector<vector<Coor<Nd>, Cpu>> j;
+            /// Image ranges of the operator on each level; the first one is the image partition
+            std::vector<Proc_ranges<Ni>> ranges;
+            /// ops[l-1] are the components of the operator from ranges[l+1] to ranges[l]
+            std::vector<std::pair<std::vector<BSR<Nd, Ni, T, XPU0>>,
+                                  std::vector<BSR<Nd, Ni, T, XPU1>>>>
+                ops;
+        };
+
+        /// Operators for doing the matvec exchanging only the halo of the input tensor referenced
+        /// by the operator, see `get_bsr_halo`
+        template <std::size_t Nd, std::size_t Ni, typename T, typename XPU0, typename XPU1>
+        struct BSRHalo {
+            /// Whether the operator supports the halo exchange and the operators were prepared
+            bool supported = false;
+            /// Image ranges of the components as domain ranges
+            Proc_ranges<Nd> own;
+            /// ghosts[s] are the domain ranges of the s-th ghost region of all components
+            std::vector<Proc_ranges<Nd>> ghosts;
+            /// Components with the nonzero blocks referencing elements out of the image range
+            std::pair<std::vector<BSR<Nd, Ni, T, XPU0>>, std::vector<BSR<Nd, Ni, T, XPU1>>>
+                boundary;
+        };
+
         /// A BSR tensor composed of several components
         template <std::size_t Nd, std::size_t Ni, typename T, typename XPU0, typename XPU1>
         struct BSRComponents_tmpl : BSR_handle {
@@ -1207,6 +2946,12 @@ namespace superbblas {
             Coor<Nd> krond;  ///< dimensions of Kronecker in the domain space
             Coor<Ni> kroni;  ///< dimensions of Kronecker in the image space
             CoorOrder co;    ///< Coordinate order of ii and jj
+            /// Extended operators for computing powers
+            std::shared_ptr<BSRPowers<Nd, Ni, T, XPU0, XPU1>> powers =
+                std::make_shared<BSRPowers<Nd, Ni, T, XPU0, XPU1>>();
+            /// Boundary operators for the halo exchange
+            std::shared_ptr<BSRHalo<Nd, Ni, T, XPU0, XPU1>> halo =
+                std::make_shared<BSRHalo<Nd, Ni, T, XPU0, XPU1>>();
 
             bool check(std::size_t Nd_, std::size_t Ni_, detail::num_type type, const Context *ctx,
                        unsigned int ncomponents, unsigned int nprocs, unsigned int rank,
@@ -1247,6 +2992,180 @@ namespace superbblas {
         using BSRComponents = BSRComponents_tmpl<Nd, Ni, T, Cpu, Cpu>;
 #endif // SUPERBBLAS_USE_GPU
 
+        /// Keep a copy of the nonzero pattern of the components
+        /// \param ops: BSR components
+        /// \param i: (out) number of nonzero blocks on each block row for every component
+        /// \param j: (out) domain coordinates of the nonzero blocks for every component
+
+        template <std::size_t Nd, std::size_t Ni, typename T, typename XPU>
+        void keep_bsr_pattern(const std::vector<BSR<Nd, Ni, T, XPU>> &ops,
+                              std::vector<Indices<Cpu>> &i, std::vector<vector<Coor<Nd>, Cpu>> &j) {
+            for (const auto &op : ops) {
+                i[op.v.componentId] = clone(makeSure(op.v.i, Cpu{}));
+                j[op.v.componentId] = clone(makeSure(op.v.j, Cpu{}));
+            }
+        }
+
+        /// Return a component with the nonzero blocks referencing domain elements out of the image
+        /// range of the component, and the bounding boxes of these elements
+        /// \param op: BSR component
+        /// \param fsi: image range of the component
+        /// \param fsd: domain range of the component
+        /// \param dim: dimensions of the domain space
+        /// \param ghosts: (out) domain ranges of the referenced elements on the 2*Nd regions of the
+        ///        domain range around the image range; the regions 2*d and 2*d+1 are the ones
+        ///        before and after the image range on dimension d
+        /// \param supported: (out) set to false if the image range isn't inside the domain range
+
+        template <std::size_t Nd, typename T, typename XPU>
+        BSR<Nd, Nd, T, XPU> get_bsr_boundary(const BSR<Nd, Nd, T, XPU> &op,
+                                             const From_size_item<Nd> &fsi,
+                                             const From_size_item<Nd> &fsd, const Coor<Nd> &dim,
+                                             From_size_item<Nd> *ghosts, bool &supported) {
+            // Get the image range relative to the domain range
+            Coor<Nd> lo, hi;
+            for (std::size_t d = 0; d < Nd; ++d) {
+                lo[d] = normalize_coor(fsi[0][d] - fsd[0][d], dim[d]);
+                hi[d] = lo[d] + fsi[1][d];
+                if (hi[d] > fsd[1][d]) supported = false;
+            }
+            if (op.v.kron_it.size() > 0) supported = false;
+            if (!supported || volume(fsi[1]) == 0) return op;
+
+            // Select the nonzero blocks not fully contained in the image range
+            Indices<Cpu> i = makeSure(op.v.i, Cpu{});
+            vector<Coor<Nd>, Cpu> j = makeSure(op.v.j, Cpu{});
+            vector<T, Cpu> v = makeSure(op.v.it, Cpu{});
+            const std::size_t B = volume(op.v.blocki) * volume(op.v.blockd);
+            Indices<Cpu> ib(i.size(), Cpu{});
+            std::vector<Coor<Nd>> jb;
+            std::vector<T> vb;
+            std::vector<Coor<Nd>> gfrom(2 * Nd, fsd[1]), gto(2 * Nd, Coor<Nd>{{}});
+            std::size_t k = 0;
+            for (std::size_t r = 0; r < i.size(); ++r) {
+                ib[r] = 0;
+                for (IndexType n = 0; n < i[r]; ++n, ++k) {
+                    const Coor<Nd> c = j[k];
+                    if (c[0] < 0) continue;
+                    bool inside = true;
+                    for (std::size_t d = 0; d < Nd; ++d)
+                        if (c[d] < lo[d] || c[d] + op.v.blockd[d] > hi[d]) inside = false;
+                    if (inside) continue;
+                    ib[r]++;
+                    jb.push_back(c);
+                    vb.insert(vb.end(), v.data() + k * B, v.data() + (k + 1) * B);
+
+                    // Extend the bounding box of the regions overlapping the block
+                    for (std::size_t s = 0; s < 2 * Nd; ++s) {
+                        const std::size_t ds = s / 2;
+                        Coor<Nd> from, to;
+                        bool empty = false;
+                        for (std::size_t d = 0; d < Nd; ++d) {
+                            IndexType rfrom = 0, rto = fsd[1][d];
+                            if (d < ds) {
+                                rfrom = lo[d];
+                                rto = hi[d];
+                            } else if (d == ds && s % 2 == 0) {
+                                rto = lo[d];
+                            } else if (d == ds) {
+                                rfrom = hi[d];
+                            }
+                            from[d] = std::max(c[d], rfrom);
+                            to[d] = std::min(c[d] + op.v.blockd[d], rto);
+                            if (from[d] >= to[d]) empty = true;
+                        }
+                        if (empty) continue;
+                        for (std::size_t d = 0; d < Nd; ++d) {
+                            gfrom[s][d] = std::min(gfrom[s][d], from[d]);
+                            gto[s][d] = std::max(gto[s][d], to[d]);
+                        }
+                    }
+                }
+            }
+            for (std::size_t s = 0; s < 2 * Nd; ++s) {
+                ghosts[s] = From_size_item<Nd>{};
+                if (gto[s][0] <= gfrom[s][0]) continue;
+                ghosts[s][0] = normalize_coor(fsd[0] + gfrom[s], dim);
+                ghosts[s][1] = gto[s] - gfrom[s];
+            }
+
+            vector<Coor<Nd>, Cpu> jbv(jb.size(), Cpu{});
+            std::copy(jb.begin(), jb.end(), jbv.data());
+            vector<T, Cpu> vbv(vb.size(), Cpu{});
+            std::copy(vb.begin(), vb.end(), vbv.data());
+            XPU xpu = op.v.it.ctx();
+            return BSR<Nd, Nd, T, XPU>{BSRComponent<Nd, Nd, T, XPU>{
+                makeSure(ib, xpu), makeSure(jbv, xpu), makeSure(vbv, xpu), op.v.dimd, op.v.dimi,
+                op.v.blockd, op.v.blocki, op.v.krond, op.v.kroni, op.v.kron_it, op.v.blockImFast,
+                op.v.co, op.v.componentId, op.v.lowPrecision}};
+        }
+
+        /// Prepare the operators for doing the matvec bringing only the elements of the input
+        /// tensor referenced by the operator out of the image range of each component
+        /// \param bsr: BSR tensor components
+        /// \param comm: communicator
+        ///
+        /// The referenced elements around the image range are grouped into at most 2*Nd disjoint
+        /// ghost regions, each of them the bounding box of the referenced elements on the region
+        /// before or after the image range on a dimension. Besides, the nonzero blocks
+        /// referencing these elements are copied into the boundary operators. The operator should
+        /// be square and the image range should be inside the domain range on every component.
+        /// The result is stored in `bsr.halo`. It should be called while the nonzero pattern
+        /// given by the user is still valid.
+
+        template <std::size_t Nd, std::size_t Ni, typename T, typename XPU0, typename XPU1,
+                  typename Comm, typename std::enable_if<Nd == Ni, bool>::type = true>
+        void get_bsr_halo(const BSRComponents_tmpl<Nd, Ni, T, XPU0, XPU1> &bsr, Comm comm) {
+            BSRHalo<Nd, Ni, T, XPU0, XPU1> &r = *bsr.halo;
+
+            tracker<Cpu> _t("BSR halo setup", Cpu{0});
+
+            // Get the boundary operators and the ghost regions of the local components
+            const unsigned int ncomponents = bsr.pi[comm.rank].size();
+            std::vector<From_size_item<Nd>> ghosts(ncomponents * 2 * Nd);
+            bool supported =
+                bsr.dimd == bsr.dimi && volume(bsr.krond) == 1 && volume(bsr.kroni) == 1;
+            for (const auto &op : bsr.c.first) {
+                if (!supported) break;
+                const unsigned int cid = op.v.componentId;
+                r.boundary.first.push_back(get_bsr_boundary(op, bsr.pi[comm.rank][cid],
+                                                            bsr.pd[comm.rank][cid], bsr.dimd,
+                                                            &ghosts[cid * 2 * Nd], supported));
+            }
+            for (const auto &op : bsr.c.second) {
+                if (!supported) break;
+                const unsigned int cid = op.v.componentId;
+                r.boundary.second.push_back(get_bsr_boundary(op, bsr.pi[comm.rank][cid],
+                                                             bsr.pd[comm.rank][cid], bsr.dimd,
+                                                             &ghosts[cid * 2 * Nd], supported));
+            }
+            if (global_max(supported ? 0 : 1, comm) != 0) {
+                r.boundary.first.clear();
+                r.boundary.second.clear();
+                return;
+            }
+
+            // Gather the ghost regions from all processes, skipping the empty ones everywhere
+            const std::vector<From_size_item<Nd>> all_ghosts = all_gather(ghosts, comm);
+            for (std::size_t s = 0; s < 2 * Nd; ++s) {
+                Proc_ranges<Nd> g(comm.nprocs);
+                bool empty = true;
+                for (unsigned int rank = 0; rank < comm.nprocs; ++rank) {
+                    for (unsigned int i = 0; i < ncomponents; ++i) {
+                        g[rank].push_back(all_ghosts[(rank * ncomponents + i) * 2 * Nd + s]);
+                        if (volume(g[rank].back()[1]) > 0) empty = false;
+                    }
+                }
+                if (!empty) r.ghosts.push_back(g);
+            }
+            r.own = bsr.pi;
+            r.supported = true;
+        }
+
+        template <std::size_t Nd, std::size_t Ni, typename T, typename XPU0, typename XPU1,
+                  typename Comm, typename std::enable_if<Nd != Ni, bool>::type = true>
+        void get_bsr_halo(const BSRComponents_tmpl<Nd, Ni, T, XPU0, XPU1> &, Comm) {}
+
         /// Return a components based on the nonzeros of a BSR operator
         /// \param bsr: BSR operator
 
@@ -1266,6 +3185,50 @@ namespace superbblas {
             return r;
         }
 
+        /// Prepare the auxiliary operators for computing powers and for exchanging only the halo,
+        /// if they are enabled
+        /// \param r: BSR tensor components
+        /// \param comm: communicator
+
+        template <std::size_t Nd, std::size_t Ni, typename T, typename XPU0, typename XPU1,
+                  typename Comm>
+        void prepare_bsr_powers_and_halo(BSRComponents_tmpl<Nd, Ni, T, XPU0, XPU1> &r, Comm comm) {
+            // The blocks of Hermitian operators are mirrored only within each component, which
+            // the auxiliary operators don't support
+            for (const auto &c : r.c.first)
+                if (c.v.hermitian) return;
+            for (const auto &c : r.c.second)
+                if (c.v.hermitian) return;
+
+            // Keep a copy of the nonzero pattern for computing powers, see `get_bsr_powers`
+            if (getUseBSRPowers()) {
+                const unsigned int ncomponents = r.pi[comm.rank].size();
+                r.powers->i.resize(ncomponents);
+                r.powers->j.resize(ncomponents);
+                keep_bsr_pattern(r.c.first, r.powers->i, r.powers->j);
+                keep_bsr_pattern(r.c.second, r.powers->i, r.powers->j);
+            }
+
+            // Split the operator for exchanging only the halo, see `get_bsr_halo`
+            if (getUseBSRHalo()) get_bsr_halo(r, comm);
+        }
+
+        /// Return the first domain element relative to the first image element of a component
+        /// \param fromd: first domain element
+        /// \param fromi: first image element
+        /// \param dim: dimensions of the operator
+
+        template <std::size_t N>
+        Coor<N> get_bsr_fromdi(const Coor<N> &fromd, const Coor<N> &fromi, const Coor<N> &dim) {
+            return normalize_coor(fromd - fromi, dim);
+        }
+
+        template <std::size_t Nd, std::size_t Ni>
+        Coor<Nd> get_bsr_fromdi(const Coor<Nd> &, const Coor<Ni> &, const Coor<Nd> &) {
+            throw std::runtime_error("hermitian BSR: the image and the domain should have the "
+                                     "same number of dimensions");
+        }
+
         template <std::size_t Nd, std::size_t Ni, typename T, typename Comm>
         BSRComponents<Nd, Ni, T>
         get_bsr_components(T **v, IndexType **ii, Coor<Nd> **jj, T **kronv, const Context *ctx,
@@ -1273,7 +3236,7 @@ namespace superbblas {
                            const Coor<Ni> &dimi, From_size_iterator<Nd> pd, const Coor<Nd> &dimd,
                            const Coor<Nd> &blockd, const Coor<Ni> &blocki, const Coor<Nd> &krond,
                            const Coor<Ni> &kroni, bool blockImFast, Comm comm, CoorOrder co,
-                           Session session) {
+                           Session session, bool lowPrecision = false, bool hermitian = false) {
             // Get components on the local process
             From_size_iterator<Nd> fsd = pd + comm.rank * ncomponents;
             From_size_iterator<Ni> fsi = pi + comm.rank * ncomponents;
@@ -1313,6 +3276,8 @@ namespace superbblas {
                 std::size_t num_neighbors = (nii > 0 ? njj / nii : 0);
                 std::size_t nkronvalues =
                     (kronv ? volume(krond) * volume(kroni) * num_neighbors : 0);
+                Coor<Nd> fromdi =
+                    hermitian ? get_bsr_fromdi(fsd[i][0], fsi[i][0], dimd) : Coor<Nd>{};
                 switch (ctx[i].plat) {
 #ifdef SUPERBBLAS_USE_GPU
                 case CPU:
@@ -1322,7 +3287,7 @@ namespace superbblas {
                         to_vector(v[i], nvalues, ctx[i].toCpu(session)), fsd[i][1], fsi[i][1],
                         blockd, blocki, krond, kroni,
                         to_vector(kronvi, nkronvalues, ctx[i].toCpu(session)), blockImFast, co,
-                        i}});
+                        i, lowPrecision, hermitian, fromdi, dimd}});
                     assert(!v[i] || getPtrDevice(v[i]) == CPU_DEVICE_ID);
                     break;
                 case GPU:
@@ -1332,7 +3297,7 @@ namespace superbblas {
                         to_vector(v[i], nvalues, ctx[i].toGpu(session)), fsd[i][1], fsi[i][1],
                         blockd, blocki, krond, kroni,
                         to_vector(kronvi, nkronvalues, ctx[i].toGpu(session)), blockImFast, co,
-                        i}});
+                        i, lowPrecision, hermitian, fromdi, dimd}});
                     assert(!v[i] || getPtrDevice(v[i]) == ctx[i].device);
                     break;
 #else // SUPERBBLAS_USE_GPU
@@ -1343,13 +3308,16 @@ namespace superbblas {
                         to_vector(v[i], nvalues, ctx[i].toCpu(session)), fsd[i][1], fsi[i][1],
                         blockd, blocki, krond, kroni,
                         to_vector(kronvi, nkronvalues, ctx[i].toCpu(session)), blockImFast, co,
-                        i}});
+                        i, lowPrecision, hermitian, fromdi, dimd}});
                     assert(!v[i] || getPtrDevice(v[i]) == CPU_DEVICE_ID);
                     break;
 #endif
                 default: throw std::runtime_error("Unsupported platform");
                 }
             }
+
+            prepare_bsr_powers_and_halo(r, comm);
+
             return r;
         }
 
@@ -1360,9 +3328,346 @@ namespace superbblas {
             if (!bsrh->check(Nd, Ni, detail::num_type_v<T>::value, ctx, ncomponents, comm.nprocs,
                              comm.rank, co))
                 throw std::runtime_error(
-                    "Given BSR handle doesn't match the template parameters Nd, Ni, or T, does not "
-                    "match contexts, or does not match MPI communicator");
-            return static_cast<BSRComponents<Nd, Ni, T> *>(bsrh);
+                    "Given BSR handle doesn't match the template parameters Nd, Ni, or T, does not "
+                    "match contexts, or does not match MPI communicator");
+            return static_cast<BSRComponents<Nd, Ni, T> *>(bsrh);
+        }
+
+        //
+        // Even-odd decomposition
+        //
+
+        /// Return the parity of a coordinate, the sum of its components modulo two
+        /// \param c: coordinate
+
+        template <std::size_t N> int get_parity(const Coor<N> &c) {
+            IndexType s = 0;
+            for (std::size_t d = 0; d < N; ++d) s += c[d];
+            return s % 2;
+        }
+
+        /// Return the ranges on the half lattice covering the given ranges on the full lattice
+        /// \param p: ranges on the full lattice
+        /// \param dim: dimensions of the full lattice
+        /// \param halved_dim: dimension whose size is halved
+        /// \param exact: whether to throw an error if a range doesn't start and end on even
+        ///        coordinates on the halved dimension, so that the half range has exactly the
+        ///        elements of either parity on the range
+
+        template <std::size_t N>
+        Proc_ranges<N> get_half_ranges(const Proc_ranges<N> &p, const Coor<N> &dim,
+                                       unsigned int halved_dim, bool exact) {
+            Proc_ranges<N> r = p;
+            for (auto &ranges : r) {
+                for (auto &fs : ranges) {
+                    const IndexType from = fs[0][halved_dim], size = fs[1][halved_dim];
+                    if (exact && (from % 2 != 0 || size % 2 != 0))
+                        throw std::runtime_error("get_bsr_even_odd: unsupported image partition "
+                                                 "with odd ranges on the halved dimension");
+                    fs[0][halved_dim] = from / 2;
+                    fs[1][halved_dim] =
+                        std::min((from + size + 1) / 2 - from / 2, dim[halved_dim] / 2);
+                    if (size == 0) fs[1][halved_dim] = 0;
+                }
+            }
+            return r;
+        }
+
+        /// Return the block rows of a component on sites with a given parity restricted to the
+        /// nonzero blocks on domain sites with a given parity, on the half lattices
+        /// \param op: BSR component
+        /// \param fsi: image range of the component
+        /// \param fsd: domain range of the component
+        /// \param fsi_h: image range of the component on the half lattice
+        /// \param fsd_h: domain range of the component on the half lattice
+        /// \param dim: dimensions of the full lattice
+        /// \param halved_dim: dimension whose size is halved
+        /// \param pi: parity of the image sites
+        /// \param pd: parity of the domain sites
+        ///
+        /// The blocks should cover whole dimensions, so the coordinates of a block row are the
+        /// ones of its first element.
+
+        template <std::size_t N, typename T, typename XPU>
+        BSR<N, N, T, XPU>
+        get_bsr_parity_block(const BSR<N, N, T, XPU> &op, const From_size_item<N> &fsi,
+                             const From_size_item<N> &fsd, const From_size_item<N> &fsi_h,
+                             const From_size_item<N> &fsd_h, const Coor<N> &dim,
+                             unsigned int halved_dim, int pi, int pd) {
+            Coor<N> dim_h = dim;
+            dim_h[halved_dim] /= 2;
+            Indices<Cpu> i = makeSure(op.v.i, Cpu{});
+            vector<Coor<N>, Cpu> j = makeSure(op.v.j, Cpu{});
+            vector<T, Cpu> v = makeSure(op.v.it, Cpu{});
+            const std::size_t B = volume(op.v.blocki) * volume(op.v.blockd);
+
+            // Get the first nonzero block of each block row
+            std::vector<std::size_t> i0(i.size() + 1, 0);
+            for (std::size_t r = 0; r < i.size(); ++r) i0[r + 1] = i0[r] + i[r];
+
+            // Visit the block rows on the half lattice and select the nonzero blocks of the
+            // corresponding block row on the full lattice
+            const Coor<N> rows = fsi[1] / op.v.blocki, rows_h = fsi_h[1] / op.v.blocki;
+            const Coor<N, std::size_t> strides = get_strides<std::size_t>(rows, op.v.co);
+            const Coor<N, std::size_t> strides_h = get_strides<std::size_t>(rows_h, op.v.co);
+            const std::size_t nrows_h = volume(rows_h);
+            Indices<Cpu> ib(nrows_h, Cpu{});
+            std::vector<Coor<N>> jb;
+            std::vector<T> vb;
+            for (std::size_t rh = 0; rh < nrows_h; ++rh) {
+                Coor<N> c = normalize_coor(index2coor(rh, rows_h, strides_h) + fsi_h[0], dim_h);
+                c[halved_dim] *= 2;
+                c[halved_dim] += (pi + get_parity(c)) % 2;
+                const std::size_t r = coor2index(normalize_coor(c - fsi[0], dim), rows, strides);
+                ib[rh] = 0;
+                for (std::size_t k = i0[r]; k < i0[r + 1]; ++k) {
+                    if (j[k][0] < 0) continue;
+                    Coor<N> cd = normalize_coor(j[k] + fsd[0], dim);
+                    if (get_parity(cd) != pd) continue;
+                    cd[halved_dim] /= 2;
+                    ib[rh]++;
+                    jb.push_back(normalize_coor(cd - fsd_h[0], dim_h));
+                    vb.insert(vb.end(), v.data() + k * B, v.data() + (k + 1) * B);
+                }
+            }
+
+            vector<Coor<N>, Cpu> jbv(jb.size(), Cpu{});
+            std::copy(jb.begin(), jb.end(), jbv.data());
+            vector<T, Cpu> vbv(vb.size(), Cpu{});
+            std::copy(vb.begin(), vb.end(), vbv.data());
+            XPU xpu = op.v.it.ctx();
+            return BSR<N, N, T, XPU>{BSRComponent<N, N, T, XPU>{
+                makeSure(ib, xpu), makeSure(jbv, xpu), makeSure(vbv, xpu), fsd_h[1], fsi_h[1],
+                op.v.blockd, op.v.blocki, op.v.krond, op.v.kroni, op.v.kron_it, op.v.blockImFast,
+                op.v.co, op.v.componentId, op.v.lowPrecision}};
+        }
+
+        /// Return the even-even, even-odd, odd-even, and odd-odd sub-operators of a BSR operator
+        /// \param bsr: BSR tensor components
+        /// \param halved_dim: dimension whose size is halved on the sub-operators
+        /// \param comm: communicator
+        ///
+        /// The parity of an element is the sum of its coordinates modulo two. The sub-operators
+        /// act on half lattices with the same dimensions as the operator but `halved_dim`, which
+        /// is halved, and the element with coordinates `c` is at `c[halved_dim]/2` on the half
+        /// lattice of its parity. The sub-operators have their own copy of the nonzeros, but
+        /// this function should be called while the nonzero pattern given by the user is valid.
+
+        template <std::size_t N, typename T, typename XPU0, typename XPU1, typename Comm>
+        std::array<BSRComponents_tmpl<N, N, T, XPU0, XPU1>, 4>
+        get_bsr_even_odd(const BSRComponents_tmpl<N, N, T, XPU0, XPU1> &bsr,
+                         unsigned int halved_dim, Comm comm) {
+            tracker<Cpu> _t("BSR even-odd setup", Cpu{0});
+
+            // Check that the operator can be split
+            if (halved_dim >= N)
+                throw std::runtime_error("get_bsr_even_odd: invalid halved dimension");
+            if (bsr.dimd != bsr.dimi || volume(bsr.krond) != 1 || volume(bsr.kroni) != 1)
+                throw std::runtime_error(
+                    "get_bsr_even_odd: unsupported non-square or Kronecker operators");
+            for (const auto &op : bsr.c.first)
+                if (op.v.kron_it.size() > 0)
+                    throw std::runtime_error("get_bsr_even_odd: unsupported Kronecker operators");
+            for (const auto &op : bsr.c.second)
+                if (op.v.kron_it.size() > 0)
+                    throw std::runtime_error("get_bsr_even_odd: unsupported Kronecker operators");
+            for (const auto &op : bsr.c.first)
+                if (op.v.hermitian)
+                    throw std::runtime_error("get_bsr_even_odd: unsupported hermitian storage");
+            for (const auto &op : bsr.c.second)
+                if (op.v.hermitian)
+                    throw std::runtime_error("get_bsr_even_odd: unsupported hermitian storage");
+            for (std::size_t d = 0; d < N; ++d)
+                if ((bsr.blocki[d] != 1 && bsr.blocki[d] != bsr.dimi[d]) ||
+                    (bsr.blockd[d] != 1 && bsr.blockd[d] != bsr.dimd[d]))
+                    throw std::runtime_error(
+                        "get_bsr_even_odd: unsupported blocks not covering whole dimensions");
+            if (bsr.blocki[halved_dim] != 1 || bsr.blockd[halved_dim] != 1 ||
+                bsr.dimi[halved_dim] % 2 != 0)
+                throw std::runtime_error(
+                    "get_bsr_even_odd: the halved dimension should be even and not blocked");
+
+            // Get the partitions on the half lattices
+            Coor<N> dim_h = bsr.dimi;
+            dim_h[halved_dim] /= 2;
+            const Proc_ranges<N> pi_h = get_half_ranges(bsr.pi, bsr.dimi, halved_dim, true);
+            const Proc_ranges<N> pd_h = get_half_ranges(bsr.pd, bsr.dimd, halved_dim, false);
+
+            // Select the nonzero blocks of each sub-operator, r[2*pi+pd] with the image sites of
+            // parity pi and the domain sites of parity pd
+            std::array<BSRComponents_tmpl<N, N, T, XPU0, XPU1>, 4> r;
+            for (int p = 0; p < 4; ++p) {
+                BSRComponents_tmpl<N, N, T, XPU0, XPU1> &rp = r[p];
+                rp.pd = pd_h;
+                rp.dimd = dim_h;
+                rp.pi = pi_h;
+                rp.dimi = dim_h;
+                rp.blockd = bsr.blockd;
+                rp.blocki = bsr.blocki;
+                rp.krond = bsr.krond;
+                rp.kroni = bsr.kroni;
+                rp.co = bsr.co;
+                for (const auto &op : bsr.c.first) {
+                    const unsigned int cid = op.v.componentId;
+                    rp.c.first.push_back(get_bsr_parity_block(
+                        op, bsr.pi[comm.rank][cid], bsr.pd[comm.rank][cid], pi_h[comm.rank][cid],
+                        pd_h[comm.rank][cid], bsr.dimi, halved_dim, p / 2, p % 2));
+                }
+                for (const auto &op : bsr.c.second) {
+                    const unsigned int cid = op.v.componentId;
+                    rp.c.second.push_back(get_bsr_parity_block(
+                        op, bsr.pi[comm.rank][cid], bsr.pd[comm.rank][cid], pi_h[comm.rank][cid],
+                        pd_h[comm.rank][cid], bsr.dimi, halved_dim, p / 2, p % 2));
+                }
+                prepare_bsr_powers_and_halo(rp, comm);
+            }
+
+            return r;
+        }
+
+        /// Operators for applying the Schur complement M_ee - M_eo M_oo^{-1} M_oe of an operator
+        /// split with `get_bsr_even_odd`, see `get_bsr_schur`
+        template <std::size_t N, typename T, typename XPU0, typename XPU1>
+        struct BSRSchur_tmpl : BSR_handle {
+            /// Even-even sub-operator
+            BSRComponents_tmpl<N, N, T, XPU0, XPU1> ee;
+            /// Even-odd sub-operator
+            BSRComponents_tmpl<N, N, T, XPU0, XPU1> eo;
+            /// Odd-even sub-operator with the nonzero blocks multiplied by M_oo^{-1}
+            BSRComponents_tmpl<N, N, T, XPU0, XPU1> oo_inv_oe;
+        };
+
+#ifdef SUPERBBLAS_USE_GPU
+        /// Schur complement operators with CPU and GPU components
+        template <std::size_t N, typename T> using BSRSchur = BSRSchur_tmpl<N, T, Gpu, Cpu>;
+#else
+        /// Schur complement operators with only CPU components
+        template <std::size_t N, typename T> using BSRSchur = BSRSchur_tmpl<N, T, Cpu, Cpu>;
+#endif // SUPERBBLAS_USE_GPU
+
+        /// Return the odd-even component with the nonzero blocks multiplied by the inverse of the
+        /// odd-odd component, which should be block diagonal
+        /// \param oo: odd-odd component
+        /// \param oe: odd-even component
+        /// \param fsi: image range of the components
+        /// \param fsd: domain range of the odd-odd component
+        /// \param dim: dimensions of the half lattice
+
+        template <std::size_t N, typename T, typename XPU>
+        BSR<N, N, T, XPU> get_bsr_oo_inv_oe(const BSR<N, N, T, XPU> &oo,
+                                            const BSR<N, N, T, XPU> &oe,
+                                            const From_size_item<N> &fsi,
+                                            const From_size_item<N> &fsd, const Coor<N> &dim) {
+            const std::size_t n = volume(oo.v.blocki), m = volume(oo.v.blockd);
+            if (n != m)
+                throw std::runtime_error(
+                    "get_bsr_schur: the blocks of the odd-odd sub-operator should be square");
+
+            // Check that the only nonzero block on each block row is on the diagonal
+            const Coor<N> rows = fsi[1] / oo.v.blocki;
+            const Coor<N, std::size_t> strides = get_strides<std::size_t>(rows, oo.v.co);
+            const std::size_t nrows = volume(rows);
+            Indices<Cpu> ioo = makeSure(oo.v.i, Cpu{});
+            vector<Coor<N>, Cpu> joo = makeSure(oo.v.j, Cpu{});
+            for (std::size_t r = 0; r < nrows; ++r)
+                if (ioo[r] != 1 || normalize_coor(joo[r] + fsd[0], dim) !=
+                                       normalize_coor(index2coor(r, rows, strides) + fsi[0], dim))
+                    throw std::runtime_error(
+                        "get_bsr_schur: the odd-odd sub-operator should be block diagonal");
+
+            // Invert the diagonal blocks; when the blocks are stored with the domain indices the
+            // fastest, this computes the transpose of the inverses
+            vector<T, Cpu> inv = clone(makeSure(oo.v.it, Cpu{}));
+            local_inversion(n, nrows, inv);
+
+            // Multiply the nonzero blocks of M_oe by the inverse of the block on their row
+            Indices<Cpu> ioe = makeSure(oe.v.i, Cpu{});
+            vector<T, Cpu> voe = makeSure(oe.v.it, Cpu{});
+            vector<T, Cpu> r(voe.size(), Cpu{});
+            std::vector<std::size_t> i0(nrows + 1, 0);
+            for (std::size_t i = 0; i < nrows; ++i) i0[i + 1] = i0[i] + ioe[i];
+            const std::size_t md = volume(oe.v.blockd);
+            const T *invp = inv.data(), *voep = voe.data();
+            T *rp = r.data();
+#ifdef _OPENMP
+#    pragma omp parallel for schedule(static)
+#endif
+            for (std::size_t i = 0; i < nrows; ++i) {
+                // Column-major blocks are consecutive columns of a single matrix, B' = inv * B;
+                // row-major blocks are the transposes, B'^T = B^T * inv^T
+                if (oe.v.blockImFast) {
+                    xgemm('N', 'N', n, md * ioe[i], n, T{1}, invp + n * n * i, n,
+                          voep + i0[i] * n * md, n, T{0}, rp + i0[i] * n * md, n, Cpu{});
+                } else {
+                    for (std::size_t k = i0[i]; k < i0[i + 1]; ++k)
+                        xgemm('N', 'N', md, n, n, T{1}, voep + k * n * md, md, invp + n * n * i,
+                              n, T{0}, rp + k * n * md, md, Cpu{});
+                }
+            }
+
+            BSRComponent<N, N, T, XPU> v = oe.v;
+            v.it = makeSure(r, oe.v.it.ctx());
+            return BSR<N, N, T, XPU>{v};
+        }
+
+        /// Return the operators for applying the Schur complement M_ee - M_eo M_oo^{-1} M_oe
+        /// \param eo: sub-operators returned by `get_bsr_even_odd`
+        /// \param comm: communicator
+        ///
+        /// The sub-operator M_oo should be block diagonal with square blocks.
+
+        template <std::size_t N, typename T, typename XPU0, typename XPU1, typename Comm>
+        BSRSchur_tmpl<N, T, XPU0, XPU1>
+        get_bsr_schur(const std::array<BSRComponents_tmpl<N, N, T, XPU0, XPU1>, 4> &eo,
+                      Comm comm) {
+            tracker<Cpu> _t("BSR Schur complement setup", Cpu{0});
+
+            BSRSchur_tmpl<N, T, XPU0, XPU1> r;
+            r.ee = eo[0];
+            r.eo = eo[1];
+
+            // Replace the components of M_oe, and prepare the auxiliary operators again because
+            // the ones of M_oe have a copy of its nonzeros
+            BSRComponents_tmpl<N, N, T, XPU0, XPU1> &s = r.oo_inv_oe;
+            const BSRComponents_tmpl<N, N, T, XPU0, XPU1> &oe = eo[2], &oo = eo[3];
+            s.pd = oe.pd;
+            s.dimd = oe.dimd;
+            s.pi = oe.pi;
+            s.dimi = oe.dimi;
+            s.blockd = oe.blockd;
+            s.blocki = oe.blocki;
+            s.krond = oe.krond;
+            s.kroni = oe.kroni;
+            s.co = oe.co;
+            for (std::size_t i = 0; i < oe.c.first.size(); ++i) {
+                const unsigned int cid = oe.c.first[i].v.componentId;
+                s.c.first.push_back(get_bsr_oo_inv_oe(oo.c.first[i], oe.c.first[i],
+                                                      oo.pi[comm.rank][cid],
+                                                      oo.pd[comm.rank][cid], oo.dimd));
+            }
+            for (std::size_t i = 0; i < oe.c.second.size(); ++i) {
+                const unsigned int cid = oe.c.second[i].v.componentId;
+                s.c.second.push_back(get_bsr_oo_inv_oe(oo.c.second[i], oe.c.second[i],
+                                                       oo.pi[comm.rank][cid],
+                                                       oo.pd[comm.rank][cid], oo.dimd));
+            }
+            prepare_bsr_powers_and_halo(s, comm);
+
+            return r;
+        }
+
+        template <std::size_t N, typename T, typename Comm>
+        BSRSchur<N, T> *get_bsr_schur_from_handle(BSR_handle *bsrh, const Context *ctx,
+                                                  int ncomponents, const Comm &comm,
+                                                  CoorOrder co) {
+            BSRSchur<N, T> *r = dynamic_cast<BSRSchur<N, T> *>(bsrh);
+            if (!r || !r->ee.check(N, N, detail::num_type_v<T>::value, ctx, ncomponents,
+                                   comm.nprocs, comm.rank, co))
+                throw std::runtime_error(
+                    "Given BSR handle isn't a Schur complement handle, doesn't match the template "
+                    "parameters Nd, Ni, or T, does not match contexts, or does not match MPI "
+                    "communicator");
+            return r;
         }
 
         //
@@ -1942,6 +4247,62 @@ namespace superbblas {
             transSp = kindx == ContractWithImage;
         }
 
+        /// Check the inputs of a local RSB operator - tensor multiplication and return the
+        /// layout of the dense tensors; return false if there is nothing to do
+        /// \param bsr: BSR tensor component
+        /// \param oim: dimension labels for the RSB operator image space
+        /// \param odm: dimension labels for the RSB operator domain space
+        /// \param dimx: dimensions of the right tensor
+        /// \param ox: dimension labels for the right operator
+        /// \param dimy: dimensions of the output tensor
+        /// \param oy: dimension labels for the output tensor
+        /// \param okr: dimension label for the RSB operator powers (or zero for a single power)
+        /// \param transSp: (out) whether to contract with the transpose of the operator
+        /// \param lx: (out) layout of the right tensor
+        /// \param ly: (out) layout of the output tensor
+        /// \param ldx: (out) leading dimension of the right tensor
+        /// \param ldy: (out) leading dimension of the output tensor
+        /// \param volC: (out) number of columns of the dense tensors
+
+        template <std::size_t Nd, std::size_t Ni, std::size_t Nx, std::size_t Ny, typename T,
+                  typename XPU>
+        bool get_local_bsr_krylov_layout(const BSR<Nd, Ni, T, XPU> &bsr, const Order<Ni> &oim,
+                                         const Order<Nd> &odm, const Coor<Nx> &dimx,
+                                         const Order<Nx> &ox, const Coor<Ny> &dimy,
+                                         const Order<Ny> &oy, char okr, bool &transSp,
+                                         MatrixLayout &lx, MatrixLayout &ly, IndexType &ldx,
+                                         IndexType &ldy, std::size_t &volC) {
+
+            // Quick exit
+            if (volume(dimx) == 0 && volume(dimy) == 0) return false;
+
+            // Check inputs and get the common dimensions
+            Order<Nx> sug_ox;
+            Order<Ny> sug_oy;
+            Order<Ny> sug_oy_trans;
+            bool is_kron =
+                (volume(bsr.v.krond) > 1 || volume(bsr.v.kroni) > 1 || bsr.v.kron_it.size() > 0);
+            local_bsr_krylov_check(bsr.v.dimi, bsr.v.dimd, oim, odm, bsr.v.blocki, bsr.v.blockd,
+                                   bsr.v.kroni, bsr.v.krond, is_kron, dimx, ox, dimy, oy, okr,
+                                   bsr.allowLayout, bsr.preferredLayout, bsr.v.co, transSp, lx, ly,
+                                   volC, sug_ox, sug_oy, sug_oy_trans);
+            if (sug_ox != ox || sug_oy != oy)
+                throw std::runtime_error(
+                    "Unsupported layout for the input and output dense tensors");
+
+            std::size_t vold = volume(bsr.v.dimd), voli = volume(bsr.v.dimi);
+            IndexType ki = volume(bsr.v.kroni);
+            IndexType kd = volume(bsr.v.krond);
+            if (vold == 0 || voli == 0) return false;
+            // Layout for row major: (kd,n,bd,rows)
+            // Layout for column major: (bd,rows,n,kd)
+            ldx = lx == ColumnMajor ? (!transSp ? vold / kd : voli / ki)
+                                    : (!transSp ? kd : ki) * volC;
+            ldy = ly == ColumnMajor ? (!transSp ? voli / ki : vold / kd)
+                                    : (!transSp ? ki : kd) * volC;
+            return true;
+        }
+
         /// RSB operator - tensor multiplication
         /// \param pim: partitioning of the RSB operator image in consecutive ranges
         /// \param pdm: pseudo-partitioning of the RSB operator domain in consecutive ranges
@@ -1971,36 +4332,14 @@ namespace superbblas {
                                 std::string(")"),
                             vx.ctx());
 
-            // Quick exit
-            if (volume(dimx) == 0 && volume(dimy) == 0) return;
-
-            // Check inputs and get the common dimensions
+            // Check inputs and get the layouts
             bool transSp;
             MatrixLayout lx, ly;
+            IndexType ldx, ldy;
             std::size_t volC;
-            Order<Nx> sug_ox;
-            Order<Ny> sug_oy;
-            Order<Ny> sug_oy_trans;
-            bool is_kron =
-                (volume(bsr.v.krond) > 1 || volume(bsr.v.kroni) > 1 || bsr.v.kron_it.size() > 0);
-            local_bsr_krylov_check(bsr.v.dimi, bsr.v.dimd, oim, odm, bsr.v.blocki, bsr.v.blockd,
-                                   bsr.v.kroni, bsr.v.krond, is_kron, dimx, ox, dimy, oy, okr,
-                                   bsr.allowLayout, bsr.preferredLayout, bsr.v.co, transSp, lx, ly,
-                                   volC, sug_ox, sug_oy, sug_oy_trans);
-            if (sug_ox != ox || sug_oy != oy)
-                throw std::runtime_error(
-                    "Unsupported layout for the input and output dense tensors");
-
-            std::size_t vold = volume(bsr.v.dimd), voli = volume(bsr.v.dimi);
-            IndexType ki = volume(bsr.v.kroni);
-            IndexType kd = volume(bsr.v.krond);
-            if (vold == 0 || voli == 0) return;
-            // Layout for row major: (kd,n,bd,rows)
-            // Layout for column major: (bd,rows,n,kd)
-            IndexType ldx = lx == ColumnMajor ? (!transSp ? vold / kd : voli / ki)
-                                              : (!transSp ? kd : ki) * volC;
-            IndexType ldy = ly == ColumnMajor ? (!transSp ? voli / ki : vold / kd)
-                                              : (!transSp ? ki : kd) * volC;
+            if (!get_local_bsr_krylov_layout(bsr, oim, odm, dimx, ox, dimy, oy, okr, transSp, lx,
+                                             ly, ldx, ldy, volC))
+                return;
 
             // Do the contraction
             _t.flops = bsr.getFlopsPerMatvec(volC, lx);
@@ -2009,6 +4348,59 @@ namespace superbblas {
             bsr(alpha, transSp, vx, ldx, lx, vy, ldy, ly, volC);
         }
 
+        /// Several RSB operators with the same nonzero pattern - tensor multiplication; the
+        /// operators are applied in a single pass if the implementation supports it, see
+        /// `bsr_multi_matvec`
+        /// \param ops: BSR tensor components
+        /// \param oim: dimension labels for the RSB operator image space
+        /// \param odm: dimension labels for the RSB operator domain space
+        /// \param dimx: dimensions of the right tensor
+        /// \param ox: dimension labels for the right operator
+        /// \param vx: right input tensor
+        /// \param dimy: dimensions of the output tensors
+        /// \param oy: dimension labels for the output tensors
+        /// \param vy: output tensor for each operator
+
+        template <std::size_t Nd, std::size_t Ni, std::size_t Nx, std::size_t Ny, typename T,
+                  typename XPU>
+        void local_bsr_multi_krylov(T alpha, const std::vector<const BSR<Nd, Ni, T, XPU> *> &ops,
+                                    const Order<Ni> &oim, const Order<Nd> &odm,
+                                    const Coor<Nx> &dimx, const Order<Nx> &ox, vector<T, XPU> vx,
+                                    const Coor<Ny> &dimy, const Order<Ny> &oy,
+                                    const std::vector<vector<T, XPU>> &vy) {
+
+            if (ops.size() == 0) return;
+            tracker<XPU> _t(std::string("local fused BSR matvec (") +
+                                ops[0]->implementation() + std::string(")"),
+                            vx.ctx());
+
+            // Check inputs and get the layouts
+            bool transSp;
+            MatrixLayout lx, ly;
+            IndexType ldx, ldy;
+            std::size_t volC;
+            if (!get_local_bsr_krylov_layout(*ops[0], oim, odm, dimx, ox, dimy, oy, 0, transSp, lx,
+                                             ly, ldx, ldy, volC))
+                return;
+
+            // Do the contraction of all operators at once, or one by one if not supported
+            if (bsr_multi_matvec(alpha, ops, transSp, vx, ldx, lx, vy, ldy, ly, volC)) {
+                _t.arity = volC;
+                for (const BSR<Nd, Ni, T, XPU> *op : ops) {
+                    _t.flops += op->getFlopsPerMatvec(volC, lx);
+                    _t.memops += op->getMemopsPerMatvec(volC, lx);
+                }
+                // The input tensor is read once for all operators
+                _t.memops -= (double)(ops.size() - 1) * volume(ops[0]->v.blockd) * volC *
+                             ops[0]->v.j.size() * sizeof(T);
+                return;
+            }
+            _t.stop();
+            for (unsigned int op = 0; op < ops.size(); ++op)
+                local_bsr_krylov<Nd, Ni, Nx, Ny, T>(alpha, *ops[op], oim, odm, dimx, ox, vx, dimy,
+                                                    oy, 0, vy[op]);
+        }
+
         /// Get the partitions for the dense input and output tensors
         /// \param p0: partitioning of the first origin tensor in consecutive ranges
         /// \param o0: dimension labels for the first operator
@@ -2090,6 +4482,569 @@ namespace superbblas {
             return {pxr, pyr};
         }
 
+        /// Return the coordinates with two extra dimensions, placed as the fastest ones
+        /// \param c: coordinates
+        /// \param a: first extra coordinate
+        /// \param b: second extra coordinate, the fastest one
+        /// \param co: coordinate linearization order
+
+        template <std::size_t N>
+        Coor<N + 2> append_fastest(const Coor<N> &c, IndexType a, IndexType b, CoorOrder co) {
+            Coor<N + 2> r;
+            if (co == SlowToFast) {
+                std::copy_n(c.begin(), N, r.begin());
+                r[N] = a;
+                r[N + 1] = b;
+            } else {
+                r[0] = b;
+                r[1] = a;
+                std::copy_n(c.begin(), N, r.begin() + 2);
+            }
+            return r;
+        }
+
+        /// Return the partition of a tensor with the nonzero blocks of each block row
+        /// \param p: partition of the image space
+        /// \param bk: dimensions of the blocks in the image space
+        /// \param nnz: number of nonzero blocks on each block row
+        /// \param b: extra fastest dimension
+        /// \param co: coordinate linearization order
+
+        template <std::size_t N>
+        Proc_ranges<N + 2> get_rows_partition(const Proc_ranges<N> &p, const Coor<N> &bk,
+                                              IndexType nnz, IndexType b, CoorOrder co) {
+            Proc_ranges<N + 2> r(p.size());
+            for (unsigned int rank = 0; rank < p.size(); ++rank) {
+                r[rank].resize(p[rank].size());
+                for (unsigned int i = 0; i < p[rank].size(); ++i) {
+                    if (volume(p[rank][i][1]) == 0) continue;
+                    r[rank][i][0] = append_fastest(p[rank][i][0] / bk, 0, 0, co);
+                    r[rank][i][1] = append_fastest(p[rank][i][1] / bk, nnz, b, co);
+                }
+            }
+            return r;
+        }
+
+        /// Return a range extended by the same halo that the domain range of a component has
+        /// around its image range
+        /// \param fs: range to extend
+        /// \param fsi: image range of the component
+        /// \param fsd: domain range of the component
+        /// \param dim: dimensions of the whole space
+
+        template <std::size_t N>
+        From_size_item<N> extend_range(const From_size_item<N> &fs, const From_size_item<N> &fsi,
+                                       const From_size_item<N> &fsd, const Coor<N> &dim) {
+            if (volume(fs[1]) == 0 || volume(fsi[1]) == 0) return fs;
+            From_size_item<N> r;
+            for (std::size_t d = 0; d < N; ++d) {
+                IndexType lo = normalize_coor(fsi[0][d] - fsd[0][d], dim[d]);
+                IndexType hi = fsd[1][d] - fsi[1][d] - lo;
+                if (fsd[1][d] >= dim[d] || fs[1][d] + lo + hi >= dim[d]) {
+                    r[0][d] = 0;
+                    r[1][d] = dim[d];
+                } else {
+                    r[0][d] = normalize_coor(fs[0][d] - lo, dim[d]);
+                    r[1][d] = fs[1][d] + lo + hi;
+                }
+            }
+            return r;
+        }
+
+        /// Append the nonzero values and the global domain coordinates of the nonzero blocks of
+        /// the components into CPU tensors
+        /// \param ops: BSR components
+        /// \param opj: domain coordinates of the nonzero blocks for every component
+        /// \param pd: domain ranges of the local components
+        /// \param dimd: dimensions of the domain space
+        /// \param dimv: dimensions of the local tensor with the values of each component
+        /// \param dimj: dimensions of the local tensor with the coordinates of each component
+        /// \param v: (out) nonzero values
+        /// \param j: (out) domain coordinates of the nonzero blocks, or -1 for unused blocks
+
+        template <std::size_t Nd, std::size_t Ni, typename T, typename XPU>
+        void append_bsr_rows(const std::vector<BSR<Nd, Ni, T, XPU>> &ops,
+                             const std::vector<vector<Coor<Nd>, Cpu>> &opj,
+                             const std::vector<From_size_item<Nd>> &pd, const Coor<Nd> &dimd,
+                             const std::vector<Coor<Ni + 2>> &dimv,
+                             const std::vector<Coor<Ni + 2>> &dimj,
+                             Components_tmpl<Ni + 2, T, Cpu, Cpu> &v,
+                             Components_tmpl<Ni + 2, IndexType, Cpu, Cpu> &j) {
+            for (const auto &op : ops) {
+                const unsigned int cid = op.v.componentId;
+                vector<IndexType, Cpu> jc(opj[cid].size() * Nd, Cpu{});
+                for (std::size_t k = 0; k < opj[cid].size(); ++k) {
+                    Coor<Nd> c = opj[cid][k];
+                    if (c[0] >= 0) c = normalize_coor(c + pd[cid][0], dimd);
+                    std::copy_n(c.begin(), Nd, jc.data() + k * Nd);
+                }
+                v.second.push_back(Component<Ni + 2, T, Cpu>{makeSure(op.v.it, Cpu{}), dimv[cid],
+                                                             cid, Mask<Cpu>{}});
+                j.second.push_back(
+                    Component<Ni + 2, IndexType, Cpu>{jc, dimj[cid], cid, Mask<Cpu>{}});
+            }
+        }
+
+        /// Return a component of the operator extended to a larger image range
+        /// \param op: original component
+        /// \param v: nonzero values on the new image range
+        /// \param j: global domain coordinates of the nonzero blocks on the new image range
+        /// \param nnz: number of nonzero blocks on each block row
+        /// \param fsi: new image range
+        /// \param fsd: new domain range
+        /// \param dimd: dimensions of the domain space
+        /// \param covered: (out) set to false if some nonzero block is outside `fsd`
+
+        template <std::size_t Nd, std::size_t Ni, typename T, typename XPU>
+        BSR<Nd, Ni, T, XPU>
+        get_extended_bsr(const BSR<Nd, Ni, T, XPU> &op, const vector<T, Cpu> &v,
+                         const vector<IndexType, Cpu> &j, IndexType nnz,
+                         const From_size_item<Ni> &fsi, const From_size_item<Nd> &fsd,
+                         const Coor<Nd> &dimd, bool &covered) {
+            const std::size_t nrows = j.size() / Nd / nnz;
+            Indices<Cpu> ii(nrows, Cpu{});
+            for (std::size_t k = 0; k < nrows; ++k) ii[k] = nnz;
+            vector<Coor<Nd>, Cpu> jj(nrows * nnz, Cpu{});
+            bool covered_op = true;
+            for (std::size_t k = 0; k < jj.size(); ++k) {
+                Coor<Nd> c;
+                std::copy_n(j.data() + k * Nd, Nd, c.begin());
+                if (c[0] >= 0) {
+                    c = normalize_coor(c - fsd[0], dimd);
+                    for (std::size_t d = 0; d < Nd; ++d)
+                        if (c[d] >= fsd[1][d]) covered_op = false;
+                }
+                jj[k] = c;
+            }
+            if (!covered_op) {
+                covered = false;
+                return op;
+            }
+
+            XPU xpu = op.v.it.ctx();
+            return BSR<Nd, Ni, T, XPU>{BSRComponent<Nd, Ni, T, XPU>{
+                makeSure(ii, xpu), makeSure(jj, xpu), makeSure(v, xpu), fsd[1], fsi[1],
+                op.v.blockd, op.v.blocki, op.v.krond, op.v.kroni, op.v.kron_it, op.v.blockImFast,
+                op.v.co, op.v.componentId, op.v.lowPrecision}};
+        }
+
+        /// Prepare the operators for computing several powers of a BSR operator with a single
+        /// halo exchange of the input vectors, and return whether it is supported
+        /// \param bsr: BSR tensor components
+        /// \param power: number of powers
+        /// \param comm: communicator
+        ///
+        /// The image range of each component is extended on every level by the halo that the
+        /// domain range has around the image range, and the rows of the operator on the extended
+        /// range are gathered from the other components. The operator should be square, have the
+        /// same number of nonzero blocks on all block rows, and the blocks should be either one
+        /// element or the whole dimension. The result is stored in `bsr.powers`.
+
+        template <std::size_t Nd, std::size_t Ni, typename T, typename XPU0, typename XPU1,
+                  typename Comm, typename std::enable_if<Nd == Ni, bool>::type = true>
+        bool get_bsr_powers(const BSRComponents_tmpl<Nd, Ni, T, XPU0, XPU1> &bsr,
+                            unsigned int power, Comm comm) {
+            BSRPowers<Nd, Ni, T, XPU0, XPU1> &r = *bsr.powers;
+            if (!r.supported || r.ops.size() + 1 >= power) return r.supported;
+
+            tracker<Cpu> _t("BSR powers setup", Cpu{0});
+
+            // Check the dimensions of the operator and the ranges of the components; all
+            // processes reach the same conclusion
+            bool supported = bsr.dimd == bsr.dimi && bsr.blockd == bsr.blocki &&
+                             volume(bsr.krond) == 1 && volume(bsr.kroni) == 1 &&
+                             r.i.size() == bsr.pi[comm.rank].size();
+            for (std::size_t d = 0; d < Ni; ++d)
+                if (bsr.blocki[d] != 1 && bsr.blocki[d] != bsr.dimi[d]) supported = false;
+            for (unsigned int rank = 0; rank < bsr.pi.size(); ++rank) {
+                for (unsigned int i = 0; i < bsr.pi[rank].size(); ++i) {
+                    const auto &fsi = bsr.pi[rank][i], &fsd = bsr.pd[rank][i];
+                    if (volume(fsi[1]) == 0) continue;
+                    for (std::size_t d = 0; d < Ni; ++d) {
+                        if (bsr.blocki[d] != 1 && fsi[1][d] != bsr.dimi[d]) supported = false;
+                        if (fsd[1][d] < bsr.dimd[d] &&
+                            normalize_coor(fsi[0][d] - fsd[0][d], bsr.dimd[d]) + fsi[1][d] >
+                                fsd[1][d])
+                            supported = false;
+                    }
+                }
+            }
+            if (!supported) {
+                r.supported = false;
+                return false;
+            }
+
+            // Check that all block rows have the same number of nonzero blocks
+            int nnz_min = std::numeric_limits<int>::max(), nnz_max = 0;
+            for (const auto &i : r.i) {
+                for (std::size_t k = 0; k < i.size(); ++k) {
+                    nnz_min = std::min(nnz_min, (int)i[k]);
+                    nnz_max = std::max(nnz_max, (int)i[k]);
+                }
+            }
+            nnz_max = global_max(nnz_max, comm);
+            nnz_min = -global_max(nnz_min <= nnz_max ? -nnz_min : -nnz_max, comm);
+            if (nnz_max == 0 || nnz_min != nnz_max) {
+                r.supported = false;
+                return false;
+            }
+
+            // Gather the nonzero values and the global domain coordinates of the nonzero blocks
+            // on tensors with the block rows as the slowest dimensions
+            const IndexType nnz = nnz_max;
+            const IndexType B = volume(bsr.blocki) * volume(bsr.blockd);
+            const Coor<Ni + 2> dimv = append_fastest(bsr.dimi / bsr.blocki, nnz, B, bsr.co);
+            const Coor<Ni + 2> dimj = append_fastest(bsr.dimi / bsr.blocki, nnz, Nd, bsr.co);
+            const Order<Ni + 2> o = trivial_order<Ni + 2>();
+            const Proc_ranges<Ni + 2> pv0 = get_rows_partition(bsr.pi, bsr.blocki, nnz, B, bsr.co);
+            const Proc_ranges<Ni + 2> pj0 = get_rows_partition(bsr.pi, bsr.blocki, nnz, Nd, bsr.co);
+            std::vector<Coor<Ni + 2>> localv, localj;
+            for (const auto &fs : pv0[comm.rank]) localv.push_back(fs[1]);
+            for (const auto &fs : pj0[comm.rank]) localj.push_back(fs[1]);
+            Components_tmpl<Ni + 2, T, Cpu, Cpu> v0;
+            Components_tmpl<Ni + 2, IndexType, Cpu, Cpu> j0;
+            append_bsr_rows(bsr.c.first, r.j, bsr.pd[comm.rank], bsr.dimd, localv, localj, v0,
+                            j0);
+            append_bsr_rows(bsr.c.second, r.j, bsr.pd[comm.rank], bsr.dimd, localv, localj, v0,
+                            j0);
+
+            // Create the operators for the new levels
+            if (r.ranges.empty()) r.ranges = {bsr.pi, bsr.pd};
+            bool covered = true;
+            for (unsigned int l = r.ops.size() + 1; l < power; ++l) {
+                // Extend the ranges of the last level with the halo
+                Proc_ranges<Ni> next = r.ranges[l];
+                for (unsigned int rank = 0; rank < next.size(); ++rank)
+                    for (unsigned int i = 0; i < next[rank].size(); ++i)
+                        next[rank][i] = extend_range(r.ranges[l][rank][i], bsr.pi[rank][i],
+                                                     bsr.pd[rank][i], bsr.dimi);
+                r.ranges.push_back(next);
+
+                // Gather the rows on the image ranges of this level
+                const Proc_ranges<Ni + 2> pv1 =
+                    get_rows_partition(r.ranges[l], bsr.blocki, nnz, B, bsr.co);
+                const Proc_ranges<Ni + 2> pj1 =
+                    get_rows_partition(r.ranges[l], bsr.blocki, nnz, Nd, bsr.co);
+                Components_tmpl<Ni + 2, T, Cpu, Cpu> v1 =
+                    like_this_components(pv1, v0, comm, dontCacheAlloc, doZeroInit);
+                Components_tmpl<Ni + 2, IndexType, Cpu, Cpu> j1 =
+                    like_this_components(pj1, j0, comm, dontCacheAlloc, doZeroInit);
+                copy<Ni + 2, Ni + 2, T>(T{1}, pv0, {{}}, dimv, dimv, o, toConst(v0), pv1, {{}},
+                                        dimv, o, v1, comm, EWOp::Copy{}, bsr.co);
+                copy<Ni + 2, Ni + 2, IndexType>(1, pj0, {{}}, dimj, dimj, o, toConst(j0), pj1,
+                                                {{}}, dimj, o, j1, comm, EWOp::Copy{}, bsr.co);
+
+                // Create the local components from ranges[l+1] to ranges[l]
+                const auto &fsi = r.ranges[l][comm.rank];
+                const auto &fsd = r.ranges[l + 1][comm.rank];
+                std::pair<std::vector<BSR<Nd, Ni, T, XPU0>>, std::vector<BSR<Nd, Ni, T, XPU1>>>
+                    ops;
+                const std::size_t n0 = bsr.c.first.size();
+                for (unsigned int i = 0; i < n0; ++i) {
+                    const unsigned int cid = bsr.c.first[i].v.componentId;
+                    ops.first.push_back(get_extended_bsr(bsr.c.first[i], v1.second[i].it,
+                                                         j1.second[i].it, nnz, fsi[cid],
+                                                         fsd[cid], bsr.dimd, covered));
+                }
+                for (unsigned int i = 0; i < bsr.c.second.size(); ++i) {
+                    const unsigned int cid = bsr.c.second[i].v.componentId;
+                    ops.second.push_back(get_extended_bsr(bsr.c.second[i], v1.second[n0 + i].it,
+                                                          j1.second[n0 + i].it, nnz, fsi[cid],
+                                                          fsd[cid], bsr.dimd, covered));
+                }
+                r.ops.push_back(ops);
+            }
+
+            // Give up if some nonzero block falls out of the domain range on any process
+            if (global_max(covered ? 0 : 1, comm) != 0) {
+                r.supported = false;
+                r.ranges.clear();
+                r.ops.clear();
+            }
+
+            return r.supported;
+        }
+
+        template <std::size_t Nd, std::size_t Ni, typename T, typename XPU0, typename XPU1,
+                  typename Comm, typename std::enable_if<Nd != Ni, bool>::type = true>
+        bool get_bsr_powers(const BSRComponents_tmpl<Nd, Ni, T, XPU0, XPU1> &, unsigned int,
+                            Comm) {
+            return false;
+        }
+
+        /// Compute several powers of a BSR operator with the operators from `get_bsr_powers`
+        /// \param alpha: factor on the contraction
+        /// \param bsr: BSR tensor components
+        /// \param oim: dimension labels for the RSB operator image space
+        /// \param odm: dimension labels for the RSB operator domain space
+        /// \param pxys: partitions of the input and output tensors on each level
+        /// \param sug_ox: dimension labels for the input tensor
+        /// \param vx: input tensor components on the partition of the last level
+        /// \param sug_dimx: dimensions of the input tensor
+        /// \param beta: factor on the original output tensor
+        /// \param py: partitioning of the output tensor
+        /// \param oy: dimension labels for the output tensor
+        /// \param fromy: first coordinate to write on the output tensor
+        /// \param dimy: dimensions of the output tensor
+        /// \param okr: dimension label for the RSB operator powers
+        /// \param vy: output tensor components
+        /// \param vy0: auxiliary tensor components on the image partition
+        /// \param sug_oy: dimension labels for the auxiliary output tensor
+        /// \param sug_sizey: dimensions of the auxiliary output tensor
+        /// \param sug_oy_trans: dimension labels for the auxiliary output tensor as an input tensor
+        /// \param power_pos: position of `okr` on `oy`
+        /// \param comm: communicator
+        /// \param co: coordinate linearization order
+
+        template <std::size_t Nd, std::size_t Ni, std::size_t Nx, std::size_t Ny, typename T,
+                  typename Comm, typename XPU0, typename XPU1>
+        void bsr_krylov_powers(T alpha, const BSRComponents_tmpl<Nd, Ni, T, XPU0, XPU1> &bsr,
+                               const Order<Ni> &oim, const Order<Nd> &odm,
+                               const std::vector<std::pair<Proc_ranges<Nx>, Proc_ranges<Ny>>> &pxys,
+                               const Order<Nx> &sug_ox,
+                               const Components_tmpl<Nx, T, XPU0, XPU1> &vx,
+                               const Coor<Nx> &sug_dimx, T beta, const Proc_ranges<Ny> &py,
+                               const Order<Ny> &oy, const Coor<Ny> &fromy, const Coor<Ny> &dimy,
+                               char okr, const Components_tmpl<Ny, T, XPU0, XPU1> &vy,
+                               const Components_tmpl<Ny, T, XPU0, XPU1> &vy0,
+                               const Order<Ny> &sug_oy, const Coor<Ny> &sug_sizey,
+                               const Order<Ny> &sug_oy_trans, unsigned int power_pos, Comm comm,
+                               CoorOrder co) {
+
+            const unsigned int power = pxys.size();
+            Components_tmpl<Nx, T, XPU0, XPU1> vxl = vx;
+            for (unsigned int p = 0; p < power; ++p) {
+                // The p-th power is computed on the image ranges of level power-1-p
+                const unsigned int l = power - 1 - p;
+                const Proc_ranges<Nx> &px_ = pxys[l].first;
+                const Proc_ranges<Ny> &py_ = pxys[l].second;
+                const auto &ops = (l == 0 ? bsr.c : bsr.powers->ops[l - 1]);
+                Components_tmpl<Ny, T, XPU0, XPU1> vyl =
+                    (l == 0 ? vy0 : like_this_components(py_, vxl, comm, doCacheAlloc));
+                for (unsigned int i = 0; i < ops.first.size(); ++i) {
+                    const unsigned int componentId = ops.first[i].v.componentId;
+                    local_bsr_krylov<Nd, Ni, Nx, Ny, T>(
+                        p == 0 ? alpha : T{1}, ops.first[i], oim, odm,
+                        px_[comm.rank][componentId][1], sug_ox, vxl.first[i].it,
+                        py_[comm.rank][componentId][1], sug_oy, okr, vyl.first[i].it);
+                }
+                for (unsigned int i = 0; i < ops.second.size(); ++i) {
+                    const unsigned int componentId = ops.second[i].v.componentId;
+                    local_bsr_krylov<Nd, Ni, Nx, Ny, T>(
+                        p == 0 ? alpha : T{1}, ops.second[i], oim, odm,
+                        px_[comm.rank][componentId][1], sug_ox, vxl.second[i].it,
+                        py_[comm.rank][componentId][1], sug_oy, okr, vyl.second[i].it);
+                }
+
+                // Restrict the result to the image partition
+                if (l > 0)
+                    copy<Ny, Ny, T>(T{1}, py_, {{}}, sug_sizey, sug_sizey, sug_oy, toConst(vyl),
+                                    pxys[0].second, {{}}, sug_sizey, sug_oy, vy0, comm,
+                                    EWOp::Copy{}, co, doForceLocal);
+
+                // Copy the result to final tensor
+                Coor<Ny> fromyi = fromy;
+                fromyi[power_pos] += p;
+                if (std::norm(beta) == 0)
+                    copy<Ny, Ny, T>(1.0, pxys[0].second, {{}}, sug_sizey, sug_sizey, sug_oy,
+                                    toConst(vy0), py, fromyi, dimy, oy, vy, comm, EWOp::Copy{}, co);
+                else
+                    copy<Ny, Ny, T>(1.0, pxys[0].second, {{}}, sug_sizey, sug_sizey, sug_oy,
+                                    toConst(vy0), py, fromyi, dimy, oy, vy, comm, EWOp::Add{}, co);
+
+                // Copy the result into x for doing the next power; the image ranges of this level
+                // are the domain ranges of the next one, so no communication is needed
+                if (p == power - 1) break;
+                Components_tmpl<Nx, T, XPU0, XPU1> vxn =
+                    like_this_components(pxys[l - 1].first, vxl, comm, doCacheAlloc);
+                copy<Ny, Nx, T>(T{1}, py_, {{}}, sug_sizey, sug_sizey, sug_oy_trans, toConst(vyl),
+                                pxys[l - 1].first, {{}}, sug_dimx, sug_ox, vxn, comm, EWOp::Copy{},
+                                co, doForceLocal);
+                vxl = vxn;
+            }
+        }
+
+        /// Copy or add the local components of a tensor into the local components of another
+        /// tensor with larger ranges
+        /// \param alpha: factor on the copy
+        /// \param v0: origin tensor components
+        /// \param p0: ranges of the local components of the origin tensor
+        /// \param p1: ranges of the local components of the destination tensor
+        /// \param dim: dimensions of the whole tensor
+        /// \param o: dimension labels for both tensors
+        /// \param v1: destination tensor components
+        /// \param co: coordinate linearization order
+
+        template <std::size_t N, typename T, typename XPU, typename EWOP>
+        void copy_into_ranges(T alpha, const std::vector<Component<N, T, XPU>> &v0,
+                              const std::vector<From_size_item<N>> &p0,
+                              const std::vector<From_size_item<N>> &p1, const Coor<N> &dim,
+                              const Order<N> &o, const std::vector<Component<N, T, XPU>> &v1,
+                              EWOP, CoorOrder co) {
+            for (unsigned int i = 0; i < v0.size(); ++i) {
+                const unsigned int componentId = v0[i].componentId;
+                const From_size_item<N> &fs0 = p0[componentId], &fs1 = p1[componentId];
+                if (volume(fs0[1]) == 0) continue;
+                local_copy<N, N, T, T>(alpha, o, {{}}, fs0[1], fs0[1],
+                                       vector<const T, XPU>(v0[i].it), Mask<XPU>{}, o,
+                                       normalize_coor(fs0[0] - fs1[0], dim), fs1[1], v1[i].it,
+                                       Mask<XPU>{}, EWOP{}, co);
+            }
+        }
+
+        /// Do the contraction with the components of a BSR operator
+        /// \param alpha: factor on the contraction
+        /// \param ops: BSR components
+        /// \param oim: dimension labels for the RSB operator image space
+        /// \param odm: dimension labels for the RSB operator domain space
+        /// \param px: ranges of the local components of the input tensor
+        /// \param ox: dimension labels for the input tensor
+        /// \param vx: input tensor components
+        /// \param py: ranges of the local components of the output tensor
+        /// \param oy: dimension labels for the output tensor
+        /// \param okr: dimension label for the RSB operator powers (or zero for a single power)
+        /// \param vy: output tensor components
+        /// \param ewop: either to copy or to add the result into the output tensor
+        /// \param co: coordinate linearization order
+
+        template <std::size_t Nd, std::size_t Ni, std::size_t Nx, std::size_t Ny, typename T,
+                  typename XPU, typename EWOP>
+        void local_bsr_krylov(T alpha, const std::vector<BSR<Nd, Ni, T, XPU>> &ops,
+                              const Order<Ni> &oim, const Order<Nd> &odm,
+                              const std::vector<From_size_item<Nx>> &px, const Order<Nx> &ox,
+                              const std::vector<Component<Nx, T, XPU>> &vx,
+                              const std::vector<From_size_item<Ny>> &py, const Order<Ny> &oy,
+                              char okr, const std::vector<Component<Ny, T, XPU>> &vy, EWOP,
+                              CoorOrder co) {
+            for (unsigned int i = 0; i < ops.size(); ++i) {
+                const unsigned int componentId = ops[i].v.componentId;
+                if (std::is_same<EWOP, EWOp::Copy>::value) {
+                    local_bsr_krylov<Nd, Ni, Nx, Ny, T>(alpha, ops[i], oim, odm,
+                                                        px[componentId][1], ox, vx[i].it,
+                                                        py[componentId][1], oy, okr, vy[i].it);
+                } else if (ops[i].v.j.size() > 0) {
+                    vector<T, XPU> vyi(vy[i].it.size(), vy[i].it.ctx(), doCacheAlloc);
+                    local_bsr_krylov<Nd, Ni, Nx, Ny, T>(alpha, ops[i], oim, odm,
+                                                        px[componentId][1], ox, vx[i].it,
+                                                        py[componentId][1], oy, okr, vyi);
+                    local_copy<Ny, Ny, T, T>(T{1}, oy, {{}}, py[componentId][1],
+                                             py[componentId][1], vector<const T, XPU>(vyi),
+                                             Mask<XPU>{}, oy, {{}}, py[componentId][1], vy[i].it,
+                                             Mask<XPU>{}, EWOP{}, co);
+                }
+            }
+        }
+
+        /// Start the contraction of a BSR operator with a tensor bringing only the halo of the
+        /// input tensor referenced by the operator, see `get_bsr_halo`; return the output
+        /// tensor and the request to finish the contraction
+        /// \param alpha: factor on the contraction
+        /// \param bsr: BSR tensor components
+        /// \param oim: dimension labels for the RSB operator image space
+        /// \param odm: dimension labels for the RSB operator domain space
+        /// \param px: partitioning of the input tensor in consecutive ranges
+        /// \param ox: dimension labels for the input tensor
+        /// \param fromx: first coordinate to operate from the input tensor
+        /// \param sizex: number of elements to operate in each dimension
+        /// \param dimx: dimensions of the input tensor
+        /// \param vx: input tensor components
+        /// \param px_: partitioning of the input tensor on the domain ranges
+        /// \param sug_ox: dimension labels for the input tensor on the domain ranges
+        /// \param sug_dimx: dimensions of the input tensor on the domain ranges
+        /// \param py_: partitioning of the output tensor on the image ranges
+        /// \param oy: dimension labels for the output tensor
+        /// \param sug_oy: dimension labels for the output tensor on the image ranges
+        /// \param okr: dimension label for the RSB operator powers (or zero for a single power)
+        /// \param comm: communicator
+        /// \param co: coordinate linearization order
+        ///
+        /// The contribution of the elements on the image range of each component is computed
+        /// with the original operator while the ghost regions arrive, and the contribution of
+        /// the ghost regions is added afterwards with the boundary operators.
+
+        template <std::size_t Nd, std::size_t Ni, std::size_t Nx, std::size_t Ny, typename T,
+                  typename Comm, typename XPU0, typename XPU1>
+        std::pair<Components_tmpl<Ny, T, XPU0, XPU1>, Request>
+        bsr_krylov_halo(T alpha, const BSRComponents_tmpl<Nd, Ni, T, XPU0, XPU1> &bsr,
+                        const Order<Ni> &oim, const Order<Nd> &odm, const Proc_ranges<Nx> &px,
+                        const Order<Nx> &ox, const Coor<Nx> &fromx, const Coor<Nx> &sizex,
+                        const Coor<Nx> &dimx, const Components_tmpl<Nx, T, XPU0, XPU1> &vx,
+                        const Proc_ranges<Nx> &px_, const Order<Nx> &sug_ox,
+                        const Coor<Nx> &sug_dimx, const Proc_ranges<Ny> &py_, const Order<Ny> &oy,
+                        const Order<Ny> &sug_oy, char okr, Comm comm, CoorOrder co) {
+
+            tracker<Cpu> _t("distributed BSR matvec (halo)", Cpu{0});
+
+            const BSRHalo<Nd, Ni, T, XPU0, XPU1> &h = *bsr.halo;
+            const auto mock = get_mock_components(bsr);
+
+            // Start bringing the ghost regions of the input tensor
+            std::vector<Proc_ranges<Nx>> pg;
+            std::vector<Components_tmpl<Nx, T, XPU0, XPU1>> vg;
+            std::vector<Request> reqs;
+            for (const auto &g : h.ghosts) {
+                pg.push_back(get_output_partition(g, odm, bsr.pi, oim, px, ox, sug_ox, sizex, oy,
+                                                  sug_oy, okr, comm)
+                                 .first);
+                auto vg_and_req =
+                    reorder_tensor_request(px, ox, fromx, sizex, dimx, vx, pg.back(), sug_dimx,
+                                           sug_ox, mock, comm, co, true /* force copy */,
+                                           doCacheAlloc);
+                vg.push_back(vg_and_req.first);
+                reqs.push_back(vg_and_req.second);
+            }
+
+            // Put the elements on the image ranges into a tensor on the domain ranges with zero
+            // ghost regions, and do the contraction with them
+            const Proc_ranges<Nx> po = get_output_partition(h.own, odm, bsr.pi, oim, px, ox, sug_ox,
+                                                            sizex, oy, sug_oy, okr, comm)
+                                           .first;
+            Components_tmpl<Nx, T, XPU0, XPU1> vo = reorder_tensor(
+                px, ox, fromx, sizex, dimx, vx, po, sug_dimx, sug_ox, mock, comm, co,
+                false /* don't force copy */, doCacheAlloc);
+            Components_tmpl<Nx, T, XPU0, XPU1> vx_ =
+                like_this_components(px_, mock, comm, doCacheAlloc, doZeroInit);
+            copy_into_ranges(T{1}, vo.first, po[comm.rank], px_[comm.rank], sug_dimx, sug_ox,
+                             vx_.first, EWOp::Copy{}, co);
+            copy_into_ranges(T{1}, vo.second, po[comm.rank], px_[comm.rank], sug_dimx, sug_ox,
+                             vx_.second, EWOp::Copy{}, co);
+            Components_tmpl<Ny, T, XPU0, XPU1> vy_ =
+                like_this_components(py_, vx_, comm, doCacheAlloc);
+            local_bsr_krylov<Nd, Ni, Nx, Ny, T>(alpha, bsr.c.first, oim, odm, px_[comm.rank],
+                                                sug_ox, vx_.first, py_[comm.rank], sug_oy, okr,
+                                                vy_.first, EWOp::Copy{}, co);
+            local_bsr_krylov<Nd, Ni, Nx, Ny, T>(alpha, bsr.c.second, oim, odm, px_[comm.rank],
+                                                sug_ox, vx_.second, py_[comm.rank], sug_oy, okr,
+                                                vy_.second, EWOp::Copy{}, co);
+
+            _t.stop();
+
+            // Finish by adding the contribution of the ghost regions
+            Request r = [=] {
+                tracker<Cpu> _t("distributed BSR matvec (halo)", Cpu{0});
+
+                for (const auto &req : reqs) wait(req);
+                Components_tmpl<Nx, T, XPU0, XPU1> vxg =
+                    like_this_components(px_, mock, comm, doCacheAlloc, doZeroInit);
+                for (unsigned int s = 0; s < vg.size(); ++s) {
+                    copy_into_ranges(T{1}, vg[s].first, pg[s][comm.rank], px_[comm.rank],
+                                     sug_dimx, sug_ox, vxg.first, EWOp::Copy{}, co);
+                    copy_into_ranges(T{1}, vg[s].second, pg[s][comm.rank], px_[comm.rank],
+                                     sug_dimx, sug_ox, vxg.second, EWOp::Copy{}, co);
+                }
+                local_bsr_krylov<Nd, Ni, Nx, Ny, T>(alpha, h.boundary.first, oim, odm,
+                                                    px_[comm.rank], sug_ox, vxg.first,
+                                                    py_[comm.rank], sug_oy, okr, vy_.first,
+                                                    EWOp::Add{}, co);
+                local_bsr_krylov<Nd, Ni, Nx, Ny, T>(alpha, h.boundary.second, oim, odm,
+                                                    px_[comm.rank], sug_ox, vxg.second,
+                                                    py_[comm.rank], sug_oy, okr, vy_.second,
+                                                    EWOp::Add{}, co);
+            };
+
+            return {vy_, r};
+        }
+
         /// RSB operator - tensor multiplication
         /// \param bsr: BSR tensor components
         /// \param oim: dimension labels for the RSB operator image space
@@ -2183,12 +5138,42 @@ namespace superbblas {
             auto pxy_ = get_output_partition(bsr.pd, odm, bsr.pi, oim, px, ox, sug_ox, sizex, oy,
                                              sug_oy, okr, comm, just_local);
 
+            // Compute all powers with a single exchange of the input tensor when the operator
+            // supports it and the dense input tensor is contracted with the domain
+            bool x_on_image = false;
+            for (char c : ox)
+                if (std::find(oim.begin(), oim.end(), c) != oim.end()) x_on_image = true;
+            const bool use_powers = power > 1 && !just_local && !x_on_image &&
+                                    getUseBSRPowers() && get_bsr_powers(bsr, power, comm);
+
+            // Bring only the halo of the input tensor referenced by the operator for a single power
+            const bool use_halo =
+                power == 1 && !just_local && !x_on_image && bsr.halo->supported;
+
+            // Get the partitions of the dense tensors on each level, pxys[l] for the operator
+            // from ranges[l+1] to ranges[l]
+            std::vector<std::pair<Proc_ranges<Nx>, Proc_ranges<Ny>>> pxys(1, pxy_);
+            if (use_powers) {
+                const auto &ranges = bsr.powers->ranges;
+                for (unsigned int l = 1; l < power; ++l)
+                    pxys.push_back(get_output_partition(ranges[l + 1], odm, ranges[l], oim, px, ox,
+                                                        sug_ox, sizex, oy, sug_oy, okr, comm));
+            }
+
             // Copy the input dense tensor to a compatible layout to the sparse tensor
-            Proc_ranges<Nx> px_ = pxy_.first;
+            Proc_ranges<Nx> px_ = pxys.back().first;
             ForceLocal force_local = (just_local ? doForceLocal : dontForceLocal);
-            auto vx_and_req = reorder_tensor_request(
-                px, ox, fromx, sizex, dimx, vx, px_, sug_dimx, sug_ox, get_mock_components(bsr),
-                comm, co, power > 1 /* force copy when power > 1 */, doCacheAlloc, force_local);
+            std::pair<Components_tmpl<Nx, T, XPU0, XPU1>, Request> vx_and_req;
+            std::pair<Components_tmpl<Ny, T, XPU0, XPU1>, Request> vy_and_req;
+            if (use_halo)
+                vy_and_req = bsr_krylov_halo<Nd, Ni, Nx, Ny, T>(
+                    alpha, bsr, oim, odm, px, ox, fromx, sizex, dimx, vx, px_, sug_ox, sug_dimx,
+                    pxy_.second, oy, sug_oy, okr, comm, co);
+            else
+                vx_and_req = reorder_tensor_request(
+                    px, ox, fromx, sizex, dimx, vx, px_, sug_dimx, sug_ox,
+                    get_mock_components(bsr), comm, co, power > 1 /* force copy when power > 1 */,
+                    doCacheAlloc, force_local);
             Components_tmpl<Nx, T, XPU0, XPU1> vx_ = vx_and_req.first;
 
             // Scale the output vector if beta isn't 0 or 1
@@ -2201,68 +5186,278 @@ namespace superbblas {
 
                 // Wait for the data to be ready
                 wait(vx_and_req.second);
+                wait(vy_and_req.second);
 
                 // Allocate the output tensor
                 Proc_ranges<Ny> py_ = pxy_.second;
                 Components_tmpl<Ny, T, XPU0, XPU1> vy_ =
-                    like_this_components(py_, vx_, comm, doCacheAlloc);
+                    use_halo ? vy_and_req.first
+                             : like_this_components(py_, vx_, comm, doCacheAlloc);
+
+                // Do contraction with the powers computed without communications in between
+                if (use_powers) {
+                    bsr_krylov_powers<Nd, Ni, Nx, Ny, T>(alpha, bsr, oim, odm, pxys, sug_ox, vx_,
+                                                         sug_dimx, beta, py, oy, fromy, dimy, okr,
+                                                         vy, vy_, sug_oy, sug_sizey, sug_oy_trans,
+                                                         power_pos, comm, co);
+                    return;
+                }
 
-                // Do contraction
+                // Do contraction; the halo variant has already done it
                 for (unsigned int p = 0; p < power; ++p) {
-                    for (unsigned int i = 0; i < bsr.c.first.size(); ++i) {
-                        const unsigned int componentId = bsr.c.first[i].v.componentId;
+                    if (!use_halo) {
                         local_bsr_krylov<Nd, Ni, Nx, Ny, T>(
-                            p == 0 ? alpha : T{1}, bsr.c.first[i], oim, odm,
-                            px_[comm.rank][componentId][1], sug_ox, vx_.first[i].it,
-                            py_[comm.rank][componentId][1], sug_oy, okr, vy_.first[i].it);
-                    }
-                    for (unsigned int i = 0; i < bsr.c.second.size(); ++i) {
-                        const unsigned int componentId = bsr.c.second[i].v.componentId;
+                            p == 0 ? alpha : T{1}, bsr.c.first, oim, odm, px_[comm.rank], sug_ox,
+                            vx_.first, py_[comm.rank], sug_oy, okr, vy_.first, EWOp::Copy{}, co);
                         local_bsr_krylov<Nd, Ni, Nx, Ny, T>(
-                            p == 0 ? alpha : T{1}, bsr.c.second[i], oim, odm,
-                            px_[comm.rank][componentId][1], sug_ox, vx_.second[i].it,
-                            py_[comm.rank][componentId][1], sug_oy, okr, vy_.second[i].it);
+                            p == 0 ? alpha : T{1}, bsr.c.second, oim, odm, px_[comm.rank],
+                            sug_ox, vx_.second, py_[comm.rank], sug_oy, okr, vy_.second,
+                            EWOp::Copy{}, co);
                     }
 
-                    // Copy the result to final tensor
-                    Coor<Ny> fromyi = fromy;
-                    if (p > 0) fromyi[power_pos] += p;
-                    if (std::norm(beta) == 0)
-                        copy<Ny, Ny, T>(1.0, py_, {{}}, sug_sizey, sug_sizey, sug_oy, toConst(vy_),
-                                        py, fromyi, dimy, oy, vy, comm, EWOp::Copy{}, co,
-                                        force_local);
-                    else
-                        copy<Ny, Ny, T>(1.0, py_, {{}}, sug_sizey, sug_sizey, sug_oy, toConst(vy_),
-                                        py, fromyi, dimy, oy, vy, comm, EWOp::Add{}, co,
-                                        force_local);
+                    // Copy the result to final tensor
+                    Coor<Ny> fromyi = fromy;
+                    if (p > 0) fromyi[power_pos] += p;
+                    if (std::norm(beta) == 0)
+                        copy<Ny, Ny, T>(1.0, py_, {{}}, sug_sizey, sug_sizey, sug_oy, toConst(vy_),
+                                        py, fromyi, dimy, oy, vy, comm, EWOp::Copy{}, co,
+                                        force_local);
+                    else
+                        copy<Ny, Ny, T>(1.0, py_, {{}}, sug_sizey, sug_sizey, sug_oy, toConst(vy_),
+                                        py, fromyi, dimy, oy, vy, comm, EWOp::Add{}, co,
+                                        force_local);
+
+                    // Copy the result into x for doing the next power
+                    if (p == power - 1) break;
+                    copy<Nx, Nx, T>(T{0}, px_, {{}}, sug_dimx, sug_dimx, sug_ox, toConst(vx_), px_,
+                                    {{}}, sug_dimx, sug_ox, vx_, comm, EWOp::Copy{}, co,
+                                    force_local);
+                    copy<Ny, Nx, T>(T{1}, py_, {{}}, sug_sizey, sug_sizey, sug_oy_trans,
+                                    toConst(vy_), px_, {{}}, sug_dimx, sug_ox, vx_, comm,
+                                    EWOp::Copy{}, co, force_local);
+                }
+            };
+
+            _t.stop();
+
+            // Do the contraction now if we have all the data ready; otherwise, postpone
+            Request r;
+            if (vx_and_req.second || vy_and_req.second)
+                r = bsr_req;
+            else
+                wait(bsr_req);
+
+            if (getDebugLevel() >= 1) {
+                for (const auto &i : bsr.c.first) sync(i.v.it.ctx());
+                for (const auto &i : bsr.c.second) sync(i.v.it.ctx());
+                if (!just_local) barrier(comm);
+            }
+
+            return r;
+        }
+
+        /// Several BSR operators with the same partitioning and nonzero pattern - tensor
+        /// multiplication, y[op] = alpha * A[op] * x + beta * y[op]; the input tensor is brought
+        /// once for all operators
+        /// \param bsrs: BSR tensor components for each operator
+        /// \param oim: dimension labels for the RSB operator image space
+        /// \param odm: dimension labels for the RSB operator domain space
+        /// \param px: partitioning of the right tensor in consecutive ranges
+        /// \param ox: dimension labels for the right operator
+        /// \param fromx: first coordinate to operate from the origin tensor
+        /// \param sizex: number of elements to operate in each dimension
+        /// \param dimx: dimension size for the origin tensor
+        /// \param vx: right input tensor components
+        /// \param py: partitioning of the resulting tensors in consecutive ranges
+        /// \param oy: dimension labels for the output tensors
+        /// \param fromy: first coordinate to copy the result from the destination tensors
+        /// \param sizey: number of elements to copy in each dimension
+        /// \param dimy: dimension size for the destination tensors
+        /// \param vy: output tensor components for each operator
+        /// \param co: coordinate linearization order
+
+        template <std::size_t Nd, std::size_t Ni, std::size_t Nx, std::size_t Ny, typename T,
+                  typename Comm, typename XPU0, typename XPU1>
+        void
+        bsr_multi_krylov(T alpha,
+                         const std::vector<const BSRComponents_tmpl<Nd, Ni, T, XPU0, XPU1> *> &bsrs,
+                         const Order<Ni> &oim, const Order<Nd> &odm, const Proc_ranges<Nx> &px,
+                         const Order<Nx> &ox, const Coor<Nx> &fromx, const Coor<Nx> &sizex,
+                         const Coor<Nx> &dimx, const Components_tmpl<Nx, T, XPU0, XPU1> &vx,
+                         T beta, const Proc_ranges<Ny> &py, const Order<Ny> &oy,
+                         const Coor<Ny> &fromy, const Coor<Ny> &sizey, const Coor<Ny> &dimy,
+                         const std::vector<Components_tmpl<Ny, T, XPU0, XPU1>> &vy, Comm comm,
+                         CoorOrder co) {
+
+            if (bsrs.size() != vy.size())
+                throw std::runtime_error("bsr_multi_krylov: the number of operators and output "
+                                         "tensors should be the same");
+            if (bsrs.size() == 0) return;
+            const BSRComponents_tmpl<Nd, Ni, T, XPU0, XPU1> &bsr = *bsrs[0];
+
+            // Check that common arguments have the same value in all processes
+
+            if (getDebugLevel() >= 1) {
+                struct tag_type {}; // For hashing template arguments
+                check_consistency(std::make_tuple(std::string("bsr_multi_krylov"), alpha, oim, odm,
+                                                  px, ox, fromx, sizex, dimx, beta, py, oy, fromy,
+                                                  sizey, dimy, bsrs.size(), comm.nprocs, co,
+                                                  typeid(tag_type).hash_code()),
+                                  comm);
+            }
+
+            tracker<Cpu> _t("distributed fused BSR matvec", Cpu{0});
+
+            // Check that all operators have the same coordinate ordering and partitioning
+            for (const auto *op : bsrs) {
+                if (op->co != co)
+                    throw std::runtime_error("Unsupported to use a different coordinate ordering "
+                                             "that one used to create the matrix");
+                bool same = op->pd == bsr.pd && op->pi == bsr.pi && op->dimd == bsr.dimd &&
+                            op->dimi == bsr.dimi && op->blockd == bsr.blockd &&
+                            op->blocki == bsr.blocki && op->krond == bsr.krond &&
+                            op->kroni == bsr.kroni && op->c.first.size() == bsr.c.first.size() &&
+                            op->c.second.size() == bsr.c.second.size();
+                for (std::size_t i = 0; same && i < bsr.c.first.size(); ++i)
+                    same = op->c.first[i].v.componentId == bsr.c.first[i].v.componentId;
+                for (std::size_t i = 0; same && i < bsr.c.second.size(); ++i)
+                    same = op->c.second[i].v.componentId == bsr.c.second[i].v.componentId;
+                if (!same)
+                    throw std::runtime_error(
+                        "bsr_multi_krylov: all operators should have the same partitioning");
+            }
+
+            // Generate the partitioning and the storage for the dense matrix input and output tensor
+            Order<Nx> sug_ox = ox;
+            Order<Ny> sug_oy = oy;
+            Order<Ny> sug_oy_trans;
+            if (bsr.c.first.size() > 0) {
+                bool transSp;
+                MatrixLayout lx, ly;
+                std::size_t volC;
+                bool is_kron =
+                    (volume(bsr.c.first[0].v.krond) > 1 || volume(bsr.c.first[0].v.kroni) > 1 ||
+                     bsr.c.first[0].v.kron_it.size() > 0);
+                local_bsr_krylov_check(bsr.dimi, bsr.dimd, oim, odm, bsr.blocki, bsr.blockd,
+                                       bsr.kroni, bsr.krond, is_kron, sizex, ox, sizey, oy, 0,
+                                       bsr.c.first[0].allowLayout, bsr.c.first[0].preferredLayout,
+                                       co, transSp, lx, ly, volC, sug_ox, sug_oy, sug_oy_trans);
+            } else if (bsr.c.second.size() > 0) {
+                bool transSp;
+                MatrixLayout lx, ly;
+                std::size_t volC;
+                bool is_kron =
+                    (volume(bsr.c.second[0].v.krond) > 1 || volume(bsr.c.second[0].v.kroni) > 1 ||
+                     bsr.c.second[0].v.kron_it.size() > 0);
+                local_bsr_krylov_check(bsr.dimi, bsr.dimd, oim, odm, bsr.blocki, bsr.blockd,
+                                       bsr.kroni, bsr.krond, is_kron, sizex, ox, sizey, oy, 0,
+                                       bsr.c.second[0].allowLayout, bsr.c.second[0].preferredLayout,
+                                       co, transSp, lx, ly, volC, sug_ox, sug_oy, sug_oy_trans);
+            }
+            Coor<Nx> sug_dimx = reorder_coor(dimx, find_permutation(ox, sug_ox));
+            Coor<Ny> sug_sizey = reorder_coor(sizey, find_permutation(oy, sug_oy));
+
+            auto pxy_ = get_output_partition(bsr.pd, odm, bsr.pi, oim, px, ox, sug_ox, sizex, oy,
+                                             sug_oy, 0, comm);
 
-                    // Copy the result into x for doing the next power
-                    if (p == power - 1) break;
-                    copy<Nx, Nx, T>(T{0}, px_, {{}}, sug_dimx, sug_dimx, sug_ox, toConst(vx_), px_,
-                                    {{}}, sug_dimx, sug_ox, vx_, comm, EWOp::Copy{}, co,
-                                    force_local);
-                    copy<Ny, Nx, T>(T{1}, py_, {{}}, sug_sizey, sug_sizey, sug_oy_trans,
-                                    toConst(vy_), px_, {{}}, sug_dimx, sug_ox, vx_, comm,
-                                    EWOp::Copy{}, co, force_local);
+            // Copy the input dense tensor to a compatible layout to the sparse tensors only once
+            Proc_ranges<Nx> px_ = pxy_.first;
+            Proc_ranges<Ny> py_ = pxy_.second;
+            Components_tmpl<Nx, T, XPU0, XPU1> vx_ =
+                reorder_tensor(px, ox, fromx, sizex, dimx, vx, px_, sug_dimx, sug_ox,
+                               get_mock_components(bsr), comm, co, false /* don't force copy */,
+                               doCacheAlloc);
+
+            // Do the contraction of each local component with all operators
+            std::vector<Components_tmpl<Ny, T, XPU0, XPU1>> vy_;
+            for (std::size_t op = 0; op < bsrs.size(); ++op)
+                vy_.push_back(like_this_components(py_, vx_, comm, doCacheAlloc));
+            for (std::size_t i = 0; i < bsr.c.first.size(); ++i) {
+                const unsigned int componentId = bsr.c.first[i].v.componentId;
+                std::vector<const BSR<Nd, Ni, T, XPU0> *> ops;
+                std::vector<vector<T, XPU0>> vyi;
+                for (std::size_t op = 0; op < bsrs.size(); ++op) {
+                    ops.push_back(&bsrs[op]->c.first[i]);
+                    vyi.push_back(vy_[op].first[i].it);
                 }
-            };
-
-            _t.stop();
+                local_bsr_multi_krylov<Nd, Ni, Nx, Ny, T>(
+                    alpha, ops, oim, odm, px_[comm.rank][componentId][1], sug_ox,
+                    vx_.first[i].it, py_[comm.rank][componentId][1], sug_oy, vyi);
+            }
+            for (std::size_t i = 0; i < bsr.c.second.size(); ++i) {
+                const unsigned int componentId = bsr.c.second[i].v.componentId;
+                std::vector<const BSR<Nd, Ni, T, XPU1> *> ops;
+                std::vector<vector<T, XPU1>> vyi;
+                for (std::size_t op = 0; op < bsrs.size(); ++op) {
+                    ops.push_back(&bsrs[op]->c.second[i]);
+                    vyi.push_back(vy_[op].second[i].it);
+                }
+                local_bsr_multi_krylov<Nd, Ni, Nx, Ny, T>(
+                    alpha, ops, oim, odm, px_[comm.rank][componentId][1], sug_ox,
+                    vx_.second[i].it, py_[comm.rank][componentId][1], sug_oy, vyi);
+            }
 
-            // Do the contraction now if we have all the data ready; otherwise, postpone
-            Request r;
-            if (vx_and_req.second)
-                r = bsr_req;
-            else
-                wait(bsr_req);
+            // Copy the results to the final tensors, scaling them first if beta isn't 0 or 1
+            for (std::size_t op = 0; op < bsrs.size(); ++op) {
+                if (std::norm(beta) == 0) {
+                    copy<Ny, Ny, T>(1.0, py_, {{}}, sug_sizey, sug_sizey, sug_oy, toConst(vy_[op]),
+                                    py, fromy, dimy, oy, vy[op], comm, EWOp::Copy{}, co);
+                } else {
+                    if (beta != T{1})
+                        copy<Ny, Ny, T>(beta, py, {{}}, dimy, dimy, oy, toConst(vy[op]), py, {{}},
+                                        dimy, oy, vy[op], comm, EWOp::Copy{}, co);
+                    copy<Ny, Ny, T>(1.0, py_, {{}}, sug_sizey, sug_sizey, sug_oy, toConst(vy_[op]),
+                                    py, fromy, dimy, oy, vy[op], comm, EWOp::Add{}, co);
+                }
+            }
 
             if (getDebugLevel() >= 1) {
-                for (const auto &i : bsr.c.first) sync(i.v.it.ctx());
-                for (const auto &i : bsr.c.second) sync(i.v.it.ctx());
-                if (!just_local) barrier(comm);
+                for (const auto *op : bsrs) {
+                    for (const auto &i : op->c.first) sync(i.v.it.ctx());
+                    for (const auto &i : op->c.second) sync(i.v.it.ctx());
+                }
+                barrier(comm);
             }
+        }
 
-            return r;
+        /// Schur complement of an even-odd split operator - tensor multiplication,
+        /// y = alpha * (M_ee - M_eo M_oo^{-1} M_oe) * x + beta * y
+        /// \param schur: Schur complement operators, see `get_bsr_schur`
+        ///
+        /// The input tensor is brought once for M_ee and M_oo^{-1} M_oe. The input and output
+        /// tensors are on the even half lattice.
+
+        template <std::size_t N, std::size_t Nx, std::size_t Ny, typename T, typename Comm,
+                  typename XPU0, typename XPU1>
+        void bsr_schur_krylov(T alpha, const BSRSchur_tmpl<N, T, XPU0, XPU1> &schur,
+                              const Order<N> &oim, const Order<N> &odm, const Proc_ranges<Nx> &px,
+                              const Order<Nx> &ox, const Coor<Nx> &fromx, const Coor<Nx> &sizex,
+                              const Coor<Nx> &dimx, const Components_tmpl<Nx, T, XPU0, XPU1> &vx,
+                              T beta, const Proc_ranges<Ny> &py, const Order<Ny> &oy,
+                              const Coor<Ny> &fromy, const Coor<Ny> &sizey, const Coor<Ny> &dimy,
+                              const Components_tmpl<Ny, T, XPU0, XPU1> &vy, Comm comm,
+                              CoorOrder co) {
+
+            tracker<Cpu> _t("distributed BSR Schur matvec", Cpu{0});
+
+            // Compute y = alpha * M_ee * x + beta * y and t = alpha * M_oo^{-1} * M_oe * x
+            Components_tmpl<Ny, T, XPU0, XPU1> t = like_this_components(
+                py, vy, comm, doCacheAlloc, std::norm(beta) == 0 ? dontZeroInit : doZeroInit);
+            std::vector<const BSRComponents_tmpl<N, N, T, XPU0, XPU1> *> ops{&schur.ee,
+                                                                             &schur.oo_inv_oe};
+            std::vector<Components_tmpl<Ny, T, XPU0, XPU1>> vys{vy, t};
+            bsr_multi_krylov<N, N, Nx, Ny, T>(alpha, ops, oim, odm, px, ox, fromx, sizex, dimx, vx,
+                                              beta, py, oy, fromy, sizey, dimy, vys, comm, co);
+
+            // Compute y -= M_eo * t, taking the image labels of t as domain labels
+            Order<Ny> ot = oy;
+            for (char &c : ot) {
+                auto it = std::find(oim.begin(), oim.end(), c);
+                if (it != oim.end()) c = odm[it - oim.begin()];
+            }
+            wait(bsr_krylov<N, N, Ny, Ny, T>(T{-1}, schur.eo, oim, odm, py, ot, fromy, sizey, dimy,
+                                             t, T{1}, py, oy, fromy, sizey, dimy, 0, vy, comm,
+                                             co));
         }
     }
 
@@ -2280,6 +5475,11 @@ namespace superbblas {
     /// \param ctx: context
     /// \param co: coordinate linearization order; either `FastToSlow` for natural order or `SlowToFast` for lexicographic order
     /// \param bsrh (out) handle to BSR nonzero pattern
+    /// \param session: concurrent calls should have different session
+    /// \param lowPrecisionValues: whether to keep a copy of the nonzero values in lower precision
+    ///        (float for double) and use it in the contractions; only supported by the builtin
+    ///        CPU implementation on non-Hermitian operators without Kronecker blocks, and ignored
+    ///        otherwise. Both the microkernels and BLAS use the values in lower precision
     ///
     /// NOTE: keep allocated the space pointed out by ii, jj, and v until calling `destroy_bsr`.
 
@@ -2288,14 +5488,57 @@ namespace superbblas {
                     const PartitionItem<Nd> *pdm, const Coor<Nd> &dimd, int ncomponents,
                     const Coor<Ni> &blockim, const Coor<Nd> &blockdm, bool blockImFast,
                     IndexType **ii, Coor<Nd> **jj, const T **v, const Context *ctx,
-                    MPI_Comm mpicomm, CoorOrder co, BSR_handle **bsrh, Session session = 0) {
+                    MPI_Comm mpicomm, CoorOrder co, BSR_handle **bsrh, Session session = 0,
+                    bool lowPrecisionValues = false) {
 
         detail::MpiComm comm = detail::get_comm(mpicomm);
 
         detail::BSRComponents<Nd, Ni, T> *r =
             new detail::BSRComponents<Nd, Ni, T>{detail::get_bsr_components<Nd, Ni, T>(
                 (T **)v, ii, jj, nullptr, ctx, ncomponents, pim, dimi, pdm, dimd, blockdm, blockim,
-                detail::ones<Nd>(), detail::ones<Ni>(), blockImFast, comm, co, session)};
+                detail::ones<Nd>(), detail::ones<Ni>(), blockImFast, comm, co, session,
+                lowPrecisionValues)};
+        *bsrh = r;
+    }
+
+    /// Create a Hermitian BSR sparse operator given only the diagonal and upper blocks
+    /// \param pim: partitioning of the RSB operator image in consecutive ranges
+    /// \param pdm: pseudo-partitioning of the RSB operator domain in consecutive ranges
+    /// \param ncomponents: number of consecutive components in each MPI rank
+    /// \param blockim: image dimensions of the block
+    /// \param blockdm: domain dimensions of the block
+    /// \param blockImFast: whether the blocks are stored with the image indices the fastest
+    /// \param ii: ii[i] is the index of the first nonzero block on the i-th blocked image operator element
+    /// \param jj: domain coordinates of the nonzero blocks of RSB operator
+    /// \param v: nonzero values
+    /// \param ctx: context
+    /// \param co: coordinate linearization order; either `FastToSlow` for natural order or `SlowToFast` for lexicographic order
+    /// \param bsrh (out) handle to BSR nonzero pattern
+    /// \param session: concurrent calls should have different session
+    ///
+    /// The operator is as given by `create_bsr` except that each component only has the blocks
+    /// on and above the diagonal whose domain coordinate is on the image range of the component;
+    /// the blocks under the diagonal are the conjugate transpose of the given ones. The blocks
+    /// coupling with coordinates out of the image range of the component are given in full.
+    /// Only supported by the builtin CPU implementation and with square blocks.
+    ///
+    /// NOTE: keep allocated the space pointed out by ii, jj, and v until calling `destroy_bsr`.
+
+    template <std::size_t N, typename T>
+    void create_hermitian_bsr(const PartitionItem<N> *pim, const Coor<N> &dimi,
+                              const PartitionItem<N> *pdm, const Coor<N> &dimd, int ncomponents,
+                              const Coor<N> &blockim, const Coor<N> &blockdm, bool blockImFast,
+                              IndexType **ii, Coor<N> **jj, const T **v, const Context *ctx,
+                              MPI_Comm mpicomm, CoorOrder co, BSR_handle **bsrh,
+                              Session session = 0) {
+
+        detail::MpiComm comm = detail::get_comm(mpicomm);
+
+        detail::BSRComponents<N, N, T> *r =
+            new detail::BSRComponents<N, N, T>{detail::get_bsr_components<N, N, T>(
+                (T **)v, ii, jj, nullptr, ctx, ncomponents, pim, dimi, pdm, dimd, blockdm, blockim,
+                detail::ones<N>(), detail::ones<N>(), blockImFast, comm, co, session,
+                false /* low precision */, true /* hermitian */)};
         *bsrh = r;
     }
 
@@ -2382,6 +5625,150 @@ namespace superbblas {
             wait(r);
     }
 
+    /// Several BSR sparse operators with the same partitioning and nonzero pattern - tensor
+    /// multiplication, y[op] = alpha * A[op] * x + beta * y[op]; the input tensor is brought
+    /// once for all operators, and the builtin CPU implementation contracts each block row of
+    /// all operators before the next one
+    /// \param bsrhs: BSR handle for each operator
+    /// \param nops: number of operators
+    /// \param oim: dimension labels for the RSB operator image space
+    /// \param odm: dimension labels for the RSB operator domain space
+    /// \param px: partitioning of the right tensor in consecutive ranges
+    /// \param ox: dimension labels for the right operator
+    /// \param fromx: first coordinate to operate from the origin tensor
+    /// \param sizex: number of elements to operate in each dimension
+    /// \param dimx: dimension size for the origin tensor
+    /// \param vx: data for the second operator
+    /// \param py: partitioning of the resulting tensors in consecutive ranges
+    /// \param oy: dimension labels for the output tensors
+    /// \param fromy: first coordinate to copy the result from the destination tensors
+    /// \param sizey: number of elements to copy in each dimension
+    /// \param dimy: dimension size for the destination tensors
+    /// \param vy: data for the output tensors; vy[op * ncomponents + i] is the i-th component
+    ///        of the output tensor for the op-th operator
+    /// \param ctx: context for each data pointer in vx and vy
+
+    template <std::size_t Nd, std::size_t Ni, std::size_t Nx, std::size_t Ny, typename T>
+    void bsr_multi_krylov(T alpha, BSR_handle *const *bsrhs, int nops, const char *oim,
+                          const char *odm, const PartitionItem<Nx> *px, int ncomponents,
+                          const char *ox, const Coor<Nx> &fromx, const Coor<Nx> &sizex,
+                          const Coor<Nx> &dimx, const T **vx, T beta, const PartitionItem<Ny> *py,
+                          const char *oy, const Coor<Ny> &fromy, const Coor<Ny> &sizey,
+                          const Coor<Ny> &dimy, T **vy, const Context *ctx,
+                          MPI_Comm mpicomm, CoorOrder co, Session session = 0) {
+
+        Order<Ni> oim_ = detail::toArray<Ni>(oim, "oim");
+        Order<Nd> odm_ = detail::toArray<Nd>(odm, "odm");
+        Order<Nx> ox_ = detail::toArray<Nx>(ox, "ox");
+        Order<Ny> oy_ = detail::toArray<Ny>(oy, "oy");
+
+        detail::MpiComm comm = detail::get_comm(mpicomm);
+
+        std::vector<const detail::BSRComponents<Nd, Ni, T> *> bsrs;
+        std::vector<detail::Components<Ny, T>> vys;
+        for (int op = 0; op < nops; ++op) {
+            bsrs.push_back(detail::get_bsr_components_from_handle<Nd, Ni, T>(
+                bsrhs[op], ctx, ncomponents, comm, co));
+            vys.push_back(detail::get_components<Ny>(vy + op * ncomponents, nullptr, ctx,
+                                                     ncomponents, py, comm, session));
+        }
+
+        detail::bsr_multi_krylov<Nd, Ni, Nx, Ny, T>(
+            alpha, bsrs, oim_, odm_, detail::get_from_size(px, ncomponents * comm.nprocs, comm),
+            ox_, fromx, sizex, dimx,
+            detail::get_components<Nx>((T **)vx, nullptr, ctx, ncomponents, px, comm, session),
+            beta, detail::get_from_size(py, ncomponents * comm.nprocs, comm), oy_, fromy, sizey,
+            dimy, vys, comm, co);
+    }
+
+    /// Create the even-even, even-odd, odd-even, and odd-odd sub-operators of a BSR operator,
+    /// and optionally the operator for applying their Schur complement with `bsr_schur_krylov`
+    /// \param bsrh: BSR handle of a square operator
+    /// \param halved_dim: dimension whose size is halved on the sub-operators
+    /// \param ncomponents: number of components in the BSR handle
+    /// \param ctx: context for each data pointer in the BSR handle
+    /// \param comm: MPI communicator
+    /// \param co: coordinate linearization order; either `FastToSlow` for natural order or `SlowToFast` for lexicographic order
+    /// \param eo_bsrh: (out) handles of the sub-operators M_ee, M_eo, M_oe, and M_oo
+    /// \param schur_bsrh: (out) if not null, handle for M_ee - M_eo M_oo^{-1} M_oe; M_oo should
+    ///        be block diagonal with square blocks
+    ///
+    /// The parity of an element is the sum of its coordinates modulo two. The sub-operators
+    /// act on half lattices with the same dimensions as the operator but `halved_dim`, which is
+    /// halved, and the element with coordinates `c` is at `c[halved_dim]/2` on the half lattice
+    /// of its parity. The partitions are the ones of the operator with the ranges halved on
+    /// `halved_dim`, and the image ranges should start and end on even coordinates on it. The
+    /// blocks should cover whole dimensions, and Kronecker operators aren't supported.
+    ///
+    /// NOTE: the new handles keep their own copy of the nonzeros; destroy them with `destroy_bsr`.
+
+    template <std::size_t Nd, std::size_t Ni, typename T>
+    void create_bsr_even_odd(BSR_handle *bsrh, unsigned int halved_dim, int ncomponents,
+                             const Context *ctx, MPI_Comm mpicomm, CoorOrder co, BSR_handle **eo_bsrh,
+                             BSR_handle **schur_bsrh = nullptr) {
+
+        static_assert(Nd == Ni, "create_bsr_even_odd: the operator should be square");
+        detail::MpiComm comm = detail::get_comm(mpicomm);
+
+        detail::BSRComponents<Nd, Ni, T> *bsr =
+            detail::get_bsr_components_from_handle<Nd, Ni, T>(bsrh, ctx, ncomponents, comm, co);
+
+        auto eo = detail::get_bsr_even_odd(*bsr, halved_dim, comm);
+        if (schur_bsrh)
+            *schur_bsrh = new detail::BSRSchur<Nd, T>{detail::get_bsr_schur(eo, comm)};
+        for (int p = 0; p < 4; ++p) eo_bsrh[p] = new detail::BSRComponents<Nd, Ni, T>{eo[p]};
+    }
+
+    /// Schur complement of an even-odd split BSR operator - tensor multiplication,
+    /// y = alpha * (M_ee - M_eo M_oo^{-1} M_oe) * x + beta * y
+    /// \param schur_bsrh: handle returned by `create_bsr_even_odd`
+    /// \param oim: dimension labels for the RSB operator image space
+    /// \param odm: dimension labels for the RSB operator domain space
+    /// \param px: partitioning of the right tensor in consecutive ranges
+    /// \param ox: dimension labels for the right operator
+    /// \param fromx: first coordinate to operate from the origin tensor
+    /// \param sizex: number of elements to operate in each dimension
+    /// \param dimx: dimension size for the origin tensor
+    /// \param vx: data for the second operator
+    /// \param py: partitioning of the resulting tensor in consecutive ranges
+    /// \param oy: dimension labels for the output tensor
+    /// \param fromy: first coordinate to copy the result from the destination tensor
+    /// \param sizey: number of elements to copy in each dimension
+    /// \param dimy: dimension size for the destination tensor
+    /// \param vy: data for the output tensor
+    /// \param ctx: context for each data pointer in vx and vy
+    ///
+    /// The input and output tensors are on the even half lattice, see `create_bsr_even_odd`.
+
+    template <std::size_t Nd, std::size_t Ni, std::size_t Nx, std::size_t Ny, typename T>
+    void bsr_schur_krylov(T alpha, BSR_handle *schur_bsrh, const char *oim, const char *odm,
+                          const PartitionItem<Nx> *px, int ncomponents, const char *ox,
+                          const Coor<Nx> &fromx, const Coor<Nx> &sizex, const Coor<Nx> &dimx,
+                          const T **vx, T beta, const PartitionItem<Ny> *py, const char *oy,
+                          const Coor<Ny> &fromy, const Coor<Ny> &sizey, const Coor<Ny> &dimy,
+                          T **vy, const Context *ctx, MPI_Comm mpicomm, CoorOrder co,
+                          Session session = 0) {
+
+        static_assert(Nd == Ni, "bsr_schur_krylov: the operator should be square");
+        Order<Ni> oim_ = detail::toArray<Ni>(oim, "oim");
+        Order<Nd> odm_ = detail::toArray<Nd>(odm, "odm");
+        Order<Nx> ox_ = detail::toArray<Nx>(ox, "ox");
+        Order<Ny> oy_ = detail::toArray<Ny>(oy, "oy");
+
+        detail::MpiComm comm = detail::get_comm(mpicomm);
+
+        detail::BSRSchur<Nd, T> *schur =
+            detail::get_bsr_schur_from_handle<Nd, T>(schur_bsrh, ctx, ncomponents, comm, co);
+
+        detail::bsr_schur_krylov<Nd, Nx, Ny, T>(
+            alpha, *schur, oim_, odm_, detail::get_from_size(px, ncomponents * comm.nprocs, comm),
+            ox_, fromx, sizex, dimx,
+            detail::get_components<Nx>((T **)vx, nullptr, ctx, ncomponents, px, comm, session),
+            beta, detail::get_from_size(py, ncomponents * comm.nprocs, comm), oy_, fromy, sizey,
+            dimy, detail::get_components<Ny>(vy, nullptr, ctx, ncomponents, py, comm, session),
+            comm, co);
+    }
+
     /// Return the preferred layout for the input and output tensor in `bsr_krylov`
     /// \param bsrh: BSR handle
     /// \param ncomponents: number of components in the BSR handle
@@ -2434,6 +5821,11 @@ namespace superbblas {
     /// \param ctx: context
     /// \param co: coordinate linearization order; either `FastToSlow` for natural order or `SlowToFast` for lexicographic order
     /// \param bsrh (out) handle to BSR nonzero pattern
+    /// \param session: concurrent calls should have different session
+    /// \param lowPrecisionValues: whether to keep a copy of the nonzero values in lower precision
+    ///        (float for double) and use it in the contractions; only supported by the builtin
+    ///        CPU implementation on non-Hermitian operators without Kronecker blocks, and ignored
+    ///        otherwise. Both the microkernels and BLAS use the values in lower precision
     ///
     /// NOTE: keep allocated the space pointed out by ii, jj, and v until calling `destroy_bsr`.
 
@@ -2442,14 +5834,55 @@ namespace superbblas {
                     const PartitionItem<Nd> *pdm, const Coor<Nd> &dimd, int ncomponents,
                     const Coor<Ni> &blockim, const Coor<Nd> &blockdm, bool blockImFast,
                     IndexType **ii, Coor<Nd> **jj, const T **v, const Context *ctx, CoorOrder co,
-                    BSR_handle **bsrh, Session session = 0) {
+                    BSR_handle **bsrh, Session session = 0, bool lowPrecisionValues = false) {
 
         detail::SelfComm comm = detail::get_comm();
 
         detail::BSRComponents<Nd, Ni, T> *r =
             new detail::BSRComponents<Nd, Ni, T>{detail::get_bsr_components<Nd, Ni, T>(
                 (T **)v, ii, jj, nullptr, ctx, ncomponents, pim, dimi, pdm, dimd, blockdm, blockim,
-                detail::ones<Nd>(), detail::ones<Ni>(), blockImFast, comm, co, session)};
+                detail::ones<Nd>(), detail::ones<Ni>(), blockImFast, comm, co, session,
+                lowPrecisionValues)};
+        *bsrh = r;
+    }
+
+    /// Create a Hermitian BSR sparse operator given only the diagonal and upper blocks
+    /// \param pim: partitioning of the RSB operator image in consecutive ranges
+    /// \param pdm: pseudo-partitioning of the RSB operator domain in consecutive ranges
+    /// \param ncomponents: number of consecutive components in each MPI rank
+    /// \param blockim: image dimensions of the block
+    /// \param blockdm: domain dimensions of the block
+    /// \param blockImFast: whether the blocks are stored with the image indices the fastest
+    /// \param ii: ii[i] is the index of the first nonzero block on the i-th blocked image operator element
+    /// \param jj: domain coordinates of the nonzero blocks of RSB operator
+    /// \param v: nonzero values
+    /// \param ctx: context
+    /// \param co: coordinate linearization order; either `FastToSlow` for natural order or `SlowToFast` for lexicographic order
+    /// \param bsrh (out) handle to BSR nonzero pattern
+    /// \param session: concurrent calls should have different session
+    ///
+    /// The operator is as given by `create_bsr` except that each component only has the blocks
+    /// on and above the diagonal whose domain coordinate is on the image range of the component;
+    /// the blocks under the diagonal are the conjugate transpose of the given ones. The blocks
+    /// coupling with coordinates out of the image range of the component are given in full.
+    /// Only supported by the builtin CPU implementation and with square blocks.
+    ///
+    /// NOTE: keep allocated the space pointed out by ii, jj, and v until calling `destroy_bsr`.
+
+    template <std::size_t N, typename T>
+    void create_hermitian_bsr(const PartitionItem<N> *pim, const Coor<N> &dimi,
+                              const PartitionItem<N> *pdm, const Coor<N> &dimd, int ncomponents,
+                              const Coor<N> &blockim, const Coor<N> &blockdm, bool blockImFast,
+                              IndexType **ii, Coor<N> **jj, const T **v, const Context *ctx,
+                              CoorOrder co, BSR_handle **bsrh, Session session = 0) {
+
+        detail::SelfComm comm = detail::get_comm();
+
+        detail::BSRComponents<N, N, T> *r =
+            new detail::BSRComponents<N, N, T>{detail::get_bsr_components<N, N, T>(
+                (T **)v, ii, jj, nullptr, ctx, ncomponents, pim, dimi, pdm, dimd, blockdm, blockim,
+                detail::ones<N>(), detail::ones<N>(), blockImFast, comm, co, session,
+                false /* low precision */, true /* hermitian */)};
         *bsrh = r;
     }
 
@@ -2542,6 +5975,149 @@ namespace superbblas {
         if (request) *request = Request{};
     }
 
+    /// Several BSR sparse operators with the same partitioning and nonzero pattern - tensor
+    /// multiplication, y[op] = alpha * A[op] * x + beta * y[op]; the input tensor is brought
+    /// once for all operators, and the builtin CPU implementation contracts each block row of
+    /// all operators before the next one
+    /// \param bsrhs: BSR handle for each operator
+    /// \param nops: number of operators
+    /// \param oim: dimension labels for the RSB operator image space
+    /// \param odm: dimension labels for the RSB operator domain space
+    /// \param px: partitioning of the right tensor in consecutive ranges
+    /// \param ox: dimension labels for the right operator
+    /// \param fromx: first coordinate to operate from the origin tensor
+    /// \param sizex: number of elements to operate in each dimension
+    /// \param dimx: dimension size for the origin tensor
+    /// \param vx: data for the second operator
+    /// \param py: partitioning of the resulting tensors in consecutive ranges
+    /// \param oy: dimension labels for the output tensors
+    /// \param fromy: first coordinate to copy the result from the destination tensors
+    /// \param sizey: number of elements to copy in each dimension
+    /// \param dimy: dimension size for the destination tensors
+    /// \param vy: data for the output tensors; vy[op * ncomponents + i] is the i-th component
+    ///        of the output tensor for the op-th operator
+    /// \param ctx: context for each data pointer in vx and vy
+
+    template <std::size_t Nd, std::size_t Ni, std::size_t Nx, std::size_t Ny, typename T>
+    void bsr_multi_krylov(T alpha, BSR_handle *const *bsrhs, int nops, const char *oim,
+                          const char *odm, const PartitionItem<Nx> *px, int ncomponents,
+                          const char *ox, const Coor<Nx> &fromx, const Coor<Nx> &sizex,
+                          const Coor<Nx> &dimx, const T **vx, T beta, const PartitionItem<Ny> *py,
+                          const char *oy, const Coor<Ny> &fromy, const Coor<Ny> &sizey,
+                          const Coor<Ny> &dimy, T **vy, const Context *ctx, CoorOrder co,
+                          Session session = 0) {
+
+        Order<Ni> oim_ = detail::toArray<Ni>(oim, "oim");
+        Order<Nd> odm_ = detail::toArray<Nd>(odm, "odm");
+        Order<Nx> ox_ = detail::toArray<Nx>(ox, "ox");
+        Order<Ny> oy_ = detail::toArray<Ny>(oy, "oy");
+
+        detail::SelfComm comm = detail::get_comm();
+
+        std::vector<const detail::BSRComponents<Nd, Ni, T> *> bsrs;
+        std::vector<detail::Components<Ny, T>> vys;
+        for (int op = 0; op < nops; ++op) {
+            bsrs.push_back(detail::get_bsr_components_from_handle<Nd, Ni, T>(
+                bsrhs[op], ctx, ncomponents, comm, co));
+            vys.push_back(detail::get_components<Ny>(vy + op * ncomponents, nullptr, ctx,
+                                                     ncomponents, py, comm, session));
+        }
+
+        detail::bsr_multi_krylov<Nd, Ni, Nx, Ny, T>(
+            alpha, bsrs, oim_, odm_, detail::get_from_size(px, ncomponents * comm.nprocs, comm),
+            ox_, fromx, sizex, dimx,
+            detail::get_components<Nx>((T **)vx, nullptr, ctx, ncomponents, px, comm, session),
+            beta, detail::get_from_size(py, ncomponents * comm.nprocs, comm), oy_, fromy, sizey,
+            dimy, vys, comm, co);
+    }
+
+    /// Create the even-even, even-odd, odd-even, and odd-odd sub-operators of a BSR operator,
+    /// and optionally the operator for applying their Schur complement with `bsr_schur_krylov`
+    /// \param bsrh: BSR handle of a square operator
+    /// \param halved_dim: dimension whose size is halved on the sub-operators
+    /// \param ncomponents: number of components in the BSR handle
+    /// \param ctx: context for each data pointer in the BSR handle
+    /// \param co: coordinate linearization order; either `FastToSlow` for natural order or `SlowToFast` for lexicographic order
+    /// \param eo_bsrh: (out) handles of the sub-operators M_ee, M_eo, M_oe, and M_oo
+    /// \param schur_bsrh: (out) if not null, handle for M_ee - M_eo M_oo^{-1} M_oe; M_oo should
+    ///        be block diagonal with square blocks
+    ///
+    /// The parity of an element is the sum of its coordinates modulo two. The sub-operators
+    /// act on half lattices with the same dimensions as the operator but `halved_dim`, which is
+    /// halved, and the element with coordinates `c` is at `c[halved_dim]/2` on the half lattice
+    /// of its parity. The partitions are the ones of the operator with the ranges halved on
+    /// `halved_dim`, and the image ranges should start and end on even coordinates on it. The
+    /// blocks should cover whole dimensions, and Kronecker operators aren't supported.
+    ///
+    /// NOTE: the new handles keep their own copy of the nonzeros; destroy them with `destroy_bsr`.
+
+    template <std::size_t Nd, std::size_t Ni, typename T>
+    void create_bsr_even_odd(BSR_handle *bsrh, unsigned int halved_dim, int ncomponents,
+                             const Context *ctx, CoorOrder co, BSR_handle **eo_bsrh,
+                             BSR_handle **schur_bsrh = nullptr) {
+
+        static_assert(Nd == Ni, "create_bsr_even_odd: the operator should be square");
+        detail::SelfComm comm = detail::get_comm();
+
+        detail::BSRComponents<Nd, Ni, T> *bsr =
+            detail::get_bsr_components_from_handle<Nd, Ni, T>(bsrh, ctx, ncomponents, comm, co);
+
+        auto eo = detail::get_bsr_even_odd(*bsr, halved_dim, comm);
+        if (schur_bsrh)
+            *schur_bsrh = new detail::BSRSchur<Nd, T>{detail::get_bsr_schur(eo, comm)};
+        for (int p = 0; p < 4; ++p) eo_bsrh[p] = new detail::BSRComponents<Nd, Ni, T>{eo[p]};
+    }
+
+    /// Schur complement of an even-odd split BSR operator - tensor multiplication,
+    /// y = alpha * (M_ee - M_eo M_oo^{-1} M_oe) * x + beta * y
+    /// \param schur_bsrh: handle returned by `create_bsr_even_odd`
+    /// \param oim: dimension labels for the RSB operator image space
+    /// \param odm: dimension labels for the RSB operator domain space
+    /// \param px: partitioning of the right tensor in consecutive ranges
+    /// \param ox: dimension labels for the right operator
+    /// \param fromx: first coordinate to operate from the origin tensor
+    /// \param sizex: number of elements to operate in each dimension
+    /// \param dimx: dimension size for the origin tensor
+    /// \param vx: data for the second operator
+    /// \param py: partitioning of the resulting tensor in consecutive ranges
+    /// \param oy: dimension labels for the output tensor
+    /// \param fromy: first coordinate to copy the result from the destination tensor
+    /// \param sizey: number of elements to copy in each dimension
+    /// \param dimy: dimension size for the destination tensor
+    /// \param vy: data for the output tensor
+    /// \param ctx: context for each data pointer in vx and vy
+    ///
+    /// The input and output tensors are on the even half lattice, see `create_bsr_even_odd`.
+
+    template <std::size_t Nd, std::size_t Ni, std::size_t Nx, std::size_t Ny, typename T>
+    void bsr_schur_krylov(T alpha, BSR_handle *schur_bsrh, const char *oim, const char *odm,
+                          const PartitionItem<Nx> *px, int ncomponents, const char *ox,
+                          const Coor<Nx> &fromx, const Coor<Nx> &sizex, const Coor<Nx> &dimx,
+                          const T **vx, T beta, const PartitionItem<Ny> *py, const char *oy,
+                          const Coor<Ny> &fromy, const Coor<Ny> &sizey, const Coor<Ny> &dimy,
+                          T **vy, const Context *ctx, CoorOrder co,
+                          Session session = 0) {
+
+        static_assert(Nd == Ni, "bsr_schur_krylov: the operator should be square");
+        Order<Ni> oim_ = detail::toArray<Ni>(oim, "oim");
+        Order<Nd> odm_ = detail::toArray<Nd>(odm, "odm");
+        Order<Nx> ox_ = detail::toArray<Nx>(ox, "ox");
+        Order<Ny> oy_ = detail::toArray<Ny>(oy, "oy");
+
+        detail::SelfComm comm = detail::get_comm();
+
+        detail::BSRSchur<Nd, T> *schur =
+            detail::get_bsr_schur_from_handle<Nd, T>(schur_bsrh, ctx, ncomponents, comm, co);
+
+        detail::bsr_schur_krylov<Nd, Nx, Ny, T>(
+            alpha, *schur, oim_, odm_, detail::get_from_size(px, ncomponents * comm.nprocs, comm),
+            ox_, fromx, sizex, dimx,
+            detail::get_components<Nx>((T **)vx, nullptr, ctx, ncomponents, px, comm, session),
+            beta, detail::get_from_size(py, ncomponents * comm.nprocs, comm), oy_, fromy, sizey,
+            dimy, detail::get_components<Ny>(vy, nullptr, ctx, ncomponents, py, comm, session),
+            comm, co);
+    }
+
     /// Return the preferred layout for the input and output tensor in `bsr_krylov`
     /// \param bsrh: BSR handle
     /// \param ncomponents: number of components in the BSR handle
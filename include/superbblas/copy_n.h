@@ -3,6 +3,16 @@
 
 #include "blas.h"
 
+/// Macro SUPERBBLAS_USE_X86_SIMD activates the hand-vectorized CPU kernels for AVX2 and AVX-512.
+/// The kernels are compiled for all instruction sets and selected at runtime, so the flags
+/// passed to the compiler don't need to support them. Define SUPERBBLAS_NO_SIMD to disable them.
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__CUDACC__) && !defined(__HIPCC__) &&    \
+    !defined(SUPERBBLAS_NO_SIMD)
+#    define SUPERBBLAS_USE_X86_SIMD
+#    include <immintrin.h>
+#endif
+
 #ifdef SUPERBBLAS_CREATING_LIB
 /// Generate template instantiations for copy_n_lower functions with template parameters IndexType, T and Q
 
@@ -577,6 +587,278 @@ namespace superbblas {
             copy_n<IndexType>(alpha, v, xpuv, nullptr, xpuv, n, w, xpuw, nullptr, xpuw, EWOP{});
         }
 
+#ifdef SUPERBBLAS_USE_X86_SIMD
+        ///
+        /// Blocking copy on CPU with SIMD instructions
+        ///
+
+        namespace simd {
+            /// Instruction sets
+            struct Avx2 {};
+            struct Avx512 {};
+
+#    define SUPERBBLAS_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#    define SUPERBBLAS_TARGET_AVX512 __attribute__((target("avx512f")))
+
+            /// Operations on registers of type R for an instruction set
+            /// \tparam ISA: instruction set
+            /// \tparam R: float or double
+
+            template <typename ISA, typename R> struct reg;
+
+            template <> struct reg<Avx2, float> {
+                using type = __m256;
+                static constexpr int lanes = 8;
+                SUPERBBLAS_TARGET_AVX2 static type load(const float *p) { return _mm256_loadu_ps(p); }
+                SUPERBBLAS_TARGET_AVX2 static void store(float *p, type a) { _mm256_storeu_ps(p, a); }
+                SUPERBBLAS_TARGET_AVX2 static type set1(float a) { return _mm256_set1_ps(a); }
+                SUPERBBLAS_TARGET_AVX2 static type zero() { return _mm256_setzero_ps(); }
+                SUPERBBLAS_TARGET_AVX2 static type add(type a, type b) { return _mm256_add_ps(a, b); }
+                SUPERBBLAS_TARGET_AVX2 static type mul(type a, type b) { return _mm256_mul_ps(a, b); }
+                /// Return a*b - c for even lanes and a*b + c for odd lanes
+                SUPERBBLAS_TARGET_AVX2 static type fmaddsub(type a, type b, type c) {
+                    return _mm256_fmaddsub_ps(a, b, c);
+                }
+                /// Swap the even and the odd lanes
+                SUPERBBLAS_TARGET_AVX2 static type swap_pairs(type a) {
+                    return _mm256_permute_ps(a, 0xB1);
+                }
+            };
+
+            template <> struct reg<Avx2, double> {
+                using type = __m256d;
+                static constexpr int lanes = 4;
+                SUPERBBLAS_TARGET_AVX2 static type load(const double *p) { return _mm256_loadu_pd(p); }
+                SUPERBBLAS_TARGET_AVX2 static void store(double *p, type a) { _mm256_storeu_pd(p, a); }
+                SUPERBBLAS_TARGET_AVX2 static type set1(double a) { return _mm256_set1_pd(a); }
+                SUPERBBLAS_TARGET_AVX2 static type zero() { return _mm256_setzero_pd(); }
+                SUPERBBLAS_TARGET_AVX2 static type add(type a, type b) { return _mm256_add_pd(a, b); }
+                SUPERBBLAS_TARGET_AVX2 static type mul(type a, type b) { return _mm256_mul_pd(a, b); }
+                SUPERBBLAS_TARGET_AVX2 static type fmaddsub(type a, type b, type c) {
+                    return _mm256_fmaddsub_pd(a, b, c);
+                }
+                SUPERBBLAS_TARGET_AVX2 static type swap_pairs(type a) {
+                    return _mm256_permute_pd(a, 0x5);
+                }
+            };
+
+            template <> struct reg<Avx512, float> {
+                using type = __m512;
+                static constexpr int lanes = 16;
+                SUPERBBLAS_TARGET_AVX512 static type load(const float *p) { return _mm512_loadu_ps(p); }
+                SUPERBBLAS_TARGET_AVX512 static void store(float *p, type a) { _mm512_storeu_ps(p, a); }
+                SUPERBBLAS_TARGET_AVX512 static type set1(float a) { return _mm512_set1_ps(a); }
+                SUPERBBLAS_TARGET_AVX512 static type zero() { return _mm512_setzero_ps(); }
+                SUPERBBLAS_TARGET_AVX512 static type add(type a, type b) { return _mm512_add_ps(a, b); }
+                SUPERBBLAS_TARGET_AVX512 static type mul(type a, type b) { return _mm512_mul_ps(a, b); }
+                SUPERBBLAS_TARGET_AVX512 static type fmaddsub(type a, type b, type c) {
+                    return _mm512_fmaddsub_ps(a, b, c);
+                }
+                SUPERBBLAS_TARGET_AVX512 static type swap_pairs(type a) {
+                    return _mm512_shuffle_ps(a, a, 0xB1);
+                }
+            };
+
+            template <> struct reg<Avx512, double> {
+                using type = __m512d;
+                static constexpr int lanes = 8;
+                SUPERBBLAS_TARGET_AVX512 static type load(const double *p) { return _mm512_loadu_pd(p); }
+                SUPERBBLAS_TARGET_AVX512 static void store(double *p, type a) { _mm512_storeu_pd(p, a); }
+                SUPERBBLAS_TARGET_AVX512 static type set1(double a) { return _mm512_set1_pd(a); }
+                SUPERBBLAS_TARGET_AVX512 static type zero() { return _mm512_setzero_pd(); }
+                SUPERBBLAS_TARGET_AVX512 static type add(type a, type b) { return _mm512_add_pd(a, b); }
+                SUPERBBLAS_TARGET_AVX512 static type mul(type a, type b) { return _mm512_mul_pd(a, b); }
+                SUPERBBLAS_TARGET_AVX512 static type fmaddsub(type a, type b, type c) {
+                    return _mm512_fmaddsub_pd(a, b, c);
+                }
+                SUPERBBLAS_TARGET_AVX512 static type swap_pairs(type a) {
+                    return _mm512_shuffle_pd(a, a, 0x55);
+                }
+            };
+
+            /// Real type and whether the type is complex for the types supported by the kernels
+            /// \tparam T: type to inspect
+
+            template <typename T> struct elem_info {
+                static constexpr bool supported = false;
+            };
+            template <> struct elem_info<float> {
+                static constexpr bool supported = true, is_complex = false;
+                using real = float;
+            };
+            template <> struct elem_info<double> {
+                static constexpr bool supported = true, is_complex = false;
+                using real = double;
+            };
+            template <> struct elem_info<_Complex float> {
+                static constexpr bool supported = true, is_complex = true;
+                using real = float;
+            };
+            template <> struct elem_info<_Complex double> {
+                static constexpr bool supported = true, is_complex = true;
+                using real = double;
+            };
+
+            /// Type of alpha in w[indicesw[i]] (+)= alpha * v[indicesv[i]]
+            enum AlphaKind { AlphaZero, AlphaOne, AlphaGeneral };
+
+            /// Return the best instruction set allowed by SB_CPU_SIMD and supported by the CPU:
+            /// 0 for none, 1 for AVX2, and 2 for AVX-512
+
+            inline int get_cpu_simd_level() {
+                static int level = []() {
+                    __builtin_cpu_init();
+                    int l = 0;
+                    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) l = 1;
+                    if (l == 1 && __builtin_cpu_supports("avx512f")) l = 2;
+                    return getCpuSimd() < 0 ? l : std::min(l, getCpuSimd());
+                }();
+                return level;
+            }
+
+/// Define the kernel w[indicesw[i]+j] (+)= alpha * v[indicesv[i]+j] for j < blocking with an
+/// instruction set, where the contiguous runs of `blocking` elements are processed with full
+/// registers and the remainder with scalar operations. When B > 0, blocking is B.
+
+#    define SUPERBBLAS_COPY_N_BLOCKING_SIMD(ISA, TARGET)                                            \
+        template <int B, AlphaKind AK, typename IndexType, typename T, typename EWOP>              \
+        TARGET void copy_n_blocking_kernel(ISA, const T alpha, const T *SB_RESTRICT v,             \
+                                           IndexType blocking,                                     \
+                                           const IndexType *SB_RESTRICT indicesv, IndexType n,     \
+                                           T *SB_RESTRICT w,                                       \
+                                           const IndexType *SB_RESTRICT indicesw, EWOP) {          \
+            using R = typename elem_info<T>::real;                                                 \
+            using S = reg<ISA, R>;                                                                 \
+            constexpr bool cplx = elem_info<T>::is_complex;                                        \
+            constexpr bool add = std::is_same<EWOP, EWOp::Add>::value;                             \
+            constexpr IndexType elems_per_reg = S::lanes / (cplx ? 2 : 1);                         \
+            const IndexType b = (B > 0 ? B : blocking);                                            \
+            const R *alphar = (const R *)&alpha;                                                   \
+            const typename S::type ar = S::set1(alphar[0]),                                        \
+                                   ai = S::set1(cplx ? alphar[cplx ? 1 : 0] : R{0});               \
+            for (IndexType i = 0; i < n; ++i) {                                                    \
+                const T *SB_RESTRICT vi = v + (indicesv ? indicesv[i] : i * b);                    \
+                T *SB_RESTRICT wi = w + (indicesw ? indicesw[i] : i * b);                          \
+                IndexType j = 0;                                                                   \
+                for (; j + elems_per_reg <= b; j += elems_per_reg) {                               \
+                    typename S::type x;                                                            \
+                    if (AK == AlphaZero) {                                                         \
+                        x = S::zero();                                                             \
+                    } else {                                                                       \
+                        x = S::load((const R *)(vi + j));                                          \
+                        if (AK == AlphaGeneral)                                                    \
+                            x = cplx ? S::fmaddsub(ar, x, S::mul(ai, S::swap_pairs(x)))            \
+                                     : S::mul(ar, x);                                              \
+                    }                                                                              \
+                    if (add) x = S::add(S::load((const R *)(wi + j)), x);                          \
+                    S::store((R *)(wi + j), x);                                                    \
+                }                                                                                  \
+                for (; j < b; ++j) {                                                               \
+                    const T x = (AK == AlphaZero ? (T)0 : AK == AlphaOne ? vi[j] : alpha * vi[j]);   \
+                    if (add)                                                                       \
+                        wi[j] += x;                                                                \
+                    else                                                                           \
+                        wi[j] = x;                                                                 \
+                }                                                                                  \
+            }                                                                                      \
+        }
+
+            SUPERBBLAS_COPY_N_BLOCKING_SIMD(Avx2, SUPERBBLAS_TARGET_AVX2)
+            SUPERBBLAS_COPY_N_BLOCKING_SIMD(Avx512, SUPERBBLAS_TARGET_AVX512)
+
+#    undef SUPERBBLAS_COPY_N_BLOCKING_SIMD
+#    undef SUPERBBLAS_TARGET_AVX2
+#    undef SUPERBBLAS_TARGET_AVX512
+
+            /// Select the kernel for the blocking size
+            /// NOTE: blocking one is never used here; copy_n_blocking_lower calls copy_n_lower for it
+
+            template <AlphaKind AK, typename ISA, typename IndexType, typename T, typename EWOP>
+            void copy_n_blocking_select_blocking(ISA, const T &alpha, const T *v,
+                                                 IndexType blocking, const IndexType *indicesv,
+                                                 IndexType n, T *w, const IndexType *indicesw,
+                                                 EWOP) {
+                switch (blocking) {
+                case 2:
+                    copy_n_blocking_kernel<2, AK>(ISA{}, alpha, v, blocking, indicesv, n, w,
+                                                  indicesw, EWOP{});
+                    break;
+                case 4:
+                    copy_n_blocking_kernel<4, AK>(ISA{}, alpha, v, blocking, indicesv, n, w,
+                                                  indicesw, EWOP{});
+                    break;
+                case 8:
+                    copy_n_blocking_kernel<8, AK>(ISA{}, alpha, v, blocking, indicesv, n, w,
+                                                  indicesw, EWOP{});
+                    break;
+                case 12:
+                    copy_n_blocking_kernel<12, AK>(ISA{}, alpha, v, blocking, indicesv, n, w,
+                                                   indicesw, EWOP{});
+                    break;
+                default:
+                    copy_n_blocking_kernel<0, AK>(ISA{}, alpha, v, blocking, indicesv, n, w,
+                                                  indicesw, EWOP{});
+                }
+            }
+
+            /// Select the kernel for the value of alpha
+            template <typename ISA, typename IndexType, typename T, typename EWOP>
+            void copy_n_blocking(ISA, const T &alpha, const T *v, IndexType blocking,
+                                 const IndexType *indicesv, IndexType n, T *w,
+                                 const IndexType *indicesw, EWOP) {
+                if (alpha == (T)1)
+                    copy_n_blocking_select_blocking<AlphaOne>(ISA{}, alpha, v, blocking, indicesv,
+                                                              n, w, indicesw, EWOP{});
+                else if (is_zero(alpha))
+                    copy_n_blocking_select_blocking<AlphaZero>(ISA{}, alpha, v, blocking, indicesv,
+                                                               n, w, indicesw, EWOP{});
+                else
+                    copy_n_blocking_select_blocking<AlphaGeneral>(ISA{}, alpha, v, blocking,
+                                                                  indicesv, n, w, indicesw, EWOP{});
+            }
+        }
+
+        /// Copy n blocks, w[indicesw[i]+j] (+)= alpha * v[indicesv[i]+j] for j < blocking, with
+        /// SIMD instructions if the CPU supports them and the types are supported
+        /// \return whether the copy was done
+
+        template <typename IndexType, typename T, typename Q, typename EWOP,
+                  typename std::enable_if<!std::is_same<T, Q>::value ||
+                                              !simd::elem_info<T>::supported,
+                                          bool>::type = true>
+        bool copy_n_blocking_cpu_simd(const T &, const T *, IndexType, const IndexType *, Cpu,
+                                      IndexType, Q *, const IndexType *, Cpu, EWOP) {
+            return false;
+        }
+
+        template <typename IndexType, typename T, typename Q, typename EWOP,
+                  typename std::enable_if<std::is_same<T, Q>::value &&
+                                              simd::elem_info<T>::supported,
+                                          bool>::type = true>
+        bool copy_n_blocking_cpu_simd(const T &alpha, const T *v, IndexType blocking,
+                                      const IndexType *indicesv, Cpu, IndexType n, Q *w,
+                                      const IndexType *indicesw, Cpu, EWOP) {
+            if (is_zero(alpha) && std::is_same<EWOP, EWOp::Add>::value) return true;
+            switch (simd::get_cpu_simd_level()) {
+            case 1:
+                simd::copy_n_blocking(simd::Avx2{}, alpha, v, blocking, indicesv, n, w, indicesw,
+                                      EWOP{});
+                return true;
+            case 2:
+                simd::copy_n_blocking(simd::Avx512{}, alpha, v, blocking, indicesv, n, w, indicesw,
+                                      EWOP{});
+                return true;
+            default: return false;
+            }
+        }
+#else
+        template <typename IndexType, typename T, typename Q, typename EWOP>
+        bool copy_n_blocking_cpu_simd(const T &, const T *, IndexType, const IndexType *, Cpu,
+                                      IndexType, Q *, const IndexType *, Cpu, EWOP) {
+            return false;
+        }
+#endif // SUPERBBLAS_USE_X86_SIMD
+
         ///
         /// Blocking copy on CPU
         ///
@@ -621,20 +903,24 @@ namespace superbblas {
                     const IndexType *indiceswi =
                         indicesw + (indicesw != nullptr ? si : IndexType(0));
 
-                    copy_n_blocking_cpu(alphac, vi, blocking, indicesvi, Cpu{}, ni, wi, indiceswi,
-                                        Cpu{}, EWOP{});
+                    if (!copy_n_blocking_cpu_simd(alphac, vi, blocking, indicesvi, Cpu{}, ni, wi,
+                                                  indiceswi, Cpu{}, EWOP{}))
+                        copy_n_blocking_cpu_select(alphac, vi, blocking, indicesvi, Cpu{}, ni, wi,
+                                                   indiceswi, Cpu{}, EWOP{});
                 }
             } else
 #endif
             {
-                copy_n_blocking_cpu(alphac, (Tc *)v, blocking, indicesv, Cpu{}, n, (Qc *)w,
-                                    indicesw, Cpu{}, EWOP{});
+                if (!copy_n_blocking_cpu_simd(alphac, (Tc *)v, blocking, indicesv, Cpu{}, n,
+                                              (Qc *)w, indicesw, Cpu{}, EWOP{}))
+                    copy_n_blocking_cpu_select(alphac, (Tc *)v, blocking, indicesv, Cpu{}, n,
+                                               (Qc *)w, indicesw, Cpu{}, EWOP{});
             }
         }
 
 #define COPY_N_BLOCKING_VW_FOR(S)                                                                  \
     for (IndexType i = 0; i < n; ++i) {                                                            \
-        for (IndexType j = 0; j < blocking; ++j) {                                                 \
+        for (IndexType j = 0; j < bs; ++j) {                                                       \
             IndexType vj = indicesv[i] + j, wj = indicesw[i] + j;                                  \
             (void)vj;                                                                              \
             S;                                                                                     \
@@ -643,8 +929,8 @@ namespace superbblas {
 
 #define COPY_N_BLOCKING_W_FOR(S)                                                                   \
     for (IndexType i = 0; i < n; ++i) {                                                            \
-        for (IndexType j = 0; j < blocking; ++j) {                                                 \
-            IndexType wj = indicesw[i] + j, idx = i * blocking + j;                                \
+        for (IndexType j = 0; j < bs; ++j) {                                                       \
+            IndexType wj = indicesw[i] + j, idx = i * bs + j;                                      \
             (void)idx;                                                                             \
             S;                                                                                     \
         }                                                                                          \
@@ -652,15 +938,17 @@ namespace superbblas {
 
 #define COPY_N_BLOCKING_V_FOR(S)                                                                   \
     for (IndexType i = 0; i < n; ++i) {                                                            \
-        for (IndexType j = 0; j < blocking; ++j) {                                                 \
-            IndexType vj = indicesv[i] + j, idx = i * blocking + j;                                \
+        for (IndexType j = 0; j < bs; ++j) {                                                       \
+            IndexType vj = indicesv[i] + j, idx = i * bs + j;                                      \
             (void)vj;                                                                              \
             S;                                                                                     \
         }                                                                                          \
     }
 
         /// Copy n values, w[indicesw[i]] = v[indicesv[i]]
-        template <typename IndexType, typename T, typename Q>
+        /// \tparam B: if greater than zero, the value of `blocking` known at compile time
+
+        template <int B = 0, typename IndexType, typename T, typename Q>
         void copy_n_blocking_cpu(const T &alpha, const T *SB_RESTRICT v, IndexType blocking,
                                  const IndexType *SB_RESTRICT indicesv, Cpu, IndexType n,
                                  Q *SB_RESTRICT w, const IndexType *SB_RESTRICT indicesw, Cpu,
@@ -669,6 +957,8 @@ namespace superbblas {
             static_assert(!is_complex<T>::value && !is_complex<Q>::value,
                           "don't use std::complex here; use C complex if needed");
 
+            const IndexType bs = (B > 0 ? B : blocking);
+
             if (indicesv == nullptr && indicesw != nullptr) {
                 /// Case: w[indicesw[i]] = v[i]
                 if (alpha == (T)1) {
@@ -702,7 +992,9 @@ namespace superbblas {
         }
 
         /// Copy n values, w[indicesw[i]] += v[indicesv[i]]
-        template <typename IndexType, typename T, typename Q>
+        /// \tparam B: if greater than zero, the value of `blocking` known at compile time
+
+        template <int B = 0, typename IndexType, typename T, typename Q>
         void copy_n_blocking_cpu(const T &alpha, const T *SB_RESTRICT v, IndexType blocking,
                                  const IndexType *SB_RESTRICT indicesv, Cpu, IndexType n,
                                  Q *SB_RESTRICT w, const IndexType *SB_RESTRICT indicesw, Cpu,
@@ -711,6 +1003,8 @@ namespace superbblas {
             static_assert(!is_complex<T>::value && !is_complex<Q>::value,
                           "don't use std::complex here; use C complex if needed");
 
+            const IndexType bs = (B > 0 ? B : blocking);
+
             if (is_zero(alpha)) return;
 
             if (indicesv == nullptr && indicesw != nullptr) {
@@ -743,6 +1037,36 @@ namespace superbblas {
 #undef COPY_N_BLOCKING_W_FOR
 #undef COPY_N_BLOCKING_V_FOR
 
+        /// Copy n values, w[indicesw[i]] (+)= v[indicesv[i]], with the common blocking values,
+        /// mostly coming from spin and color dimensions, given at compile time
+
+        template <typename IndexType, typename T, typename Q, typename EWOP>
+        void copy_n_blocking_cpu_select(const T &alpha, const T *v, IndexType blocking,
+                                        const IndexType *indicesv, Cpu, IndexType n, Q *w,
+                                        const IndexType *indicesw, Cpu, EWOP) {
+            switch (blocking) {
+            case 3:
+                copy_n_blocking_cpu<3>(alpha, v, blocking, indicesv, Cpu{}, n, w, indicesw, Cpu{},
+                                       EWOP{});
+                break;
+            case 4:
+                copy_n_blocking_cpu<4>(alpha, v, blocking, indicesv, Cpu{}, n, w, indicesw, Cpu{},
+                                       EWOP{});
+                break;
+            case 12:
+                copy_n_blocking_cpu<12>(alpha, v, blocking, indicesv, Cpu{}, n, w, indicesw, Cpu{},
+                                        EWOP{});
+                break;
+            case 24:
+                copy_n_blocking_cpu<24>(alpha, v, blocking, indicesv, Cpu{}, n, w, indicesw, Cpu{},
+                                        EWOP{});
+                break;
+            default:
+                copy_n_blocking_cpu(alpha, v, blocking, indicesv, Cpu{}, n, w, indicesw, Cpu{},
+                                    EWOP{});
+            }
+        }
+
         ///
         /// Blocking copy on GPU
         ///
@@ -911,12 +1235,12 @@ namespace superbblas {
             if (deviceId(xpuv) == CPU_DEVICE_ID) {
                 launchHostKernel(
                     [=] {
-                        // We call `copy_n_blocking_cpu` instead of `copy_n_blocking` with cpu contexts to avoid
+                        // We call `copy_n_blocking_cpu_select` instead of `copy_n_blocking` with cpu contexts to avoid
                         // spawning threads inside a host kernel, they may not run on multiple cores
                         using Tc = typename ccomplex<T>::type;
                         using Qc = typename ccomplex<Q>::type;
-                        copy_n_blocking_cpu(*(Tc *)&alpha, (Tc *)v, blocking, indicesv, Cpu{}, n,
-                                            (Qc *)w, indicesw, Cpu{}, EWOP{});
+                        copy_n_blocking_cpu_select(*(Tc *)&alpha, (Tc *)v, blocking, indicesv,
+                                                   Cpu{}, n, (Qc *)w, indicesw, Cpu{}, EWOP{});
                     },
                     xpuv);
             } else {
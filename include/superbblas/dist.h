@@ -5,6 +5,8 @@
 #include <algorithm>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <type_traits>
@@ -726,6 +728,27 @@ namespace superbblas {
 
         inline void barrier(MpiComm comm) { MPI_check(MPI_Barrier(comm.comm)); }
 
+        /// Return the largest value among all processes
+        /// \param v: local value
+        /// \param comm: communicator
+
+        inline int global_max(int v, MpiComm comm) {
+            MPI_check(MPI_Allreduce(MPI_IN_PLACE, &v, 1, MPI_INT, MPI_MAX, comm.comm));
+            return v;
+        }
+
+        /// Return the concatenation of the vectors of all processes, ordered by rank
+        /// \param v: local vector; all processes should give vectors with the same size
+        /// \param comm: communicator
+
+        template <typename T> std::vector<T> all_gather(const std::vector<T> &v, MpiComm comm) {
+            std::vector<T> r(v.size() * comm.nprocs);
+            const MpiInt bytes = (MpiInt)(sizeof(T) * v.size());
+            MPI_check(MPI_Allgather(v.data(), bytes, MPI_BYTE, r.data(), bytes, MPI_BYTE,
+                                    comm.comm));
+            return r;
+        }
+
         template <typename T, typename H = Hash<T>>
         void check_consistency(const T &t, const MpiComm &comm) {
             if (getDebugLevel() == 0 || comm.nprocs == 1) return;
@@ -740,48 +763,91 @@ namespace superbblas {
             vector<T, XPUbuff> buf;     ///< pointer to data
             vector<MpiInt, Cpu> counts; ///< number of items send/receive for rank i
             vector<MpiInt, Cpu> displ;  ///< index of the first element to send/receive for rank i
+            std::vector<int> peers;     ///< ranks with nonzero counts
         };
 
+        /// Return the ranks with nonzero counts
+        /// \param counts: number of items send/receive for each rank
+
+        inline std::vector<int> get_peers(const vector<MpiInt, Cpu> &counts) {
+            std::vector<int> peers;
+            for (std::size_t rank = 0; rank < counts.size(); ++rank)
+                if (counts[rank] > 0) peers.push_back(rank);
+            return peers;
+        }
+
         /// Allocate buffers and prepare arrays from a list of ranges to be used in a MPI communication
         /// \param toSend: iterator over a list of tensor ranges to be packed
         /// \param comm: communicator
+        /// \param xpu: context for the buffer
+        /// \param buf: (optional) buffer to use instead of allocating one
 
         template <typename T, typename XPUbuff, std::size_t Nd>
         PackedValues<T, XPUbuff> prepare_pack(const Range_proc_range_ranges<Nd> &toSend,
-                                              const MpiComm &comm, const XPUbuff &xpu) {
+                                              const MpiComm &comm, const XPUbuff &xpu,
+                                              vector<T, XPUbuff> buf = vector<T, XPUbuff>()) {
 
             // Allocate PackedValues
             static_assert(MpiTypeSize % sizeof(T) == 0,
                           "Please change MpiTypeSize to be a power of two!");
 
-            // Prepare counts and displ
-            vector<MpiInt, Cpu> counts(comm.nprocs, Cpu{});
-            vector<MpiInt, Cpu> displ(comm.nprocs, Cpu{});
+            // Find counts and displ on cache
+            using Key = std::tuple<Range_proc_range_ranges<Nd>, int, int, std::size_t>;
+            using Value = std::tuple<vector<MpiInt, Cpu>, // counts
+                                     vector<MpiInt, Cpu>, // displ
+                                     std::vector<int>,    // peers
+                                     std::size_t>;        // number of T elements
+            struct cache_tag {};
+            auto cache = getCache<Key, Value, TupleHash<Key>, cache_tag>(Cpu{});
+            Key key{toSend, comm.nprocs, comm.rank, sizeof(T)};
+            auto it = cache.find(key);
+
+            // If they are not, prepare counts and displ
+            vector<MpiInt, Cpu> counts;
+            vector<MpiInt, Cpu> displ;
+            std::vector<int> peers;
             std::size_t n = 0; // accumulate total number of T elements
-            int d = 0;         // accumulate total number of MpiT elements
-            for (unsigned int rank = 0; rank < comm.nprocs; ++rank) {
-                std::size_t n_rank = 0;  // total number of T elements in rank
-                if (rank != comm.rank) { // Skip the communications of the local rank
-                    // Compute the total number of T elements for rank i
-                    for (unsigned int irange = 0; irange < toSend.size(); ++irange)
-                        for (const auto &ranges : toSend[irange][rank]) n_rank += volume(ranges);
-                }
-                std::size_t new_size = multiple_of(n_rank * sizeof(T), MpiTypeSize);
-                n += new_size / sizeof(T);
-                counts[rank] = new_size / MpiTypeSize;
-                displ[rank] = d;
-                d += counts[rank];
-            }
-            if (d * MpiTypeSize != n * sizeof(T))
-                throw std::runtime_error(
-                    "Exceeded the maximum package size: increase `MpiTypeSize`");
+            if (it == cache.end()) {
+                counts = vector<MpiInt, Cpu>(comm.nprocs, Cpu{});
+                displ = vector<MpiInt, Cpu>(comm.nprocs, Cpu{});
+                int d = 0; // accumulate total number of MpiT elements
+                for (unsigned int rank = 0; rank < comm.nprocs; ++rank) {
+                    std::size_t n_rank = 0;  // total number of T elements in rank
+                    if (rank != comm.rank) { // Skip the communications of the local rank
+                        // Compute the total number of T elements for rank i
+                        for (unsigned int irange = 0; irange < toSend.size(); ++irange)
+                            for (const auto &ranges : toSend[irange][rank])
+                                n_rank += volume(ranges);
+                    }
+                    std::size_t new_size = multiple_of(n_rank * sizeof(T), MpiTypeSize);
+                    n += new_size / sizeof(T);
+                    counts[rank] = new_size / MpiTypeSize;
+                    displ[rank] = d;
+                    d += counts[rank];
+                }
+                if (d * MpiTypeSize != n * sizeof(T))
+                    throw std::runtime_error(
+                        "Exceeded the maximum package size: increase `MpiTypeSize`");
 
-            // NOTE: MPI calls may have problems passing null pointers as buffers
-            if (n == 0) n = MpiTypeSize / sizeof(T);
+                // NOTE: MPI calls may have problems passing null pointers as buffers
+                if (n == 0) n = MpiTypeSize / sizeof(T);
 
-            vector<T, XPUbuff> buf(n, xpu, doCacheAllocExternal, MpiTypeSize);
+                peers = get_peers(counts);
+                cache.insert(key, Value{counts, displ, peers, n},
+                             storageSize(counts) + storageSize(displ));
+            } else {
+                counts = std::get<0>(it->second.value);
+                displ = std::get<1>(it->second.value);
+                peers = std::get<2>(it->second.value);
+                n = std::get<3>(it->second.value);
+            }
+
+            if (buf.size() == 0)
+                buf = vector<T, XPUbuff>(n, xpu, doCacheAllocExternal, MpiTypeSize);
+            else if (buf.size() < n)
+                throw std::runtime_error("prepare_pack: the given buffer is too small");
 
-            return PackedValues<T, XPUbuff>{buf, counts, displ};
+            return PackedValues<T, XPUbuff>{buf, counts, displ, peers};
         }
 
         /// Return the common blocksize given a list of ranges
@@ -865,23 +931,66 @@ namespace superbblas {
             }
         }
 
-        /// Pack a list of subtensors contiguously in memory
+        /// Return for each rank the first element to copy if all elements are consecutive on both
+        /// the origin and the destination, or -1 otherwise
+        /// \param indices0: origin indices
+        /// \param indices1: destination indices
+        /// \param rank_disp: first index for each rank and the total
+        /// \param blocksize: number of consecutive elements to copy for each index
+
+        template <typename IndexType>
+        std::vector<std::ptrdiff_t> get_contiguous_ranks(const IndicesT<IndexType, Cpu> &indices0,
+                                                         const IndicesT<IndexType, Cpu> &indices1,
+                                                         const std::vector<std::size_t> &rank_disp,
+                                                         std::size_t blocksize) {
+            std::vector<std::ptrdiff_t> r(rank_disp.size() - 1, -1);
+            for (std::size_t rank = 0; rank + 1 < rank_disp.size(); ++rank) {
+                const std::size_t i0 = rank_disp[rank], i1 = rank_disp[rank + 1];
+                if (i0 == i1) continue;
+                bool contiguous = true;
+                for (std::size_t i = i0 + 1; i < i1 && contiguous; ++i)
+                    contiguous =
+                        (std::size_t)(indices0[i] - indices0[i0]) == (i - i0) * blocksize &&
+                        (std::size_t)(indices1[i] - indices1[i0]) == (i - i0) * blocksize;
+                if (contiguous) r[rank] = indices0[i0];
+            }
+            return r;
+        }
+
+        /// Indices to pack a component
+        template <typename IndexType, typename XPU0, typename XPUbuff>
+        struct PackComponentIndices {
+            IndicesT<IndexType, XPU0> indices0;    ///< indices of the origin elements
+            IndicesT<IndexType, XPUbuff> indices1; ///< indices on the buffer
+            std::size_t blocksize;                 ///< number of consecutive elements to copy
+            std::vector<std::size_t> rank_disp;    ///< first index for each rank and the total
+            /// first origin element for each rank if the elements are consecutive, or -1
+            std::vector<std::ptrdiff_t> rank_contiguous;
+        };
+
+        /// Indices to pack all components
+        template <typename IndexType, typename XPU0, typename XPU1, typename XPUbuff>
+        using PackIndices = std::pair<std::vector<PackComponentIndices<IndexType, XPU0, XPUbuff>>,
+                                      std::vector<PackComponentIndices<IndexType, XPU1, XPUbuff>>>;
+
+        /// Return the indices to pack a list of subtensors contiguously in memory
         /// \param o0: dimension labels for the origin tensor
         /// \param fs: a From_size iterator
         /// \param dim0: dimension size for the origin tensor
-        /// \param v0: data for the origin tensor
+        /// \param xpu0: context of the origin tensor
+        /// \param mask0: mask for the origin tensor
         /// \param o1: dimension labels for the destination tensor
-        /// \param v1: data for the destination tensor
+        /// \param disp1: (input/output) first element on the buffer to write for each rank
+        /// \param xpubuff: context of the buffer
         /// \param comm: communicator
         /// \param co: coordinate linearization order
 
-        template <typename IndexType, std::size_t Nd0, std::size_t Nd1, typename T, typename Q,
-                  typename XPU0, typename XPUbuff>
-        void pack_component(const Order<Nd0> &o0,
-                            const typename Range_proc_range_ranges<Nd0>::value_type &fs,
-                            const Coor<Nd0> &dim0, vector<const T, XPU0> v0, Mask<XPU0> mask0,
-                            const Order<Nd1> &o1, Indices<Cpu> &disp1, vector<Q, XPUbuff> &v1,
-                            MpiComm comm, CoorOrder co) {
+        template <typename IndexType, std::size_t Nd0, std::size_t Nd1, typename XPU0,
+                  typename XPUbuff>
+        PackComponentIndices<IndexType, XPU0, XPUbuff> get_pack_component_indices(
+            const Order<Nd0> &o0, const typename Range_proc_range_ranges<Nd0>::value_type &fs,
+            const Coor<Nd0> &dim0, const XPU0 &xpu0, Mask<XPU0> mask0, const Order<Nd1> &o1,
+            Indices<Cpu> &disp1, const XPUbuff &xpubuff, MpiComm comm, CoorOrder co) {
 
             assert(fs.size() == comm.nprocs);
 
@@ -889,31 +998,32 @@ namespace superbblas {
             using Key = std::tuple<typename Range_proc_range_ranges<Nd0>::value_type, Coor<Nd0>,
                                    PairPerms<Nd0, Nd1>, Indices<Cpu>, int, int, int, CoorOrder>;
             using Value = std::tuple<IndicesT<IndexType, XPU0>, IndicesT<IndexType, XPUbuff>,
-                                     size_t, Indices<Cpu>>;
+                                     size_t, Indices<Cpu>, std::vector<std::size_t>,
+                                     std::vector<std::ptrdiff_t>>;
             struct cache_tag {};
-            auto cache = getCache<Key, Value, TupleHash<Key>, cache_tag>(v0.ctx());
+            auto cache = getCache<Key, Value, TupleHash<Key>, cache_tag>(xpu0);
             Key key{fs,
                     dim0,
                     get_perms(o0, o1),
                     clone(disp1),
                     comm.rank,
-                    deviceId(v0.ctx()),
-                    deviceId(v1.ctx()),
+                    deviceId(xpu0),
+                    deviceId(xpubuff),
                     co};
             auto it = mask0.size() == 0 ? cache.find(key) : cache.end();
 
             // If they are not, compute the permutation vectors
-            IndicesT<IndexType, XPU0> indices0_xpu;
-            IndicesT<IndexType, XPUbuff> indices1;
-            std::size_t blocksize = 1;
+            PackComponentIndices<IndexType, XPU0, XPUbuff> r;
+            r.blocksize = 1;
             if (it == cache.end()) {
-                tracker<XPU0> _t("comp. pack permutation", v0.ctx());
+                tracker<XPU0> _t("comp. pack permutation", xpu0);
 
                 // Figure out the common blocksize
                 std::size_t nblock = 0;
                 if (mask0.size() == 0)
                     get_block_size_for_copy_normalize(o0, fs, dim0, o1, comm, co, nblock,
-                                                      blocksize);
+                                                      r.blocksize);
+                const std::size_t blocksize = r.blocksize;
 
                 // Get the maximum volume of communicated data without the local part
                 std::size_t vol = 0;
@@ -925,8 +1035,11 @@ namespace superbblas {
                 IndicesT<IndexType, Cpu> indices0{vol, Cpu{}};
                 IndicesT<IndexType, Cpu> indices1_cpu{vol, Cpu{}};
                 Mask<Cpu> mask0_cpu = makeSure(mask0, Cpu{});
+                r.rank_disp.resize(fs.size() + 1);
                 std::size_t n = 0;
                 for (std::size_t rank = 0; rank < fs.size(); ++rank) {
+                    r.rank_disp[rank] = n;
+
                     // Skip the communications of the local rank
                     if (rank == comm.rank) continue;
 
@@ -972,83 +1085,188 @@ namespace superbblas {
                         }
                     }
                 }
+                r.rank_disp[fs.size()] = n;
                 indices0.resize(n);
                 indices1_cpu.resize(n);
-                indices0_xpu = makeSure(indices0, v0.ctx());
-                indices1 = makeSure(indices1_cpu, v1.ctx());
+                r.rank_contiguous =
+                    get_contiguous_ranks(indices0, indices1_cpu, r.rank_disp, blocksize);
+                r.indices0 = makeSure(indices0, xpu0);
+                r.indices1 = makeSure(indices1_cpu, xpubuff);
 
                 // The cache trackers consider that all cache entries are on the same device; so just track the
                 // indices0_xpu when using gpus
                 if (mask0.size() == 0) {
                     std::size_t size =
-                        storageSize(indices0_xpu) +
-                        (deviceId(v0.ctx()) == deviceId(v1.ctx()) ? storageSize(indices1) : 0ul);
+                        storageSize(r.indices0) +
+                        (deviceId(xpu0) == deviceId(xpubuff) ? storageSize(r.indices1) : 0ul);
                     cache.insert(key,
-                                 Value{archive(indices0_xpu), archive(indices1), blocksize,
-                                       archive(clone(disp1))},
+                                 Value{archive(r.indices0), archive(r.indices1), r.blocksize,
+                                       archive(clone(disp1)), r.rank_disp, r.rank_contiguous},
                                  size);
                 }
             } else {
-                indices0_xpu = std::get<0>(it->second.value);
-                indices1 = std::get<1>(it->second.value);
-                blocksize = std::get<2>(it->second.value);
+                r.indices0 = std::get<0>(it->second.value);
+                r.indices1 = std::get<1>(it->second.value);
+                r.blocksize = std::get<2>(it->second.value);
                 const auto new_disp1 = std::get<3>(it->second.value);
                 std::copy_n(new_disp1.data(), new_disp1.size(), disp1.data());
+                r.rank_disp = std::get<4>(it->second.value);
+                r.rank_contiguous = std::get<5>(it->second.value);
             }
 
-            // Do the copy
+            return r;
+        }
+
+        /// Pack a component, or only the part sent to one rank
+        /// \param pi: indices returned by `get_pack_component_indices`
+        /// \param v0: data for the origin tensor
+        /// \param v1: data for the destination tensor
+        /// \param rank: if nonnegative, only copy the elements sent to this rank
+
+        template <typename IndexType, typename T, typename Q, typename XPU0, typename XPUbuff>
+        void pack_component_values(const PackComponentIndices<IndexType, XPU0, XPUbuff> &pi,
+                                   vector<const T, XPU0> v0, vector<Q, XPUbuff> &v1,
+                                   int rank = -1) {
+            const std::size_t i0 = (rank < 0 ? 0 : pi.rank_disp[rank]);
+            const std::size_t i1 = (rank < 0 ? pi.indices0.size() : pi.rank_disp[rank + 1]);
+            if (i0 == i1) return;
+
             tracker<XPUbuff> _t(std::string("local copy from ") + platformToStr(v0.ctx()) +
                                     std::string(" to ") + platformToStr(v1.ctx()),
                                 v1.ctx());
-            _t.memops = (double)(sizeof(T) + sizeof(Q)) * indices0_xpu.size() * blocksize;
-            copy_n_blocking<IndexType, T, Q>(1.0, v0.data(), v0.ctx(), blocksize,
-                                             indices0_xpu.begin(), indices0_xpu.ctx(),
-                                             indices0_xpu.size(), v1.data(), v1.ctx(),
-                                             indices1.begin(), indices1.ctx(), EWOp::Copy{});
+            _t.memops = (double)(sizeof(T) + sizeof(Q)) * (i1 - i0) * pi.blocksize;
+            copy_n_blocking<IndexType, T, Q>(1.0, v0.data(), v0.ctx(), pi.blocksize,
+                                             pi.indices0.begin() + i0, pi.indices0.ctx(), i1 - i0,
+                                             v1.data(), v1.ctx(), pi.indices1.begin() + i0,
+                                             pi.indices1.ctx(), EWOp::Copy{});
         }
 
-        /// Pack a list of ranges to be used in a MPI communication
+        /// Return the indices to pack a list of ranges to be used in a MPI communication
         /// \param toSend: list of tensor ranges to be sent for each component
-        /// \param ncomponents0: number of elements in toSend and v
         /// \param v: vector containing the values to send
         /// \param o0: dimension labels for the origin tensor
         /// \param o1: dimension labels for the destination tensor
         /// \param comm: communicator
         /// \param co: coordinate linearization order
+        /// \param r: (input/output) buffer for the packed values; the counts are updated when
+        ///        using masks
 
         template <typename IndexType, typename Q, std::size_t Nd0, std::size_t Nd1, typename T,
                   typename XPU0, typename XPU1, typename XPUbuff>
-        PackedValues<Q, XPUbuff> pack(const Range_proc_range_ranges<Nd0> &toSend,
-                                      const Components_tmpl<Nd0, const T, XPU0, XPU1> &v,
-                                      const Order<Nd0> &o0, const Order<Nd1> &o1, MpiComm comm,
-                                      XPUbuff xpu, CoorOrder co) {
+        PackIndices<IndexType, XPU0, XPU1, XPUbuff>
+        get_pack_indices(const Range_proc_range_ranges<Nd0> &toSend,
+                         const Components_tmpl<Nd0, const T, XPU0, XPU1> &v, const Order<Nd0> &o0,
+                         const Order<Nd1> &o1, MpiComm comm, CoorOrder co,
+                         PackedValues<Q, XPUbuff> &r) {
 
             assert(num_components(v) == toSend.size());
 
-            tracker<Cpu> _t("prepare and pack", Cpu{});
-
-            PackedValues<Q, XPUbuff> r = prepare_pack<Q>(toSend, comm, xpu);
+            // Find indices on cache; the displacements on the buffer only depend on `toSend` and
+            // the type Q, so the cache hits skip building them
+            using Key = std::tuple<Range_proc_range_ranges<Nd0>, std::vector<Coor<Nd0>>,
+                                   PairPerms<Nd0, Nd1>, int, int, int, std::vector<int>, CoorOrder>;
+            struct cache_tag {};
+            auto cache = getCache<Key, PackIndices<IndexType, XPU0, XPU1, XPUbuff>,
+                                  TupleHash<Key>, cache_tag>(r.buf.ctx());
+            bool using_mask = false;
+            std::vector<Coor<Nd0>> dims;
+            std::vector<int> ids; // component id and device for each component
+            for (const auto &it : v.first) {
+                using_mask |= (it.mask_it.size() > 0);
+                dims.push_back(it.dim);
+                ids.push_back(it.componentId);
+                ids.push_back(deviceId(it.it.ctx()));
+            }
+            ids.push_back(-1);
+            for (const auto &it : v.second) {
+                using_mask |= (it.mask_it.size() > 0);
+                dims.push_back(it.dim);
+                ids.push_back(it.componentId);
+                ids.push_back(deviceId(it.it.ctx()));
+            }
+            Key key{toSend,    dims,      get_perms(o0, o1), comm.nprocs,
+                    comm.rank, deviceId(r.buf.ctx()), ids,     co};
+            auto it = !using_mask ? cache.find(key) : cache.end();
+            if (it != cache.end()) return it->second.value;
 
             Indices<Cpu> buf_disp(comm.nprocs, Cpu{});
             for (unsigned int rank = 0; rank < comm.nprocs; ++rank)
                 buf_disp[rank] = r.displ[rank] * (MpiTypeSize / sizeof(Q));
 
+            PackIndices<IndexType, XPU0, XPU1, XPUbuff> pi;
+            pi.first.resize(v.first.size());
+            pi.second.resize(v.second.size());
             for (unsigned int componentId0 = 0; componentId0 < toSend.size(); ++componentId0) {
-                for (const Component<Nd0, const T, XPU0> &c : v.first)
-                    if (c.componentId == componentId0)
-                        pack_component<IndexType>(o0, toSend[componentId0], c.dim, c.it, c.mask_it,
-                                                  o1, buf_disp, r.buf, comm, co);
-                for (const Component<Nd0, const T, XPU1> &c : v.second)
-                    if (c.componentId == componentId0)
-                        pack_component<IndexType>(o0, toSend[componentId0], c.dim, c.it, c.mask_it,
-                                                  o1, buf_disp, r.buf, comm, co);
-            }
-
-            // Update the counts when using mask
-            if (v.first.size() > 0 && v.first[0].mask_it.size() > 0)
+                for (unsigned int i = 0; i < v.first.size(); ++i)
+                    if (v.first[i].componentId == componentId0)
+                        pi.first[i] = get_pack_component_indices<IndexType>(
+                            o0, toSend[componentId0], v.first[i].dim, v.first[i].it.ctx(),
+                            v.first[i].mask_it, o1, buf_disp, r.buf.ctx(), comm, co);
+                for (unsigned int i = 0; i < v.second.size(); ++i)
+                    if (v.second[i].componentId == componentId0)
+                        pi.second[i] = get_pack_component_indices<IndexType>(
+                            o0, toSend[componentId0], v.second[i].dim, v.second[i].it.ctx(),
+                            v.second[i].mask_it, o1, buf_disp, r.buf.ctx(), comm, co);
+            }
+
+            // Update the counts when using mask; the counts may be shared with the cache
+            if (v.first.size() > 0 && v.first[0].mask_it.size() > 0) {
+                r.counts = clone(r.counts);
                 for (unsigned int rank = 0; rank < comm.nprocs; ++rank)
                     r.counts[rank] = (buf_disp[rank] * sizeof(Q) + MpiTypeSize - 1) / MpiTypeSize -
                                      r.displ[rank];
+            }
+
+            // The indices are shared with the cache of `get_pack_component_indices`, so only
+            // charge the displacements for each rank
+            if (!using_mask)
+                cache.insert(key, pi,
+                             (sizeof(std::size_t) + sizeof(std::ptrdiff_t)) * (comm.nprocs + 1) *
+                                 (pi.first.size() + pi.second.size()));
+            return pi;
+        }
+
+        /// Pack the values of all components, or only the ones sent to one rank
+        /// \param pi: indices returned by `get_pack_indices`
+        /// \param v: vector containing the values to send
+        /// \param r: buffer for the packed values
+        /// \param rank: if nonnegative, only copy the elements sent to this rank
+
+        template <typename IndexType, typename Q, std::size_t Nd0, typename T, typename XPU0,
+                  typename XPU1, typename XPUbuff>
+        void pack_values(const PackIndices<IndexType, XPU0, XPU1, XPUbuff> &pi,
+                         const Components_tmpl<Nd0, const T, XPU0, XPU1> &v,
+                         PackedValues<Q, XPUbuff> &r, int rank = -1) {
+            for (unsigned int i = 0; i < v.first.size(); ++i)
+                pack_component_values(pi.first[i], v.first[i].it, r.buf, rank);
+            for (unsigned int i = 0; i < v.second.size(); ++i)
+                pack_component_values(pi.second[i], v.second[i].it, r.buf, rank);
+        }
+
+        /// Pack a list of ranges to be used in a MPI communication
+        /// \param toSend: list of tensor ranges to be sent for each component
+        /// \param ncomponents0: number of elements in toSend and v
+        /// \param v: vector containing the values to send
+        /// \param o0: dimension labels for the origin tensor
+        /// \param o1: dimension labels for the destination tensor
+        /// \param comm: communicator
+        /// \param co: coordinate linearization order
+        /// \param buf: (optional) buffer to use instead of allocating one
+
+        template <typename IndexType, typename Q, std::size_t Nd0, std::size_t Nd1, typename T,
+                  typename XPU0, typename XPU1, typename XPUbuff>
+        PackedValues<Q, XPUbuff> pack(const Range_proc_range_ranges<Nd0> &toSend,
+                                      const Components_tmpl<Nd0, const T, XPU0, XPU1> &v,
+                                      const Order<Nd0> &o0, const Order<Nd1> &o1, MpiComm comm,
+                                      XPUbuff xpu, CoorOrder co,
+                                      const vector<Q, XPUbuff> &buf = vector<Q, XPUbuff>()) {
+
+            assert(num_components(v) == toSend.size());
+
+            tracker<Cpu> _t("prepare and pack", Cpu{});
+
+            PackedValues<Q, XPUbuff> r = prepare_pack<Q>(toSend, comm, xpu, buf);
+            pack_values(get_pack_indices<IndexType>(toSend, v, o0, o1, comm, co, r), v, r);
             return r;
         }
 
@@ -1073,17 +1291,30 @@ namespace superbblas {
             std::vector<IndicesT<IndexType, Cpu>> indices_groups;
             /// blocksize for block copying
             std::vector<std::size_t> blocksize;
+            /// first index received from each rank and the total, for each component
+            std::vector<std::vector<std::size_t>> rank_disp;
+            /// first group of indices received from each rank and the total, for each component
+            std::vector<std::vector<std::size_t>> rank_groups_disp;
+            /// first destination element for each rank if the elements are consecutive, or -1,
+            /// for each component
+            std::vector<std::vector<std::ptrdiff_t>> rank_contiguous;
             UnpackedValues(const vector<T, XPUbuff> &buf, const vector<MpiInt, Cpu> &counts,
-                           const vector<MpiInt, Cpu> &displ,
+                           const vector<MpiInt, Cpu> &displ, const std::vector<int> &peers,
                            const std::vector<IndicesT<IndexType, XPUbuff>> &indices_buf,
                            const Range_IndicesT_tmpl<IndexType, XPU0, XPU1> &indices,
                            const std::vector<IndicesT<IndexType, Cpu>> &indices_groups,
-                           const std::vector<std::size_t> &blocksize)
-                : PackedValues<T, XPUbuff>{buf, counts, displ},
+                           const std::vector<std::size_t> &blocksize,
+                           const std::vector<std::vector<std::size_t>> &rank_disp,
+                           const std::vector<std::vector<std::size_t>> &rank_groups_disp,
+                           const std::vector<std::vector<std::ptrdiff_t>> &rank_contiguous)
+                : PackedValues<T, XPUbuff>{buf, counts, displ, peers},
                   indices_buf(indices_buf),
                   indices(indices),
                   indices_groups(indices_groups),
-                  blocksize(blocksize) {}
+                  blocksize(blocksize),
+                  rank_disp(rank_disp),
+                  rank_groups_disp(rank_groups_disp),
+                  rank_contiguous(rank_contiguous) {}
         };
 
         /// Return whether some ranges to receive overlaps
@@ -1148,13 +1379,15 @@ namespace superbblas {
         /// \param xpu: context for the buffer
         /// \param comm: communication
         /// \param co: coordinate linearization order
+        /// \param buf: (optional) buffer to use instead of allocating one
 
         template <typename IndexType, std::size_t Nd, typename T, typename XPU0, typename XPU1,
                   typename XPUbuff, typename EWOP>
         UnpackedValues<IndexType, T, XPUbuff, XPU0, XPU1>
         prepare_unpack(const Range_proc_range_ranges<Nd> &toReceive,
                        const Components_tmpl<Nd, T, XPU0, XPU1> &v, XPUbuff xpu,
-                       const MpiComm &comm, CoorOrder co, EWOP) {
+                       const MpiComm &comm, CoorOrder co, EWOP,
+                       vector<T, XPUbuff> buf = vector<T, XPUbuff>()) {
 
             assert(toReceive.size() == num_components(v));
 
@@ -1166,10 +1399,14 @@ namespace superbblas {
             using Value =
                 std::tuple<vector<MpiInt, Cpu>,                        // counts
                            vector<MpiInt, Cpu>,                        // displ
+                           std::vector<int>,                           // peers
                            std::vector<IndicesT<IndexType, XPUbuff>>,  // indices for the buffer
                            Range_IndicesT_tmpl<IndexType, XPU0, XPU1>, // indices
                            std::vector<IndicesT<IndexType, Cpu>>, // number of indices to process
-                           std::vector<std::size_t>>;             // blocksize
+                           std::vector<std::size_t>,              // blocksize
+                           std::vector<std::vector<std::size_t>>, // first index for each rank
+                           std::vector<std::vector<std::size_t>>,  // first group for each rank
+                           std::vector<std::vector<std::ptrdiff_t>>>; // first consecutive element
             struct cache_tag {};
             auto cache = getCache<Key, Value, TupleHash<Key>, cache_tag>(xpu);
 
@@ -1192,10 +1429,13 @@ namespace superbblas {
             // If they are not, compute the permutation vectors
             vector<MpiInt, Cpu> counts;
             vector<MpiInt, Cpu> displ;
+            std::vector<int> peers;
             std::vector<IndicesT<IndexType, XPUbuff>> indices_buf;
             Range_IndicesT_tmpl<IndexType, XPU0, XPU1> indices;
             std::vector<IndicesT<IndexType, Cpu>> indices_groups;
             std::vector<std::size_t> blocksize;
+            std::vector<std::vector<std::size_t>> rank_disp, rank_groups_disp;
+            std::vector<std::vector<std::ptrdiff_t>> rank_contiguous;
             if (it == cache.end()) {
                 counts = vector<MpiInt, Cpu>(comm.nprocs, Cpu{});
                 displ = vector<MpiInt, Cpu>(comm.nprocs, Cpu{});
@@ -1222,8 +1462,15 @@ namespace superbblas {
                 std::vector<std::vector<IndexType>> disp_bufs(toReceive.size());
                 std::size_t disp_buf = 0;
                 const std::size_t num_T = MpiTypeSize / sizeof(T);
-                for (std::size_t rank = 0; rank < comm.nprocs; ++rank) {
-                    if (rank == comm.rank) continue;
+                rank_disp.resize(toReceive.size(), std::vector<std::size_t>(comm.nprocs + 1));
+                rank_groups_disp.resize(toReceive.size(),
+                                        std::vector<std::size_t>(comm.nprocs + 1));
+                for (std::size_t rank = 0; rank <= comm.nprocs; ++rank) {
+                    for (std::size_t dstrange = 0; dstrange < toReceive.size(); ++dstrange) {
+                        rank_disp[dstrange][rank] = num_elems[dstrange];
+                        rank_groups_disp[dstrange][rank] = indices0_groups[dstrange].size();
+                    }
+                    if (rank == comm.rank || rank == comm.nprocs) continue;
 
                     const std::size_t srcrange1 =
                         (toReceive.size() > 0 ? toReceive[0][rank].size() : 0);
@@ -1269,9 +1516,11 @@ namespace superbblas {
                 displ[0] = 0;
                 for (std::size_t i = 1; i < comm.nprocs; ++i)
                     displ[i] = displ[i - 1] + counts[i - 1];
+                peers = get_peers(counts);
 
                 // Create the permutation for the buffer
                 indices_buf = std::vector<IndicesT<IndexType, XPUbuff>>(toReceive.size());
+                std::vector<IndicesT<IndexType, Cpu>> indices_buf_cpus(toReceive.size());
                 for (unsigned int irange = 0; irange < toReceive.size(); ++irange) {
                     IndicesT<IndexType, Cpu> indices_buf_cpu(num_elems[irange], Cpu{});
                     for (std::size_t i = 0, i_buf = 0; i < indices0_groups[irange].size(); ++i) {
@@ -1282,10 +1531,12 @@ namespace superbblas {
                                 disp_buf + (num_blocks++) * blocksize[irange];
                     }
                     indices_buf[irange] = makeSure(indices_buf_cpu, xpu);
+                    indices_buf_cpus[irange] = indices_buf_cpu;
                 }
 
                 // Concatenate all indices into a single permutation vector
                 indices = Range_IndicesT_tmpl<IndexType, XPU0, XPU1>();
+                rank_contiguous.resize(toReceive.size());
                 indices.first.resize(v.first.size());
                 indices.second.resize(v.second.size());
                 for (unsigned int irange = 0; irange < toReceive.size(); ++irange) {
@@ -1296,6 +1547,9 @@ namespace superbblas {
                                           indices_cpu.data() + i0, Cpu{});
                         i0 += indices.size();
                     }
+                    rank_contiguous[irange] =
+                        get_contiguous_ranks(indices_cpu, indices_buf_cpus[irange],
+                                             rank_disp[irange], blocksize[irange]);
                     for (unsigned int i = 0; i < v.first.size(); ++i)
                         if (v.first[i].componentId == irange)
                             indices.first[i] = {irange, makeSure(indices_cpu, v.first[i].it.ctx())};
@@ -1326,17 +1580,23 @@ namespace superbblas {
                 if (!using_mask) {
                     std::size_t size = storageSize(indices_buf) + storageSize(indices);
                     cache.insert(key,
-                                 Value{archive(counts), archive(displ), archive(indices_buf),
-                                       archive(indices), archive(indices_groups), blocksize},
+                                 Value{archive(counts), archive(displ), peers,
+                                       archive(indices_buf), archive(indices),
+                                       archive(indices_groups), blocksize, rank_disp,
+                                       rank_groups_disp, rank_contiguous},
                                  size);
                 }
             } else {
                 counts = std::get<0>(it->second.value);
                 displ = std::get<1>(it->second.value);
-                indices_buf = std::get<2>(it->second.value);
-                indices = std::get<3>(it->second.value);
-                indices_groups = std::get<4>(it->second.value);
-                blocksize = std::get<5>(it->second.value);
+                peers = std::get<2>(it->second.value);
+                indices_buf = std::get<3>(it->second.value);
+                indices = std::get<4>(it->second.value);
+                indices_groups = std::get<5>(it->second.value);
+                blocksize = std::get<6>(it->second.value);
+                rank_disp = std::get<7>(it->second.value);
+                rank_groups_disp = std::get<8>(it->second.value);
+                rank_contiguous = std::get<9>(it->second.value);
             }
 
             std::size_t buf_count = (displ.back() + counts.back()) * (MpiTypeSize / sizeof(T));
@@ -1344,65 +1604,207 @@ namespace superbblas {
             // NOTE: MPI calls may have problems passing null pointers as buffers
             if (buf_count == 0) buf_count = MpiTypeSize / sizeof(T);
 
-            // Allocate the buffer
-            vector<T, XPUbuff> buf(buf_count, xpu, doCacheAllocExternal, MpiTypeSize);
+            // Allocate the buffer unless one is given
+            if (buf.size() == 0)
+                buf = vector<T, XPUbuff>(buf_count, xpu, doCacheAllocExternal, MpiTypeSize);
+            else if (buf.size() < buf_count)
+                throw std::runtime_error("prepare_unpack: the given buffer is too small");
 
             return UnpackedValues<IndexType, T, XPUbuff, XPU0, XPU1>{
-                buf, counts, displ, indices_buf, indices, indices_groups, blocksize};
+                buf,     counts,         displ,     peers,     indices_buf,
+                indices, indices_groups, blocksize, rank_disp, rank_groups_disp,
+                rank_contiguous};
         }
 
         /// Unpack and copy packed tensors from a MPI communication
         /// \param r: packed subtensors
-        /// \param toReceive: list of tensor ranges to receive
         /// \param v: data for the destination tensor
-        /// \param comm: communication
-        /// \param co: coordinate linearization order
         /// \param alpha: factor applied to packed tensors
+        /// \param rank: if nonnegative, only unpack the elements received from this rank
+        /// \param elems0: if given, only unpack the elements from elems0[irange] on each component
+        /// \param elems1: if given, only unpack the elements up to elems1[irange] on each component
 
         template <typename IndexType, std::size_t Nd, typename T, typename XPUbuff, typename XPU0,
                   typename XPU1, typename EWOP>
         void unpack(const UnpackedValues<IndexType, T, XPUbuff, XPU0, XPU1> &r,
                     const Components_tmpl<Nd, T, XPU0, XPU1> &v, EWOP,
-                    typename elem<T>::type alpha) {
+                    typename elem<T>::type alpha, int rank = -1,
+                    const std::vector<std::size_t> *elems0 = nullptr,
+                    const std::vector<std::size_t> *elems1 = nullptr) {
 
             tracker<XPUbuff> _t(std::string("unpack from ") + platformToStr(r.buf.ctx()),
                                 r.buf.ctx());
 
             // Transfer the buffer to the destination device
             for (unsigned int irange = 0; irange < r.indices_buf.size(); ++irange) {
+                // Get the range of indices and groups of indices to process
+                const auto &groups = r.indices_groups[irange];
+                const std::size_t i0 = (rank < 0 ? 0 : r.rank_disp[irange][rank]);
+                const std::size_t i1 =
+                    (rank < 0 ? r.indices_buf[irange].size() : r.rank_disp[irange][rank + 1]);
+                const bool single_group = (groups.size() == 1);
+                const std::size_t g0 =
+                    (rank < 0 || single_group ? 0 : r.rank_groups_disp[irange][rank]);
+                const std::size_t g1 = (rank < 0 || single_group
+                                            ? groups.size()
+                                            : r.rank_groups_disp[irange][rank + 1]);
+                const std::size_t e0 = (elems0 ? std::max(i0, (*elems0)[irange]) : i0);
+                const std::size_t e1 = (elems1 ? std::min(i1, (*elems1)[irange]) : i1);
+                if (e0 >= e1) continue;
+
                 for (unsigned int j = 0; j < r.indices.first.size(); ++j) {
                     if (r.indices.first[j].componentId != irange) continue;
-                    IndexType disp = 0;
-                    for (unsigned int i = 0, i1 = r.indices_groups[irange].size(); i < i1; ++i) {
-                        copy_n_blocking<IndexType, T, T>(
-                            alpha, r.buf.data(), r.buf.ctx(), r.blocksize[irange],
-                            r.indices_buf[irange].data() + disp, r.indices_buf[irange].ctx(),
-                            r.indices_groups[irange][i], v.first[j].it.data(), v.first[j].it.ctx(),
-                            r.indices.first[j].it.data() + disp, r.indices.first[j].it.ctx(),
-                            EWOP{});
-                        disp += r.indices_groups[irange][i];
+                    std::size_t disp = i0;
+                    for (std::size_t i = g0; i < g1; ++i) {
+                        const std::size_t n = (single_group ? i1 - i0 : groups[i]);
+                        const std::size_t d0 = std::max(disp, e0), d1 = std::min(disp + n, e1);
+                        if (d0 < d1)
+                            copy_n_blocking<IndexType, T, T>(
+                                alpha, r.buf.data(), r.buf.ctx(), r.blocksize[irange],
+                                r.indices_buf[irange].data() + d0, r.indices_buf[irange].ctx(),
+                                d1 - d0, v.first[j].it.data(), v.first[j].it.ctx(),
+                                r.indices.first[j].it.data() + d0, r.indices.first[j].it.ctx(),
+                                EWOP{});
+                        disp += n;
                     }
-                    _t.memops += (double)sizeof(T) * 2.0 * r.indices.first[j].it.size() *
-                                 r.blocksize[irange];
+                    _t.memops += (double)sizeof(T) * 2.0 * (e1 - e0) * r.blocksize[irange];
                 }
                 for (unsigned int j = 0; j < r.indices.second.size(); ++j) {
                     if (r.indices.second[j].componentId != irange) continue;
-                    IndexType disp = 0;
-                    for (unsigned int i = 0, i1 = r.indices_groups[irange].size(); i < i1; ++i) {
-                        copy_n_blocking<IndexType, T, T>(
-                            alpha, r.buf.data(), r.buf.ctx(), r.blocksize[irange],
-                            r.indices_buf[irange].data() + disp, r.indices_buf[irange].ctx(),
-                            r.indices_groups[irange][i], v.second[j].it.data(),
-                            v.second[j].it.ctx(), r.indices.second[j].it.data() + disp,
-                            r.indices.second[j].it.ctx(), EWOP{});
-                        disp += r.indices_groups[irange][i];
+                    std::size_t disp = i0;
+                    for (std::size_t i = g0; i < g1; ++i) {
+                        const std::size_t n = (single_group ? i1 - i0 : groups[i]);
+                        const std::size_t d0 = std::max(disp, e0), d1 = std::min(disp + n, e1);
+                        if (d0 < d1)
+                            copy_n_blocking<IndexType, T, T>(
+                                alpha, r.buf.data(), r.buf.ctx(), r.blocksize[irange],
+                                r.indices_buf[irange].data() + d0, r.indices_buf[irange].ctx(),
+                                d1 - d0, v.second[j].it.data(), v.second[j].it.ctx(),
+                                r.indices.second[j].it.data() + d0, r.indices.second[j].it.ctx(),
+                                EWOP{});
+                        disp += n;
                     }
-                    _t.memops += (double)sizeof(T) * 2.0 * r.indices.second[j].it.size() *
-                                 r.blocksize[irange];
+                    _t.memops += (double)sizeof(T) * 2.0 * (e1 - e0) * r.blocksize[irange];
                 }
             }
         }
 
+        /// Find the only component with elements to send to a rank if they are consecutive
+        /// \param pi: indices for each component
+        /// \param v: components
+        /// \param rank: destination rank
+        /// \param ptr: (input/output) first element to send
+        /// \param n: (input/output) number of elements to send
+        /// \return: false if some elements cannot be sent directly from the component
+
+        template <typename IndexType, std::size_t Nd, typename T, typename XPU, typename XPUbuff>
+        bool
+        find_contiguous_source(const std::vector<PackComponentIndices<IndexType, XPU, XPUbuff>> &pi,
+                               const std::vector<Component<Nd, const T, XPU>> &v, int rank,
+                               const T *&ptr, std::size_t &n) {
+            for (unsigned int i = 0; i < v.size(); ++i) {
+                const std::size_t ni =
+                    (pi[i].rank_disp[rank + 1] - pi[i].rank_disp[rank]) * pi[i].blocksize;
+                if (ni == 0) continue;
+                // NOTE: only host memory without pending operations is passed to MPI
+                if (n > 0 || !std::is_same<XPU, Cpu>::value || pi[i].rank_contiguous[rank] < 0)
+                    return false;
+                ptr = v[i].it.data() + pi[i].rank_contiguous[rank];
+                n = ni;
+            }
+            return true;
+        }
+
+        /// Return the first element to send to a rank directly from the origin tensor, or null if
+        /// the message should be packed
+        /// \param pi: indices returned by `get_pack_indices`
+        /// \param v: vector containing the values to send
+        /// \param r: buffer for the packed values
+        /// \param rank: destination rank
+
+        template <typename IndexType, typename Q, std::size_t Nd0, typename T, typename XPU0,
+                  typename XPU1, typename XPUbuff,
+                  typename std::enable_if<std::is_same<T, Q>::value, bool>::type = true>
+        const Q *get_contiguous_source(const PackIndices<IndexType, XPU0, XPU1, XPUbuff> &pi,
+                                       const Components_tmpl<Nd0, const T, XPU0, XPU1> &v,
+                                       const PackedValues<Q, XPUbuff> &r, int rank) {
+            const T *ptr = nullptr;
+            std::size_t n = 0;
+            if (!getUseMPIZeroCopy() || r.counts[rank] == 0 ||
+                !find_contiguous_source(pi.first, v.first, rank, ptr, n) ||
+                !find_contiguous_source(pi.second, v.second, rank, ptr, n))
+                return nullptr;
+
+            // The message size is a multiple of `MpiTypeSize`, so avoid reading beyond the elements
+            if (n * sizeof(Q) != (std::size_t)r.counts[rank] * MpiTypeSize) return nullptr;
+            return ptr;
+        }
+
+        template <typename IndexType, typename Q, std::size_t Nd0, typename T, typename XPU0,
+                  typename XPU1, typename XPUbuff,
+                  typename std::enable_if<!std::is_same<T, Q>::value, bool>::type = true>
+        const Q *get_contiguous_source(const PackIndices<IndexType, XPU0, XPU1, XPUbuff> &,
+                                       const Components_tmpl<Nd0, const T, XPU0, XPU1> &,
+                                       const PackedValues<Q, XPUbuff> &, int) {
+            return nullptr;
+        }
+
+        /// Find the only component receiving elements from a rank if they are consecutive
+        /// \param indices: indices of the destination elements for each component
+        /// \param v: components
+        /// \param irange: component index
+        /// \param disp: first destination element
+        /// \param ptr: (input/output) first element to receive
+
+        template <typename IndexType, std::size_t Nd, typename T, typename XPU>
+        bool find_contiguous_destination(const std::vector<IndicesT_tmpl<IndexType, XPU>> &indices,
+                                         const std::vector<Component<Nd, T, XPU>> &v,
+                                         unsigned int irange, std::ptrdiff_t disp, T *&ptr) {
+            for (unsigned int j = 0; j < indices.size(); ++j) {
+                if (indices[j].componentId != irange) continue;
+                if (ptr || !std::is_same<XPU, Cpu>::value) return false;
+                ptr = v[j].it.data() + disp;
+            }
+            return true;
+        }
+
+        /// Return the first element to receive from a rank directly on the destination tensor,
+        /// or null if the message should be unpacked
+        /// \param r: buffer and indices returned by `prepare_unpack`
+        /// \param v: data for the destination tensor
+        /// \param alpha: factor applied to packed tensors
+        /// \param rank: origin rank
+
+        template <typename IndexType, std::size_t Nd, typename T, typename XPUbuff, typename XPU0,
+                  typename XPU1, typename EWOP>
+        T *get_contiguous_destination(const UnpackedValues<IndexType, T, XPUbuff, XPU0, XPU1> &r,
+                                      const Components_tmpl<Nd, T, XPU0, XPU1> &v, EWOP,
+                                      typename elem<T>::type alpha, int rank) {
+            if (!getUseMPIZeroCopy() || !std::is_same<EWOP, EWOp::Copy>::value ||
+                alpha != typename elem<T>::type{1} || r.counts[rank] == 0)
+                return nullptr;
+
+            T *ptr = nullptr;
+            std::size_t n = 0;
+            for (unsigned int irange = 0; irange < r.indices_buf.size(); ++irange) {
+                const std::size_t ni =
+                    (r.rank_disp[irange][rank + 1] - r.rank_disp[irange][rank]) *
+                    r.blocksize[irange];
+                if (ni == 0) continue;
+                const std::ptrdiff_t disp = r.rank_contiguous[irange][rank];
+                if (n > 0 || disp < 0 ||
+                    !find_contiguous_destination(r.indices.first, v.first, irange, disp, ptr) ||
+                    !find_contiguous_destination(r.indices.second, v.second, irange, disp, ptr) ||
+                    !ptr)
+                    return nullptr;
+                n = ni;
+            }
+
+            // The message size is a multiple of `MpiTypeSize`, so avoid writing beyond the elements
+            if (n * sizeof(T) != (std::size_t)r.counts[rank] * MpiTypeSize) return nullptr;
+            return ptr;
+        }
+
         /// Return a counter, used by `send_receive`
 
         inline std::size_t &getSendReceiveCallNumer() {
@@ -1410,6 +1812,218 @@ namespace superbblas {
             return call_number;
         }
 
+        /// Asynchronous sending and receiving overlapping packing, communication and unpacking
+        /// \param o0: dimension labels for the origin tensor
+        /// \param toSend: list of tensor ranges to be sent for each component
+        /// \param v0: origin data to send
+        /// \param xpubuff0: context to hold the mpi sender buffer
+        /// \param o1: dimension labels for the destination tensor
+        /// \param toReceive: list of tensor ranges to receive
+        /// \param xpubuff1: context to hold the mpi receiver buffer
+        /// \param v1: destination data
+        /// \param comm: communication
+        /// \param co: coordinate linearization order
+        /// \param alpha: factor applied to sending tensors
+        /// \param call_number: annotation to pair this call with the returned lambda
+        ///
+        /// NOTE: the messages are split into chunks, see `getMPIPipelineChunkSize`. All receives
+        /// are posted first; then the message for each process is packed and its chunks are sent
+        /// while the previous ones are in flight; and each chunk is unpacked as soon as it and the
+        /// previous chunks from the same process arrive.
+
+        template <typename IndexType, typename XPUbuff0, typename XPUbuff1, std::size_t Nd0,
+                  std::size_t Nd1, typename T, typename Q, typename XPU0, typename XPU1,
+                  typename EWOP>
+        Request send_receive_pipelined(const Order<Nd0> &o0,
+                                       const Range_proc_range_ranges<Nd0> &toSend,
+                                       const Components_tmpl<Nd0, const T, XPU0, XPU1> &v0,
+                                       XPUbuff0 xpubuff0, const Order<Nd1> &o1,
+                                       const Range_proc_range_ranges<Nd1> &toReceive,
+                                       const Components_tmpl<Nd1, Q, XPU0, XPU1> &v1,
+                                       XPUbuff1 xpubuff1, MpiComm comm, EWOP, CoorOrder co,
+                                       typename elem<T>::type alpha, std::size_t call_number) {
+
+            tracker<Cpu> _t("packing", Cpu{});
+
+            // Prepare the buffers and the indices for packing and unpacking
+            UnpackedValues<IndexType, Q, XPUbuff1, XPU0, XPU1> v1ToReceive =
+                prepare_unpack<IndexType>(toReceive, v1, xpubuff1, comm, co, EWOP{});
+            PackedValues<Q, XPUbuff0> v0ToSend = prepare_pack<Q>(toSend, comm, xpubuff0);
+            const auto pack_indices =
+                get_pack_indices<IndexType>(toSend, v0, o0, o1, comm, co, v0ToSend);
+            _t.stop();
+
+            static MPI_Datatype dtype = get_mpi_datatype();
+            const int tag = 0;
+            const unsigned int T_num = MpiTypeSize / sizeof(Q);
+            const std::size_t chunk_count =
+                getMPIPipelineChunkSize() == 0
+                    ? (std::size_t)std::numeric_limits<MpiInt>::max()
+                    : std::max(getMPIPipelineChunkSize() / MpiTypeSize, (std::size_t)1);
+
+            // Post the receives of all chunks; the contiguous messages are received directly on
+            // v1. The requests recv_first[i] up to recv_first[i+1] receive the chunks from
+            // recv_ranks[i], which is -1 for the direct receives
+            std::vector<MPI_Request> recv_r;
+            std::vector<std::size_t> recv_first;
+            std::vector<int> recv_ranks;
+            bool some_chunked = false;
+            sync(v1ToReceive.buf.ctx());
+            for (int p : v1ToReceive.peers) {
+                const std::size_t count = v1ToReceive.counts[p];
+                if (count == 0) continue;
+                Q *recv_direct = get_contiguous_destination(v1ToReceive, v1, EWOP{}, Q(alpha), p);
+                Q *ptr = recv_direct ? recv_direct
+                                     : v1ToReceive.buf.data() + v1ToReceive.displ[p] * T_num;
+                recv_first.push_back(recv_r.size());
+                recv_ranks.push_back(recv_direct ? -1 : p);
+                some_chunked |= (!recv_direct && count > chunk_count);
+                for (std::size_t c0 = 0; c0 < count; c0 += chunk_count) {
+                    recv_r.push_back(MPI_REQUEST_NULL);
+                    MPI_check(MPI_Irecv(ptr + c0 * T_num, (int)std::min(chunk_count, count - c0),
+                                        dtype, p, tag, comm.comm, &recv_r.back()));
+                }
+            }
+            recv_first.push_back(recv_r.size());
+
+            // Get the buffer positions of the received elements on the host to find the elements
+            // completed by each chunk; the positions increase for each component and process
+            std::vector<IndicesT<IndexType, Cpu>> indices_buf_cpu;
+            if (some_chunked)
+                for (const auto &indices : v1ToReceive.indices_buf)
+                    indices_buf_cpu.push_back(makeSure(indices, Cpu{}));
+
+            // Pack and send the messages one process at a time, starting with the next rank to
+            // avoid all processes sending to the same process at once
+            std::vector<MPI_Request> send_r;
+            const auto &send_peers = v0ToSend.peers;
+            const std::size_t first_peer =
+                std::upper_bound(send_peers.begin(), send_peers.end(), (int)comm.rank) -
+                send_peers.begin();
+            for (std::size_t i = 0; i < send_peers.size(); ++i) {
+                const int p = send_peers[(first_peer + i) % send_peers.size()];
+                if (v0ToSend.counts[p] == 0) continue;
+                const Q *send_direct = get_contiguous_source(pack_indices, v0, v0ToSend, p);
+                if (!send_direct) {
+                    pack_values(pack_indices, v0, v0ToSend, p);
+                    sync(v0ToSend.buf.ctx());
+                }
+                const Q *ptr =
+                    send_direct ? send_direct : v0ToSend.buf.data() + v0ToSend.displ[p] * T_num;
+                const std::size_t count = v0ToSend.counts[p];
+                for (std::size_t c0 = 0; c0 < count; c0 += chunk_count) {
+                    send_r.push_back(MPI_REQUEST_NULL);
+                    MPI_check(MPI_Isend(ptr + c0 * T_num, (int)std::min(chunk_count, count - c0),
+                                        dtype, p, tag, comm.comm, &send_r.back()));
+                }
+            }
+
+            struct tag_type {}; // For hashing template arguments
+            auto wait_and_unpack = [=]() mutable {
+                // Make sure that all processes wait for the copy operations in the same order
+                if (getDebugLevel() > 0) {
+                    check_consistency(std::make_tuple(std::string("wait for send_receive"),
+                                                      call_number, typeid(tag_type).hash_code()),
+                                      comm);
+                }
+
+                // Unpack the chunks from each process in order as they arrive; next[i] is the
+                // next chunk to unpack from recv_ranks[i], and the elements from elems[i] on
+                // each component are not unpacked yet
+                std::vector<bool> arrived(recv_r.size(), false);
+                std::vector<std::size_t> next(recv_first.begin(), recv_first.end() - 1);
+                std::vector<std::vector<std::size_t>> elems(recv_ranks.size());
+                for (std::size_t i = 0; i < recv_r.size(); ++i) {
+                    int idx = 0;
+                    {
+                        tracker<Cpu> _t("MPI wait", Cpu{});
+                        MPI_check(MPI_Waitany((int)recv_r.size(), recv_r.data(), &idx,
+                                              MPI_STATUS_IGNORE));
+                    }
+                    arrived[idx] = true;
+                    const std::size_t ip =
+                        std::upper_bound(recv_first.begin(), recv_first.end(), (std::size_t)idx) -
+                        recv_first.begin() - 1;
+                    const int p = recv_ranks[ip];
+                    if (p < 0) continue; // received directly on v1
+                    for (; next[ip] < recv_first[ip + 1] && arrived[next[ip]]; ++next[ip]) {
+                        if (deviceId(v1ToReceive.buf.ctx()) >= 0)
+                            syncLegacyStream(v1ToReceive.buf.ctx());
+                        if (recv_first[ip + 1] - recv_first[ip] == 1) {
+                            unpack(v1ToReceive, v1, EWOP{}, Q(alpha), p);
+                            continue;
+                        }
+
+                        // Unpack the elements ending before the end of the chunk; the last
+                        // chunk completes the remaining elements
+                        const std::size_t nranges = v1ToReceive.indices_buf.size();
+                        if (elems[ip].size() == 0)
+                            for (std::size_t irange = 0; irange < nranges; ++irange)
+                                elems[ip].push_back(v1ToReceive.rank_disp[irange][p]);
+                        std::vector<std::size_t> elems1(nranges);
+                        const std::size_t k = next[ip] - recv_first[ip];
+                        const std::size_t end =
+                            (v1ToReceive.displ[p] +
+                             std::min((k + 1) * chunk_count, (std::size_t)v1ToReceive.counts[p])) *
+                            T_num;
+                        for (std::size_t irange = 0; irange < nranges; ++irange) {
+                            const IndexType *pos = indices_buf_cpu[irange].data();
+                            const std::size_t bs = v1ToReceive.blocksize[irange];
+                            elems1[irange] =
+                                std::partition_point(
+                                    pos + elems[ip][irange],
+                                    pos + v1ToReceive.rank_disp[irange][p + 1],
+                                    [=](IndexType i) { return (std::size_t)i + bs <= end; }) -
+                                pos;
+                        }
+                        unpack(v1ToReceive, v1, EWOP{}, Q(alpha), p, &elems[ip], &elems1);
+                        elems[ip] = elems1;
+                    }
+                }
+
+                // Wait for the sending to finish
+                if (send_r.size() > 0) {
+                    tracker<Cpu> _t("MPI wait", Cpu{});
+                    MPI_check(MPI_Waitall((int)send_r.size(), send_r.data(), MPI_STATUS_IGNORE));
+                }
+                v0ToSend.buf.clear();
+            };
+
+            if (!getUseMPINonBlock()) {
+                wait_and_unpack();
+                return {};
+            }
+            return wait_and_unpack;
+        }
+
+        /// Persistent MPI requests and buffers for a repeated communication pattern
+
+        template <typename T, typename XPUbuff0, typename XPUbuff1> struct SendReceivePlan {
+            /// Buffer for the packed values to send
+            vector<T, XPUbuff0> send_buf;
+            /// Buffer for the values to receive
+            vector<T, XPUbuff1> recv_buf;
+            /// Persistent requests, first the receiving ones and then the sending ones
+            std::vector<MPI_Request> requests;
+            /// Whether the requests have been started and not waited yet
+            bool in_use;
+
+            SendReceivePlan(const vector<T, XPUbuff0> &send_buf,
+                            const vector<T, XPUbuff1> &recv_buf)
+                : send_buf(send_buf), recv_buf(recv_buf), in_use(false) {}
+
+            ~SendReceivePlan() {
+                int finalized = 0;
+                MPI_Finalized(&finalized);
+                if (finalized) return;
+                for (MPI_Request &r : requests)
+                    if (r != MPI_REQUEST_NULL) MPI_Request_free(&r);
+            }
+
+            SendReceivePlan(const SendReceivePlan &) = delete;
+            SendReceivePlan &operator=(const SendReceivePlan &) = delete;
+        };
+
         /// Asynchronous sending and receiving
         /// \param o0: dimension labels for the origin tensor
         /// \param toSend: list of tensor ranges to be sent for each component
@@ -1422,6 +2036,10 @@ namespace superbblas {
         /// \param comm: communication
         /// \param co: coordinate linearization order
         /// \param alpha: factor applied to sending tensors
+        /// \param sparse_comms: whether all processes communicate with a few others
+        ///
+        /// NOTE: if `getUseMPIPersistent()`, the buffers and the MPI requests are kept in a
+        /// cache and reused by later calls with the same communication pattern.
 
         template <typename IndexType, typename XPUbuff0, typename XPUbuff1, std::size_t Nd0,
                   std::size_t Nd1, typename T, typename Q, typename XPU0, typename XPU1,
@@ -1430,7 +2048,8 @@ namespace superbblas {
                              const Components_tmpl<Nd0, const T, XPU0, XPU1> &v0, XPUbuff0 xpubuff0,
                              const Order<Nd1> &o1, const Range_proc_range_ranges<Nd1> &toReceive,
                              const Components_tmpl<Nd1, Q, XPU0, XPU1> &v1, XPUbuff1 xpubuff1,
-                             MpiComm comm, EWOP, CoorOrder co, typename elem<T>::type alpha) {
+                             MpiComm comm, EWOP, CoorOrder co, typename elem<T>::type alpha,
+                             bool sparse_comms) {
 
             if (comm.nprocs <= 1) return [] {};
 
@@ -1444,13 +2063,93 @@ namespace superbblas {
                                   comm);
             }
 
+            if (getUseMPIPipeline())
+                return send_receive_pipelined<IndexType>(o0, toSend, v0, xpubuff0, o1, toReceive,
+                                                         v1, xpubuff1, comm, EWOP{}, co, alpha,
+                                                         call_number);
+
             tracker<Cpu> _t("packing", Cpu{});
 
-            // Pack v0 and prepare for receiving data from other processes
+            // Look for a persistent plan for this communication pattern; masks change the
+            // amount of data to send and receive, so plans are not used in that case
+            using Plan = SendReceivePlan<Q, XPUbuff0, XPUbuff1>;
+            std::shared_ptr<Plan> plan;
+            bool new_plan = false;
+            bool use_mask = false;
+            for (const auto &c : v0.first) use_mask |= (c.mask_it.size() > 0);
+            for (const auto &c : v0.second) use_mask |= (c.mask_it.size() > 0);
+            for (const auto &c : v1.first) use_mask |= (c.mask_it.size() > 0);
+            for (const auto &c : v1.second) use_mask |= (c.mask_it.size() > 0);
+            const bool use_plan = getUseMPIPersistent() && !use_mask;
+            using Key = std::tuple<Range_proc_range_ranges<Nd0>, Range_proc_range_ranges<Nd1>,
+                                   int, int, MPI_Comm>;
+            struct cache_tag {};
+            // Charge the plan to the cache of the device holding the buffers; the send buffer
+            // decides unless it is on the host
+            auto plan_cache =
+                deviceId(xpubuff0) >= 0 || deviceId(xpubuff1) < 0
+                    ? getCache<Key, std::shared_ptr<Plan>, TupleHash<Key>, cache_tag>(xpubuff0)
+                    : getCache<Key, std::shared_ptr<Plan>, TupleHash<Key>, cache_tag>(xpubuff1);
+            const Key plan_key{toSend, toReceive, deviceId(xpubuff0), deviceId(xpubuff1),
+                               comm.comm};
+            if (use_plan) {
+                auto it = plan_cache.find(plan_key);
+                if (it == plan_cache.end()) {
+                    new_plan = true;
+                } else if (!it->second.value->in_use) {
+                    plan = it->second.value;
+                }
+            }
+
+            // Alltoall is a collective; it cannot be mixed with the point-to-point persistent or
+            // pipelined requests other processes may be using. Also, avoid it when every process
+            // talks to a few others, as the point-to-point calls are limited to the actual peers
+            const bool use_alltoall = getUseAlltoall() && !getUseMPIPersistent() &&
+                                      !getUseMPIPipeline() && !sparse_comms;
+
+            // Prepare for sending v0 and receiving data from other processes
             PackedValues<Q, XPUbuff0> v0ToSend =
-                pack<IndexType, Q>(toSend, v0, o0, o1, comm, xpubuff0, co);
+                prepare_pack<Q>(toSend, comm, xpubuff0,
+                                plan ? plan->send_buf : vector<Q, XPUbuff0>());
+            const auto pack_indices =
+                get_pack_indices<IndexType>(toSend, v0, o0, o1, comm, co, v0ToSend);
             UnpackedValues<IndexType, Q, XPUbuff1, XPU0, XPU1> v1ToReceive =
-                prepare_unpack<IndexType>(toReceive, v1, xpubuff1, comm, co, EWOP{});
+                prepare_unpack<IndexType>(toReceive, v1, xpubuff1, comm, co, EWOP{},
+                                          plan ? plan->recv_buf : vector<Q, XPUbuff1>());
+
+            // Send and receive the contiguous messages directly from the tensors on the
+            // point-to-point calls, and pack the rest; send_direct[i] and recv_direct[i] are for
+            // the i-th peer on `v0ToSend.peers` and `v1ToReceive.peers` respectively
+            const std::vector<int> &send_peers = v0ToSend.peers;
+            const std::vector<int> &recv_peers = v1ToReceive.peers;
+            std::vector<const Q *> send_direct(send_peers.size(), nullptr);
+            std::vector<Q *> recv_direct(recv_peers.size(), nullptr);
+            bool some_send_direct = false, some_recv_direct = false;
+            if (!plan && !new_plan && !use_alltoall) {
+                for (std::size_t i = 0; i < send_peers.size(); ++i)
+                    some_send_direct |= (send_direct[i] = get_contiguous_source(
+                                             pack_indices, v0, v0ToSend, send_peers[i])) != nullptr;
+                for (std::size_t i = 0; i < recv_peers.size(); ++i)
+                    some_recv_direct |=
+                        (recv_direct[i] = get_contiguous_destination(
+                             v1ToReceive, v1, EWOP{}, Q(alpha), recv_peers[i])) != nullptr;
+            }
+            if (!some_send_direct) {
+                pack_values(pack_indices, v0, v0ToSend);
+            } else {
+                for (std::size_t i = 0; i < send_peers.size(); ++i)
+                    if (!send_direct[i]) pack_values(pack_indices, v0, v0ToSend, send_peers[i]);
+            }
+            auto unpack_v1 = [=]() {
+                if (deviceId(v1ToReceive.buf.ctx()) >= 0) syncLegacyStream(v1ToReceive.buf.ctx());
+                if (!some_recv_direct) {
+                    unpack(v1ToReceive, v1, EWOP{}, Q(alpha));
+                } else {
+                    for (std::size_t i = 0; i < v1ToReceive.peers.size(); ++i)
+                        if (!recv_direct[i])
+                            unpack(v1ToReceive, v1, EWOP{}, Q(alpha), v1ToReceive.peers[i]);
+                }
+            };
 
             // Do a ton of checking
             static MPI_Datatype dtype = get_mpi_datatype();
@@ -1499,8 +2198,50 @@ namespace superbblas {
                 getStream(v0ToSend.buf.ctx()) != getStream(v1ToReceive.buf.ctx()))
                 sync(v1ToReceive.buf.ctx());
             _t.stop();
-            if (getUseMPINonBlock()) {
-                if (getUseAlltoall()) {
+
+            // Create the persistent requests for a new plan
+            if (new_plan) {
+                tracker<Cpu> _t("MPI create persistent requests", Cpu{});
+                plan = std::make_shared<Plan>(v0ToSend.buf, v1ToReceive.buf);
+                plan->requests.reserve(v1ToReceive.peers.size() + v0ToSend.peers.size());
+                for (int p : v1ToReceive.peers) {
+                    if (v1ToReceive.counts[p] == 0) continue;
+                    plan->requests.push_back(MPI_REQUEST_NULL);
+                    MPI_check(MPI_Recv_init(v1ToReceive.buf.data() + v1ToReceive.displ[p] * T_num,
+                                            v1ToReceive.counts[p], dtype, p, tag, comm.comm,
+                                            &plan->requests.back()));
+                }
+                for (int p : v0ToSend.peers) {
+                    if (v0ToSend.counts[p] == 0) continue;
+                    plan->requests.push_back(MPI_REQUEST_NULL);
+                    MPI_check(MPI_Send_init(v0ToSend.buf.data() + v0ToSend.displ[p] * T_num,
+                                            v0ToSend.counts[p], dtype, p, tag, comm.comm,
+                                            &plan->requests.back()));
+                }
+                plan_cache.insert(plan_key, plan,
+                                  (v0ToSend.buf.size() + v1ToReceive.buf.size()) * sizeof(Q));
+            }
+
+            // Start the persistent requests
+            if (plan) {
+                tracker<Cpu> _t("MPI start persistent", Cpu{});
+                plan->in_use = true;
+                // NOTE: some MPI implementations complain about null pointers for the requests
+                if (plan->requests.size() > 0)
+                    MPI_check(MPI_Startall((int)plan->requests.size(), plan->requests.data()));
+                if (!getUseMPINonBlock()) {
+                    MPI_check(MPI_Waitall((int)plan->requests.size(), plan->requests.data(),
+                                          MPI_STATUS_IGNORE));
+                    plan->in_use = false;
+                    unpack_v1();
+                    return {};
+                }
+            }
+
+            if (plan) {
+                // The requests were already started
+            } else if (getUseMPINonBlock()) {
+                if (use_alltoall) {
                     tracker<Cpu> _t("MPI ialltoall", Cpu{});
                     r.resize(1);
                     MPI_check(MPI_Ialltoallv(v0ToSend.buf.data(), v0ToSend.counts.data(),
@@ -1509,24 +2250,30 @@ namespace superbblas {
                                              dtype, comm.comm, &r.front()));
                 } else {
                     tracker<Cpu> _t("MPI isend_recv", Cpu{});
-                    r.reserve(comm.nprocs * 2);
-                    for (unsigned int p = 0; p < comm.nprocs; ++p) {
+                    r.reserve(v1ToReceive.peers.size() + v0ToSend.peers.size());
+                    for (std::size_t i = 0; i < recv_peers.size(); ++i) {
+                        const int p = recv_peers[i];
                         if (v1ToReceive.counts[p] == 0) continue;
                         r.push_back(MPI_REQUEST_NULL);
-                        MPI_check(MPI_Irecv(v1ToReceive.buf.data() + v1ToReceive.displ[p] * T_num,
+                        MPI_check(MPI_Irecv(recv_direct[i] ? recv_direct[i]
+                                                           : v1ToReceive.buf.data() +
+                                                                 v1ToReceive.displ[p] * T_num,
                                             v1ToReceive.counts[p], dtype, p, tag, comm.comm,
                                             &r.back()));
                     }
-                    for (unsigned int p = 0; p < comm.nprocs; ++p) {
+                    for (std::size_t i = 0; i < send_peers.size(); ++i) {
+                        const int p = send_peers[i];
                         if (v0ToSend.counts[p] == 0) continue;
                         r.push_back(MPI_REQUEST_NULL);
-                        MPI_check(MPI_Isend(v0ToSend.buf.data() + v0ToSend.displ[p] * T_num,
+                        MPI_check(MPI_Isend(send_direct[i] ? send_direct[i]
+                                                           : v0ToSend.buf.data() +
+                                                                 v0ToSend.displ[p] * T_num,
                                             v0ToSend.counts[p], dtype, p, tag, comm.comm,
                                             &r.back()));
                     }
                 }
             } else {
-                if (getUseAlltoall()) {
+                if (use_alltoall) {
                     tracker<Cpu> _t("MPI alltoall", Cpu{});
                     MPI_check(MPI_Alltoallv(v0ToSend.buf.data(), v0ToSend.counts.data(),
                                             v0ToSend.displ.data(), dtype, v1ToReceive.buf.data(),
@@ -1534,16 +2281,27 @@ namespace superbblas {
                                             dtype, comm.comm));
                 } else {
                     tracker<Cpu> _t("MPI send_recv", Cpu{});
-                    for (unsigned int p = 0; p < comm.nprocs; ++p) {
+                    // Go over the union of the sorted peer lists
+                    for (std::size_t i = 0, j = 0;
+                         i < send_peers.size() || j < recv_peers.size();) {
+                        const int ps = (i < send_peers.size() ? send_peers[i] : (int)comm.nprocs);
+                        const int pr = (j < recv_peers.size() ? recv_peers[j] : (int)comm.nprocs);
+                        const int p = std::min(ps, pr);
+                        const Q *send_ptr = (ps == p && send_direct[i])
+                                                ? send_direct[i]
+                                                : v0ToSend.buf.data() + v0ToSend.displ[p] * T_num;
+                        Q *recv_ptr = (pr == p && recv_direct[j])
+                                          ? recv_direct[j]
+                                          : v1ToReceive.buf.data() + v1ToReceive.displ[p] * T_num;
+                        if (ps == p) ++i;
+                        if (pr == p) ++j;
                         if (v0ToSend.counts[p] == 0 && v1ToReceive.counts[p] == 0) continue;
-                        MPI_check(MPI_Sendrecv(
-                            v0ToSend.buf.data() + v0ToSend.displ[p] * T_num, v0ToSend.counts[p],
-                            dtype, p, tag, v1ToReceive.buf.data() + v1ToReceive.displ[p] * T_num,
-                            v1ToReceive.counts[p], dtype, p, tag, comm.comm, MPI_STATUS_IGNORE));
+                        MPI_check(MPI_Sendrecv(send_ptr, v0ToSend.counts[p], dtype, p, tag,
+                                               recv_ptr, v1ToReceive.counts[p], dtype, p, tag,
+                                               comm.comm, MPI_STATUS_IGNORE));
                     }
                 }
-                if (deviceId(v1ToReceive.buf.ctx()) >= 0) syncLegacyStream(v1ToReceive.buf.ctx());
-                unpack(v1ToReceive, v1, EWOP{}, Q(alpha));
+                unpack_v1();
                 return {};
             }
 
@@ -1560,21 +2318,32 @@ namespace superbblas {
                 // Wait for the MPI communication to finish
                 {
                     tracker<Cpu> _t("MPI wait", Cpu{});
-                    MPI_check(MPI_Waitall((int)r.size(), r.data(), MPI_STATUS_IGNORE));
+                    if (plan) {
+                        MPI_check(MPI_Waitall((int)plan->requests.size(), plan->requests.data(),
+                                              MPI_STATUS_IGNORE));
+                        plan->in_use = false;
+                    } else {
+                        MPI_check(MPI_Waitall((int)r.size(), r.data(), MPI_STATUS_IGNORE));
+                    }
                 }
 
                 // Clear origin buffer
                 v0ToSend.buf.clear();
 
                 // Copy back to v1
-                if (deviceId(v1ToReceive.buf.ctx()) >= 0) syncLegacyStream(v1ToReceive.buf.ctx());
-                unpack(v1ToReceive, v1, EWOP{}, Q(alpha));
+                unpack_v1();
             };
         }
 #endif // SUPERBBLAS_USE_MPI
 
         inline void barrier(SelfComm) {}
 
+        inline int global_max(int v, SelfComm) { return v; }
+
+        template <typename T> std::vector<T> all_gather(const std::vector<T> &v, SelfComm) {
+            return v;
+        }
+
         /// Asynchronous sending and receiving; do nothing for `SelfComm` communicator
         /// \param o0: dimension labels for the origin tensor
         /// \param toSend: list of tensor ranges to be sent for each component
@@ -1587,6 +2356,7 @@ namespace superbblas {
         /// \param comm: communication
         /// \param co: coordinate linearization order
         /// \param alpha: factor applied to sending tensors
+        /// \param sparse_comms: whether all processes communicate with a few others
 
         template <typename IndexType, typename XPUbuff0, typename XPUbuff1, std::size_t Nd0,
                   std::size_t Nd1, typename T, typename Q, typename XPU0, typename XPU1,
@@ -1595,7 +2365,8 @@ namespace superbblas {
                              const Components_tmpl<Nd0, const T, XPU0, XPU1> &v0, XPUbuff0 xpubuff0,
                              const Order<Nd1> &o1, const Range_proc_range_ranges<Nd1> &toReceive,
                              const Components_tmpl<Nd1, Q, XPU0, XPU1> &v1, XPUbuff1 xpubuff1,
-                             SelfComm comm, EWOP, CoorOrder co, typename elem<T>::type alpha) {
+                             SelfComm comm, EWOP, CoorOrder co, typename elem<T>::type alpha,
+                             bool sparse_comms) {
             (void)o0;
             (void)toSend;
             (void)v0;
@@ -1606,6 +2377,7 @@ namespace superbblas {
             (void)xpubuff1;
             (void)co;
             (void)alpha;
+            (void)sparse_comms;
             if (comm.nprocs <= 1) return [] {};
             throw std::runtime_error("Unsupported SelfComm with nprocs > 1");
         }
@@ -1652,6 +2424,7 @@ namespace superbblas {
         /// \param comm: communication
         /// \param co: coordinate linearization order
         /// \param alpha: factor applied to sending tensors
+        /// \param sparse_comms: whether all processes communicate with a few others
         ///
         /// NOTE: choose size_t as the IndexType in case the local volume is too large
 
@@ -1664,7 +2437,8 @@ namespace superbblas {
                                  XPUbuff0 xpubuff0, const Order<Nd1> &o1,
                                  const Range_proc_range_ranges<Nd1> &toReceive,
                                  const Components_tmpl<Nd1, Q, XPU0, XPU1> &v1, XPUbuff1 xpubuff1,
-                                 Comm comm, EWOp, CoorOrder co, typename elem<T>::type alpha) {
+                                 Comm comm, EWOp, CoorOrder co, typename elem<T>::type alpha,
+                                 bool sparse_comms) {
 
             bool use_size_t = false;
             const std::size_t max_IndexType = (std::size_t)std::numeric_limits<IndexType>::max();
@@ -1681,10 +2455,10 @@ namespace superbblas {
 
             if (!use_size_t) {
                 return send_receive<IndexType>(o0, toSend, v0, xpubuff0, o1, toReceive, v1,
-                                               xpubuff1, comm, EWOp{}, co, alpha);
+                                               xpubuff1, comm, EWOp{}, co, alpha, sparse_comms);
             } else {
                 return send_receive<std::size_t>(o0, toSend, v0, xpubuff0, o1, toReceive, v1,
-                                                 xpubuff1, comm, EWOp{}, co, alpha);
+                                                 xpubuff1, comm, EWOp{}, co, alpha, sparse_comms);
             }
         }
 
@@ -1698,6 +2472,7 @@ namespace superbblas {
         /// \param comm: communication
         /// \param co: coordinate linearization order
         /// \param alpha: factor applied to sending tensors
+        /// \param sparse_comms: whether all processes communicate with a few others
 
         template <std::size_t Nd0, std::size_t Nd1, typename T, typename Q, typename XPU0,
                   typename XPU1, typename Comm, typename EWOp>
@@ -1705,7 +2480,7 @@ namespace superbblas {
                              const Components_tmpl<Nd0, const T, XPU0, XPU1> &v0,
                              const Order<Nd1> &o1, const Range_proc_range_ranges<Nd1> &toReceive,
                              const Components_tmpl<Nd1, Q, XPU0, XPU1> &v1, const Comm &comm, EWOp,
-                             CoorOrder co, typename elem<T>::type alpha) {
+                             CoorOrder co, typename elem<T>::type alpha, bool sparse_comms) {
 
             // Whether to allow the use of gpu buffers for the sender/receiver buffers
             static const bool use_mpi_gpu = [] {
@@ -1732,19 +2507,20 @@ namespace superbblas {
                     if (v1.first.size() > 0) {
                         return send_receive_choose_size(o0, toSend, v0, gpu0, o1, toReceive, v1,
                                                         v1.first.front().it.ctx().toCpuPinned(),
-                                                        comm, EWOp{}, co, alpha);
+                                                        comm, EWOp{}, co, alpha, sparse_comms);
                     } else {
                         return send_receive_choose_size(o0, toSend, v0, gpu0, o1, toReceive, v1,
-                                                        Cpu{}, comm, EWOp{}, co, alpha);
+                                                        Cpu{}, comm, EWOp{}, co, alpha,
+                                                        sparse_comms);
                     }
                 } else if (v1.first.size() > 0) {
                     return send_receive_choose_size(o0, toSend, v0, Cpu{}, o1, toReceive, v1,
                                                     v1.first.front().it.ctx().toCpuPinned(), comm,
-                                                    EWOp{}, co, alpha);
+                                                    EWOp{}, co, alpha, sparse_comms);
                 }
 #endif // SUPERBBLAS_USE_GPU
                 return send_receive_choose_size(o0, toSend, v0, Cpu{}, o1, toReceive, v1, Cpu{},
-                                                comm, EWOp{}, co, alpha);
+                                                comm, EWOp{}, co, alpha, sparse_comms);
             }
 
             // Use mpi send/receive buffers on gpu memory
@@ -1769,7 +2545,7 @@ namespace superbblas {
             }
             assert(found_it);
             return send_receive_choose_size(o0, toSend, v0, gpu, o1, toReceive, v1, gpu, comm,
-                                            EWOp{}, co, alpha);
+                                            EWOp{}, co, alpha, sparse_comms);
         }
 
         /// Return a permutation that transform an o0 coordinate into an o1 coordinate
@@ -2198,6 +2974,54 @@ namespace superbblas {
             return false;
         }
 
+        /// Return whether every process sends to and receives from a few other processes
+        /// \param p0: partitioning of the origin tensor in consecutive ranges
+        /// \param from0: first coordinate to copy from the origin tensor
+        /// \param size0: number of elements to copy in each dimension
+        /// \param dim0: dimension size for the origin tensor
+        /// \param o0: dimension labels for the origin tensor
+        /// \param p1: partitioning of the destination tensor in consecutive ranges
+        /// \param from1: coordinate in destination tensor where first coordinate from origin tensor is copied
+        /// \param dim1: dimension size for the destination tensor
+        /// \param o1: dimension labels for the destination tensor
+        ///
+        /// NOTE: the result only depends on the global partitions, so all processes agree on it
+
+        template <std::size_t Nd0, std::size_t Nd1>
+        bool is_communication_sparse(const Proc_ranges<Nd0> &p0, const Coor<Nd0> &from0,
+                                     const Coor<Nd0> &size0, const Coor<Nd0> &dim0,
+                                     const Order<Nd0> &o0, const Proc_ranges<Nd1> &p1,
+                                     const Coor<Nd1> &from1, const Coor<Nd1> &dim1,
+                                     const Order<Nd1> &o1) {
+
+            assert(p0.size() == p1.size());
+            const int mode = getUseMPISparse();
+            if (mode >= 0) return mode > 0;
+
+            tracker<Cpu> _t("detect sparse communications", Cpu{});
+            const std::size_t nprocs = p0.size();
+            const std::size_t max_peers = nprocs / getMPISparseRatio();
+            if (max_peers == 0) return false;
+            Coor<Nd1> perm0 = find_permutation<Nd0, Nd1>(o0, o1);
+            Coor<Nd1> size1 = reorder_coor<Nd0, Nd1>(size0, perm0, 1); // size in the destination
+            Proc_ranges<Nd1> p1_(nprocs);
+            for (unsigned int irank = 0; irank < nprocs; ++irank)
+                p1_[irank] = intersection(p1[irank], from1, size1, dim1);
+            std::vector<std::size_t> num_receives(nprocs, 0);
+            for (unsigned int irank = 0; irank < nprocs; ++irank) {
+                auto fs01 = translate_range(intersection(p0[irank], from0, size0, dim0), from0,
+                                            dim0, from1, dim1, perm0);
+                std::size_t num_sends = 0;
+                for (unsigned int jrank = 0; jrank < nprocs; ++jrank) {
+                    if (irank == jrank) continue;
+                    if (volume(intersection(p1_[jrank], fs01, dim1)) == 0) continue;
+                    if (++num_sends > max_peers || ++num_receives[jrank] > max_peers)
+                        return false;
+                }
+            }
+            return true;
+        }
+
 #ifdef SUPERBBLAS_USE_GPU
         /// Return the gpu components with a parallel context
         /// \param v: components
@@ -2298,7 +3122,7 @@ namespace superbblas {
 
             Range_proc_range_ranges<Nd0> toSend;
             Range_proc_range_ranges<Nd1> toReceive;
-            bool need_comms, zeroout_v1;
+            bool need_comms, zeroout_v1, sparse_comms;
 
             if (std::norm(alpha) != 0) {
                 // Find precomputed pieces on cache
@@ -2310,6 +3134,7 @@ namespace superbblas {
                     Range_proc_range_ranges<Nd1> toReceive;
                     bool need_comms;
                     bool zeroout_v1;
+                    bool sparse_comms;
                 };
                 struct cache_tag {};
                 auto cache = getCache<Key, Value, TupleHash<Key>, cache_tag>(Cpu{});
@@ -2339,16 +3164,23 @@ namespace superbblas {
                         (std::is_same<EWOP, EWOp::Copy>::value &&
                          !has_full_support(p0, from0, size0, dim0, o0, p1, from1, dim1, o1));
 
+                    // Check whether the processes exchange data with a few others
+                    sparse_comms = need_comms && is_communication_sparse(p0, from0, size0, dim0,
+                                                                         o0, p1, from1, dim1, o1);
+
                     // Save the results
-                    cache.insert(key, {toSend, toReceive, need_comms, zeroout_v1}, 0);
+                    cache.insert(key, {toSend, toReceive, need_comms, zeroout_v1, sparse_comms},
+                                 0);
                 } else {
                     toSend = it->second.value.toSend;
                     toReceive = it->second.value.toReceive;
                     need_comms = it->second.value.need_comms;
                     zeroout_v1 = it->second.value.zeroout_v1;
+                    sparse_comms = it->second.value.sparse_comms;
                 }
             } else {
                 need_comms = false;
+                sparse_comms = false;
                 zeroout_v1 = std::is_same<EWOP, EWOp::Copy>::value;
             }
 
@@ -2386,7 +3218,7 @@ namespace superbblas {
             Request mpi_req;
             if (need_comms)
                 mpi_req = send_receive<Nd0, Nd1>(o0, toSend, v0, o1, toReceive, v1, comm, ewop, co,
-                                                 alpha);
+                                                 alpha, sparse_comms);
 
             // Do the local copies
             for (const Component<Nd0, const T, XPU0> &c0 : v0.first) {
@@ -112,6 +112,327 @@ namespace superbblas {
         return use_alltoall;
     }
 
+    /// Return whether to overlap packing, communication and unpacking, which may have been set by the environment variable SB_MPI_PIPELINE
+    /// \return bool: whether to pipeline the communications
+    /// The accepted value in the environment variable SB_MPI_PIPELINE are:
+    ///   * 0: pack all messages, send them, and unpack all of them after all arrive (default)
+    ///   * != 0: pack and send the message for each process one at a time, and unpack each
+    ///     message as soon as it arrives; it takes precedence over SB_MPI_PERSISTENT
+
+    inline bool getUseMPIPipeline() {
+        static bool mpi_pipeline = []() {
+            const char *l = std::getenv("SB_MPI_PIPELINE");
+            if (l) return (0 != std::atoi(l));
+            return false;
+        }();
+        return mpi_pipeline;
+    }
+
+    /// Return the size of the chunks in which the pipelined communications split the messages, which may have been set by the environment variable SB_MPI_PIPELINE_CHUNK
+    /// \return std::size_t: chunk size in bytes
+    /// The accepted value in the environment variable SB_MPI_PIPELINE_CHUNK are:
+    ///   * 0: don't split the messages
+    ///   * > 0: maximum number of bytes of each chunk (default 1 MiB)
+
+    inline std::size_t getMPIPipelineChunkSize() {
+        static std::size_t mpi_pipeline_chunk = []() {
+            const char *l = std::getenv("SB_MPI_PIPELINE_CHUNK");
+            if (l) return (std::size_t)std::max(0ll, std::atoll(l));
+            return (std::size_t)1024 * 1024;
+        }();
+        return mpi_pipeline_chunk;
+    }
+
+    /// Return whether to use point-to-point MPI calls limited to the actual peers instead of MPI_Alltoallv, which may have been set by the environment variable SB_MPI_SPARSE
+    /// \return int: the mode
+    /// The accepted value in the environment variable SB_MPI_SPARSE are:
+    ///   * < 0: use them when all processes communicate with a few others (default)
+    ///   * 0: never
+    ///   * > 0: always
+
+    inline int getUseMPISparse() {
+        static int mpi_sparse = []() {
+            const char *l = std::getenv("SB_MPI_SPARSE");
+            if (l) return std::atoi(l);
+            return -1;
+        }();
+        return mpi_sparse;
+    }
+
+    /// Return the ratio between the number of processes and the maximum number of peers of a process to consider the communication pattern sparse, which may have been set by the environment variable SB_MPI_SPARSE_RATIO
+    /// \return int: the ratio
+    /// The accepted value in the environment variable SB_MPI_SPARSE_RATIO are:
+    ///   * >= 1: a pattern is sparse if no process sends to or receives from more than nprocs/ratio processes (default 4)
+
+    inline int getMPISparseRatio() {
+        static int mpi_sparse_ratio = []() {
+            const char *l = std::getenv("SB_MPI_SPARSE_RATIO");
+            if (l) return std::max(1, std::atoi(l));
+            return 4;
+        }();
+        return mpi_sparse_ratio;
+    }
+
+    /// Return whether to reuse persistent MPI requests for repeated communication patterns, which may have been set by the environment variable SB_MPI_PERSISTENT
+    /// \return bool: whether to use persistent MPI requests
+    /// The accepted value in the environment variable SB_MPI_PERSISTENT are:
+    ///   * 0: create new MPI requests for each communication (default)
+    ///   * != 0: use persistent MPI requests with MPI_Send_init/MPI_Recv_init, and point-to-point
+    ///     communications instead of MPI_Alltoallv
+
+    inline bool getUseMPIPersistent() {
+        static bool mpi_persistent = []() {
+            const char *l = std::getenv("SB_MPI_PERSISTENT");
+            if (l) return (0 != std::atoi(l));
+            return false;
+        }();
+        return mpi_persistent;
+    }
+
+    /// Return whether to send from and receive into the tensors directly when the elements exchanged with a process are consecutive in memory, which may have been set by the environment variable SB_MPI_ZERO_COPY
+    /// \return bool: whether to skip packing and unpacking contiguous messages
+    /// The accepted value in the environment variable SB_MPI_ZERO_COPY are:
+    ///   * 0: always pack and unpack the messages into intermediate buffers (default)
+    ///   * != 0: skip the intermediate buffers for contiguous messages on point-to-point calls;
+    ///     with immediate MPI calls, the origin tensor should not be modified until `wait`
+
+    inline bool getUseMPIZeroCopy() {
+        static bool mpi_zero_copy = []() {
+            const char *l = std::getenv("SB_MPI_ZERO_COPY");
+            if (l) return (0 != std::atoi(l));
+            return false;
+        }();
+        return mpi_zero_copy;
+    }
+
+    /// Return whether to compute the powers of a BSR operator with a single communication round, which may have been set by the environment variable SB_BSR_POWERS
+    /// \return bool: whether to use the matrix-powers kernel
+    /// The accepted value in the environment variable SB_BSR_POWERS are:
+    ///   * 0: exchange the halo of the input vectors before computing each power (default)
+    ///   * != 0: bring the input vectors on a halo as deep as the number of powers and the
+    ///     operator rows on that halo, and compute all powers without communications in between
+
+    inline bool getUseBSRPowers() {
+        static bool bsr_powers = []() {
+            const char *l = std::getenv("SB_BSR_POWERS");
+            if (l) return (0 != std::atoi(l));
+            return false;
+        }();
+        return bsr_powers;
+    }
+
+    /// Return whether to exchange only the halo of the input vectors referenced by a BSR operator, which may have been set by the environment variable SB_BSR_HALO
+    /// \return bool: whether to use the halo exchange on BSR matvecs
+    /// The accepted value in the environment variable SB_BSR_HALO are:
+    ///   * 0: copy the whole domain range of each component before the matvec (default)
+    ///   * != 0: copy the image range of each component and bring the referenced elements out of
+    ///     it into ghost regions, while computing the contributions of the local part
+
+    inline bool getUseBSRHalo() {
+        static bool bsr_halo = []() {
+            const char *l = std::getenv("SB_BSR_HALO");
+            if (l) return (0 != std::atoi(l));
+            return false;
+        }();
+        return bsr_halo;
+    }
+
+    /// Return whether to use the register-blocked microkernels on the builtin CPU BSR matvec, which may have been set by the environment variable SB_BSR_MICROKERNELS
+    /// \return int: the mode
+    /// The accepted value in the environment variable SB_BSR_MICROKERNELS are:
+    ///   * 0: multiply each nonzero block with a BLAS call
+    ///   * 1: use the microkernels on small blocks if their accumulators fit on the registers
+    ///     (default)
+    ///   * > 1: use the microkernels on all blocks with at most 64 rows
+
+    inline int getUseBSRMicrokernels() {
+        static int bsr_microkernels = []() {
+            const char *l = std::getenv("SB_BSR_MICROKERNELS");
+            if (l) return std::max(0, std::atoi(l));
+            return 1;
+        }();
+        return bsr_microkernels;
+    }
+
+    /// Return whether the builtin CPU BSR operators keep a copy of the nonzero values, which may have been set by the environment variable SB_BSR_FIRST_TOUCH
+    /// \return bool: whether to copy the nonzero values
+    /// The accepted value in the environment variable SB_BSR_FIRST_TOUCH are:
+    ///   * 0: use the nonzero values given at creation (default)
+    ///   * != 0: copy the nonzero values with the threads that are going to use them on the
+    ///     matvecs, so that each page is on the memory node of its thread; later changes on the
+    ///     given values are not going to be visible by the operator
+
+    inline bool getUseBSRFirstTouch() {
+        static bool bsr_first_touch = []() {
+            const char *l = std::getenv("SB_BSR_FIRST_TOUCH");
+            if (l) return (0 != std::atoi(l));
+            return false;
+        }();
+        return bsr_first_touch;
+    }
+
+    /// Return whether the builtin CPU BSR operators use the sliced ELL format (SELL-C-sigma), which may have been set by the environment variable SB_BSR_SELL
+    /// \return int: the mode
+    /// The accepted value in the environment variable SB_BSR_SELL are:
+    ///   * < 0: use it on single-vector matvecs when a column of a block takes less than 32 bytes
+    ///     and the padding is at most 10% of the nonzero blocks (default)
+    ///   * 0: never
+    ///   * > 0: always
+
+    inline int getUseBSRSell() {
+        static int bsr_sell = []() {
+            const char *l = std::getenv("SB_BSR_SELL");
+            if (l) return std::atoi(l);
+            return -1;
+        }();
+        return bsr_sell;
+    }
+
+    /// Return the number of SELL chunks on which the block rows are sorted by the number of nonzeros, which may have been set by the environment variable SB_BSR_SELL_SIGMA
+    /// \return int: the number of chunks
+    /// The accepted value in the environment variable SB_BSR_SELL_SIGMA are:
+    ///   * <= 1: don't sort the block rows (default)
+    ///   * > 1: sort the block rows on windows of that many chunks
+
+    inline int getBSRSellSigma() {
+        static int bsr_sell_sigma = []() {
+            const char *l = std::getenv("SB_BSR_SELL_SIGMA");
+            if (l) return std::max(1, std::atoi(l));
+            return 1;
+        }();
+        return bsr_sell_sigma;
+    }
+
+    /// Return whether the builtin CPU BSR matvec uses compressed column indices, which may have been set by the environment variable SB_BSR_COMPRESSED_INDICES
+    /// \return bool: whether to use compressed column indices
+    /// The accepted value in the environment variable SB_BSR_COMPRESSED_INDICES are:
+    ///   * 0: read a full index for each nonzero block (default)
+    ///   * != 0: read an 8-bit or 16-bit index on a table of offsets from the block row for each
+    ///     nonzero block when there are few distinct offsets, as on stencil operators
+
+    inline bool getUseBSRCompressedIndices() {
+        static bool bsr_compressed_indices = []() {
+            const char *l = std::getenv("SB_BSR_COMPRESSED_INDICES");
+            if (l) return (0 != std::atoi(l));
+            return false;
+        }();
+        return bsr_compressed_indices;
+    }
+
+    /// Return the number of columns that the builtin CPU BSR matvec processes at once, which may have been set by the environment variable SB_BSR_RHS_TILE
+    /// \return int: the number of columns
+    /// The accepted value in the environment variable SB_BSR_RHS_TILE are:
+    ///   * < 0: process all columns at once
+    ///   * 0: choose the number from the block size and the last level cache size (default)
+    ///   * > 0: process at most that many columns at once
+
+    inline int getBSRRhsTile() {
+        static int bsr_rhs_tile = []() {
+            const char *l = std::getenv("SB_BSR_RHS_TILE");
+            if (l) return std::atoi(l);
+            return 0;
+        }();
+        return bsr_rhs_tile;
+    }
+
+    /// Return whether to read and write the values of the storages with positional I/O calls, which may have been set by the environment variable SB_STORAGE_PIO
+    /// \return bool&: reference to the value, which can be changed at runtime
+    /// The accepted value in the environment variable SB_STORAGE_PIO are:
+    ///   * 0: seek and read/write every contiguous range of values individually
+    ///   * != 0: coalesce the contiguous ranges and access them with pread/preadv/pwrite
+    ///     without moving the file position (default)
+
+    inline bool &getUseStoragePositionalIO() {
+        static bool storage_pio = []() {
+            const char *l = std::getenv("SB_STORAGE_PIO");
+            if (l) return (0 != std::atoi(l));
+            return true;
+        }();
+        return storage_pio;
+    }
+
+    /// Return whether to map into memory the storages opened only for reading, which may have been set by the environment variable SB_STORAGE_MMAP
+    /// \return bool&: reference to the value, which can be changed at runtime
+    /// The accepted value in the environment variable SB_STORAGE_MMAP are:
+    ///   * 0: read the values from the file
+    ///   * != 0: map the file into memory when opening a storage and copy the values directly from
+    ///     the mapping when possible (default)
+
+    inline bool &getUseStorageMmap() {
+        static bool storage_mmap = []() {
+            const char *l = std::getenv("SB_STORAGE_MMAP");
+            if (l) return (0 != std::atoi(l));
+            return true;
+        }();
+        return storage_mmap;
+    }
+
+    /// Return whether to use the block index at the end of the storages, which may have been set by the environment variable SB_STORAGE_INDEX
+    /// \return bool&: reference to the value, which can be changed at runtime
+    /// The accepted value in the environment variable SB_STORAGE_INDEX are:
+    ///   * 0: read the header of every chunk when opening a storage, don't write the index, and
+    ///     create the storages with version 0 of the format, see `storage.h`
+    ///   * != 0: read the blocks from the index when opening a storage if it is present and
+    ///     valid, and write the index when flushing and closing storages (default)
+
+    inline bool &getUseStorageIndex() {
+        static bool storage_index = []() {
+            const char *l = std::getenv("SB_STORAGE_INDEX");
+            if (l) return (0 != std::atoi(l));
+            return true;
+        }();
+        return storage_index;
+    }
+
+    /// Return the number of blocks from which the storages index their blocks with trees instead of a grid, which may have been set by the environment variable SB_STORAGE_BLOCK_TREE
+    /// \return int&: reference to the value, which can be changed at runtime
+    /// The accepted value in the environment variable SB_STORAGE_BLOCK_TREE are:
+    ///   * 0: always use the grid
+    ///   * > 0: switch to the trees when a storage has at least that many blocks (default 256)
+
+    inline int &getStorageBlockTreeThreshold() {
+        static int storage_block_tree_threshold = []() {
+            const char *l = std::getenv("SB_STORAGE_BLOCK_TREE");
+            if (l) return std::max(0, std::atoi(l));
+            return 256;
+        }();
+        return storage_block_tree_threshold;
+    }
+
+    /// Return the maximum number of readings and writings in flight on storages when using io_uring, which may have been set by the environment variable SB_STORAGE_IO_URING
+    /// \return int&: reference to the value, which can be changed at runtime
+    /// The accepted value in the environment variable SB_STORAGE_IO_URING are:
+    ///   * 0: don't use io_uring
+    ///   * > 0: queue depth of the io_uring created by a storage on its first reading or writing
+    ///     that isn't served by the memory mapping (default 64); only used if superbblas was
+    ///     compiled with SUPERBBLAS_USE_IO_URING
+
+    inline int &getStorageIOUringDepth() {
+        static int storage_io_uring_depth = []() {
+            const char *l = std::getenv("SB_STORAGE_IO_URING");
+            if (l) return std::max(0, std::atoi(l));
+            return 64;
+        }();
+        return storage_io_uring_depth;
+    }
+
+    /// Return the maximum number of MiB read on buffers with io_uring before waiting for the
+    /// readings and copying the buffers into the destination, which may have been set by the
+    /// environment variable SB_STORAGE_IO_URING_BUFFER
+    /// \return std::size_t&: reference to the value, which can be changed at runtime
+    /// The accepted value in the environment variable SB_STORAGE_IO_URING_BUFFER are:
+    ///   * 0: wait for the readings of every block
+    ///   * > 0: maximum MiB of the buffers in flight (default 256)
+
+    inline std::size_t &getStorageIOUringBufferSize() {
+        static std::size_t storage_io_uring_buffer = []() {
+            const char *l = std::getenv("SB_STORAGE_IO_URING_BUFFER");
+            if (l) return (std::size_t)std::max(0, std::atoi(l));
+            return (std::size_t)256;
+        }();
+        return storage_io_uring_buffer;
+    }
+
     /// Return whether to allow passing GPU pointers to MPI calls
     /// \return int: unspecified by the user when zero and greater than zero when allowing passing GPU pointers to MPI calls
     /// The accepted value in the environment variable SB_MPI_GPU are:
@@ -127,6 +448,23 @@ namespace superbblas {
         return use_mpi_gpu;
     }
 
+    /// Return the highest SIMD instruction set allowed in the CPU kernels, which may have been set by the environment variable SB_CPU_SIMD
+    /// \return int: value
+    /// The accepted value in the environment variable SB_CPU_SIMD are:
+    ///   * < 0: use the best instruction set supported by the CPU (default)
+    ///   * 0: don't use explicit SIMD kernels
+    ///   * 1: use up to AVX2
+    ///   * >= 2: use up to AVX-512
+
+    inline int getCpuSimd() {
+        static int simd = []() {
+            const char *l = std::getenv("SB_CPU_SIMD");
+            if (l) return std::atoi(l);
+            return -1;
+        }();
+        return simd;
+    }
+
     /// Return the maximum size of the cache permutation for CPU in GiB
     /// \return int: value
     /// The accepted value in the environment variable SB_CACHEGB_CPU are:
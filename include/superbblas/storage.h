@@ -4,21 +4,34 @@
 #include "crc32.h"
 #include "dist.h"
 #include "tensor.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <limits>
 #include <list>
+#include <memory>
 #include <set>
 #include <sstream>
 #include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #include <unordered_map>
 #if defined(SUPERBBLAS_USE_ANARCHOFS) && defined(SUPERBBLAS_USE_MPI)
 #    include "anarchofs_lib.h"
 #endif
+#ifdef SUPERBBLAS_USE_IO_URING
+#    include <linux/io_uring.h>
+#    include <sys/syscall.h>
+#endif
 
 /// Specification for simple, sparse, streamed tensor (S3T) format
 /// magic_number <i32>: 314
-/// version <i32>: version of S3T format (currently 0)
+/// version <i32>: version of S3T format (currently 1, or 0 if the index is disabled)
 /// values_datatype <i32>: datatype used for the values; currently supported values:
 ///  - 0: float
 ///  - 1: double
@@ -36,6 +49,7 @@
 /// checksum_block <double>: largest contiguous data length in bytes to compute the checksum;
 ///  data blocks larger than that will report the checksum of the checksums
 /// num_chunks <double>: number of chunks that follows
+/// (if version is 1) index_disp <double>: first byte of the index, or zero if there's no index
 /// chunk: repeat as many times as needed
 ///  -  number_of_blocks <double>: number of blocks
 ///  -  from_size <{from <double*dimensions>, size <double*dimensions>}*number_of_blocks>: the i-th
@@ -47,6 +61,16 @@
 /// of the entire content of the file up to this position; if checksum is 2, this is the
 /// checksum of the entire content of the file up this position excepting `num_chunks`, `values`
 /// and `values_checksum`.
+/// (if version is 1 and index_disp isn't zero) index: copy of the content of the chunk headers
+///  -  num_chunks <double>: number of chunks described by the index
+///  -  chunks_end <double>: first byte after the last chunk
+///  -  checksum_headers <double>: if checksum is 2, checksum of the headers as in global_checksum
+///  -  number_of_blocks <double>: number of blocks in all chunks
+///  -  from_size_disp <{from <double*dimensions>, size <double*dimensions>, values_disp <double>,
+///     values_checksum_disp <double>}*number_of_blocks>: the i-th item has the coordinates of
+///     the i-th block in the file, the first byte of its values and the first byte of its
+///     values_checksum (zero if checksum is not 2)
+///  -  index_checksum <double>: checksum of the index content up to this position
 ///
 /// NOTES:
 /// - The restrictions in the metadata's length and the padding are to make all subsequent fields
@@ -54,6 +78,11 @@
 /// - A slightly simpler implementation is to restrict each chunk to a single block; allowing
 ///   multiple blocks in a chunks gives a mechanism to increase the locality when reading all
 ///   "from_size" in the file.
+/// - The index is optional and only saves reading all chunk headers when opening the file. It's
+///   written when flushing or closing the file, and index_disp is set to zero when adding a chunk,
+///   so a file that wasn't closed properly still has a valid index or none at all. Files with
+///   version 0 are still supported, and they are never given an index. Files are created with
+///   version 0 if the index is disabled with SB_STORAGE_INDEX=0, see `getUseStorageIndex`.
 /// - The type of the coordinates for from_size is double instead of the obvious better type i64
 ///   just because the latter type is not supported by MPI.
 
@@ -73,6 +102,9 @@ namespace superbblas {
         /// Magic number
         const int magic_number = 314;
 
+        /// Latest version of the S3T format
+        const int last_version = 1;
+
         /// Open file modes
         enum Mode { CreateForReadWrite, ReadWrite, OnlyRead };
 
@@ -548,7 +580,707 @@ namespace superbblas {
         }
 #endif // defined(SUPERBBLAS_USE_ANARCHOFS) && defined(SUPERBBLAS_USE_MPI)
 
+        //
+        // Positional I/O
+        //
+
+        /// Contiguous range of values on the file and on memory
+        struct FileRun {
+            std::size_t file_disp; ///< number of bytes from the beginning of the file
+            std::size_t mem_disp;  ///< number of elements from the beginning of the buffer
+            std::size_t n;         ///< number of elements
+        };
+
+        /// Return the contiguous ranges of values on the file given by `get_normalize_permutation`
+        /// \param disp: number of bytes from the beginning of the file before the coordinate zero
+        /// \param disp0: number of elements to add to all the indices
+        /// \param blk: number of consecutive elements starting at each index
+        /// \param indices: first element of each range (or the identity if it is empty)
+        /// \return: the ranges with consecutive ranges on the file merged
+
+        template <typename T, typename IndexType>
+        std::vector<FileRun> get_file_runs(std::size_t disp, std::size_t disp0, std::size_t blk,
+                                           const IndicesT<IndexType, Cpu> &indices) {
+            std::vector<FileRun> r;
+            for (std::size_t i = 0; i < indices.size(); ++i) {
+                std::size_t file_disp =
+                    disp +
+                    (disp0 + (indices.data() == nullptr ? i : (std::size_t)indices[i])) * sizeof(T);
+                if (r.size() > 0 && r.back().file_disp + r.back().n * sizeof(T) == file_disp)
+                    r.back().n += blk;
+                else
+                    r.push_back(FileRun{file_disp, i * blk, blk});
+            }
+            return r;
+        }
+
+        /// Largest number of bytes between two ranges that are read with a single call
+        constexpr std::size_t file_runs_max_gap = 4096;
+
+        /// Largest number of buffers passed to preadv
+#ifdef IOV_MAX
+        constexpr int file_runs_max_iov = IOV_MAX;
+#else
+        constexpr int file_runs_max_iov = 1024;
+#endif
+
+        /// Read the content of the file into the buffers, taking care of partial readings
+        /// \param fd: file descriptor
+        /// \param iov: buffers; the content is modified
+        /// \param offset: number of bytes from the beginning of the file of the first buffer
+
+        inline void preadv_all(int fd, std::vector<struct iovec> &iov, std::size_t offset) {
+            struct iovec *p = iov.data();
+            int n = (int)iov.size();
+            while (n > 0) {
+                ssize_t r = preadv(fd, p, n, (off_t)offset);
+                if (r < 0 && errno == EINTR) continue;
+                if (r <= 0) gen_error("Error reading from a file");
+                offset += r;
+                for (; n > 0 && (std::size_t)r >= p->iov_len; ++p, --n) r -= p->iov_len;
+                if (n > 0) {
+                    p->iov_base = (char *)p->iov_base + r;
+                    p->iov_len -= r;
+                }
+            }
+        }
+
+        /// Write the buffer into the file, taking care of partial writings
+        /// \param fd: file descriptor
+        /// \param v: buffer
+        /// \param n: number of bytes to write
+        /// \param offset: number of bytes from the beginning of the file
+
+        inline void pwrite_all(int fd, const char *v, std::size_t n, std::size_t offset) {
+            while (n > 0) {
+                ssize_t r = pwrite(fd, v, n, (off_t)offset);
+                if (r < 0 && errno == EINTR) continue;
+                if (r <= 0) gen_error("Error writing in a file");
+                v += r;
+                n -= r;
+                offset += r;
+            }
+        }
+
+        /// Read several ranges of values without changing the file position
+        /// \param f: file handler
+        /// \param runs: ranges to read
+        /// \param v: buffer where to put the values
+        ///
+        /// NOTE: ranges separated by a few bytes are read with a single preadv call, throwing
+        /// away the values in between.
+
+        template <typename T>
+        void read_runs(std::FILE *f, const std::vector<FileRun> &runs, T *v) {
+            // Make visible the pending writes on the stdio buffer and discard the read buffer
+            flush(f);
+            int fd = fileno(f);
+
+            std::unique_ptr<char[]> gap;
+            std::vector<struct iovec> iov;
+            std::size_t i = 0;
+            while (i < runs.size()) {
+                iov.clear();
+                std::size_t offset = runs[i].file_disp, end = offset;
+                for (; i < runs.size() && (int)iov.size() + 2 <= file_runs_max_iov; ++i) {
+                    if (iov.size() > 0) {
+                        if (runs[i].file_disp < end || runs[i].file_disp - end > file_runs_max_gap)
+                            break;
+                        if (runs[i].file_disp > end) {
+                            if (!gap) gap.reset(new char[file_runs_max_gap]);
+                            iov.push_back({gap.get(), runs[i].file_disp - end});
+                        }
+                    }
+                    iov.push_back({v + runs[i].mem_disp, runs[i].n * sizeof(T)});
+                    end = runs[i].file_disp + runs[i].n * sizeof(T);
+                }
+                preadv_all(fd, iov, offset);
+            }
+        }
+
+        /// Write several ranges of values without changing the file position
+        /// \param f: file handler
+        /// \param runs: ranges to write
+        /// \param v: buffer with the values
+
+        template <typename T>
+        void write_runs(std::FILE *f, const std::vector<FileRun> &runs, const T *v,
+                        vector<T, Cpu>) {
+            // Write the pending values on the stdio buffer
+            flush(f);
+            int fd = fileno(f);
+            for (const FileRun &run : runs)
+                pwrite_all(fd, (const char *)(v + run.mem_disp), run.n * sizeof(T), run.file_disp);
+        }
+
+#ifdef SUPERBBLAS_USE_MPI
+#    ifdef SUPERBBLAS_USE_MPIIO
+        template <typename T>
+        void read_runs(File_Requests &f, const std::vector<FileRun> &runs, T *v) {
+            for (const FileRun &run : runs) {
+                MPI_Status status;
+                MPI_check(MPI_File_read_at(f.f, run.file_disp, v + run.mem_disp,
+                                           run.n * get_count_from_type<T>(),
+                                           mpi_datatype_basic_from_type<T>(), &status));
+            }
+        }
+
+        template <typename T>
+        void write_runs(File_Requests &f, const std::vector<FileRun> &runs, const T *v,
+                        vector<T, Cpu> w) {
+            for (const FileRun &run : runs) {
+                MPI_Request req;
+                MPI_check(MPI_File_iwrite_at(f.f, run.file_disp, v + run.mem_disp,
+                                             run.n * get_count_from_type<T>(),
+                                             mpi_datatype_basic_from_type<T>(), &req));
+                f.reqs.push_back(new Alloc<T>{req, w});
+            }
+        }
+#    else
+        template <typename T> void read_runs(File_Comm f, const std::vector<FileRun> &runs, T *v) {
+            read_runs(f.f, runs, v);
+        }
+
+        template <typename T>
+        void write_runs(File_Comm f, const std::vector<FileRun> &runs, const T *v,
+                        vector<T, Cpu> w) {
+            write_runs(f.f, runs, v, w);
+        }
+#    endif // SUPERBBLAS_USE_MPIIO
+#endif     // SUPERBBLAS_USE_MPI
+
+#if defined(SUPERBBLAS_USE_ANARCHOFS) && defined(SUPERBBLAS_USE_MPI)
+        template <typename Comm, typename T>
+        void read_runs(FileAfs<Comm> &f, const std::vector<FileRun> &runs, T *v) {
+            if (f.f_afs != nullptr) {
+                for (const FileRun &run : runs) {
+                    seek(f, run.file_disp);
+                    read(f, v + run.mem_disp, run.n);
+                }
+            } else {
+                read_runs(f.f_local, runs, v);
+            }
+        }
+
+        template <typename Comm, typename T>
+        void write_runs(FileAfs<Comm> &f, const std::vector<FileRun> &runs, const T *v,
+                        vector<T, Cpu> w) {
+            if (f.f_afs != nullptr)
+                throw std::runtime_error("write: unsupported operation for anarchofs");
+            write_runs(f.f_local, runs, v, w);
+        }
+#endif // defined(SUPERBBLAS_USE_ANARCHOFS) && defined(SUPERBBLAS_USE_MPI)
+
+        //
+        // Memory-mapped files
+        //
+
+        /// Return the file descriptor of a local file or -1 if it has no one
+        ///
+        /// NOTE: the stdio buffer is flushed, so that accessing the file descriptor directly
+        /// observes all previous writes.
+
+        inline int get_file_descriptor(std::FILE *f) {
+            flush(f);
+            return fileno(f);
+        }
+
+#ifdef SUPERBBLAS_USE_MPI
+#    ifdef SUPERBBLAS_USE_MPIIO
+        inline int get_file_descriptor(const File_Requests &) { return -1; }
+#    else
+        inline int get_file_descriptor(const File_Comm &f) { return get_file_descriptor(f.f); }
+#    endif // SUPERBBLAS_USE_MPIIO
+#endif     // SUPERBBLAS_USE_MPI
+
+#if defined(SUPERBBLAS_USE_ANARCHOFS) && defined(SUPERBBLAS_USE_MPI)
+        template <typename Comm> int get_file_descriptor(const FileAfs<Comm> &f) {
+            return f.f_afs != nullptr ? -1 : get_file_descriptor(f.f_local);
+        }
+#endif // defined(SUPERBBLAS_USE_ANARCHOFS) && defined(SUPERBBLAS_USE_MPI)
+
+        /// Read-only mapping of a whole file into memory
+        struct FileMap {
+            const char *ptr;  ///< first byte of the file, or null if the file isn't mapped
+            std::size_t size; ///< number of bytes mapped
+        };
+
+        /// Map a whole file into memory for reading
+        /// \param fd: file descriptor
+        /// \return: the mapping, which is null if the file couldn't be mapped
+        ///
+        /// NOTE: the pages aren't read ahead because storages are usually accessed at random.
+
+        inline FileMap map_file(int fd) {
+            struct stat st;
+            if (fd < 0 || fstat(fd, &st) != 0 || st.st_size <= 0) return {nullptr, 0};
+            void *ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (ptr == MAP_FAILED) return {nullptr, 0};
+            madvise(ptr, st.st_size, MADV_RANDOM);
+            return {(const char *)ptr, (std::size_t)st.st_size};
+        }
+
+        /// Undo `map_file`
+
+        inline void unmap_file(FileMap &m) {
+            if (m.ptr == nullptr) return;
+            if (munmap((void *)m.ptr, m.size) != 0) gen_error("Error unmapping file");
+            m = FileMap{nullptr, 0};
+        }
+
+        /// Hint the kernel to read soon a range of a mapped file
+        /// \param m: mapping
+        /// \param first: first byte of the range
+        /// \param last: one past the last byte of the range
+
+        inline void advise_mapped_range(const FileMap &m, std::size_t first, std::size_t last) {
+            static const std::size_t page_size = sysconf(_SC_PAGESIZE);
+            first = first / page_size * page_size;
+            last = std::min(m.size, last);
+            if (first < last) madvise((void *)(m.ptr + first), last - first, MADV_WILLNEED);
+        }
+
+        //
+        // Asynchronous I/O with io_uring
+        //
+
+        /// Pending read or write on an io_uring
+        struct IOUringOp {
+            int fd;                     ///< file descriptor
+            bool write;                 ///< whether to write or to read
+            char *ptr;                  ///< buffer
+            std::size_t n;              ///< number of bytes to read or write
+            std::size_t offset;         ///< number of bytes from the beginning of the file
+            std::shared_ptr<void> keep; ///< keep alive the buffer until the operation finishes
+        };
+
+#ifdef SUPERBBLAS_USE_IO_URING
+        /// Submission and completion queues of an io_uring, accessed without liburing
+        struct IOUring {
+            int ring_fd;                       ///< io_uring file descriptor
+            void *sq_ptr, *cq_ptr, *sqes_ptr;  ///< mappings of the queues
+            std::size_t sq_size, cq_size;      ///< size of the mappings of the queues
+            std::size_t sqes_size;             ///< size of the mapping of the submission entries
+            unsigned int *sq_tail, *sq_mask;   ///< submission queue tail and index mask
+            unsigned int *sq_array;            ///< submission queue entries indices
+            io_uring_sqe *sqes;                ///< submission queue entries
+            unsigned int *cq_head, *cq_tail;   ///< completion queue head and tail
+            unsigned int *cq_mask;             ///< completion queue index mask
+            io_uring_cqe *cqes;                ///< completion queue entries
+            std::vector<IOUringOp> ops;        ///< operation on each slot
+            std::vector<unsigned int> free_ops; ///< slots without operation
+            unsigned int to_submit = 0;         ///< queued operations not submitted yet
+
+            IOUring()
+                : ring_fd(-1),
+                  sq_ptr(MAP_FAILED),
+                  cq_ptr(MAP_FAILED),
+                  sqes_ptr(MAP_FAILED),
+                  sq_size(0),
+                  cq_size(0),
+                  sqes_size(0) {}
+
+            ~IOUring() {
+                if (sqes_ptr != MAP_FAILED) munmap(sqes_ptr, sqes_size);
+                if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) munmap(cq_ptr, cq_size);
+                if (sq_ptr != MAP_FAILED) munmap(sq_ptr, sq_size);
+                if (ring_fd >= 0) ::close(ring_fd);
+            }
+        };
+
+        /// Return a new io_uring or null if the kernel doesn't support it
+        /// \param depth: maximum number of operations in flight
+
+        inline std::shared_ptr<IOUring> create_io_uring(unsigned int depth) {
+            if (depth == 0) return nullptr;
+
+            io_uring_params p;
+            std::memset(&p, 0, sizeof(p));
+            int ring_fd = (int)syscall(__NR_io_uring_setup, depth, &p);
+            if (ring_fd < 0) return nullptr;
+            std::shared_ptr<IOUring> r = std::make_shared<IOUring>();
+            r->ring_fd = ring_fd;
+
+            // Reading and writing at explicit offsets were introduced at the same time as
+            // IORING_FEAT_RW_CUR_POS
+            if ((p.features & IORING_FEAT_RW_CUR_POS) == 0) return nullptr;
+
+            // Map the queues
+            r->sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+            r->cq_size = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+            if (p.features & IORING_FEAT_SINGLE_MMAP)
+                r->sq_size = r->cq_size = std::max(r->sq_size, r->cq_size);
+            r->sq_ptr = mmap(nullptr, r->sq_size, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+            if (r->sq_ptr == MAP_FAILED) return nullptr;
+            if (p.features & IORING_FEAT_SINGLE_MMAP) {
+                r->cq_ptr = r->sq_ptr;
+            } else {
+                r->cq_ptr = mmap(nullptr, r->cq_size, PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+                if (r->cq_ptr == MAP_FAILED) return nullptr;
+            }
+            r->sqes_size = p.sq_entries * sizeof(io_uring_sqe);
+            r->sqes_ptr = mmap(nullptr, r->sqes_size, PROT_READ | PROT_WRITE,
+                               MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+            if (r->sqes_ptr == MAP_FAILED) return nullptr;
+
+            char *sq = (char *)r->sq_ptr, *cq = (char *)r->cq_ptr;
+            r->sq_tail = (unsigned int *)(sq + p.sq_off.tail);
+            r->sq_mask = (unsigned int *)(sq + p.sq_off.ring_mask);
+            r->sq_array = (unsigned int *)(sq + p.sq_off.array);
+            r->sqes = (io_uring_sqe *)r->sqes_ptr;
+            r->cq_head = (unsigned int *)(cq + p.cq_off.head);
+            r->cq_tail = (unsigned int *)(cq + p.cq_off.tail);
+            r->cq_mask = (unsigned int *)(cq + p.cq_off.ring_mask);
+            r->cqes = (io_uring_cqe *)(cq + p.cq_off.cqes);
+
+            // Limit the operations in flight to the submission queue size, so neither the
+            // submission queue nor the completion queue, which is at least as large, overflow
+            r->ops.resize(p.sq_entries);
+            for (unsigned int i = 0; i < p.sq_entries; ++i) r->free_ops.push_back(i);
+
+            return r;
+        }
+
+        inline void io_uring_push(IOUring &r, const IOUringOp &op);
+
+        /// Submit the queued operations and process the finished ones
+        /// \param r: io_uring
+        /// \param min_complete: minimum number of operations to wait for
+
+        inline void io_uring_reap(IOUring &r, unsigned int min_complete) {
+            // Submit all the queued operations, waiting for `min_complete` of them to finish.
+            // NOTE: the kernel skips the waiting if it submits fewer operations than requested,
+            // so keep calling until everything is submitted and the waiting is done
+            while (true) {
+                long ret = syscall(__NR_io_uring_enter, r.ring_fd, r.to_submit, min_complete,
+                                   min_complete > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+                if (ret < 0) {
+                    if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                        gen_error("Error submitting operations to io_uring");
+                    continue;
+                }
+                bool all_submitted = ((unsigned int)ret == r.to_submit);
+                r.to_submit -= (unsigned int)ret;
+                if (all_submitted) break;
+            }
+
+            // Process the finished operations
+            unsigned int head = *r.cq_head;
+            unsigned int tail = __atomic_load_n(r.cq_tail, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head) {
+                const io_uring_cqe &cqe = r.cqes[head & *r.cq_mask];
+                unsigned int slot = (unsigned int)cqe.user_data;
+                int res = cqe.res;
+                __atomic_store_n(r.cq_head, head + 1, __ATOMIC_RELEASE);
+                IOUringOp op = r.ops[slot];
+                r.ops[slot] = IOUringOp{};
+                r.free_ops.push_back(slot);
+                if (res < 0) {
+                    errno = -res;
+                    gen_error(op.write ? "Error writing in a file" : "Error reading from a file");
+                }
+                if (res == 0)
+                    throw std::runtime_error(op.write ? "Error writing in a file"
+                                                      : "Error reading from a file");
+
+                // Resubmit what is left on a partial reading or writing
+                if ((std::size_t)res < op.n) {
+                    op.ptr += res;
+                    op.n -= res;
+                    op.offset += res;
+                    io_uring_push(r, op);
+                }
+            }
+        }
+
+        /// Queue an operation, waiting for another one to finish if there are too many in flight
+        /// \param r: io_uring
+        /// \param op: operation
+
+        inline void io_uring_push(IOUring &r, const IOUringOp &op) {
+            while (r.free_ops.empty()) io_uring_reap(r, 1);
+            unsigned int slot = r.free_ops.back();
+            r.free_ops.pop_back();
+            r.ops[slot] = op;
+
+            unsigned int tail = *r.sq_tail;
+            unsigned int idx = tail & *r.sq_mask;
+            io_uring_sqe &sqe = r.sqes[idx];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = op.write ? IORING_OP_WRITE : IORING_OP_READ;
+            sqe.fd = op.fd;
+            sqe.addr = (std::uint64_t)op.ptr;
+            sqe.len = (std::uint32_t)op.n;
+            sqe.off = op.offset;
+            sqe.user_data = slot;
+            r.sq_array[idx] = idx;
+            __atomic_store_n(r.sq_tail, tail + 1, __ATOMIC_RELEASE);
+            r.to_submit++;
+        }
+
+        /// Wait for all the operations in flight
+        /// \param r: io_uring
+
+        inline void io_uring_wait_all(IOUring &r) {
+            while (r.free_ops.size() < r.ops.size()) io_uring_reap(r, 1);
+        }
+
+        /// Process the finished operations without waiting
+        /// \param r: io_uring
+
+        inline void io_uring_test(IOUring &r) {
+            if (r.free_ops.size() < r.ops.size()) io_uring_reap(r, 0);
+        }
+#else
+        struct IOUring {};
+
+        inline std::shared_ptr<IOUring> create_io_uring(unsigned int) { return nullptr; }
+
+        inline void io_uring_push(IOUring &, const IOUringOp &) {
+            throw std::runtime_error("superbblas compiled without io_uring support");
+        }
+
+        inline void io_uring_wait_all(IOUring &) {}
+
+        inline void io_uring_test(IOUring &) {}
+#endif // SUPERBBLAS_USE_IO_URING
+
+        /// Largest number of bytes read or written by a single io_uring operation
+        constexpr std::size_t io_uring_max_op_size = std::size_t(1) << 30;
+
+        /// Queue the reading of several ranges of values
+        /// \param r: io_uring
+        /// \param fd: file descriptor
+        /// \param runs: ranges to read
+        /// \param v: buffer where to put the values
+        /// \param w: vector with the buffer, which is kept alive until the reading finishes
+        ///
+        /// NOTE: the values are ready after calling `io_uring_wait_all`.
+
+        template <typename T>
+        void read_runs(IOUring &r, int fd, const std::vector<FileRun> &runs, T *v,
+                       vector<T, Cpu> w) {
+            std::shared_ptr<void> keep = std::make_shared<vector<T, Cpu>>(w);
+            for (const FileRun &run : runs) {
+                char *ptr = (char *)(v + run.mem_disp);
+                for (std::size_t i = 0, n = run.n * sizeof(T); i < n; i += io_uring_max_op_size)
+                    io_uring_push(r, IOUringOp{fd, false, ptr + i,
+                                               std::min(n - i, io_uring_max_op_size),
+                                               run.file_disp + i, keep});
+            }
+        }
+
+        /// Queue the writing of several ranges of values
+        /// \param r: io_uring
+        /// \param fd: file descriptor
+        /// \param runs: ranges to write
+        /// \param v: buffer with the values
+        /// \param w: vector with the buffer, which is kept alive until the writing finishes
+
+        template <typename T>
+        void write_runs(IOUring &r, int fd, const std::vector<FileRun> &runs, const T *v,
+                        vector<T, Cpu> w) {
+            std::shared_ptr<void> keep = std::make_shared<vector<T, Cpu>>(w);
+            for (const FileRun &run : runs) {
+                char *ptr = (char *)(v + run.mem_disp);
+                for (std::size_t i = 0, n = run.n * sizeof(T); i < n; i += io_uring_max_op_size)
+                    io_uring_push(r, IOUringOp{fd, true, ptr + i,
+                                               std::min(n - i, io_uring_max_op_size),
+                                               run.file_disp + i, keep});
+            }
+        }
+
+        /// Spatial index of boxes with logarithmic insertion and intersection queries
+        ///
+        /// The boxes are kept on several packed R-trees; the boxes of each tree are sorted
+        /// recursively on every dimension (Sort-Tile-Recursive) and grouped in leaves of
+        /// `leaf_size` boxes, and the nodes on each level are grouped in the same way. The i-th
+        /// tree has room for `leaf_size * 2^i` boxes, and new boxes are added to the trees as
+        /// in a binary counter: when a tree gets full, its boxes are merged into the next tree.
+        /// The last inserted boxes that don't fill a leaf are checked one by one.
+
+        template <std::size_t N> struct BlockTree {
+            /// Index associated to a box
+            using BlockIndex = std::size_t;
+
+            /// Coordinates from `from` up to `to`, not including `to`, in each dimension
+            struct Box {
+                Coor<N> from, to;
+            };
+
+            /// Box with its associated index
+            using Item = std::pair<Box, BlockIndex>;
+            using ItemIt = typename std::vector<Item>::iterator;
+
+            /// Node of a packed tree
+            struct Node {
+                Box box;           ///< smallest box containing all boxes under the node
+                std::size_t first; ///< first child on the next level, or first item for leaves
+                std::size_t last;  ///< one past the last child or item
+            };
+
+            /// Packed tree
+            struct Tree {
+                std::vector<Item> items;               ///< boxes ordered by leaves
+                std::vector<std::vector<Node>> levels; ///< nodes on each level from the root
+            };
+
+            /// Maximum number of children of a node
+            static constexpr std::size_t leaf_size = 16;
+
+            /// Trees; the i-th one is either empty or has at least `leaf_size * 2^i` boxes
+            std::vector<Tree> trees;
+            /// Boxes not in any tree yet
+            std::vector<Item> pending;
+
+            /// Insert a box
+            /// \param box: box to insert
+            /// \param idx: index associated to the box
+
+            void insert(const Box &box, BlockIndex idx) {
+                pending.push_back({box, idx});
+                if (pending.size() < leaf_size) return;
+
+                // Merge the pending boxes and the consecutive nonempty trees into a new tree
+                std::vector<Item> items;
+                items.swap(pending);
+                std::size_t k = 0;
+                for (; k < trees.size() && trees[k].items.size() > 0; ++k) {
+                    items.insert(items.end(), trees[k].items.begin(), trees[k].items.end());
+                    trees[k] = Tree{};
+                }
+                if (k == trees.size()) trees.push_back(Tree{});
+                trees[k] = build(items);
+            }
+
+            /// Append the indices associated to the boxes overlapping the given box; an index
+            /// may appear several times if it was inserted with several boxes
+            /// \param box: box to intersect with
+            /// \param r: (out) list where to append the indices
+
+            void intersection(const Box &box, std::vector<BlockIndex> &r) const {
+                for (const Item &it : pending)
+                    if (overlap(it.first, box)) r.push_back(it.second);
+
+                std::vector<std::pair<std::size_t, std::size_t>> stack; // (level, node)
+                for (const Tree &t : trees) {
+                    if (t.levels.size() == 0) continue;
+                    for (std::size_t i = 0; i < t.levels[0].size(); ++i) stack.push_back({0, i});
+                    while (stack.size() > 0) {
+                        std::size_t level = stack.back().first;
+                        const Node &n = t.levels[level][stack.back().second];
+                        stack.pop_back();
+                        if (!overlap(n.box, box)) continue;
+                        if (level + 1 < t.levels.size()) {
+                            for (std::size_t i = n.first; i < n.last; ++i)
+                                stack.push_back({level + 1, i});
+                        } else {
+                            for (std::size_t i = n.first; i < n.last; ++i)
+                                if (overlap(t.items[i].first, box)) r.push_back(t.items[i].second);
+                        }
+                    }
+                }
+            }
+
+        private:
+            /// Return whether two boxes overlap
+            static bool overlap(const Box &a, const Box &b) {
+                for (std::size_t i = 0; i < N; ++i)
+                    if (a.to[i] <= b.from[i] || b.to[i] <= a.from[i]) return false;
+                return true;
+            }
+
+            /// Return the smallest box containing both boxes
+            static Box cover(Box a, const Box &b) {
+                for (std::size_t i = 0; i < N; ++i) {
+                    a.from[i] = std::min(a.from[i], b.from[i]);
+                    a.to[i] = std::max(a.to[i], b.to[i]);
+                }
+                return a;
+            }
+
+            /// Sort the boxes so that consecutive groups of `leaf_size` boxes are close
+            /// \param first: first box to sort
+            /// \param last: one past the last box to sort
+            /// \param dims: dimensions to sort by
+            /// \param d: index of the current dimension in `dims`
+
+            static void str_sort(ItemIt first, ItemIt last, const std::vector<std::size_t> &dims,
+                                 std::size_t d) {
+                std::size_t n = last - first;
+                if (n <= leaf_size || d >= dims.size()) return;
+
+                // Sort by the center of the boxes on the current dimension
+                const std::size_t dim = dims[d];
+                std::sort(first, last, [=](const Item &a, const Item &b) {
+                    return a.first.from[dim] + a.first.to[dim] <
+                           b.first.from[dim] + b.first.to[dim];
+                });
+
+                // Split the boxes into slabs and sort each of them on the remaining dimensions
+                if (d + 1 >= dims.size()) return;
+                std::size_t num_leaves = (n + leaf_size - 1) / leaf_size;
+                std::size_t num_slabs =
+                    std::ceil(std::pow((double)num_leaves, 1.0 / (dims.size() - d)));
+                std::size_t slab_size = (num_leaves + num_slabs - 1) / num_slabs * leaf_size;
+                for (std::size_t i = 0; i < n; i += slab_size)
+                    str_sort(first + i, first + std::min(i + slab_size, n), dims, d + 1);
+            }
+
+            /// Return a packed tree with the given boxes
+            /// \param items: boxes
+
+            static Tree build(std::vector<Item> &items) {
+                // Sort only on the dimensions where the boxes differ
+                std::vector<std::size_t> dims;
+                for (std::size_t i = 0; i < N; ++i) {
+                    for (const Item &it : items) {
+                        if (it.first.from[i] != items[0].first.from[i] ||
+                            it.first.to[i] != items[0].first.to[i]) {
+                            dims.push_back(i);
+                            break;
+                        }
+                    }
+                }
+                str_sort(items.begin(), items.end(), dims, 0);
+
+                // Group the boxes into leaves, and the nodes of each level into the nodes of
+                // the level above up to a single root level
+                Tree t;
+                t.items.swap(items);
+                std::vector<Node> level;
+                for (std::size_t i = 0; i < t.items.size(); i += leaf_size) {
+                    Node n{t.items[i].first, i, std::min(i + leaf_size, t.items.size())};
+                    for (std::size_t j = n.first + 1; j < n.last; ++j)
+                        n.box = cover(n.box, t.items[j].first);
+                    level.push_back(n);
+                }
+                t.levels.push_back(level);
+                while (t.levels.back().size() > leaf_size) {
+                    const std::vector<Node> &children = t.levels.back();
+                    std::vector<Node> parents;
+                    for (std::size_t i = 0; i < children.size(); i += leaf_size) {
+                        Node n{children[i].box, i, std::min(i + leaf_size, children.size())};
+                        for (std::size_t j = n.first + 1; j < n.last; ++j)
+                            n.box = cover(n.box, children[j].box);
+                        parents.push_back(n);
+                    }
+                    t.levels.push_back(parents);
+                }
+                std::reverse(t.levels.begin(), t.levels.end());
+                return t;
+            }
+        };
+
         /// Data-structure to accelerate the intersection of sparse tensors
+        ///
+        /// NOTE: the blocks are indexed on a non-regular grid, which is fast for a few blocks but
+        /// its cost grows faster than linearly with the number of blocks; when the number of
+        /// blocks reaches `getStorageBlockTreeThreshold()`, the blocks are indexed on a
+        /// `BlockTree` instead.
+
         template <std::size_t N, typename Key = void> struct GridHash {
             /// Index element in `blocks` and `values`
             using BlockIndex = std::size_t;
@@ -564,7 +1296,12 @@ namespace superbblas {
             /// From grid coordinate index (SlowToFast) to `blocks` and `values` indices
             std::unordered_multimap<Coor<N>, BlockIndex, TupleHash<Coor<N>>> gridToBlocks;
 
-            GridHash(Coor<N> dim) : dim{dim}, grid{{}}, gridToBlocks(16) {
+            /// Whether the blocks are indexed on `tree` instead of `grid` and `gridToBlocks`
+            bool use_tree;
+            /// Spatial index of the blocks
+            BlockTree<N> tree;
+
+            GridHash(Coor<N> dim) : dim{dim}, grid{{}}, gridToBlocks(16), use_tree(false) {
                 assert(check_positive(dim));
             }
 
@@ -585,6 +1322,24 @@ namespace superbblas {
                 blocks.push_back({from, size});
                 values.push_back(key);
 
+                // Index all the blocks on the tree if there are too many
+                const int tree_threshold = getStorageBlockTreeThreshold();
+                if (!use_tree && tree_threshold > 0 &&
+                    blocks.size() >= (std::size_t)tree_threshold) {
+                    use_tree = true;
+                    grid = std::array<From_size<1>, N>{{}};
+                    gridToBlocks.clear();
+                    for (BlockIndex bidx = 0; bidx < blocks.size(); ++bidx)
+                        for (const auto &box : periodic_boxes(blocks[bidx][0], blocks[bidx][1]))
+                            tree.insert(box, bidx);
+                    return;
+                }
+                if (use_tree) {
+                    for (const auto &box : periodic_boxes(from, size))
+                        tree.insert(box, blocks.size() - 1);
+                    return;
+                }
+
                 // Append the new intervals
                 for (unsigned int i = 0; i < N; ++i) {
                     // fs = {from, size} - \sum_j grid[i]_j
@@ -616,29 +1371,34 @@ namespace superbblas {
                 // Normalize from when being the whole dimension
                 from = normalize_from(from, size);
 
+                // Get the blocks that may overlap with the range
+                std::vector<BlockIndex> candidates;
+                if (use_tree) {
+                    for (const auto &box : periodic_boxes(from, size))
+                        tree.intersection(box, candidates);
+                    std::sort(candidates.begin(), candidates.end());
+                    candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                                     candidates.end());
+                } else {
+                    std::unordered_set<BlockIndex> visited(16);
+                    for (const auto &gi : grid_intersection(from, size)) {
+                        const auto ranges = gridToBlocks.equal_range(gi);
+                        for (auto it = ranges.first; it != ranges.second; ++it)
+                            if (visited.insert(it->second).second) candidates.push_back(it->second);
+                    }
+                }
+
                 // Compute the return
                 std::vector<std::pair<std::array<From_size_item<N>, 2>, Key>> r;
-                std::unordered_set<BlockIndex> visited(16);
-                for (const auto &gi : grid_intersection(from, size)) {
-                    const auto ranges = gridToBlocks.equal_range(gi);
-                    for (auto it = ranges.first; it != ranges.second; ++it) {
-                        BlockIndex bidx = it->second;
-
-                        // Skip if already visited
-                        if (visited.count(bidx) > 0) continue;
-
-                        // Do intersection between the block and the given range
-                        auto ranges =
-                            detail::intersection(blocks[bidx][0], blocks[bidx][1], from, size, dim);
-                        for (const auto &fs : ranges) {
-                            if (volume(fs[1]) == 0) continue;
-                            r.push_back({{blocks[bidx],
-                                          {normalize_coor(fs[0] - blocks[bidx][0], dim), fs[1]}},
-                                         values[bidx]});
-                        }
-
-                        // Note the visited block
-                        visited.insert(bidx);
+                for (BlockIndex bidx : candidates) {
+                    // Do intersection between the block and the given range
+                    auto ranges =
+                        detail::intersection(blocks[bidx][0], blocks[bidx][1], from, size, dim);
+                    for (const auto &fs : ranges) {
+                        if (volume(fs[1]) == 0) continue;
+                        r.push_back({{blocks[bidx],
+                                      {normalize_coor(fs[0] - blocks[bidx][0], dim), fs[1]}},
+                                     values[bidx]});
                     }
                 }
 
@@ -674,6 +1434,29 @@ namespace superbblas {
                 return r;
             }
 
+            /// Return the boxes without crossing the tensor boundaries covering the given range
+            std::vector<typename BlockTree<N>::Box> periodic_boxes(const Coor<N> &from,
+                                                                  const Coor<N> &size) const {
+                std::vector<typename BlockTree<N>::Box> r(1);
+                for (std::size_t i = 0; i < N; ++i) {
+                    IndexType to = from[i] + size[i];
+                    std::size_t n = r.size();
+                    if (to > dim[i]) {
+                        r.resize(n * 2);
+                        std::copy_n(r.begin(), n, r.begin() + n);
+                    }
+                    for (std::size_t j = 0; j < n; ++j) {
+                        r[j].from[i] = from[i];
+                        r[j].to[i] = std::min(to, dim[i]);
+                        if (to > dim[i]) {
+                            r[n + j].from[i] = 0;
+                            r[n + j].to[i] = to - dim[i];
+                        }
+                    }
+                }
+                return r;
+            }
+
             // Normalize from when being the whole dimension
             Coor<N> normalize_from(Coor<N> from, const Coor<N> &size) const {
                 for (std::size_t i = 0; i < N; ++i)
@@ -759,6 +1542,7 @@ namespace superbblas {
         template <std::size_t N, typename Comm> struct Storage_context : Storage_context_abstract {
             values_datatype values_type;  ///< type of the nonzero values
             std::size_t header_size;      ///< number of bytes before the field num_chunks
+            const int version;            ///< version of the S3T format of the file
             std::size_t disp;             ///< number of bytes before the current chunk
             FileHandler<Comm> fh;         ///< file descriptor
             const Coor<N> dim;            ///< global tensor dimensions
@@ -771,6 +1555,12 @@ namespace superbblas {
                                                   ///< (when checksum is BlockChecksum)
             std::size_t num_chunks;               ///< number of chunks written
             bool allow_writing;                   ///< whether to allow writing
+            FileMap mapping; ///< mapping of the file into memory (only for read-only storages)
+            std::shared_ptr<IOUring> ring; ///< engine for asynchronous reading and writing
+            bool ring_created;             ///< whether `get_ring` tried to create `ring`
+            bool modified_for_index;       ///< whether blocks were added since writing the index
+            std::size_t index_size;        ///< number of bytes of the index written in the file
+            Comm comm;                     ///< communicator
 
             /// displacement in the file of the values of a block
             std::vector<std::size_t> disp_values;
@@ -780,14 +1570,16 @@ namespace superbblas {
             std::vector<char> is_checksum_done;
             GridHash<N, std::size_t> blocks; ///< list of blocks already written
 
-            Storage_context(values_datatype values_type, std::size_t header_size,
+            Storage_context(values_datatype values_type, std::size_t header_size, int version,
                             FileHandler<Comm> fh, Coor<N> dim, bool change_endianness,
                             bool is_new_storage, checksum_type checksum,
                             std::size_t checksum_blocksize, checksum_t checksum_val,
-                            bool allow_writing)
+                            bool allow_writing, Comm comm)
                 : values_type(values_type),
                   header_size(header_size),
-                  disp(header_size + sizeof(double)), // hop over num_chunks
+                  version(version),
+                  // hop over num_chunks and index_disp
+                  disp(header_size + sizeof(double) * (version >= 1 ? 2 : 1)),
                   fh(fh),
                   dim(dim),
                   change_endianness(change_endianness),
@@ -798,18 +1590,98 @@ namespace superbblas {
                   checksum_val(checksum_val),
                   num_chunks(0),
                   allow_writing(allow_writing),
+                  mapping{nullptr, 0},
+                  ring_created(false),
+                  modified_for_index(is_new_storage),
+                  index_size(0),
+                  comm(comm),
                   blocks(dim) {}
 
+            /// Return the io_uring to queue the readings and writings, or null if not used
+            ///
+            /// NOTE: the io_uring is created on the first call, so storages only read through the
+            /// memory mapping don't create any.
+
+            IOUring *get_ring() {
+                if (!ring_created) {
+                    ring_created = true;
+                    if (get_file_descriptor(fh) >= 0)
+                        ring = create_io_uring(getStorageIOUringDepth());
+                }
+                return ring.get();
+            }
+
             std::size_t getNdim() override { return N; }
             CommType getCommType() override { return File<Comm>::value; }
-            void flush() override { detail::flush(fh); }
-            void preallocate(std::size_t size) override { detail::preallocate(fh, size); }
+            void flush() override {
+                write_index();
+                if (ring) io_uring_wait_all(*ring);
+                detail::flush(fh);
+            }
+            void preallocate(std::size_t size) override {
+                if (ring) io_uring_wait_all(*ring);
+                detail::preallocate(fh, size);
+            }
             ~Storage_context() override {
+                if (ring) io_uring_wait_all(*ring);
                 detail::flush(fh);
-                std::size_t filesize = disp + (checksum == NoChecksum ? 0 : sizeof(double));
+                std::size_t filesize =
+                    disp + (checksum == NoChecksum ? 0 : sizeof(double)) + index_size;
                 if (allow_writing) truncate(fh, filesize);
+                unmap_file(mapping);
                 close(fh);
             }
+
+            /// Write the index after the last chunk and annotate its position on the header
+            ///
+            /// NOTE: the index is written only if blocks were added since the last time. The index
+            /// ends with its own checksum, which covers all the index. `index_disp` on the header
+            /// is only covered by GlobalChecksum, which is computed after flushing; BlockChecksum
+            /// covers the chunk headers, which `read_all_blocks` compares with the index.
+
+            void write_index() {
+                if (!modified_for_index || !allow_writing || version < 1 || !getUseStorageIndex())
+                    return;
+
+                std::size_t num_blocks = disp_values.size();
+                std::size_t index_disp = disp + (checksum == NoChecksum ? 0 : sizeof(double));
+                std::size_t index_length = 5 + num_blocks * (N * 2 + 2);
+
+                // Root process writes the index
+                if (comm.rank == 0) {
+                    // Get from and size for each block; empty blocks aren't on `blocks`
+                    std::vector<From_size_item<N>> fs(num_blocks, From_size_item<N>{{}});
+                    for (std::size_t i = 0; i < blocks.blocks.size(); ++i)
+                        fs[blocks.values[i]] = blocks.blocks[i];
+
+                    std::vector<double> index;
+                    index.reserve(index_length);
+                    index.push_back(num_chunks);
+                    index.push_back(disp);
+                    index.push_back(checksum == BlockChecksum ? checksum_val : 0);
+                    index.push_back(num_blocks);
+                    for (std::size_t i = 0; i < num_blocks; ++i) {
+                        index.insert(index.end(), fs[i][0].begin(), fs[i][0].end());
+                        index.insert(index.end(), fs[i][1].begin(), fs[i][1].end());
+                        index.push_back(disp_values[i]);
+                        index.push_back(checksum == BlockChecksum ? disp_checksum[i] : 0);
+                    }
+                    if (change_endianness) detail::change_endianness(index.data(), index.size());
+                    double index_checksum = do_checksum(index.data(), index.size());
+                    if (change_endianness) detail::change_endianness(&index_checksum, 1);
+                    index.push_back(index_checksum);
+                    seek(fh, index_disp);
+                    iwrite(fh, index.data(), index.size());
+
+                    // Point to the index from the header
+                    double d = index_disp;
+                    if (change_endianness) detail::change_endianness(&d, 1);
+                    seek(fh, header_size + sizeof(double));
+                    iwrite(fh, &d, 1);
+                }
+                index_size = index_length * sizeof(double);
+                modified_for_index = false;
+            }
         };
 
         template <std::size_t N, typename T, typename Comm>
@@ -1039,10 +1911,18 @@ namespace superbblas {
             auto disp1 = std::get<0>(t);
             auto blk1 = std::get<1>(t);
             IndicesT<IndexType, Cpu> indices1 = std::get<2>(t);
-            for (std::size_t i = 0; i < indices1.size(); ++i) {
-                seek(sto.fh,
-                     disp + (disp1 + (indices1.data() == nullptr ? i : indices1[i])) * sizeof(Q));
-                iwrite(sto.fh, v0_host.data() + i * blk1, blk1, v0_host);
+            if (IOUring *ring = sto.get_ring()) {
+                write_runs(*ring, get_file_descriptor(sto.fh),
+                           get_file_runs<Q>(disp, disp1, blk1, indices1), v0_host.data(), v0_host);
+            } else if (getUseStoragePositionalIO()) {
+                write_runs(sto.fh, get_file_runs<Q>(disp, disp1, blk1, indices1), v0_host.data(),
+                           v0_host);
+            } else {
+                for (std::size_t i = 0; i < indices1.size(); ++i) {
+                    seek(sto.fh, disp + (disp1 + (indices1.data() == nullptr ? i : indices1[i])) *
+                                            sizeof(Q));
+                    iwrite(sto.fh, v0_host.data() + i * blk1, blk1, v0_host);
+                }
             }
 
             // Compute the checksum if the block is going to be completely overwritten
@@ -1106,19 +1986,23 @@ namespace superbblas {
         /// \param v1: data for the destination tensor
         /// \param ewop: either to copy or to add the origin values into the destination values
         /// \param co: coordinate linearization order
+        /// \param ring: (optional) queue the readings on this io_uring
+        /// \return: if `ring` is given, a callback to finish the operation after waiting for the
+        ///          io_uring; otherwise an empty callback
 
         template <typename IndexType, std::size_t Nd0, std::size_t Nd1, typename T, typename Q,
                   typename XPU1, typename EWOP, typename FileT>
-        void local_load(typename elem<T>::type alpha, const Order<Nd0> &o0, const Coor<Nd0> &from0,
-                        const Coor<Nd0> &size0, const Coor<Nd0> &dim0, FileT &fh, std::size_t disp,
-                        Order<Nd1> o1, Coor<Nd1> from1, Coor<Nd1> dim1, vector<Q, XPU1> v1, EWOP,
-                        CoorOrder co, bool do_change_endianness) {
+        Request local_load(typename elem<T>::type alpha, const Order<Nd0> &o0,
+                           const Coor<Nd0> &from0, const Coor<Nd0> &size0, const Coor<Nd0> &dim0,
+                           FileT &fh, std::size_t disp, Order<Nd1> o1, Coor<Nd1> from1,
+                           Coor<Nd1> dim1, vector<Q, XPU1> v1, EWOP, CoorOrder co,
+                           bool do_change_endianness, IOUring *ring) {
 
             tracker<XPU1> _t("local load", v1.ctx());
 
             // Shortcut for an empty range
             std::size_t vol = volume(size0);
-            if (vol == 0) return;
+            if (vol == 0) return {};
 
             // Make agree in ordering source and destination
             if (co != SlowToFast) {
@@ -1136,18 +2020,31 @@ namespace superbblas {
             auto disp0 = std::get<0>(t);
             auto blk0 = std::get<1>(t);
             IndicesT<IndexType, Cpu> indices0 = std::get<2>(t);
-            for (std::size_t i = 0; i < indices0.size(); ++i) {
-                seek(fh,
-                     disp + (disp0 + (indices0.data() == nullptr ? i : indices0[i])) * sizeof(T));
-                read(fh, v0.data() + i * blk0, blk0);
+            if (ring) {
+                read_runs(*ring, get_file_descriptor(fh),
+                          get_file_runs<T>(disp, disp0, blk0, indices0), v0.data(), v0);
+            } else if (getUseStoragePositionalIO()) {
+                read_runs(fh, get_file_runs<T>(disp, disp0, blk0, indices0), v0.data());
+            } else {
+                for (std::size_t i = 0; i < indices0.size(); ++i) {
+                    seek(fh, disp + (disp0 + (indices0.data() == nullptr ? i : indices0[i])) *
+                                        sizeof(T));
+                    read(fh, v0.data() + i * blk0, blk0);
+                }
             }
 
-            // Change endianness
-            if (do_change_endianness) change_endianness(v0.data(), v0.size());
+            Request finish = [=]() {
+                // Change endianness
+                if (do_change_endianness) change_endianness(v0.data(), v0.size());
 
-            // Write the values of v0 into v1
-            local_copy<Nd0, Nd1, T, Q>(alpha, o0, {{}}, size0, size0, (vector<const T, Cpu>)v0, {},
-                                       o1, from1, dim1, v1, {}, EWOp::Copy{}, co);
+                // Write the values of v0 into v1
+                local_copy<Nd0, Nd1, T, Q>(alpha, o0, {{}}, size0, size0,
+                                           (vector<const T, Cpu>)v0, {}, o1, from1, dim1, v1, {},
+                                           EWOp::Copy{}, co);
+            };
+            if (ring) return finish;
+            finish();
+            return {};
         }
 
         /// Copy from a storage into the tensor v1
@@ -1163,25 +2060,103 @@ namespace superbblas {
         /// \param v1: data for the destination tensor
         /// \param ewop: either to copy or to add the origin values into the destination values
         /// \param co: coordinate linearization order
+        /// \param ring: (optional) queue the readings on this io_uring
+        /// \return: if `ring` is given, a callback to finish the operation after waiting for the
+        ///          io_uring; otherwise an empty callback
 
         template <std::size_t Nd0, std::size_t Nd1, typename T, typename Q, typename XPU1,
                   typename EWOP, typename FileT>
-        void local_load(typename elem<T>::type alpha, const Order<Nd0> &o0, const Coor<Nd0> &from0,
-                        const Coor<Nd0> &size0, const Coor<Nd0> &dim0, FileT &fh, std::size_t disp,
-                        Order<Nd1> o1, Coor<Nd1> from1, Coor<Nd1> dim1, vector<Q, XPU1> v1, EWOP,
-                        CoorOrder co, bool do_change_endianness) {
+        Request local_load(typename elem<T>::type alpha, const Order<Nd0> &o0,
+                           const Coor<Nd0> &from0, const Coor<Nd0> &size0, const Coor<Nd0> &dim0,
+                           FileT &fh, std::size_t disp, Order<Nd1> o1, Coor<Nd1> from1,
+                           Coor<Nd1> dim1, vector<Q, XPU1> v1, EWOP, CoorOrder co,
+                           bool do_change_endianness, IOUring *ring = nullptr) {
 
             if (std::max(volume(dim0), volume(dim1)) >=
                 (std::size_t)std::numeric_limits<IndexType>::max()) {
-                local_load<std::size_t, Nd0, Nd1, T, Q>(alpha, o0, from0, size0, dim0, fh, disp, o1,
-                                                        from1, dim1, v1, EWOP{}, co,
-                                                        do_change_endianness);
+                return local_load<std::size_t, Nd0, Nd1, T, Q>(alpha, o0, from0, size0, dim0, fh,
+                                                               disp, o1, from1, dim1, v1, EWOP{},
+                                                               co, do_change_endianness, ring);
             } else {
+                return local_load<IndexType, Nd0, Nd1, T, Q>(alpha, o0, from0, size0, dim0, fh,
+                                                             disp, o1, from1, dim1, v1, EWOP{}, co,
+                                                             do_change_endianness, ring);
+            }
+        }
 
-                local_load<IndexType, Nd0, Nd1, T, Q>(alpha, o0, from0, size0, dim0, fh, disp, o1,
-                                                      from1, dim1, v1, EWOP{}, co,
-                                                      do_change_endianness);
+        /// Return whether the values of a block can be read from the file mapping
+        /// \param sto: storage context
+        /// \param blockIndex: index of the block
+        /// \param dim: dimensions of the block
+
+        template <typename T, std::size_t Nd, typename Comm>
+        bool is_block_mapped(const Storage_context<Nd, Comm> &sto, std::size_t blockIndex,
+                             const Coor<Nd> &dim) {
+            return sto.mapping.ptr != nullptr &&
+                   sto.disp_values[blockIndex] + volume(dim) * sizeof(T) <= sto.mapping.size;
+        }
+
+        /// Copy from a storage mapped into memory into the tensor v1
+        /// \param alpha: factor on the copy
+        /// \param o0: dimension labels for the origin tensor
+        /// \param from0: first coordinate to copy from the origin tensor
+        /// \param size0: number of coordinates to copy in each direction
+        /// \param dim0: dimension size for the origin tensor
+        /// \param mapping: file mapping
+        /// \param disp: number of bytes from the beginning of the file before the coordinate zero of this block
+        /// \param o1: dimension labels for the destination tensor
+        /// \param from1: coordinate in destination tensor where first coordinate from origin tensor is copied
+        /// \param dim1: dimension size for the destination tensor
+        /// \param v1: data for the destination tensor
+        /// \param ewop: either to copy or to add the origin values into the destination values
+        /// \param co: coordinate linearization order
+        ///
+        /// NOTE: unlike `local_load`, the values are copied without going through a buffer, and
+        /// they are not allowed to change endianness.
+
+        template <std::size_t Nd0, std::size_t Nd1, typename T, typename Q, typename XPU1,
+                  typename EWOP>
+        void local_load_mapped(typename elem<T>::type alpha, const Order<Nd0> &o0,
+                               const Coor<Nd0> &from0, const Coor<Nd0> &size0,
+                               const Coor<Nd0> &dim0, const FileMap &mapping, std::size_t disp,
+                               Order<Nd1> o1, Coor<Nd1> from1, Coor<Nd1> dim1, vector<Q, XPU1> v1,
+                               EWOP, CoorOrder co) {
+
+            tracker<XPU1> _t("local load mapped", v1.ctx());
+
+            // Shortcut for an empty range
+            std::size_t vol = volume(size0);
+            if (vol == 0) return;
+
+            // Make agree in ordering source and destination
+            if (co != SlowToFast) {
+                o1 = reverse(o1);
+                from1 = reverse(from1);
+                dim1 = reverse(dim1);
+                co = SlowToFast;
             }
+
+            // Hint the kernel to read the pages with the range; the range is contiguous on the
+            // file from the first to the last element unless it wraps around the block
+            bool wraps = false;
+            for (std::size_t i = 0; i < Nd0; ++i)
+                if (from0[i] + size0[i] > dim0[i]) wraps = true;
+            std::size_t first = 0, last = volume(dim0);
+            if (!wraps) {
+                auto strides = get_strides<std::size_t>(dim0, co);
+                Coor<Nd0> back = from0;
+                for (std::size_t i = 0; i < Nd0; ++i) back[i] += size0[i] - 1;
+                first = coor2index(from0, dim0, strides);
+                last = coor2index(back, dim0, strides) + 1;
+            }
+            advise_mapped_range(mapping, disp + first * sizeof(T), disp + last * sizeof(T));
+
+            // Write the values on the mapping into v1
+            _t.memops = (double)vol * sizeof(T);
+            vector<const T, Cpu> v0(volume(dim0), (const T *)(mapping.ptr + disp),
+                                    v1.ctx().toCpu());
+            local_copy<Nd0, Nd1, T, Q>(alpha, o0, from0, size0, dim0, v0, {}, o1, from1, dim1, v1,
+                                       {}, EWOp::Copy{}, co);
         }
 
         /// Copy the content of plural tensor v0 into a storage
@@ -1194,14 +2169,15 @@ namespace superbblas {
         /// \param sto: storage context
         /// \param comm: communicator context
         /// \param co: coordinate linearization order
+        /// \return: a callback to wait for the writings queued on the storage's io_uring
 
         template <std::size_t Nd0, std::size_t Nd1, typename T, typename Q, typename Comm,
                   typename XPU0, typename XPU1>
-        void save(typename elem<T>::type alpha, const Proc_ranges<Nd0> &p0, const Coor<Nd0> &from0,
-                  const Coor<Nd0> &size0, const Coor<Nd0> &dim0, const Order<Nd0> &o0,
-                  const Components_tmpl<Nd0, const T, XPU0, XPU1> &v0, Order<Nd1> o1,
-                  Storage_context<Nd1, Comm> &sto, Coor<Nd1> from1, CoorOrder co,
-                  const Comm &comm) {
+        Request save(typename elem<T>::type alpha, const Proc_ranges<Nd0> &p0,
+                     const Coor<Nd0> &from0, const Coor<Nd0> &size0, const Coor<Nd0> &dim0,
+                     const Order<Nd0> &o0, const Components_tmpl<Nd0, const T, XPU0, XPU1> &v0,
+                     Order<Nd1> o1, Storage_context<Nd1, Comm> &sto, Coor<Nd1> from1, CoorOrder co,
+                     const Comm &comm) {
 
             // Check that common arguments have the same value in all processes
             if (getDebugLevel() > 0) {
@@ -1308,6 +2284,12 @@ namespace superbblas {
 
             // Release resources on finished requests
             check_pending_requests(sto.fh);
+            if (!sto.ring) return {};
+            io_uring_test(*sto.ring);
+
+            // Return a callback to wait for the writings
+            std::shared_ptr<IOUring> ring = sto.ring;
+            return [=]() { io_uring_wait_all(*ring); };
         }
 
         /// Copy a range from a storage into a plural tensor v0
@@ -1358,27 +2340,76 @@ namespace superbblas {
 
             // Synchronize the content of the storage before reading from it
             if (sto.modified_for_flush) {
-                flush(sto.fh);
+                sto.flush();
                 sto.modified_for_flush = false;
             }
 
-            // Do the local file modifications
-            for (const Component<Nd1, Q, XPU0> &c1 : v1.first) {
-                for (const auto &o : overlaps[c1.componentId]) {
-                    assert(check_equivalence(o0, o.second_subtensor[1], o1, o.first_subtensor[1]));
-                    local_load<Nd0, Nd1, T, Q>(
-                        alpha, o0, o.second_subtensor[0], o.second_subtensor[1], o.second_tensor[1],
-                        sto.fh, sto.disp_values[o.blockIndex], o1, o.first_subtensor[0], c1.dim,
-                        c1.it, EWOP{}, co, sto.change_endianness);
+            // Do the local file modifications. The readings on the io_uring are finished when
+            // their buffers reach `getStorageIOUringBufferSize()` MiB, so that the buffers don't
+            // take as much memory as all the values loaded
+            std::vector<Request> reqs;
+            std::size_t buffer_size = 0;
+            const std::size_t max_buffer_size = getStorageIOUringBufferSize() * 1024 * 1024;
+            auto finish_reqs = [&]() {
+                if (sto.ring) io_uring_wait_all(*sto.ring);
+                for (const Request &r : reqs) wait(r);
+                reqs.clear();
+                buffer_size = 0;
+            };
+            auto push_req = [&](const Request &r, const Coor<Nd0> &size) {
+                if (!r) return;
+                reqs.push_back(r);
+                buffer_size += volume(size) * sizeof(T);
+                if (buffer_size >= max_buffer_size) finish_reqs();
+            };
+            try {
+                for (const Component<Nd1, Q, XPU0> &c1 : v1.first) {
+                    for (const auto &o : overlaps[c1.componentId]) {
+                        assert(check_equivalence(o0, o.second_subtensor[1], o1,
+                                                 o.first_subtensor[1]));
+                        if (is_block_mapped<T>(sto, o.blockIndex, o.second_tensor[1]))
+                            local_load_mapped<Nd0, Nd1, T, Q>(
+                                alpha, o0, o.second_subtensor[0], o.second_subtensor[1],
+                                o.second_tensor[1], sto.mapping, sto.disp_values[o.blockIndex],
+                                o1, o.first_subtensor[0], c1.dim, c1.it, EWOP{}, co);
+                        else
+                            push_req(local_load<Nd0, Nd1, T, Q>(
+                                         alpha, o0, o.second_subtensor[0], o.second_subtensor[1],
+                                         o.second_tensor[1], sto.fh,
+                                         sto.disp_values[o.blockIndex], o1, o.first_subtensor[0],
+                                         c1.dim, c1.it, EWOP{}, co, sto.change_endianness,
+                                         sto.get_ring()),
+                                     o.second_subtensor[1]);
+                    }
                 }
-            }
-            for (const Component<Nd1, Q, XPU1> &c1 : v1.second) {
-                for (const auto &o : overlaps[c1.componentId]) {
-                    local_load<Nd0, Nd1, T, Q>(
-                        alpha, o0, o.second_subtensor[0], o.second_subtensor[1], o.second_tensor[1],
-                        sto.fh, sto.disp_values[o.blockIndex], o1, o.first_subtensor[0], c1.dim,
-                        c1.it, EWOP{}, co, sto.change_endianness);
+                for (const Component<Nd1, Q, XPU1> &c1 : v1.second) {
+                    for (const auto &o : overlaps[c1.componentId]) {
+                        if (is_block_mapped<T>(sto, o.blockIndex, o.second_tensor[1]))
+                            local_load_mapped<Nd0, Nd1, T, Q>(
+                                alpha, o0, o.second_subtensor[0], o.second_subtensor[1],
+                                o.second_tensor[1], sto.mapping, sto.disp_values[o.blockIndex],
+                                o1, o.first_subtensor[0], c1.dim, c1.it, EWOP{}, co);
+                        else
+                            push_req(local_load<Nd0, Nd1, T, Q>(
+                                         alpha, o0, o.second_subtensor[0], o.second_subtensor[1],
+                                         o.second_tensor[1], sto.fh,
+                                         sto.disp_values[o.blockIndex], o1, o.first_subtensor[0],
+                                         c1.dim, c1.it, EWOP{}, co, sto.change_endianness,
+                                         sto.get_ring()),
+                                     o.second_subtensor[1]);
+                    }
+                }
+                finish_reqs();
+            } catch (...) {
+                // Wait for the readings in flight before releasing their buffers, and report the
+                // first error; the operations still in flight if the waiting fails keep their
+                // buffers alive
+                if (sto.ring) {
+                    try {
+                        io_uring_wait_all(*sto.ring);
+                    } catch (...) {}
                 }
+                throw;
             }
         }
 
@@ -1458,6 +2489,10 @@ namespace superbblas {
                 sizeof(int) * 6 + metadata_length + padding_size + sizeof(double) * (Nd + 1);
             checksum_t checksum_val = 0;
 
+            // Create files without the field index_disp, which older versions of superbblas
+            // can't read, unless the index is used
+            const int version = getUseStorageIndex() ? last_version : 0;
+
             if (comm.rank == 0) {
                 // Write magic_number
                 int i32 = magic_number;
@@ -1465,7 +2500,7 @@ namespace superbblas {
                 checksum_val = do_checksum(&i32, 1, 0, checksum_val);
 
                 // Write version
-                i32 = 0;
+                i32 = version;
                 write(fh, &i32, 1);
                 checksum_val = do_checksum(&i32, 1, 0, checksum_val);
 
@@ -1509,11 +2544,15 @@ namespace superbblas {
                 // Write num_chunks
                 d = 0;
                 write(fh, &d, 1);
+
+                // Write index_disp (from version 1)
+                if (version >= 1) write(fh, &d, 1);
             }
 
             // Create the handler
             return new Storage_context<Nd, Comm>{get_values_datatype<T>(),
                                                  header_size,
+                                                 version,
                                                  fh,
                                                  dim,
                                                  false /* don't change endianness */,
@@ -1521,7 +2560,8 @@ namespace superbblas {
                                                  checksum,
                                                  default_checksum_blocksize,
                                                  checksum_val,
-                                                 true /* allow writing */};
+                                                 true /* allow writing */,
+                                                 comm};
         }
 
         /// Read fields in the header of a storage
@@ -1531,7 +2571,8 @@ namespace superbblas {
         /// \param values_dtype: (out) type of the values
         /// \param metadata: (out) metadata content
         /// \param size: (out)tensor dimensions
-        /// \param header_size: (out) number of bytes before the first chunk
+        /// \param header_size: (out) number of bytes before the field num_chunks
+        /// \param version: (out) version of the S3T format
         /// \param do_change_endianness: (out) whether to change endianness
         /// \param checksum: (out) checksum type
         /// \param checksum_blocksize: (out) blocksize use by compute_checksum
@@ -1541,7 +2582,7 @@ namespace superbblas {
         template <typename Comm>
         void open_storage(const char *filename, bool allow_writing, CoorOrder co,
                           values_datatype &values_dtype, std::vector<char> &metadata,
-                          std::vector<IndexType> &size, std::size_t &header_size,
+                          std::vector<IndexType> &size, std::size_t &header_size, int &version,
                           bool &do_change_endianness, checksum_type &checksum,
                           std::size_t &checksum_blocksize, checksum_t &checksum_val, Comm comm,
                           FileHandler<Comm> &fh) {
@@ -1576,9 +2617,10 @@ namespace superbblas {
             // Read version
             read(fh, &i32, 1);
             if (do_change_endianness) change_endianness(&i32, 1);
-            if (i32 != 0)
+            if (i32 < 0 || i32 > last_version)
                 throw std::runtime_error(
                     "Unsupported version of the tensor format; try a newer version of supperbblas");
+            version = i32;
 
             // Read values_datatype
             read(fh, &i32, 1);
@@ -1786,17 +2828,96 @@ namespace superbblas {
             // Update disp
             sto.disp = values_start;
 
-            // Update num_chunks
+            // Update num_chunks and invalidate the index, which was overwritten by the new chunk
             sto.num_chunks++;
             if (comm.rank == 0) {
-                double num_chunks = sto.num_chunks;
-                if (sto.change_endianness) change_endianness(&num_chunks, 1);
+                double num_chunks_index_disp[2] = {(double)sto.num_chunks, 0};
+                if (sto.change_endianness) change_endianness(num_chunks_index_disp, 2);
                 seek(sto.fh, sto.header_size);
-                iwrite(sto.fh, &num_chunks, 1);
+                iwrite(sto.fh, num_chunks_index_disp, sto.version >= 1 ? 2 : 1);
             }
+            sto.index_size = 0;
 
             // Mark the storage as modified
-            sto.modified_for_flush = sto.modified_for_checksum = true;
+            sto.modified_for_flush = sto.modified_for_checksum = sto.modified_for_index = true;
+        }
+
+        /// Broadcast a vector from the root process
+        /// \param v: vector to broadcast; it's resized on the other processes
+        /// \param comm: communicator
+
+        template <typename T> void broadcast(std::vector<T> &, SelfComm) {}
+
+#ifdef SUPERBBLAS_USE_MPI
+        template <typename T> void broadcast(std::vector<T> &v, MpiComm comm) {
+            std::size_t n = v.size();
+            MPI_check(MPI_Bcast(&n, sizeof(n), MPI_BYTE, 0, comm.comm));
+            v.resize(n);
+            const std::size_t max_n = std::numeric_limits<int>::max() / sizeof(T);
+            for (std::size_t i = 0; i < n; i += max_n)
+                MPI_check(MPI_Bcast(v.data() + i, std::min(n - i, max_n) * sizeof(T), MPI_BYTE, 0,
+                                    comm.comm));
+        }
+#endif // SUPERBBLAS_USE_MPI
+
+        /// Read the blocks from the index at the end of the storage
+        /// \param sto: storage context
+        /// \param index_disp: first byte of the index
+        /// \return bool: whether the index was valid; if not, the storage context is not modified
+        ///
+        /// NOTE: only the root process reads the index, which is broadcast to the rest.
+
+        template <std::size_t Nd1, typename Comm>
+        bool read_index(Storage_context<Nd1, Comm> &sto, std::size_t index_disp) {
+
+            tracker<Cpu> _t("read storage index", Cpu{0});
+
+            // Root process reads the index; the index is returned empty if it isn't valid
+            const std::size_t checksum_size = (sto.checksum == NoChecksum ? 0 : sizeof(double));
+            const std::size_t block_length = Nd1 * 2 + 2;
+            std::vector<double> index;
+            if (sto.comm.rank == 0) {
+                try {
+                    index.resize(4);
+                    seek(sto.fh, index_disp);
+                    read(sto.fh, index.data(), 4);
+                    double num_blocks = index[3];
+                    if (sto.change_endianness) change_endianness(&num_blocks, 1);
+                    // Every block has `from` and `size` also on the chunk headers before the index
+                    if (num_blocks >= 0 && num_blocks * Nd1 * 2 * sizeof(double) <= index_disp) {
+                        index.resize(4 + (std::size_t)num_blocks * block_length + 1);
+                        read(sto.fh, index.data() + 4, index.size() - 4);
+                        checksum_t index_checksum = do_checksum(index.data(), index.size() - 1);
+                        if (sto.change_endianness) change_endianness(index.data(), index.size());
+                        if (index_checksum != index.back() || index[0] != sto.num_chunks ||
+                            index[1] + checksum_size != index_disp)
+                            index.clear();
+                    } else {
+                        index.clear();
+                    }
+                } catch (const std::exception &) { index.clear(); }
+            }
+            broadcast(index, sto.comm);
+            if (index.size() == 0) return false;
+
+            // Annotate the blocks; the checksum of the chunk headers on index[2] isn't used, as
+            // `read_all_blocks` computes it from the chunk headers
+            sto.disp = index[1];
+            std::size_t num_blocks = index[3];
+            for (std::size_t i = 0; i < num_blocks; ++i) {
+                const double *b = &index[4 + i * block_length];
+                Coor<Nd1> from, size;
+                std::copy_n(b, Nd1, from.begin());
+                std::copy_n(b + Nd1, Nd1, size.begin());
+                sto.blocks.append_block(from, size, sto.disp_values.size());
+                sto.disp_values.push_back(b[Nd1 * 2]);
+                if (sto.checksum == BlockChecksum) {
+                    sto.disp_checksum.push_back(b[Nd1 * 2 + 1]);
+                    sto.is_checksum_done.push_back(1); // mark them as done
+                }
+            }
+            sto.index_size = index.size() * sizeof(double);
+            return true;
         }
 
         /// Read all blocks from storage
@@ -1805,17 +2926,29 @@ namespace superbblas {
         template <std::size_t Nd1, typename Q, typename Comm>
         void read_all_blocks(Storage_context<Nd1, Comm> &sto) {
 
-            // Read num_chunks
-            double num_chunks = 0;
+            // Read num_chunks and index_disp (from version 1)
+            double num_chunks_index_disp[2] = {0, 0};
             std::size_t cur = sto.header_size;
             seek(sto.fh, cur);
-            read(sto.fh, &num_chunks, 1);
-            cur += sizeof(double);
-            if (sto.change_endianness) change_endianness(&num_chunks, 1);
-            sto.num_chunks = num_chunks;
-
-            // Read chunks
-            for (std::size_t chunk = 0; chunk < sto.num_chunks; chunk++) {
+            read(sto.fh, num_chunks_index_disp, sto.version >= 1 ? 2 : 1);
+            cur += sizeof(double) * (sto.version >= 1 ? 2 : 1);
+            if (sto.change_endianness) change_endianness(num_chunks_index_disp, 2);
+            sto.num_chunks = num_chunks_index_disp[0];
+            std::size_t index_disp = num_chunks_index_disp[1];
+
+            // Read the blocks from the index if possible
+            bool from_index = index_disp > 0 && getUseStorageIndex() && read_index(sto, index_disp);
+
+            // Otherwise, go back to the first chunk if the reading of the index moved away. With
+            // BlockChecksum, the chunk headers are read anyway to compute their checksum, and the
+            // position of the blocks on them are compared with the ones on the index
+            const bool check_index = from_index && sto.checksum == BlockChecksum;
+            if ((!from_index || check_index) && index_disp > 0) seek(sto.fh, cur);
+
+            // Read the chunks
+            std::size_t block_index = 0; // first block of the chunk on the index
+            for (std::size_t chunk = 0; (!from_index || check_index) && chunk < sto.num_chunks;
+                 chunk++) {
                 // Read the number of blocks in this chunk
                 double d;
                 read(sto.fh, &d, 1);
@@ -1847,32 +2980,49 @@ namespace superbblas {
                     blocks.push_back(From_size_item<Nd1>{from, size});
                 }
 
-                // Annotate where the nonzero values start for the block
+                // Annotate where the nonzero values start for the block, or check them
                 cur += sizeof(double) + num_blocks * Nd1 * sizeof(double) * 2;
                 for (std::size_t i = 0; i < num_blocks; ++i) {
-                    sto.blocks.append_block(blocks[i][0], blocks[i][1], sto.disp_values.size());
-                    sto.disp_values.push_back(cur);
+                    if (!check_index) {
+                        sto.blocks.append_block(blocks[i][0], blocks[i][1],
+                                                sto.disp_values.size());
+                        sto.disp_values.push_back(cur);
+                    } else if (block_index + i >= sto.disp_values.size() ||
+                               sto.disp_values[block_index + i] != cur) {
+                        throw std::runtime_error("Checksum failed: the chunk headers don't match "
+                                                 "the index");
+                    }
                     cur += num_values[i] * sizeof(Q);
                 }
                 if (sto.checksum == BlockChecksum) {
                     for (std::size_t i = 0; i < num_blocks; ++i) {
-                        sto.disp_checksum.push_back(cur);
-                        sto.is_checksum_done.push_back(1); // mark them as done
+                        if (!check_index) {
+                            sto.disp_checksum.push_back(cur);
+                            sto.is_checksum_done.push_back(1); // mark them as done
+                        } else if (sto.disp_checksum[block_index + i] != cur) {
+                            throw std::runtime_error("Checksum failed: the chunk headers don't "
+                                                     "match the index");
+                        }
                         cur += sizeof(double);
                     }
                 }
+                block_index += num_blocks;
 
                 // Set the beginning for a new block
                 seek(sto.fh, cur);
             }
 
             // Update disp
-            sto.disp = cur;
+            if (!from_index) sto.disp = cur;
+            if (check_index && (block_index != sto.disp_values.size() || cur != sto.disp))
+                throw std::runtime_error(
+                    "Checksum failed: the chunk headers don't match the index");
 
             // Check the checksum on the headers
             if (sto.checksum != NoChecksum) {
                 // Read checksum
                 double d;
+                seek(sto.fh, sto.disp);
                 read(sto.fh, &d, 1);
                 if (sto.change_endianness) change_endianness(&d, 1);
 
@@ -1902,12 +3052,13 @@ namespace superbblas {
             std::vector<char> metadata;
             std::vector<IndexType> size;
             std::size_t header_size;
+            int version;
             bool do_change_endianness;
             checksum_type checksum;
             std::size_t checksum_blocksize;
             checksum_t checksum_header;
             open_storage(filename, allow_writing, SlowToFast, values_dtype, metadata, size,
-                         header_size, do_change_endianness, checksum, checksum_blocksize,
+                         header_size, version, do_change_endianness, checksum, checksum_blocksize,
                          checksum_header, comm, fh);
 
             if (values_dtype != get_values_datatype<T>())
@@ -1921,15 +3072,28 @@ namespace superbblas {
             std::copy_n(size.begin(), Nd, dim.begin());
 
             // Create the handler
-            Storage_context<Nd, Comm> *sto = new Storage_context<Nd, Comm>{
-                values_dtype, header_size,          fh,
-                dim,          do_change_endianness, false /* not new storage */,
-                checksum,     checksum_blocksize,   checksum_header,
-                allow_writing};
+            Storage_context<Nd, Comm> *sto =
+                new Storage_context<Nd, Comm>{values_dtype,
+                                              header_size,
+                                              version,
+                                              fh,
+                                              dim,
+                                              do_change_endianness,
+                                              false /* not new storage */,
+                                              checksum,
+                                              checksum_blocksize,
+                                              checksum_header,
+                                              allow_writing,
+                                              comm};
 
             // Read the nonzero blocks
             read_all_blocks<Nd, T, Comm>(*sto);
 
+            // Map the file into memory if it isn't going to be modified; the values are copied
+            // directly from the mapping when they don't need to change endianness
+            if (!allow_writing && !do_change_endianness && getUseStorageMmap())
+                sto->mapping = map_file(get_file_descriptor(sto->fh));
+
             // Return handler
             return sto;
         }
@@ -1982,7 +3146,7 @@ namespace superbblas {
 
             // Synchronize the content of the storage before reading from it
             if (sto.modified_for_flush) {
-                flush(sto.fh);
+                sto.flush();
                 sto.modified_for_flush = false;
             }
 
@@ -2166,13 +3330,14 @@ namespace superbblas {
 
         detail::FileHandler<detail::MpiComm> fh;
         std::size_t header_size;
+        int version;
         bool do_change_endianness;
         checksum_type checksum;
         std::size_t checksum_blocksize;
         detail::checksum_t checksum_header;
         detail::open_storage(filename, false, co, values_dtype, metadata, size, header_size,
-                             do_change_endianness, checksum, checksum_blocksize, checksum_header,
-                             comm, fh);
+                             version, do_change_endianness, checksum, checksum_blocksize,
+                             checksum_header, comm, fh);
         detail::close(fh);
     }
 
@@ -2255,23 +3420,30 @@ namespace superbblas {
     /// \param from1: coordinate in destination tensor where first coordinate from origin tensor is copied
     /// \param stoh: handle to a tensor storage
     /// \param co: coordinate linearization order; either `FastToSlow` for natural order or `SlowToFast` for lexicographic order
+    /// \param request: (optional) return a callback to finish the operation later with `wait`
     /// \param session: concurrent calls should have different session
 
     template <std::size_t Nd0, std::size_t Nd1, typename T, typename Q>
     void save(typename elem<T>::type alpha, const PartitionItem<Nd0> *p0, int ncomponents0,
               const char *o0, const Coor<Nd0> &from0, const Coor<Nd0> &size0, const Coor<Nd0> &dim0,
               const T **v0, const Context *ctx0, const char *o1, const Coor<Nd1> &from1,
-              Storage_handle stoh, MPI_Comm mpicomm, CoorOrder co, Session session = 0) {
+              Storage_handle stoh, MPI_Comm mpicomm, CoorOrder co, Request *request = nullptr,
+              Session session = 0) {
 
         detail::Storage_context<Nd1, detail::MpiComm> &sto =
             *detail::get_storage_context<Nd1, Q, detail::MpiComm>(stoh);
         detail::MpiComm comm = detail::get_comm(mpicomm);
 
-        detail::save<Nd0, Nd1, T, Q>(
+        Request r = detail::save<Nd0, Nd1, T, Q>(
             alpha, detail::get_from_size(p0, ncomponents0 * comm.nprocs, comm), from0, size0, dim0,
             detail::toArray<Nd0>(o0, "o0"),
             detail::get_components<Nd0>(v0, nullptr, ctx0, ncomponents0, p0, comm, session),
             detail::toArray<Nd1>(o1, "o1"), sto, from1, co, comm);
+
+        if (request)
+            *request = r;
+        else
+            wait(r);
     }
 
     /// Copy from a storage into a plural tensor v1
@@ -2410,13 +3582,14 @@ namespace superbblas {
 
         detail::FileHandler<detail::SelfComm> fh;
         std::size_t header_size;
+        int version;
         bool do_change_endianness;
         checksum_type checksum;
         std::size_t checksum_blocksize;
         detail::checksum_t checksum_header;
         detail::open_storage(filename, false, co, values_dtype, metadata, size, header_size,
-                             do_change_endianness, checksum, checksum_blocksize, checksum_header,
-                             comm, fh);
+                             version, do_change_endianness, checksum, checksum_blocksize,
+                             checksum_header, comm, fh);
         detail::close(fh);
     }
 
@@ -2534,23 +3707,30 @@ namespace superbblas {
     /// \param from1: coordinate in destination tensor where first coordinate from origin tensor is copied
     /// \param stoh: handle to a tensor storage
     /// \param co: coordinate linearization order; either `FastToSlow` for natural order or `SlowToFast` for lexicographic order
+    /// \param request: (optional) return a callback to finish the operation later with `wait`
     /// \param session: concurrent calls should have different session
 
     template <std::size_t Nd0, std::size_t Nd1, typename T, typename Q>
     void save(typename elem<T>::type alpha, const PartitionItem<Nd0> *p0, int ncomponents0,
               const char *o0, const Coor<Nd0> &from0, const Coor<Nd0> &size0, const Coor<Nd0> &dim0,
               const T **v0, const Context *ctx0, const char *o1, const Coor<Nd1> &from1,
-              Storage_handle stoh, CoorOrder co, Session session = 0) {
+              Storage_handle stoh, CoorOrder co, Request *request = nullptr,
+              Session session = 0) {
 
         detail::Storage_context<Nd1, detail::SelfComm> &sto =
             *detail::get_storage_context<Nd1, Q, detail::SelfComm>(stoh);
         detail::SelfComm comm = detail::get_comm();
 
-        detail::save<Nd0, Nd1, T, Q>(
+        Request r = detail::save<Nd0, Nd1, T, Q>(
             alpha, detail::get_from_size(p0, ncomponents0 * comm.nprocs, comm), from0, size0, dim0,
             detail::toArray<Nd0>(o0, "o0"),
             detail::get_components<Nd0>(v0, nullptr, ctx0, ncomponents0, p0, comm, session),
             detail::toArray<Nd1>(o1, "o1"), sto, from1, co, comm);
+
+        if (request)
+            *request = r;
+        else
+            wait(r);
     }
 
     /// Copy from a storage into a plural tensor v1
@@ -1,6 +1,7 @@
 #include "superbblas.h"
 #include <iostream>
 #include <limits>
+#include <set>
 #include <sstream>
 #include <stdexcept>
 #include <vector>
@@ -384,6 +385,281 @@ void test_copy_blocking(std::size_t size, XPU xpu, EWOP, unsigned int nrep = 10)
     test_copy_blocking<T>(size, xpu, EWOP{}, T{0}, nrep);
 }
 
+template <typename T, typename Q, typename EWOP>
+void test_copy_blocking_fixed(std::size_t size, EWOP, unsigned int nrep = 10) {
+    using Tc = typename ccomplex<T>::type;
+    using Qc = typename ccomplex<Q>::type;
+
+    // Normalize size
+    size /= (sizeof(T) / sizeof(float));
+
+    vector<T, Cpu> t0 = gen_dummy_vector<T, Cpu>::get(size, Cpu{});
+    vector<Q, Cpu> t1 = gen_dummy_vector<Q, Cpu>::get(size, Cpu{});
+    const Tc alpha = (Tc)1;
+    std::vector<int> blockings{3, 4, 12, 24};
+    for (int blocking : blockings) {
+        Indices<Cpu> i0 = gen_dummy_perm(size / blocking, size / blocking, Cpu{}, blocking);
+        Indices<Cpu> i1 = gen_dummy_perm(size / blocking, size / blocking, Cpu{}, blocking);
+        IndexType n = size / blocking;
+
+        // Check that both paths give the same result
+        {
+            vector<Q, Cpu> r_generic = gen_dummy_vector<Q, Cpu>::get(size, Cpu{});
+            vector<Q, Cpu> r_fixed = gen_dummy_vector<Q, Cpu>::get(size, Cpu{});
+            const Tc alpha2 = (Tc)2;
+            copy_n_blocking_cpu(alpha2, (Tc *)t0.data(), blocking, i0.data(), Cpu{}, n,
+                                (Qc *)r_generic.data(), i1.data(), Cpu{}, EWOP{});
+            copy_n_blocking_cpu_select(alpha2, (Tc *)t0.data(), blocking, i0.data(), Cpu{}, n,
+                                       (Qc *)r_fixed.data(), i1.data(), Cpu{}, EWOP{});
+            check_are_equal<Q>(r_generic, r_fixed);
+        }
+
+        // Generic path with the blocking given at runtime
+        copy_n_blocking_cpu(alpha, (Tc *)t0.data(), blocking, i0.data(), Cpu{}, n,
+                            (Qc *)t1.data(), i1.data(), Cpu{}, EWOP{});
+        double t = w_time();
+        for (unsigned int rep = 0; rep < nrep; ++rep)
+            copy_n_blocking_cpu(alpha, (Tc *)t0.data(), blocking, i0.data(), Cpu{}, n,
+                                (Qc *)t1.data(), i1.data(), Cpu{}, EWOP{});
+        double t_generic = (w_time() - t) / nrep;
+
+        // Path with the blocking given at compile time
+        copy_n_blocking_cpu_select(alpha, (Tc *)t0.data(), blocking, i0.data(), Cpu{}, n,
+                                   (Qc *)t1.data(), i1.data(), Cpu{}, EWOP{});
+        t = w_time();
+        for (unsigned int rep = 0; rep < nrep; ++rep)
+            copy_n_blocking_cpu_select(alpha, (Tc *)t0.data(), blocking, i0.data(), Cpu{}, n,
+                                       (Qc *)t1.data(), i1.data(), Cpu{}, EWOP{});
+        double t_fixed = (w_time() - t) / nrep;
+
+        const char *sep = "    ";
+        std::cout << "blocking: " << blocking << "\t" << toStr<T>::get << " -> " << toStr<Q>::get
+                  << " in " << toStr<EWOP>::get << " (" << sizeof(T) * size / 1024. / 1024
+                  << " MiB)" << sep << "generic : "
+                  << sizeof(T) * size / t_generic / 1024 / 1024 / 1024 << " GiB/s" << sep
+                  << "fixed : " << sizeof(T) * size / t_fixed / 1024 / 1024 / 1024 << " GiB/s"
+                  << std::endl;
+    }
+}
+
+template <typename T> void test_bsr_matvec_small_blocks(std::size_t size, unsigned int nrep = 10) {
+    // Normalize size
+    size /= (sizeof(T) / sizeof(float));
+
+    const IndexType nnz_per_row = 9;
+    std::vector<int> blockings{2, 3, 4, 5, 6, 8, 12};
+    std::vector<IndexType> ncolss{1, 12};
+    for (int blocking : blockings) {
+        for (IndexType ncols : ncolss) {
+            // Generate a BSR operator with `nnz_per_row` blocks on each block row
+            const IndexType bi = blocking, bd = blocking;
+            const IndexType block_rows =
+                std::max(IndexType(1), IndexType(size / (bi * bd * nnz_per_row)));
+            vector<T, Cpu> nonzeros =
+                gen_dummy_vector<T, Cpu>::get(block_rows * nnz_per_row * bi * bd, Cpu{});
+            vector<IndexType, Cpu> ii(block_rows + 1, Cpu{}), jj(block_rows * nnz_per_row, Cpu{});
+            for (IndexType i = 0; i <= block_rows; ++i) ii[i] = i * nnz_per_row;
+            for (IndexType i = 0; i < block_rows; ++i)
+                for (IndexType j = 0; j < nnz_per_row; ++j)
+                    jj[i * nnz_per_row + j] = (i + j * j * 7) % block_rows * bd;
+            std::vector<IndexType> row_part =
+                get_balanced_row_partition(ii.data(), block_rows, get_max_cpu_threads());
+            vector<T, Cpu> x = gen_dummy_vector<T, Cpu>::get(block_rows * bd * ncols, Cpu{});
+            vector<T, Cpu> y0(block_rows * bi * ncols, Cpu{}), y1(block_rows * bi * ncols, Cpu{});
+
+            // Contract each block with a BLAS call
+            const T alpha{1};
+            double t = w_time();
+            for (unsigned int rep = 0; rep < nrep; ++rep)
+                bsr_matvec_cpu(false, block_rows, bi, bd, alpha, nonzeros.data(), false,
+                               ii.data(), jj.data(), x.data(), ncols, RowMajor, y0.data(), ncols,
+                               RowMajor, ncols, row_part);
+            double t_blas = (w_time() - t) / nrep;
+
+            // Contract each block row with the microkernels
+            t = w_time();
+            for (unsigned int rep = 0; rep < nrep; ++rep)
+                bsr_matvec_cpu(true, block_rows, bi, bd, alpha, nonzeros.data(), false, ii.data(),
+                               jj.data(), x.data(), ncols, RowMajor, y1.data(), ncols, RowMajor,
+                               ncols, row_part);
+            double t_micro = (w_time() - t) / nrep;
+
+            // Contract each block row with the microkernels and compressed column indices
+            BSRCompressedIndices cjj =
+                get_bsr_compressed_indices(block_rows, bd, ii.data(), jj.data(), row_part);
+            vector<T, Cpu> y3(block_rows * bi * ncols, Cpu{});
+            t = w_time();
+            for (unsigned int rep = 0; rep < nrep; ++rep)
+                bsr_matvec_cpu(true, block_rows, bi, bd, alpha, nonzeros.data(), false, ii.data(),
+                               jj.data(), x.data(), ncols, RowMajor, y3.data(), ncols, RowMajor,
+                               ncols, row_part, &cjj);
+            double t_cmicro = (w_time() - t) / nrep;
+
+            // Contract with the SELL format
+            SellBSR<T> sell =
+                get_sell_bsr(block_rows, bi, bd, nonzeros.data(), false, ii.data(), jj.data(),
+                             get_sell_chunk_size(bi), 1, std::numeric_limits<double>::max());
+            vector<T, Cpu> y2(block_rows * bi * ncols, Cpu{});
+            t = w_time();
+            for (unsigned int rep = 0; rep < nrep; ++rep)
+                bsr_sell_matvec_cpu(sell, bi, bd, alpha, x.data(), ncols, RowMajor, y2.data(),
+                                    ncols, RowMajor, ncols);
+            double t_sell = (w_time() - t) / nrep;
+
+            // Check the results
+            double diff = 0, diff_cmicro = 0, diff_sell = 0, norm = 0;
+            for (std::size_t i = 0; i < y0.size(); ++i) {
+                diff += std::norm(y0[i] - y1[i]);
+                diff_cmicro += std::norm(y0[i] - y3[i]);
+                diff_sell += std::norm(y0[i] - y2[i]);
+                norm += std::norm(y0[i]);
+            }
+            if (diff > norm * 1e-4 || diff_cmicro > norm * 1e-4 || diff_sell > norm * 1e-4)
+                throw std::runtime_error("Result mismatch");
+
+            const char *sep = "    ";
+            double gflops = (is_complex<T>::value ? 8. : 2.) * block_rows * nnz_per_row * bi * bd *
+                            ncols / 1e9;
+            std::cout << "block: " << blocking << "\t" << toStr<T>::get << " ncols: " << ncols
+                      << sep << "blas : " << gflops / t_blas << " GFLOPS" << sep
+                      << "microkernel : " << gflops / t_micro << " GFLOPS" << sep
+                      << "compressed indices : " << gflops / t_cmicro << " GFLOPS" << sep
+                      << "sell : " << gflops / t_sell << " GFLOPS" << std::endl;
+        }
+    }
+}
+
+template <typename T> void test_bsr_matvec_balance(std::size_t size, unsigned int nrep = 10) {
+    // Normalize size
+    size /= (sizeof(T) / sizeof(float));
+
+    // Generate a BSR operator with 4x4 blocks, where the first block rows have many more
+    // nonzero blocks than the rest
+    const IndexType bi = 4, bd = 4, ncols = 4;
+    const IndexType block_rows = std::max(IndexType(8), IndexType(size / (bi * bd * 8)));
+    vector<IndexType, Cpu> ii(block_rows + 1, Cpu{});
+    ii[0] = 0;
+    for (IndexType i = 0; i < block_rows; ++i) ii[i + 1] = ii[i] + (i < block_rows / 8 ? 36 : 4);
+    vector<IndexType, Cpu> jj(ii[block_rows], Cpu{});
+    for (IndexType i = 0; i < block_rows; ++i)
+        for (IndexType j = ii[i]; j < ii[i + 1]; ++j)
+            jj[j] = (i + (j - ii[i]) * 7) % block_rows * bd;
+    vector<T, Cpu> nonzeros = gen_dummy_vector<T, Cpu>::get(ii[block_rows] * bi * bd, Cpu{});
+    vector<T, Cpu> x = gen_dummy_vector<T, Cpu>::get(block_rows * bd * ncols, Cpu{});
+    vector<T, Cpu> y(block_rows * bi * ncols, Cpu{});
+
+    const T alpha{1};
+    std::vector<IndexType> even_part{};
+    std::vector<IndexType> balanced_part =
+        get_balanced_row_partition(ii.data(), block_rows, get_max_cpu_threads());
+    double t[2];
+    for (int balanced = 0; balanced < 2; ++balanced) {
+        const std::vector<IndexType> &row_part = balanced ? balanced_part : even_part;
+        bsr_matvec_cpu(true, block_rows, bi, bd, alpha, nonzeros.data(), false, ii.data(),
+                       jj.data(), x.data(), ncols, RowMajor, y.data(), ncols, RowMajor, ncols,
+                       row_part);
+        double t0 = w_time();
+        for (unsigned int rep = 0; rep < nrep; ++rep)
+            bsr_matvec_cpu(true, block_rows, bi, bd, alpha, nonzeros.data(), false, ii.data(),
+                           jj.data(), x.data(), ncols, RowMajor, y.data(), ncols, RowMajor, ncols,
+                           row_part);
+        t[balanced] = (w_time() - t0) / nrep;
+    }
+
+    const char *sep = "    ";
+    double gflops = (is_complex<T>::value ? 8. : 2.) * ii[block_rows] * bi * bd * ncols / 1e9;
+    std::cout << toStr<T>::get << " threads: " << get_max_cpu_threads() << sep
+              << "even rows : " << gflops / t[0] << " GFLOPS" << sep
+              << "balanced nonzeros : " << gflops / t[1] << " GFLOPS" << std::endl;
+}
+
+/// Check that the scratch arena reuses the memory freed by nested scopes spanning several blocks
+
+void test_scratch_arena() {
+    ScratchArenaScope outer;
+    int *a = outer.allocate<int>(16);
+    for (int i = 0; i < 16; ++i) a[i] = i;
+    std::vector<char *> first_chunks;
+    for (unsigned int rep = 0; rep < 4; ++rep) {
+        ScratchArenaScope inner;
+        char *b = inner.allocate<char>(64);
+        inner.allocate<char>(128);
+        inner.allocate<char>(256);
+        first_chunks.push_back(b);
+    }
+    for (int i = 0; i < 16; ++i)
+        if (a[i] != i) throw std::runtime_error("the scratch arena overwrote a chunk in use");
+    for (unsigned int rep = 2; rep < first_chunks.size(); ++rep)
+        if (first_chunks[rep] != first_chunks[1])
+            throw std::runtime_error("the scratch arena didn't reuse the freed memory");
+}
+
+template <typename T, typename XPU> void test_alloc(std::size_t size, XPU xpu, unsigned int nrep = 10) {
+    std::vector<std::size_t> num_live_buffers{0, 10, 100, 1000};
+    for (std::size_t num_live : num_live_buffers) {
+        // Keep alive `num_live` cached buffers of different sizes
+        std::vector<std::shared_ptr<char>> live;
+        for (std::size_t i = 0; i < num_live; ++i)
+            live.push_back(allocateBufferResouce<T>(size + i * 64, xpu).second);
+
+        // Allocate and release a buffer from the cache
+        allocateBufferResouce<T>(size, xpu);
+        sync(xpu);
+        double t = w_time();
+        for (unsigned int rep = 0; rep < nrep * 100; ++rep) allocateBufferResouce<T>(size, xpu);
+        sync(xpu);
+        double t_cache = (w_time() - t) / nrep / 100;
+
+        // Time the linear scan over all cached buffers that the free lists replaced: look up each
+        // buffer in the cache and select the smallest free one that is large enough
+        std::vector<char *> all_buffers;
+        for (const auto &it : live) all_buffers.push_back(it.get());
+        auto cache = getCache<char *, AllocationEntry, std::hash<char *>, allocate_buffer_t>(xpu);
+        char *selected_buffer = nullptr;
+        t = w_time();
+        for (unsigned int rep = 0; rep < nrep * 100; ++rep) {
+            std::size_t selected_buffer_size = std::numeric_limits<std::size_t>::max();
+            for (char *buffer_ptr : all_buffers) {
+                auto it = cache.find(buffer_ptr);
+                if (it != cache.end() && it->second.value.res.use_count() == 1 &&
+                    it->second.value.size >= sizeof(T) * size &&
+                    it->second.value.size < selected_buffer_size) {
+                    selected_buffer_size = it->second.value.size;
+                    selected_buffer = buffer_ptr;
+                }
+            }
+        }
+        double t_scan = (w_time() - t) / nrep / 100;
+        if (selected_buffer != nullptr)
+            throw std::runtime_error("the linear scan selected a buffer in use");
+
+        // Allocate and release a buffer without the cache
+        t = w_time();
+        for (unsigned int rep = 0; rep < nrep * 100; ++rep) allocateResouce<T>(size, xpu);
+        sync(xpu);
+        double t_nocache = (w_time() - t) / nrep / 100;
+
+        std::cout << "alloc " << toStr<T>::get << " on " << toStr<XPU>::get << " ("
+                  << sizeof(T) * size / 1024. / 1024 << " MiB) with " << num_live
+                  << " live buffers:    cached: " << t_cache * 1e6
+                  << " us    linear scan: " << t_scan * 1e6
+                  << " us    not cached: " << t_nocache * 1e6 << " us" << std::endl;
+
+        // Release the live buffers from several threads and check that they are reused
+        std::set<char *> released;
+        for (const auto &it : live) released.insert(it.get());
+#ifdef _OPENMP
+#    pragma omp parallel for schedule(static, 1)
+#endif
+        for (std::size_t i = 0; i < num_live; ++i) live[i].reset();
+        for (std::size_t i = 0; i < num_live; ++i) {
+            live[i] = allocateBufferResouce<T>(size + i * 64, xpu).second;
+            if (released.erase(live[i].get()) != 1)
+                throw std::runtime_error("allocateBufferResouce didn't reuse a released buffer");
+        }
+    }
+}
+
 int main(int argc, char **argv) {
     int size = 1000;
     int nrep = 10;
@@ -449,6 +725,65 @@ int main(int argc, char **argv) {
     }
 #endif
 
+    std::cout << std::endl;
+    std::cout << "- Blocking with fixed sizes:" << std::endl;
+    {
+        test_copy_blocking_fixed<float, float>(size, EWOp::Copy{}, nrep);
+        test_copy_blocking_fixed<float, float>(size, EWOp::Add{}, nrep);
+        test_copy_blocking_fixed<float, double>(size, EWOp::Copy{}, nrep);
+        test_copy_blocking_fixed<double, double>(size, EWOp::Copy{}, nrep);
+        test_copy_blocking_fixed<double, double>(size, EWOp::Add{}, nrep);
+        test_copy_blocking_fixed<std::complex<float>, std::complex<float>>(size, EWOp::Copy{},
+                                                                          nrep);
+        test_copy_blocking_fixed<std::complex<double>, std::complex<double>>(size, EWOp::Copy{},
+                                                                            nrep);
+        test_copy_blocking_fixed<std::complex<double>, std::complex<double>>(size, EWOp::Add{},
+                                                                            nrep);
+        clearCaches();
+        checkForMemoryLeaks(std::cout);
+    }
+
+    std::cout << std::endl;
+    std::cout << "- BSR matvec with small blocks:" << std::endl;
+    {
+        test_bsr_matvec_small_blocks<float>(size, nrep);
+        test_bsr_matvec_small_blocks<double>(size, nrep);
+        test_bsr_matvec_small_blocks<std::complex<float>>(size, nrep);
+        test_bsr_matvec_small_blocks<std::complex<double>>(size, nrep);
+        clearCaches();
+        checkForMemoryLeaks(std::cout);
+    }
+
+    std::cout << std::endl;
+    std::cout << "- BSR matvec with different number of nonzeros on each row:" << std::endl;
+    {
+        test_bsr_matvec_balance<float>(size, nrep);
+        test_bsr_matvec_balance<std::complex<double>>(size, nrep);
+        clearCaches();
+        checkForMemoryLeaks(std::cout);
+    }
+
+    std::cout << std::endl;
+    std::cout << "- Allocation:" << std::endl;
+    {
+        Context ctx = createCpuContext();
+        test_alloc<float, Cpu>(size, ctx.toCpu(0), nrep);
+        test_alloc<std::complex<double>, Cpu>(size, ctx.toCpu(0), nrep);
+        test_scratch_arena();
+        clearCaches();
+        checkForMemoryLeaks(std::cout);
+    }
+
+#ifdef SUPERBBLAS_USE_GPU
+    {
+        Context ctx = createGpuContext();
+        test_alloc<float, Gpu>(size, ctx.toGpu(0), nrep);
+        test_alloc<std::complex<double>, Gpu>(size, ctx.toGpu(0), nrep);
+        clearCaches();
+        checkForMemoryLeaks(std::cout);
+    }
+#endif
+
     std::cout << std::endl;
     std::cout << "- Blocking:" << std::endl;
     {
@@ -1,6 +1,9 @@
 #include "superbblas.h"
 #include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <iostream>
+#include <string>
 #include <vector>
 #ifdef _OPENMP
 #    include <omp.h>
@@ -165,11 +168,15 @@ void get_lattice_nonzeros_kron(bool block_imaginary_fast, const Coor<6> &op_dim,
                     1 + si + sd * op_dim[4] + dir * op_dim[4] * op_dim[4];
 }
 
-/// Create a 4D lattice with dimensions tzyxsc
+/// Create a 4D lattice with dimensions tzyxsc; if `diag` isn't zero, the diagonal blocks are
+/// diag * I + E, see below, and if `pattern` is given, it keeps the nonzero pattern allocated
 template <typename T, typename XPU>
 std::pair<BSR_handle *, vectors<T, XPU>>
 create_lattice(const PartitionStored<6> &pi, int rank, const Coor<6> op_dim,
-               const std::vector<Context> &ctx, const std::vector<XPU> &xpu) {
+               const std::vector<Context> &ctx, const std::vector<XPU> &xpu,
+               bool low_precision = false, T diag = T{0},
+               std::pair<std::vector<vector<IndexType, XPU>>, std::vector<vector<Coor<6>, XPU>>>
+                   *pattern = nullptr) {
     bool check_results = getDebugLevel() > 0;
 
     // Compute how many neighbors
@@ -217,7 +224,7 @@ create_lattice(const PartitionStored<6> &pi, int rank, const Coor<6> op_dim,
                       << vol_data * 1.0 * sizeof(T) / 1024 / 1024 << " MiB" << std::endl;
 
         vector<T, XPU> data_xpu;
-        if (check_results) {
+        if (check_results || diag != T{0}) {
             vector<T, Cpu> data_cpu(vol_data, Cpu{});
             Coor<6, std::size_t> stride = get_strides<std::size_t>(dimi, SlowToFast);
             std::size_t vol_blk = op_dim[4] * op_dim[5] * op_dim[4] * op_dim[5];
@@ -225,8 +232,21 @@ create_lattice(const PartitionStored<6> &pi, int rank, const Coor<6> op_dim,
                 Coor<6> blk_row = normalize_coor(index2coor(i, dimi, stride) + from, op_dim);
                 for (int j0 = 0; j0 < neighbors; ++j, ++j0) {
                     Coor<6> blk_col = normalize_coor(jj[j] + fromd, op_dim);
-                    get_lattice_nonzeros(blk_row, blk_col, j0, nonzero_blocks_imaginary_fast,
-                                         op_dim, data_cpu.data() + j * vol_blk);
+                    T *blk = data_cpu.data() + j * vol_blk;
+                    if (check_results)
+                        get_lattice_nonzeros(blk_row, blk_col, j0, nonzero_blocks_imaginary_fast,
+                                             op_dim, blk);
+                    else
+                        std::fill_n(blk, vol_blk, T{1});
+
+                    // Replace the diagonal block by diag * I + E, where E is zero but the
+                    // second element, which is one; so (diag * I + E)^2 = 2 * diag * (diag * I +
+                    // E) - diag^2 * I
+                    if (j0 == 0 && diag != T{0}) {
+                        std::size_t n = op_dim[4] * op_dim[5];
+                        for (std::size_t k = 0; k < n * n; ++k)
+                            blk[k] = (k % (n + 1) == 0 ? diag : (k == 1 ? T{1} : T{0}));
+                    }
                 }
             }
             data_xpu = makeSure(data_cpu, xpu[component]);
@@ -250,7 +270,8 @@ create_lattice(const PartitionStored<6> &pi, int rank, const Coor<6> op_dim,
 #ifdef SUPERBBLAS_USE_MPI
                         MPI_COMM_WORLD,
 #endif
-                        SlowToFast, &bsrh);
+                        SlowToFast, &bsrh, 0, low_precision);
+    if (pattern) *pattern = {ii_xpus, jj_xpus};
     return {bsrh, datav};
 }
 
@@ -292,11 +313,16 @@ void test_contraction(const PartitionStored<N> &pi, int rank, const char *oy_,
         const auto y = yv.getVectors()[component];
         const auto ctx = ctxs[component];
         int component_idx = rank * ctxs.size() + component;
+
+        // Check only the first power, which is the slowest dimension
+        const char *p_label = std::strchr(oy_, 'p');
+        Coor<N> size0 = pi[component_idx][1];
+        if (p_label) size0[p_label - oy_] = std::min(size0[p_label - oy_], 1);
         if (getDebugLevel() == 0) {
             if (do_fast_check) {
                 vector<T, Cpu> y_cpu = makeSure(y, Cpu{});
                 T right_value = (T)(max_neighbors(op_dim) * op_dim[4] * op_dim[5]);
-                for (std::size_t i = 0; i < y_cpu.size(); ++i)
+                for (std::size_t i = 0, vol0 = volume(size0); i < vol0; ++i)
                     if (std::norm(y_cpu[i] - right_value) > 1e-2)
                         throw std::runtime_error("check error");
             }
@@ -311,7 +337,7 @@ void test_contraction(const PartitionStored<N> &pi, int rank, const char *oy_,
             PartitionStored<7> p1(1, {Coor<7>{{}}, dimy_cpu});
             const T *ptr0 = y.data();
             T *ptr1 = y_cpu.data();
-            copy<N, 7, T, T>(T{1}, p0.data(), 1, oy_, Coor<N>{{}}, pi[component_idx][1],
+            copy<N, 7, T, T>(T{1}, p0.data(), 1, oy_, Coor<N>{{}}, size0,
                              pi[component_idx][1], &ptr0, nullptr, &ctx, p1.data(), 1, "xyztnsc",
                              Coor<7>{{}}, dimy_cpu, &ptr1, nullptr, &cpu_ctx, SlowToFast, Copy);
 
@@ -643,6 +669,126 @@ create_lattice_kron(const PartitionStored<6> &pi, int rank, bool sparse_kron, co
     return {bsrh, {datav, kronv}};
 }
 
+/// Return a complex value, or its real part for real types
+template <typename T> struct make_value {
+    static T get(double re, double) { return T(re); }
+    static T conj(const T &v) { return v; }
+};
+template <typename T> struct make_value<std::complex<T>> {
+    static std::complex<T> get(double re, double im) { return {T(re), T(im)}; }
+    static std::complex<T> conj(const std::complex<T> &v) { return std::conj(v); }
+};
+
+/// Set the values of a block of a Hermitian operator, given the global indices of the block
+/// row and column and the size of the block; the blocks are stored with the domain indices the
+/// fastest
+template <typename T>
+void get_hermitian_nonzeros_block(std::size_t row, std::size_t col, int n, T *v) {
+    // Return the value of the element (a,b) on a block on or above the diagonal
+    auto f = [=](std::size_t r, std::size_t c, int a, int b) {
+        return make_value<T>::get(1 + (r * 13 + c * 7 + a * 3 + b) % 17,
+                                  (int)((r * 5 + c * 11 + a + b * 3) % 9) - 4);
+    };
+    for (int a = 0; a < n; ++a)
+        for (int b = 0; b < n; ++b)
+            v[a * n + b] = row < col   ? f(row, col, a, b)
+                           : row > col ? make_value<T>::conj(f(col, row, b, a))
+                                       : f(row, col, a, b) + make_value<T>::conj(f(row, col, b, a));
+}
+
+/// Create a Hermitian 4D lattice with dimensions tzyxsc; if `upper` is true, create it with
+/// `create_hermitian_bsr` removing the blocks under the diagonal on each component
+template <typename T, typename XPU>
+std::pair<BSR_handle *, vectors<T, XPU>>
+create_lattice_hermitian(const PartitionStored<6> &pi, int rank, const Coor<6> op_dim, bool upper,
+                         const std::vector<Context> &ctx, const std::vector<XPU> &xpu) {
+
+    // Compute the domain ranges
+    PartitionStored<6> pd = extend(pi, op_dim);
+
+    const bool nonzero_blocks_imaginary_fast = false;
+    const int n = op_dim[4] * op_dim[5];
+    const std::size_t vol_blk = n * n;
+    Coor<6> sites = op_dim;
+    sites[4] = sites[5] = 1;
+    Coor<6, std::size_t> stride_sites = get_strides<std::size_t>(sites, SlowToFast);
+
+    std::vector<vector<IndexType, XPU>> ii_xpus;
+    std::vector<vector<Coor<6>, XPU>> jj_xpus;
+    std::vector<vector<T, XPU>> data_xpus;
+    for (unsigned int component = 0; component < ctx.size(); ++component) {
+        int rank_comp = rank * ctx.size() + component;
+        Coor<6> from = pi[rank_comp][0]; // first nonblock dimensions of the RSB image
+        Coor<6> dimi = pi[rank_comp][1]; // nonblock dimensions of the RSB image
+        auto fromd = pd[rank_comp][0];   // first nonblock dimension of the RSB domain
+        dimi[4] = dimi[5] = 1;
+        std::size_t voli = volume(dimi);
+        vector<IndexType, Cpu> ii(voli, Cpu{});
+        std::vector<Coor<6>> jj;
+        std::vector<T> data;
+        Coor<6, std::size_t> stride = get_strides<std::size_t>(dimi, SlowToFast);
+        for (std::size_t i = 0; i < voli; ++i) {
+            Coor<6> c = index2coor(i, dimi, stride) + from;
+            std::vector<Coor<6>> cols(1, c);
+            for (int dim = 0; dim < 4; ++dim) {
+                if (op_dim[dim] == 1) continue;
+                for (int dir = -1; dir < 2; dir += 2) {
+                    Coor<6> c0 = c;
+                    c0[dim] += dir;
+                    cols.push_back(c0);
+                    if (op_dim[dim] <= 2) break;
+                }
+            }
+            ii[i] = 0;
+            for (const auto &col : cols) {
+                // Skip the blocks under the diagonal with the column on the image range
+                Coor<6> coli = normalize_coor(col - from, op_dim);
+                if (upper && all_less_or_equal(coli + Coor<6>{{1, 1, 1, 1, 1, 1}}, dimi) &&
+                    coor2index(coli, dimi, stride) < i)
+                    continue;
+                ii[i]++;
+                jj.push_back(normalize_coor(col - fromd, op_dim));
+                data.resize(data.size() + vol_blk);
+                get_hermitian_nonzeros_block(
+                    coor2index(normalize_coor(c, op_dim), sites, stride_sites),
+                    coor2index(normalize_coor(col, op_dim), sites, stride_sites), n,
+                    data.data() + data.size() - vol_blk);
+            }
+        }
+
+        vector<Coor<6>, Cpu> jj_cpu(jj.size(), Cpu{});
+        std::copy(jj.begin(), jj.end(), jj_cpu.data());
+        vector<T, Cpu> data_cpu(data.size(), Cpu{});
+        std::copy(data.begin(), data.end(), data_cpu.data());
+        ii_xpus.push_back(makeSure(ii, xpu[component]));
+        jj_xpus.push_back(makeSure(jj_cpu, xpu[component]));
+        data_xpus.push_back(makeSure(data_cpu, xpu[component]));
+    }
+
+    Coor<6> block{{1, 1, 1, 1, op_dim[4], op_dim[5]}};
+    BSR_handle *bsrh = nullptr;
+    vectors<IndexType, XPU> iiv(ii_xpus);
+    vectors<Coor<6>, XPU> jjv(jj_xpus);
+    vectors<T, XPU> datav(data_xpus);
+    if (upper)
+        create_hermitian_bsr<6, T>(pi.data(), op_dim, pd.data(), op_dim, ctx.size(), block, block,
+                                   nonzero_blocks_imaginary_fast, iiv.data(), jjv.data(),
+                                   (const T **)datav.data(), ctx.data(),
+#ifdef SUPERBBLAS_USE_MPI
+                                   MPI_COMM_WORLD,
+#endif
+                                   SlowToFast, &bsrh);
+    else
+        create_bsr<6, 6, T>(pi.data(), op_dim, pd.data(), op_dim, ctx.size(), block, block,
+                            nonzero_blocks_imaginary_fast, iiv.data(), jjv.data(),
+                            (const T **)datav.data(), ctx.data(),
+#ifdef SUPERBBLAS_USE_MPI
+                            MPI_COMM_WORLD,
+#endif
+                            SlowToFast, &bsrh);
+    return {bsrh, datav};
+}
+
 /// Create a 7D tensor with dimensions ntzyxsc
 template <typename T, std::size_t N, typename XPU>
 vectors<T, XPU> create_tensor_data(const PartitionStored<N> &p, int rank, const char *o_,
@@ -687,17 +833,247 @@ vectors<T, XPU> create_tensor_data(const PartitionStored<N> &p, int rank, const
     return vectors<T, XPU>(r);
 }
 
+/// Check that each power on the output tensor is the operator applied on the previous power
+template <typename Q, typename XPU>
+void test_powers(BSR_handle *op, const PartitionStored<Nd + 1> &p1, const char *o1,
+                 const Coor<Nd + 1> &dim1, const vectors<Q, XPU> &t1, const Coor<6> &dimo,
+                 int rank, int max_power, const std::vector<Context> &ctx,
+                 const std::vector<XPU> &xpu) {
+
+    // The power dimension is the first one on `o1`; use the image labels as domain labels
+    std::string o1x(o1);
+    for (char &c : o1x)
+        if (std::strchr("xyztsc", c)) c = std::toupper(c);
+    Coor<Nd + 1> dim2 = dim1;
+    dim2[0] = 1;
+    PartitionStored<Nd + 1> p2 = p1;
+    for (auto &fs : p2) fs[1][0] = std::min(fs[1][0], 1);
+    vectors<Q, XPU> t2 = create_tensor_data<Q>(p2, rank, o1, dimo, 1, xpu);
+    vectors<Q, XPU> t3 = create_tensor_data<Q>(p2, rank, o1, dimo, 1, xpu);
+
+    for (int p = 1; p < max_power; ++p) {
+        // Apply the operator on the previous power
+        Coor<Nd + 1> fromx{{}};
+        fromx[0] = p - 1;
+        bsr_krylov<Nd - 1, Nd - 1, Nd + 1, Nd + 1, Q>(
+            Q{1}, op, "xyztsc", "XYZTSC", p1.data(), ctx.size(), o1x.c_str(), fromx, dim2, dim1,
+            (const Q **)t1.data(), Q{0}, p2.data(), o1, {{}}, dim2, dim2, 'p', t2.data(),
+            ctx.data(),
+#ifdef SUPERBBLAS_USE_MPI
+            MPI_COMM_WORLD,
+#endif
+            SlowToFast);
+
+        // Compare with the power
+        Coor<Nd + 1> from1{{}};
+        from1[0] = p;
+        copy(1, p1.data(), ctx.size(), o1, from1, dim2, dim1, (const Q **)t1.data(), nullptr,
+             ctx.data(), p2.data(), ctx.size(), o1, {{}}, dim2, t3.data(), nullptr, ctx.data(),
+#ifdef SUPERBBLAS_USE_MPI
+             MPI_COMM_WORLD,
+#endif
+             SlowToFast, Copy);
+        for (std::size_t component = 0; component < ctx.size(); ++component) {
+            vector<Q, Cpu> y2 = makeSure(t2.getVectors()[component], Cpu{});
+            vector<Q, Cpu> y3 = makeSure(t3.getVectors()[component], Cpu{});
+            for (std::size_t i = 0; i < y2.size(); ++i)
+                if (std::norm(y2[i] - y3[i]) > 1e-6 * std::max(1.0, (double)std::norm(y3[i])))
+                    throw std::runtime_error("check error on powers");
+        }
+    }
+}
+
+/// Return the partition with the dimension `d` halved
+template <std::size_t N> PartitionStored<N> halve(PartitionStored<N> p, std::size_t d) {
+    for (auto &fs : p) {
+        fs[0][d] /= 2;
+        fs[1][d] /= 2;
+    }
+    return p;
+}
+
+/// Return the local part of a tensor on the sites with the given parity, on the half lattice
+/// with the dimension x halved
+template <typename T, std::size_t N, typename XPU>
+vectors<T, XPU> get_parity_sites(const PartitionStored<N> &p, const PartitionStored<N> &ph,
+                                 int rank, const char *o, const vectors<T, XPU> &v, int parity,
+                                 const std::vector<XPU> &xpu) {
+    std::size_t x = 0;
+    while (std::tolower(o[x]) != 'x') ++x;
+    std::vector<vector<T, XPU>> r;
+    for (unsigned int component = 0; component < xpu.size(); ++component) {
+        const PartitionItem<N> &fs = p[rank * xpu.size() + component];
+        const PartitionItem<N> &fsh = ph[rank * xpu.size() + component];
+        vector<T, Cpu> v_cpu = makeSure(v.getVectors()[component], Cpu{});
+        vector<T, Cpu> r_cpu(volume(fsh[1]), Cpu{});
+        Coor<N, std::size_t> stride = get_strides<std::size_t>(fs[1], SlowToFast);
+        Coor<N, std::size_t> strideh = get_strides<std::size_t>(fsh[1], SlowToFast);
+        for (std::size_t i = 0; i < r_cpu.size(); ++i) {
+            Coor<N> c = index2coor(i, fsh[1], strideh) + fsh[0];
+            int s = 0;
+            for (std::size_t d = 0; d < N; ++d)
+                if (d != x && std::strchr("xyzt", std::tolower(o[d]))) s += c[d];
+            c[x] = 2 * c[x] + (parity + s) % 2;
+            r_cpu[i] = v_cpu[coor2index(c - fs[0], fs[1], stride)];
+        }
+        r.push_back(makeSure(r_cpu, xpu[component]));
+    }
+    return vectors<T, XPU>(r);
+}
+
+/// Throw an error if the local parts of two tensors are different
+template <typename T, typename XPU>
+void check_same(const vectors<T, XPU> &a, const vectors<T, XPU> &b, const char *what) {
+    for (std::size_t component = 0; component < a.getVectors().size(); ++component) {
+        vector<T, Cpu> a_cpu = makeSure(a.getVectors()[component], Cpu{});
+        vector<T, Cpu> b_cpu = makeSure(b.getVectors()[component], Cpu{});
+        for (std::size_t i = 0; i < a_cpu.size(); ++i)
+            if (std::norm(a_cpu[i] - b_cpu[i]) > 1e-6 * std::max(1.0, (double)std::norm(b_cpu[i])))
+                throw std::runtime_error(std::string("check error on ") + what);
+    }
+}
+
+/// Check the even-odd sub-operators and the Schur complement of a lattice operator
+template <typename Q, typename XPU>
+void test_even_odd(const Coor<Nd> &dim, const PartitionStored<Nd - 1> &po,
+                   const PartitionStored<Nd + 1> &p0, int rank, unsigned int nrep,
+                   const std::vector<Context> &ctx, const std::vector<XPU> &xpu) {
+
+    // Create a lattice operator with diagonal blocks diag * I + E, and split it
+    const Coor<Nd - 1> dimo = {dim[X], dim[Y], dim[Z], dim[T], dim[S], dim[C]}; // xyztsc
+    const Q diag{4};
+    std::pair<std::vector<vector<IndexType, XPU>>, std::vector<vector<Coor<6>, XPU>>> pattern;
+    auto op_pair = create_lattice<Q>(po, rank, dimo, ctx, xpu, false, diag, &pattern);
+    BSR_handle *eo[4], *schur = nullptr;
+    create_bsr_even_odd<Nd - 1, Nd - 1, Q>(op_pair.first, X, ctx.size(), ctx.data(),
+#ifdef SUPERBBLAS_USE_MPI
+                                           MPI_COMM_WORLD,
+#endif
+                                           SlowToFast, eo, &schur);
+
+    // Apply an operator, y = alpha * op * x + beta * y
+    auto apply = [&](Q alpha, BSR_handle *op, const PartitionStored<Nd + 1> &p,
+                     const Coor<Nd + 1> &d, const vectors<Q, XPU> &x, Q beta,
+                     const vectors<Q, XPU> &y) {
+        bsr_krylov<Nd - 1, Nd - 1, Nd + 1, Nd + 1, Q>(
+            alpha, op, "xyztsc", "XYZTSC", p.data(), ctx.size(), "pXYZTSCn", {{}}, d, d,
+            (const Q **)x.data(), beta, p.data(), "pxyztscn", {{}}, d, d, 'p', y.data(),
+            ctx.data(),
+#ifdef SUPERBBLAS_USE_MPI
+            MPI_COMM_WORLD,
+#endif
+            SlowToFast);
+    };
+
+    // Compare the operator with the sub-operators on each parity
+    const Coor<Nd + 1> dim0 = {1,      dim[X], dim[Y], dim[Z],
+                               dim[T], dim[S], dim[C], dim[N]}; // pxyztscn
+    Coor<Nd + 1> dim0h = dim0;
+    dim0h[1] /= 2;
+    PartitionStored<Nd + 1> p0h = halve(p0, 1);
+    vectors<Q, XPU> x = create_tensor_data<Q>(p0, rank, "pXYZTSCn", dimo, dim[N], xpu);
+    vectors<Q, XPU> y = create_tensor_data<Q>(p0, rank, "pxyztscn", dimo, dim[N], xpu);
+    apply(Q{1}, op_pair.first, p0, dim0, x, Q{0}, y);
+    vectors<Q, XPU> xe = get_parity_sites(p0, p0h, rank, "pXYZTSCn", x, 0, xpu);
+    vectors<Q, XPU> xo = get_parity_sites(p0, p0h, rank, "pXYZTSCn", x, 1, xpu);
+    for (int parity = 0; parity < 2; ++parity) {
+        vectors<Q, XPU> yh = create_tensor_data<Q>(p0h, rank, "pxyztscn", dimo, dim[N], xpu);
+        apply(Q{1}, eo[parity * 2], p0h, dim0h, xe, Q{0}, yh);
+        apply(Q{1}, eo[parity * 2 + 1], p0h, dim0h, xo, Q{1}, yh);
+        check_same(yh, get_parity_sites(p0, p0h, rank, "pxyztscn", y, parity, xpu),
+                   "even-odd sub-operators");
+    }
+
+    // Compare the Schur complement with M_ee - M_eo (2 / diag - M_oo / diag^2) M_oe, as
+    // M_oo^{-1} = 2 / diag - M_oo / diag^2
+    vectors<Q, XPU> ys = create_tensor_data<Q>(p0h, rank, "pxyztscn", dimo, dim[N], xpu);
+    resetTimings();
+    double t = w_time();
+    for (unsigned int rep = 0; rep < nrep; ++rep) {
+        bsr_schur_krylov<Nd - 1, Nd - 1, Nd + 1, Nd + 1, Q>(
+            Q{1}, schur, "xyztsc", "XYZTSC", p0h.data(), ctx.size(), "pXYZTSCn", {{}}, dim0h,
+            dim0h, (const Q **)xe.data(), Q{0}, p0h.data(), "pxyztscn", {{}}, dim0h, dim0h,
+            ys.data(), ctx.data(),
+#ifdef SUPERBBLAS_USE_MPI
+            MPI_COMM_WORLD,
+#endif
+            SlowToFast);
+    }
+    for (const auto &xpui : xpu) sync(xpui);
+    t = w_time() - t;
+    if (rank == 0)
+        std::cout << "Time in mavec per rhs (Schur complement): " << t / nrep / dim[N]
+                  << std::endl;
+    vectors<Q, XPU> to = create_tensor_data<Q>(p0h, rank, "pxyztscn", dimo, dim[N], xpu);
+    vectors<Q, XPU> wo = create_tensor_data<Q>(p0h, rank, "pxyztscn", dimo, dim[N], xpu);
+    vectors<Q, XPU> yr = create_tensor_data<Q>(p0h, rank, "pxyztscn", dimo, dim[N], xpu);
+    apply(Q{1}, eo[2], p0h, dim0h, xe, Q{0}, to);
+    apply(Q{1}, eo[3], p0h, dim0h, to, Q{0}, wo);
+    apply(Q{1}, eo[0], p0h, dim0h, xe, Q{0}, yr);
+    apply(Q{-2} / diag, eo[1], p0h, dim0h, to, Q{1}, yr);
+    apply(Q{1} / diag / diag, eo[1], p0h, dim0h, wo, Q{1}, yr);
+    check_same(ys, yr, "Schur complement");
+
+    for (BSR_handle *op : eo) destroy_bsr(op);
+    destroy_bsr(schur);
+    destroy_bsr(op_pair.first);
+}
+
+/// Check the Hermitian operator given with the diagonal and upper blocks only
+template <typename Q, typename XPU>
+void test_hermitian(const Coor<Nd> &dim, const PartitionStored<Nd - 1> &po,
+                    const PartitionStored<Nd + 1> &p0, int rank, unsigned int nrep,
+                    const std::vector<Context> &ctx, const std::vector<XPU> &xpu) {
+
+    // Create the operator with all blocks and with the upper blocks only
+    const Coor<Nd - 1> dimo = {dim[X], dim[Y], dim[Z], dim[T], dim[S], dim[C]}; // xyztsc
+    auto op_full = create_lattice_hermitian<Q>(po, rank, dimo, false, ctx, xpu);
+    auto op_upper = create_lattice_hermitian<Q>(po, rank, dimo, true, ctx, xpu);
+
+    // Apply an operator, y = op * x
+    auto apply = [&](BSR_handle *op, const vectors<Q, XPU> &x, const vectors<Q, XPU> &y) {
+        const Coor<Nd + 1> dim0 = {1,      dim[X], dim[Y], dim[Z],
+                                   dim[T], dim[S], dim[C], dim[N]}; // pxyztscn
+        bsr_krylov<Nd - 1, Nd - 1, Nd + 1, Nd + 1, Q>(
+            Q{1}, op, "xyztsc", "XYZTSC", p0.data(), ctx.size(), "pXYZTSCn", {{}}, dim0, dim0,
+            (const Q **)x.data(), Q{0}, p0.data(), "pxyztscn", {{}}, dim0, dim0, 'p', y.data(),
+            ctx.data(),
+#ifdef SUPERBBLAS_USE_MPI
+            MPI_COMM_WORLD,
+#endif
+            SlowToFast);
+    };
+
+    vectors<Q, XPU> x = create_tensor_data<Q>(p0, rank, "pXYZTSCn", dimo, dim[N], xpu);
+    vectors<Q, XPU> y = create_tensor_data<Q>(p0, rank, "pxyztscn", dimo, dim[N], xpu);
+    vectors<Q, XPU> yh = create_tensor_data<Q>(p0, rank, "pxyztscn", dimo, dim[N], xpu);
+    apply(op_full.first, x, y);
+    resetTimings();
+    double t = w_time();
+    for (unsigned int rep = 0; rep < nrep; ++rep) apply(op_upper.first, x, yh);
+    for (const auto &xpui : xpu) sync(xpui);
+    t = w_time() - t;
+    if (rank == 0)
+        std::cout << "Time in mavec per rhs (Hermitian): " << t / nrep / dim[N] << std::endl;
+    check_same(yh, y, "Hermitian operator");
+
+    destroy_bsr(op_full.first);
+    destroy_bsr(op_upper.first);
+}
+
 template <typename Q, typename XPU>
 void test(Coor<Nd> dim, Coor<Nd> procs, int rank, int nprocs, int max_power, unsigned int nrep,
-          const std::vector<Context> &ctx, const std::vector<XPU> &xpu) {
+          bool low_precision, const std::vector<Context> &ctx, const std::vector<XPU> &xpu) {
 
     // Create a lattice operator of Nd-1 dims
     const Coor<Nd - 1> dimo = {dim[X], dim[Y], dim[Z], dim[T], dim[S], dim[C]}; // xyztsc
     const Coor<Nd - 1> procso = {procs[X], procs[Y], procs[Z], procs[T], 1, 1}; // xyztsc
     PartitionStored<Nd - 1> po =
         basic_partitioning("xyztsc", dimo, procso, "xyzt", nprocs, ctx.size());
+    // The split operators, see below, are built from the partition without the extensions
+    const PartitionStored<Nd - 1> po_split = po;
     for (int i = 0; i < max_power - 1; ++i) po = extend(po, dimo);
-    auto op_pair = create_lattice<Q>(po, rank, dimo, ctx, xpu);
+    auto op_pair = create_lattice<Q>(po, rank, dimo, ctx, xpu, low_precision);
     BSR_handle *op = op_pair.first;
 
     // Create tensor t0 of Nd dims: an input lattice color vector
@@ -753,7 +1129,7 @@ void test(Coor<Nd> dim, Coor<Nd> procs, int rank, int nprocs, int max_power, uns
 
     // Copy tensor t0 into each of the c components of tensor 1
     resetTimings();
-    try {
+    {
         double t = w_time();
         for (unsigned int rep = 0; rep < nrep; ++rep) {
             bsr_krylov<Nd - 1, Nd - 1, Nd + 1, Nd + 1, Q>(
@@ -769,28 +1145,62 @@ void test(Coor<Nd> dim, Coor<Nd> procs, int rank, int nprocs, int max_power, uns
         t = w_time() - t;
         if (rank == 0) std::cout << "Time in mavec per rhs: " << t / nrep / dim[N] << std::endl;
         test_contraction(p1, rank, o1, t1, dimo, true, ctx);
-    } catch (const std::exception &e) { std::cout << "Caught error: " << e.what() << std::endl; }
+        test_powers(op, p1, o1, dim1, t1, dimo, rank, max_power, ctx, xpu);
+    }
+
+    // Apply the operator and another one with the same nonzero pattern at once
+    if (max_power == 1) {
+        auto op_pair2 = create_lattice<Q>(po, rank, dimo, ctx, xpu, low_precision);
+        BSR_handle *ops[2] = {op, op_pair2.first};
+        vectors<Q, XPU> t1a = create_tensor_data<Q>(p1, rank, o1, dimo, dim[N], xpu);
+        vectors<Q, XPU> t1b = create_tensor_data<Q>(p1, rank, o1, dimo, dim[N], xpu);
+        std::vector<Q *> t1ab(t1a.data(), t1a.data() + ctx.size());
+        t1ab.insert(t1ab.end(), t1b.data(), t1b.data() + ctx.size());
+        resetTimings();
+        {
+            double t = w_time();
+            for (unsigned int rep = 0; rep < nrep; ++rep) {
+                bsr_multi_krylov<Nd - 1, Nd - 1, Nd + 1, Nd + 1, Q>(
+                    Q{1}, ops, 2, "xyztsc", "XYZTSC", p0.data(), ctx.size(), "pXYZTSCn", {{}},
+                    dim0, dim0, (const Q **)t0.data(), Q{0}, p1.data(), o1, {{}}, dim1, dim1,
+                    t1ab.data(), ctx.data(),
+#ifdef SUPERBBLAS_USE_MPI
+                    MPI_COMM_WORLD,
+#endif
+                    SlowToFast);
+            }
+            for (const auto &xpui : xpu) sync(xpui);
+            t = w_time() - t;
+            if (rank == 0)
+                std::cout << "Time in mavec per rhs (two operators at once): "
+                          << t / nrep / dim[N] / 2 << std::endl;
+            test_contraction(p1, rank, o1, t1a, dimo, true, ctx);
+            test_contraction(p1, rank, o1, t1b, dimo, true, ctx);
+        }
+        destroy_bsr(op_pair2.first);
+
+        // Split the operator into even and odd sites on the half lattices
+        if (dim[X] % (2 * procs[X]) == 0) test_even_odd<Q>(dim, po, p0, rank, nrep, ctx, xpu);
+
+        // Apply a Hermitian operator given with the upper blocks only
+        if (is_cpu) test_hermitian<Q>(dim, po, p0, rank, nrep, ctx, xpu);
+    }
 
     destroy_bsr(op);
 
     if (rank == 0) reportTimings(std::cout);
     if (rank == 0) reportCacheUsage(std::cout);
 
-    // Create split tensor
-    auto op_pair_s = create_lattice_split<Q>(po, rank, dimo, ctx, xpu);
+    // Create split tensor; the parts shouldn't share image rows as their results are added up
+    auto op_pair_s = create_lattice_split<Q>(po_split, rank, dimo, ctx, xpu);
 
     // Copy tensor t0 into each of the c components of tensor 1
     resetTimings();
-    try {
+    {
         double t = w_time();
         for (unsigned int rep = 0; rep < nrep; ++rep) {
             // Set the output tensor to zero
-            copy(0, p1.data(), ctx.size(), o1, {{}}, dim1, dim1, (const Q **)t0.data(), nullptr,
-                 ctx.data(), p1.data(), ctx.size(), o1, {{}}, dim1, t1.data(), nullptr, ctx.data(),
-#ifdef SUPERBBLAS_USE_MPI
-                 MPI_COMM_WORLD,
-#endif
-                 SlowToFast, Copy);
+            for (const auto &v : t1.getVectors()) zero_n(v.data(), v.size(), v.ctx());
 
             // Do the contractions on each part
             std::vector<Request> r(op_pair_s.first.size());
@@ -813,7 +1223,21 @@ void test(Coor<Nd> dim, Coor<Nd> procs, int rank, int nprocs, int max_power, uns
             std::cout << "Time in mavec per rhs (split): " << t / nrep / dim[N] << std::endl;
         test_contraction(p1, rank, o1, t1, dimo, false /* Don't do quick check, it isn't correct */,
                          ctx);
-    } catch (const std::exception &e) { std::cout << "Caught error: " << e.what() << std::endl; }
+
+        // Check the powers of each part separately, as the sum of the powers of the parts isn't
+        // the power of the whole operator
+        for (unsigned int p = 0; max_power > 1 && p < op_pair_s.first.size(); ++p) {
+            bsr_krylov<Nd - 1, Nd - 1, Nd + 1, Nd + 1, Q>(
+                Q{1}, op_pair_s.first[p], "xyztsc", "XYZTSC", p0.data(), ctx.size(), "pXYZTSCn",
+                {{}}, dim0, dim0, (const Q **)t0.data(), Q{0}, p1.data(), o1, {{}}, dim1, dim1,
+                'p', t1.data(), ctx.data(),
+#ifdef SUPERBBLAS_USE_MPI
+                MPI_COMM_WORLD,
+#endif
+                SlowToFast);
+            test_powers(op_pair_s.first[p], p1, o1, dim1, t1, dimo, rank, max_power, ctx, xpu);
+        }
+    }
 
     for (const auto op : op_pair_s.first) destroy_bsr(op);
 
@@ -839,7 +1263,7 @@ void test(Coor<Nd> dim, Coor<Nd> procs, int rank, int nprocs, int max_power, uns
 
         // Copy tensor t0 into each of the c components of tensor 1
         resetTimings();
-        try {
+        {
             double t = w_time();
             for (unsigned int rep = 0; rep < nrep; ++rep) {
                 bsr_krylov<Nd - 1, Nd - 1, Nd + 1, Nd + 1, Q>(
@@ -857,9 +1281,7 @@ void test(Coor<Nd> dim, Coor<Nd> procs, int rank, int nprocs, int max_power, uns
                 std::cout << "Time in mavec per rhs (kron "
                           << (kron_sparse == 0 ? "dense" : "sparse") << "): " << t / nrep / dim[N]
                           << std::endl;
-            test_contraction(kp1, rank, "pxyztsnc", t1, dimo, true, ctx);
-        } catch (const std::exception &e) {
-            std::cout << "Caught error: " << e.what() << std::endl;
+            test_contraction(kp1, rank, "pxyztcns", t1, dimo, true, ctx);
         }
 
         destroy_bsr(op_kron_s.first);
@@ -887,6 +1309,7 @@ int main(int argc, char **argv) {
     int max_power = 1;
     int nrep = getDebugLevel() == 0 ? 10 : 1;
     int ncomponents = 0;
+    bool low_precision = false;
 
     // Get options
     bool procs_was_set = false;
@@ -940,10 +1363,12 @@ int main(int argc, char **argv) {
                 std::cerr << "The rep should be greater than zero" << std::endl;
                 return -1;
             }
+        } else if (std::strncmp("--low-precision", argv[i], 15) == 0) {
+            low_precision = true;
         } else if (std::strncmp("--help", argv[i], 6) == 0) {
             std::cout << "Commandline option:\n  " << argv[0]
                       << " [--dim='x y z t n b'] [--procs='x y z t n b'] [--power=p] "
-                         "[--components=c] [--help]"
+                         "[--components=c] [--low-precision] [--help]"
                       << std::endl;
             return 0;
         } else {
@@ -981,7 +1406,8 @@ int main(int argc, char **argv) {
         for (int i = 0; i < ncomponents; ++i) ctx.push_back(createCpuContext());
         std::vector<Cpu> xpus;
         for (const auto &i : ctx) xpus.push_back(i.toCpu(0));
-        test<std::complex<double>, Cpu>(dim, procs, rank, nprocs, max_power, nrep, ctx, xpus);
+        test<std::complex<double>, Cpu>(dim, procs, rank, nprocs, max_power, nrep, low_precision,
+                                        ctx, xpus);
         clearCaches();
         checkForMemoryLeaks(std::cout);
     }
@@ -992,8 +1418,9 @@ int main(int argc, char **argv) {
             ctx.push_back(createGpuContext((rank * ncomponents + i) % getGpuDevicesCount()));
         std::vector<Gpu> xpus;
         for (const auto &i : ctx) xpus.push_back(i.toGpu(0));
-        test<float, Gpu>(dim, procs, rank, nprocs, max_power, nrep, ctx, xpus);
-        test<std::complex<double>, Gpu>(dim, procs, rank, nprocs, max_power, nrep, ctx, xpus);
+        test<float, Gpu>(dim, procs, rank, nprocs, max_power, nrep, low_precision, ctx, xpus);
+        test<std::complex<double>, Gpu>(dim, procs, rank, nprocs, max_power, nrep, low_precision,
+                                        ctx, xpus);
         clearCaches();
         clearHandles();
         checkForMemoryLeaks(std::cout);
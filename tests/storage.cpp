@@ -1,4 +1,5 @@
 #include "superbblas.h"
+#include <algorithm>
 #include <climits>
 #include <cstdio>
 #include <fstream>
@@ -175,7 +176,10 @@ void test(Coor<Nd> dim, checksum_type checksum, Coor<Nd> procs, int nprocs, int
         for (unsigned int i = 0; i < vol0; i++) t0_cpu[i] = i;
         vector<Scalar, XPU> t0 = makeSure(t0_cpu, xpu);
 
-        for (int with_trans = 0; with_trans < 2; ++with_trans) {
+        // Compare writing with the calling thread against queuing the writings on io_uring
+        const int io_uring_depth = getStorageIOUringDepth();
+        for (int with_trans = 0; with_trans < 4; ++with_trans) {
+            getStorageIOUringDepth() = (with_trans < 2 ? 0 : io_uring_depth);
             double t = w_time();
             for (unsigned int rep = 0; rep < nrep; ++rep) {
                 Storage_handle stoh;
@@ -191,18 +195,20 @@ void test(Coor<Nd> dim, checksum_type checksum, Coor<Nd> procs, int nprocs, int
                                           MPI_COMM_WORLD,
 #endif
                                           SlowToFast);
+                std::vector<Request> save_reqs(dim[M]);
                 for (int m = 0; m < dim[M]; ++m) {
                     const Coor<Nd - 1> from0{{}};
                     const Coor<Nd> from1{m};
                     Scalar *ptr0 = t0.data();
                     save<Nd - 1, Nd, Scalar, Scalar>(
                         1.0, p0.data(), 1, "dtgsSnN", from0, dim0, dim0, (const Scalar **)&ptr0,
-                        &ctx, with_trans == 0 ? "mdtgsSnN" : "mdtgsSNn", from1, stoh,
+                        &ctx, with_trans % 2 == 0 ? "mdtgsSnN" : "mdtgsSNn", from1, stoh,
 #ifdef SUPERBBLAS_USE_MPI
                         MPI_COMM_WORLD,
 #endif
-                        SlowToFast);
+                        SlowToFast, &save_reqs[m]);
                 }
+                for (const Request &r : save_reqs) wait(r);
                 close_storage<Nd, Scalar>(stoh
 #ifdef SUPERBBLAS_USE_MPI
                                           ,
@@ -212,17 +218,39 @@ void test(Coor<Nd> dim, checksum_type checksum, Coor<Nd> procs, int nprocs, int
             }
             t = w_time() - t;
             if (rank == 0)
-                std::cout << "Time in writing " << (with_trans == 0 ? "" : "[with transposition] ")
-                          << t / nrep << " s (overhead " << t / nrep / trefw << " )" << std::endl;
+                std::cout << "Time in writing "
+                          << (with_trans % 2 == 0 ? "" : "[with transposition] ")
+                          << (with_trans < 2 ? "" : "[io_uring] ") << t / nrep << " s (overhead "
+                          << t / nrep / trefw << " )" << std::endl;
         }
+        getStorageIOUringDepth() = io_uring_depth;
     }
 
-    Storage_handle stoh;
+    // Open the storage three times: reading from the file with the calling thread, reading
+    // with io_uring, and reading from the file mapped into memory
+    const bool use_mmap = getUseStorageMmap();
+    const int io_uring_depth = getStorageIOUringDepth();
+    Storage_handle stoh, stoh_ring, stoh_mapped;
+    getUseStorageMmap() = false;
+    getStorageIOUringDepth() = 0;
     open_storage<Nd, Scalar>(filename_remote, false /* don't allow writing */,
 #ifdef SUPERBBLAS_USE_MPI
                              MPI_COMM_WORLD,
 #endif
                              &stoh);
+    getStorageIOUringDepth() = io_uring_depth;
+    open_storage<Nd, Scalar>(filename_remote, false /* don't allow writing */,
+#ifdef SUPERBBLAS_USE_MPI
+                             MPI_COMM_WORLD,
+#endif
+                             &stoh_ring);
+    getUseStorageMmap() = true;
+    open_storage<Nd, Scalar>(filename_remote, false /* don't allow writing */,
+#ifdef SUPERBBLAS_USE_MPI
+                             MPI_COMM_WORLD,
+#endif
+                             &stoh_mapped);
+    getUseStorageMmap() = use_mmap;
 
     // Check storage
     check_storage<Nd, Scalar>(stoh
@@ -246,7 +274,13 @@ void test(Coor<Nd> dim, checksum_type checksum, Coor<Nd> procs, int nprocs, int
             std::size_t vol1 = detail::volume(p1[rank][1]);
             vector<Scalar, XPU> t1(vol1, xpu);
 
-            for (int with_trans = 0; with_trans < 2; ++with_trans) {
+            // Compare seeking and reading every contiguous range against positional I/O,
+            // io_uring, and copying from the mapped file
+            const bool use_pio = getUseStoragePositionalIO();
+            for (int with_trans = 0; with_trans < 8; ++with_trans) {
+                getUseStoragePositionalIO() = (with_trans >= 2);
+                Storage_handle stoh_mode =
+                    (with_trans < 4 ? stoh : with_trans < 6 ? stoh_ring : stoh_mapped);
                 double t = w_time();
                 for (unsigned int rep = 0; rep < nrep; ++rep) {
                     for (auto req : reqs) {
@@ -258,9 +292,9 @@ void test(Coor<Nd> dim, checksum_type checksum, Coor<Nd> procs, int nprocs, int
                         size0[Nd - 2] = size0[Nd - 1] = n;
                         const Coor<2> from1{{}};
                         Scalar *ptr1 = t1.data();
-                        load<Nd, 2, Scalar, Scalar>(1.0, stoh, "mdtgsSnN", from0, size0, p1.data(),
-                                                    1, with_trans == 0 ? "nN" : "Nn", from1, dim1,
-                                                    &ptr1, &ctx,
+                        load<Nd, 2, Scalar, Scalar>(1.0, stoh_mode, "mdtgsSnN", from0, size0,
+                                                    p1.data(), 1, with_trans % 2 == 0 ? "nN" : "Nn",
+                                                    from1, dim1, &ptr1, &ctx,
 #ifdef SUPERBBLAS_USE_MPI
                                                     MPI_COMM_WORLD,
 #endif
@@ -270,10 +304,15 @@ void test(Coor<Nd> dim, checksum_type checksum, Coor<Nd> procs, int nprocs, int
                 t = w_time() - t;
                 if (rank == 0)
                     std::cout << "Time in reading the tensor with " << n << "^2 elements "
-                              << (with_trans == 0 ? "" : "[with transposition] ") << t / nrep
-                              << " s  "
+                              << (with_trans % 2 == 0 ? "" : "[with transposition] ")
+                              << (with_trans < 2   ? ""
+                                  : with_trans < 4 ? "[positional I/O] "
+                                  : with_trans < 6 ? "[io_uring] "
+                                                   : "[mapped] ")
+                              << t / nrep << " s  "
                               << " (overhead " << t / nrep / trefr[nni] << " )" << std::endl;
             }
+            getUseStoragePositionalIO() = use_pio;
         }
     }
 
@@ -283,6 +322,153 @@ void test(Coor<Nd> dim, checksum_type checksum, Coor<Nd> procs, int nprocs, int
                               MPI_COMM_WORLD
 #endif
     );
+    close_storage<Nd, Scalar>(stoh_ring
+#ifdef SUPERBBLAS_USE_MPI
+                              ,
+                              MPI_COMM_WORLD
+#endif
+    );
+    close_storage<Nd, Scalar>(stoh_mapped
+#ifdef SUPERBBLAS_USE_MPI
+                              ,
+                              MPI_COMM_WORLD
+#endif
+    );
+
+    // Compare opening a storage with a chunk for every mdtg reading all the chunk headers
+    // against reading the index
+    {
+        const bool use_index = getUseStorageIndex();
+        getUseStorageIndex() = true;
+        create_storage<Nd, Scalar>(dim, SlowToFast, filename_local, metadata.c_str(),
+                                   metadata.size(), checksum,
+#ifdef SUPERBBLAS_USE_MPI
+                                   MPI_COMM_WORLD,
+#endif
+                                   &stoh);
+        const Coor<4> dimb{dim[M], dim[D], dim[T], dim[G]}; // mdtg
+        const Coor<4, std::size_t> stridesb = detail::get_strides<std::size_t>(dimb, SlowToFast);
+        const std::size_t num_blocks = detail::volume(dimb);
+        for (std::size_t i = 0; i < num_blocks; ++i) {
+            std::array<Coor<Nd>, 2> fs{Coor<Nd>{{}}, dim};
+            const Coor<4> c = index2coor(i, dimb, stridesb);
+            std::copy_n(c.begin(), 4, fs[0].begin());
+            std::fill_n(fs[1].begin(), 4, 1);
+            append_blocks<Nd, Scalar>(&fs, 1, dim, stoh,
+#ifdef SUPERBBLAS_USE_MPI
+                                      MPI_COMM_WORLD,
+#endif
+                                      SlowToFast);
+        }
+        close_storage<Nd, Scalar>(stoh
+#ifdef SUPERBBLAS_USE_MPI
+                                  ,
+                                  MPI_COMM_WORLD
+#endif
+        );
+
+        for (int with_index = 0; with_index < 2; ++with_index) {
+            getUseStorageIndex() = (with_index == 1);
+            double t = w_time();
+            for (unsigned int rep = 0; rep < nrep; ++rep) {
+                open_storage<Nd, Scalar>(filename_remote, false /* don't allow writing */,
+#ifdef SUPERBBLAS_USE_MPI
+                                         MPI_COMM_WORLD,
+#endif
+                                         &stoh);
+                close_storage<Nd, Scalar>(stoh
+#ifdef SUPERBBLAS_USE_MPI
+                                          ,
+                                          MPI_COMM_WORLD
+#endif
+                );
+            }
+            t = w_time() - t;
+            if (rank == 0)
+                std::cout << "Time in opening the storage with " << num_blocks << " chunks "
+                          << (with_index == 0 ? "" : "[index] ") << t / nrep << " s" << std::endl;
+        }
+
+        // Return the blocks of the storage, reading the chunk headers or the index
+        auto get_all_blocks = [&](bool with_index) {
+            getUseStorageIndex() = with_index;
+            open_storage<Nd, Scalar>(filename_remote, false /* don't allow writing */,
+#ifdef SUPERBBLAS_USE_MPI
+                                     MPI_COMM_WORLD,
+#endif
+                                     &stoh);
+            std::vector<PartitionItem<Nd>> blocks;
+            get_blocks<Nd, Nd, Scalar>(stoh, "mdtgsSnN", "mdtgsSnN", {{}}, dim, blocks,
+#ifdef SUPERBBLAS_USE_MPI
+                                       MPI_COMM_WORLD,
+#endif
+                                       SlowToFast);
+            close_storage<Nd, Scalar>(stoh
+#ifdef SUPERBBLAS_USE_MPI
+                                      ,
+                                      MPI_COMM_WORLD
+#endif
+            );
+            std::sort(blocks.begin(), blocks.end());
+            return blocks;
+        };
+
+        // The blocks from the index should match the blocks from the chunk headers
+        const std::vector<PartitionItem<Nd>> blocks_scan = get_all_blocks(false);
+        if (blocks_scan.size() != num_blocks || get_all_blocks(true) != blocks_scan)
+            throw std::runtime_error("The blocks from the index don't match the chunks");
+
+        // Overwrite a double on the file
+        std::size_t padding_size = (8 - metadata.size() % 8) % 8;
+        std::size_t header_size =
+            sizeof(int) * 6 + metadata.size() + padding_size + sizeof(double) * (Nd + 1);
+        auto overwrite = [&](std::size_t disp, double d) {
+            if (rank == 0) {
+                std::fstream f(filename_local, std::ios::binary | std::ios::in | std::ios::out);
+                f.seekp(disp);
+                f.write((const char *)&d, sizeof(d));
+                f.close();
+            }
+#ifdef SUPERBBLAS_USE_MPI
+            MPI_Barrier(MPI_COMM_WORLD);
+#endif
+        };
+
+        // With BlockChecksum, opening the storage with the index should still check the chunk
+        // headers; corrupt the first coordinate of the first block
+        if (checksum == BlockChecksum) {
+            const std::size_t from_disp = header_size + sizeof(double) * 3;
+            double from0 = 0;
+            std::ifstream f(filename_local, std::ios::binary);
+            f.seekg(from_disp);
+            f.read((char *)&from0, sizeof(from0));
+            f.close();
+            overwrite(from_disp, from0 + 1);
+            bool failed = false;
+            try {
+                get_all_blocks(true);
+            } catch (const std::exception &) { failed = true; }
+            if (!failed)
+                throw std::runtime_error("The chunk headers weren't checked with the index");
+            overwrite(from_disp, from0);
+        }
+
+        // Opening a storage with a corrupted index, or with index_disp not pointing to the
+        // current index, should fall back to reading the chunk headers
+        std::ifstream f(filename_local, std::ios::binary | std::ios::ate);
+        const std::size_t file_size = f.tellg();
+        f.close();
+        overwrite(file_size - sizeof(double), -1); // index_checksum
+        if (get_all_blocks(true) != blocks_scan)
+            throw std::runtime_error("Failed to recover from a corrupted index");
+        overwrite(header_size + sizeof(double), header_size + sizeof(double) * 2); // index_disp
+        if (get_all_blocks(true) != blocks_scan)
+            throw std::runtime_error("Failed to recover from a stale index");
+        overwrite(header_size + sizeof(double), file_size + 1000); // index_disp
+        if (get_all_blocks(true) != blocks_scan)
+            throw std::runtime_error("Failed to recover from an index out of the file");
+        getUseStorageIndex() = use_index;
+    }
 
     for (CoorOrder co : std::array<CoorOrder, 2>{SlowToFast, FastToSlow}) {
         Storage_handle stoh;
@@ -309,6 +495,8 @@ void test(Coor<Nd> dim, checksum_type checksum, Coor<Nd> procs, int nprocs, int
             Coor<Nd - 1, std::size_t> local_strides0 =
                 detail::get_strides<std::size_t>(local_size0, co);
             Coor<Nd, std::size_t> strides1 = detail::get_strides<std::size_t>(dim, co);
+            // Reuse the source buffers while the writings may be still in flight
+            std::vector<Request> save_reqs(dim[M]);
             for (int m = 0; m < dim[M]; ++m) {
                 const Coor<Nd - 1> from0{{}};
                 const Coor<Nd> from1{m};
@@ -326,8 +514,9 @@ void test(Coor<Nd> dim, checksum_type checksum, Coor<Nd> procs, int nprocs, int
 #ifdef SUPERBBLAS_USE_MPI
                                                  MPI_COMM_WORLD,
 #endif
-                                                 co);
+                                                 co, &save_reqs[m]);
             }
+            for (const Request &r : save_reqs) wait(r);
 
             flush_storage(stoh);
 
@@ -336,7 +525,10 @@ void test(Coor<Nd> dim, checksum_type checksum, Coor<Nd> procs, int nprocs, int
                 std::size_t padding_size = (8 - metadata.size() % 8) % 8;
                 std::size_t header_size =
                     sizeof(int) * 6 + metadata.size() + padding_size + sizeof(double) * (Nd + 1);
-                std::size_t disp = header_size + sizeof(double) * (2 + Nd * 2);
+                // Hop over num_chunks, index_disp (only if the index is used), number_of_blocks,
+                // and from_size
+                std::size_t disp =
+                    header_size + sizeof(double) * ((getUseStorageIndex() ? 3 : 2) + Nd * 2);
                 std::ifstream f(filename_local, std::ios::binary);
                 f.seekg(disp);
                 Scalar s;
@@ -366,7 +558,7 @@ void test(Coor<Nd> dim, checksum_type checksum, Coor<Nd> procs, int nprocs, int
         }
 
         // Test the readings
-        {
+        auto test_readings = [&]() {
             const Coor<Nd - 2> dimr{dim[M], dim[D], dim[T], dim[G], dim[S0], dim[S1]}; // mdtgsS
             Coor<Nd - 2, std::size_t> stridesr = detail::get_strides<std::size_t>(dimr, co);
             Coor<Nd, std::size_t> strides = detail::get_strides<std::size_t>(dim, co);
@@ -413,7 +605,8 @@ void test(Coor<Nd> dim, checksum_type checksum, Coor<Nd> procs, int nprocs, int
                     }
                 }
             }
-        }
+        };
+        test_readings();
 
         close_storage<Nd, Scalar>(stoh
 #ifdef SUPERBBLAS_USE_MPI
@@ -436,6 +629,9 @@ void test(Coor<Nd> dim, checksum_type checksum, Coor<Nd> procs, int nprocs, int
 #endif
         );
 
+        // Test the readings from a storage opened only for reading, which may be mapped
+        test_readings();
+
         close_storage<Nd, Scalar>(stoh
 #ifdef SUPERBBLAS_USE_MPI
                                   ,
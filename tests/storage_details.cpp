@@ -1,4 +1,5 @@
 #include "superbblas.h"
+#include <cmath>
 #include <cstdio>
 #include <fstream>
 #include <iostream>
@@ -85,6 +86,95 @@ Blocks get_blocks<0>(const char *filename, values_datatype dtype,
     return {};
 }
 
+/// Create a storage tiling a 4D tensor with blocks of size 2^4, each block on its own chunk
+void create_bench_storage(const char *filename, std::size_t num_blocks) {
+    const std::size_t Nd = 4;
+    IndexType side = (IndexType)std::ceil(std::pow((double)num_blocks, 1.0 / Nd));
+    Coor<Nd> dimb{side, side, side, side}, dim{side * 2, side * 2, side * 2, side * 2};
+    Coor<Nd, std::size_t> stridesb = get_strides<std::size_t>(dimb, FastToSlow);
+    Storage_handle stoh;
+    create_storage<Nd, double>(dim, FastToSlow, filename, "", 0, NoChecksum, &stoh);
+    for (std::size_t i = 0; i < num_blocks; ++i) {
+        std::array<Coor<Nd>, 2> fs{index2coor(i, dimb, stridesb), Coor<Nd>{2, 2, 2, 2}};
+        for (auto &c : fs[0]) c *= 2;
+        append_blocks<Nd, double>(&fs, 1, dim, stoh, FastToSlow);
+    }
+    close_storage<Nd, double>(stoh);
+}
+
+/// Time opening the storage and doing random queries with the blocks indexed on a grid and on
+/// trees
+template <std::size_t N, typename T>
+void bench(const char *filename, const std::vector<IndexType> &dim, unsigned int num_queries) {
+    std::vector<char> o(N + 1);
+    for (unsigned int i = 0; i < N; ++i) o[i] = (char)(i + 1);
+    Coor<N> dimc{};
+    std::copy_n(dim.begin(), N, dimc.begin());
+
+    // Generate random ranges with sizes up to a quarter of the tensor in each dimension
+    std::vector<PartitionItem<N>> queries(num_queries);
+    std::size_t hash = 5831;
+    for (auto &q : queries) {
+        for (std::size_t i = 0; i < N; ++i) {
+            hash = hash * 33 + i;
+            q[0][i] = hash % dimc[i];
+            hash = hash * 33 + i;
+            q[1][i] = 1 + hash % std::max(dimc[i] / 4, (IndexType)1);
+        }
+    }
+
+    const int tree_threshold = getStorageBlockTreeThreshold();
+    for (int use_tree = 0; use_tree < 2; ++use_tree) {
+        getStorageBlockTreeThreshold() = use_tree; // zero means always using the grid
+
+        double t_open = w_time();
+        Storage_handle stoh;
+        open_storage<N, T>(filename, false /* don't allow writing */, &stoh);
+        t_open = w_time() - t_open;
+
+        double t_queries = w_time();
+        std::size_t num_overlaps = 0;
+        for (const auto &q : queries) {
+            std::vector<PartitionItem<N>> blocks;
+            get_blocks<N, N, T>(stoh, o.data(), o.data(), q[0], q[1], blocks, FastToSlow);
+            num_overlaps += blocks.size();
+        }
+        t_queries = w_time() - t_queries;
+        close_storage<N, T>(stoh);
+
+        std::cout << (use_tree == 0 ? "grid" : "tree") << ": opening " << t_open << " s, "
+                  << num_queries << " queries " << t_queries << " s (" << num_overlaps
+                  << " overlaps)" << std::endl;
+    }
+    getStorageBlockTreeThreshold() = tree_threshold;
+}
+
+template <std::size_t N = 16>
+void bench(const char *filename, values_datatype dtype, const std::vector<IndexType> &dim,
+           unsigned int num_queries) {
+    if (dim.size() != N) {
+        bench<N - 1>(filename, dtype, dim, num_queries);
+    } else {
+        switch (dtype) {
+        case FLOAT: bench<N, float>(filename, dim, num_queries); break;
+        case DOUBLE: bench<N, double>(filename, dim, num_queries); break;
+        case CFLOAT: bench<N, std::complex<float>>(filename, dim, num_queries); break;
+        case CDOUBLE: bench<N, std::complex<double>>(filename, dim, num_queries); break;
+        case CHAR: bench<N, char>(filename, dim, num_queries); break;
+        case INT: bench<N, int>(filename, dim, num_queries); break;
+        }
+    }
+}
+
+template <>
+void bench<0>(const char *filename, values_datatype dtype, const std::vector<IndexType> &dim,
+              unsigned int num_queries) {
+    (void)filename;
+    (void)dtype;
+    (void)dim;
+    (void)num_queries;
+}
+
 template <typename T> std::string to_string(const T &c) {
     std::stringstream ss;
     if (c.size() > 0) ss << c[0];
@@ -147,6 +237,22 @@ bool show(const char *filename, bool list_blocks, bool only_metadata) {
     return true;
 }
 
+bool bench(const char *filename, unsigned int num_blocks, unsigned int num_queries) {
+    try {
+        if (num_blocks > 0) create_bench_storage(filename, num_blocks);
+
+        values_datatype dtype;
+        std::vector<char> metadata;
+        std::vector<IndexType> dim;
+        read_storage_header(filename, FastToSlow, dtype, metadata, dim);
+        bench(filename, dtype, dim, num_queries);
+    } catch (const std::exception &e) {
+        std::cerr << "Ops! " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
 bool print(const char *filename, std::vector<int> fromCoor, std::vector<int> sizeCoor) {
     (void)filename;
     (void)fromCoor;
@@ -174,6 +280,13 @@ int main(int argc, char **argv) {
         "  Print the values of the subtensor starting at c0 ... and           \n"
         "  extending s0 ... coordinates in each dimension.                    \n"
         "                                                                     \n"
+        "- storage_details <file> bench [--blocks <n>] [--queries <n>]        \n"
+        "  Time opening the file and getting the blocks overlapping random    \n"
+        "  ranges, with the blocks indexed on a grid and on trees.            \n"
+        "  --blocks: first create the file with a 4D tensor tiled with n      \n"
+        "    blocks, each of them on its own chunk.                           \n"
+        "  --queries: number of random ranges (default 1000).                 \n"
+        "                                                                     \n"
         "- storage_details [--help|-h]                                        \n"
         "  Show this help                                                     \n"
         "                                                                     \n";
@@ -184,14 +297,16 @@ int main(int argc, char **argv) {
     bool list_blocks = false;
     bool only_metadata = false;
     std::vector<int> fromCoor, sizeCoor;
-    enum Action { Show, Print, Help } action = Help;
+    unsigned int num_blocks = 0, num_queries = 1000;
+    enum Action { Show, Print, Bench, Help } action = Help;
     enum Parsestate {
         FilenameOrHelp,
         Action,
         Arguments,
         From,
         FromCoor,
-        SizeCoor
+        SizeCoor,
+        BenchArguments
     } state = FilenameOrHelp;
 
     for (int i = 1; i < argc; ++i) {
@@ -217,6 +332,9 @@ int main(int argc, char **argv) {
             } else if (std::strncmp("print", argv[i], 10) == 0) {
                 action = Print;
                 state = From;
+            } else if (std::strncmp("bench", argv[i], 10) == 0) {
+                action = Bench;
+                state = BenchArguments;
             } else {
                 action = Show;
                 state = Arguments;
@@ -271,6 +389,21 @@ int main(int argc, char **argv) {
             }
             break;
         }
+
+            // Process arguments for action `bench`
+        case BenchArguments: {
+            bool is_blocks = (std::strncmp("--blocks", argv[i], 10) == 0);
+            bool is_queries = (std::strncmp("--queries", argv[i], 10) == 0);
+            unsigned int n = 0;
+            if ((!is_blocks && !is_queries) || i + 1 >= argc ||
+                std::sscanf(argv[i + 1], "%u", &n) != 1) {
+                std::cout << "Unknown argument: " << argv[i];
+                return -1;
+            }
+            (is_blocks ? num_blocks : num_queries) = n;
+            ++i;
+            break;
+        }
         }
     }
 
@@ -280,6 +413,7 @@ int main(int argc, char **argv) {
     switch (action) {
     case Show: success = show(filename, list_blocks, only_metadata); break;
     case Print: success = print(filename, fromCoor, sizeCoor); break;
+    case Bench: success = bench(filename, num_blocks, num_queries); break;
     case Help: std::cout << help << std::endl; break;
     }
 